@@ -22,103 +22,518 @@
 ////////////////////////////////////////////////////////////////////////////////
 /// @page EVDS_Callback_NRLMSISE_00 NRLMSISE-00 Earth atmospheric model
 ///
+/// The callback EVDS_NRLMSISE_00_GetAtmosphericData() evaluates the NRLMSISE-00 model
+/// for the given point. It can be used directly as the "atmospheric_data" variable
+/// of a planet. The space weather inputs are read from the following variables of
+/// the planet:
+/// Variable			| Description
+/// --------------------|---------------------------------------------------------
+/// nrlmsise-00_ap0..6	| Magnetic index array (daily AP and 3-hour AP history, default 4.0)
+/// nrlmsise-00_f107	| F10.7 flux for the previous day (default 150.0)
+/// nrlmsise-00_f107a	| 81-day average of F10.7 flux (default 150.0)
+/// nrlmsise-00_cadence	| Interval between cache refreshes in seconds (default 600.0)
 ///
+/// Full evaluation of the model is expensive, so EVDS_NRLMSISE_00_Initialize() can be
+/// used to attach a cache to the planet. The cache stores the space weather inputs
+/// and an altitude/latitude/local solar time grid of model outputs (logarithms of
+/// number densities and temperature). Grid nodes are evaluated lazily and are
+/// interpolated trilinearly, so that a query costs a table lookup instead of a full
+/// model run.
+///
+/// The cache is stamped with the system time of its last refresh. When the system
+/// time moves away from the stamp by more than "nrlmsise-00_cadence" seconds, the
+/// inputs are read again and all grid nodes are invalidated. Between refreshes the
+/// grid nodes keep the day of year and universal time of the stamp, while the diurnal
+/// variation is still tracked: the local solar time of a query is computed from the
+/// current system time and interpolated along the local solar time axis of the grid.
+///
+/// Points above the top of the grid are evaluated directly (using cached inputs).
+///
+/// The model is never evaluated while the cache is locked: missing nodes are evaluated
+/// outside the lock and published afterwards (unless the cache was refreshed meanwhile),
+/// so threads querying the cache are not serialized behind a cold grid.
 ////////////////////////////////////////////////////////////////////////////////
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <math.h>
 #include <evds.h>
 #include <nrlmsise-00.h>
 #include "evds_nrlmsise-00.h"
 
 
+//Grid steps along altitude (km), latitude (deg) and local solar time (hours)
+#define EVDS_NRLMSISE_00_ALTITUDE_STEP		10.0
+#define EVDS_NRLMSISE_00_LATITUDE_STEP		10.0
+#define EVDS_NRLMSISE_00_TIME_STEP			1.0
+//Number of grid nodes along each axis
+#define EVDS_NRLMSISE_00_ALTITUDE_NODES		101
+#define EVDS_NRLMSISE_00_LATITUDE_NODES		19
+#define EVDS_NRLMSISE_00_TIME_NODES			25
+//Values stored per node (logarithms of 9 densities, exospheric and local temperature)
+#define EVDS_NRLMSISE_00_NODE_SIZE			11
+//Default refresh cadence (seconds)
+#define EVDS_NRLMSISE_00_DEFAULT_CADENCE	600.0
+
+
+#ifndef DOXYGEN_INTERNAL_STRUCTS
+typedef struct EVDS_INTERNAL_NRLMSISE_00_CACHE_TAG {
+#ifndef EVDS_SINGLETHREADED
+	SIMC_LOCK_ID lock;			//Lock for refreshing cache and publishing nodes
+#endif
+	EVDS_REAL time;				//System time (MJD) of last refresh
+	EVDS_REAL cadence;			//Refresh cadence (days)
+	int generation;				//Generation of the cache (incremented on refresh)
+
+	struct ap_array aph;		//Cached magnetic indexes
+	EVDS_REAL f107;				//Cached F10.7 flux
+	EVDS_REAL f107a;			//Cached 81-day average F10.7 flux
+
+	double* nodes;				//Node values
+	int* node_generation;		//Generation in which each node was computed
+	int hits;					//Number of node lookups served from the cache
+	int misses;					//Number of node lookups which required evaluating the model
+} EVDS_INTERNAL_NRLMSISE_00_CACHE;
+#endif
+
+
 
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief Callback that returns atmospheric data according to NRLMSISE-00
+/// @brief Convert MJD time to year, day of year and seconds of the day
 ////////////////////////////////////////////////////////////////////////////////
-int EVDS_NRLMSISE_00_GetAtmosphericData(EVDS_OBJECT* earth, EVDS_VECTOR* r, EVDS_ENVIRONMENT_ATMOSPHERE* atmosphere) {
-	int i;
-	EVDS_REAL value;
-	EVDS_VARIABLE* variable;
+void EVDS_InternalNRLMSISE_00_GetDate(EVDS_REAL mjd, int* year, int* doy, EVDS_REAL* sec) {
+	long days,z,era,doe,yoe,y,mp,m;
 
-	struct nrlmsise_output output;
-	struct nrlmsise_input input;
-	struct nrlmsise_flags flags;
-	struct ap_array aph;
-	EVDS_REAL latitude,longitude,altitude;
+	//Days since 0000-03-01 in proleptic Gregorian calendar
+	days = (long)floor(mjd);
+	z = days - 40587 + 719468;
+	era = (z >= 0 ? z : z - 146096) / 146097;
+	doe = z - era*146097;
+	yoe = (doe - doe/1460 + doe/36524 - doe/146096) / 365;
+	mp = (5*(doe - (365*yoe + yoe/4 - yoe/100)) + 2)/153;
+	m = (mp < 10) ? mp+3 : mp-9;
+	y = yoe + era*400 + ((m <= 2) ? 1 : 0);
 
-	//Read position
-	EVDS_Vector_ToGeographicCoordinates(earth,r,&latitude,&longitude,&altitude);
+	//Days since 1st of January of the same year
+	z = y - 1; //1st of January belongs to the previous March-based year
+	era = (z >= 0 ? z : z - 399) / 400;
+	yoe = z - era*400;
+	doe = yoe*365 + yoe/4 - yoe/100 + 306;
 
-	//Setup input for the model
-	//input.year = 1900+cur_time->tm_year;
-	//input.doy = cur_time->tm_yday;
-	//input.sec = cur_time->tm_sec+cur_time->tm_min*60+cur_time->tm_hour*3600;
-	input.alt = altitude*1e-3;
-	input.g_lat = latitude;
-	input.g_long = longitude;
-	//input.lst = input.sec/3600.0 + input.g_long/15.0;
+	*year = (int)y;
+	*doy = (int)(days - 40587 + 719468 - (era*146097 + doe)) + 1;
+	*sec = (mjd - floor(mjd))*86400.0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Read space weather inputs from planet variables
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalNRLMSISE_00_ReadInputs(EVDS_OBJECT* earth, struct ap_array* aph, EVDS_REAL* f107, EVDS_REAL* f107a) {
+	int i;
+	EVDS_REAL value;
+	EVDS_VARIABLE* variable;
 
 	//Read AP indexes
 	for (i = 0; i < 7; i++) {
 		char variable_name[256];
 		sprintf(variable_name,"nrlmsise-00_ap%d",i);
 
-		aph.a[i] = 4.0;
+		aph->a[i] = 4.0;
 		EVDS_Object_GetRealVariable(earth,variable_name,&value,&variable);
-		if (variable) aph.a[i] = value;
+		if (variable) aph->a[i] = value;
 	}
-	input.ap = aph.a[0];
-	input.ap_a = &aph;
 
 	//Read f107/f107a
-	input.f107 = 150.0;
-	input.f107A = 150.0;
+	*f107 = 150.0;
+	*f107a = 150.0;
 	EVDS_Object_GetRealVariable(earth,"nrlmsise-00_f107",&value,&variable);
-	if (variable) input.f107 = value;
+	if (variable) *f107 = value;
 	EVDS_Object_GetRealVariable(earth,"nrlmsise-00_f107a",&value,&variable);
-	if (variable) input.f107A = value;
+	if (variable) *f107a = value;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Run full NRLMSISE-00 model
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalNRLMSISE_00_Evaluate(EVDS_REAL mjd, struct ap_array* aph, EVDS_REAL f107, EVDS_REAL f107a,
+									   EVDS_REAL latitude, EVDS_REAL longitude, EVDS_REAL altitude,
+									   struct nrlmsise_output* output) {
+	int i;
+	EVDS_REAL sec;
+	struct nrlmsise_input input;
+	struct nrlmsise_flags flags;
+
+	//Setup input for the model
+	EVDS_InternalNRLMSISE_00_GetDate(mjd,&input.year,&input.doy,&sec);
+	input.sec = sec;
+	input.alt = altitude*1e-3;
+	input.g_lat = latitude;
+	input.g_long = longitude;
+	input.lst = input.sec/3600.0 + input.g_long/15.0;
+	input.lst = fmod(input.lst+24.0,24.0);
+	input.f107 = f107;
+	input.f107A = f107a;
+	input.ap = aph->a[0];
+	input.ap_a = aph;
 
 	//Setup switches
 	for (i = 0; i < 24; i++) flags.switches[i] = 1;
-	flags.switches[0] = 0; //Output data in meters
+	flags.switches[0] = 0; //Output data in centimeters and grams
 	flags.switches[9] = -1; //Use ap_a array
 
 	//Execute correct model
 	if (altitude < 200000) { //Mass density
-		gtd7(&input, &flags, &output);
+		gtd7(&input, &flags, output);
 	} else { //Effective density
-		gtd7d(&input, &flags, &output);
+		gtd7d(&input, &flags, output);
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Fill atmospheric parameters from model output
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalNRLMSISE_00_ReadOutput(struct nrlmsise_output* output, EVDS_ENVIRONMENT_ATMOSPHERE* atmosphere) {
+	int i;
+	const static int species[9] = {
+		EVDS_ENVIRONMENT_SPECIES_HE, EVDS_ENVIRONMENT_SPECIES_O, EVDS_ENVIRONMENT_SPECIES_N2,
+		EVDS_ENVIRONMENT_SPECIES_O2, EVDS_ENVIRONMENT_SPECIES_AR, -1,
+		EVDS_ENVIRONMENT_SPECIES_H,  EVDS_ENVIRONMENT_SPECIES_N,  -1 };
+	const static double molar_mass[9] = { //kg/mol
+		4.0026e-3, 15.999e-3, 28.0134e-3, 31.9988e-3, 39.948e-3, 0.0, 1.008e-3, 14.007e-3, 0.0 };
+
+	atmosphere->density = output->d[5]*1e3;
+	atmosphere->pressure = 287*output->t[1]*output->d[5]*1e3;
+	atmosphere->temperature = output->t[1];
+
+	//Partial concentrations and densities (model output is per cubic centimeter)
+	atmosphere->concentration = 0.0;
+	for (i = 0; i < 9; i++) {
+		if (species[i] < 0) continue;
+		atmosphere->partial_concentration[species[i]] = output->d[i]*1e6;
+		atmosphere->partial_density[species[i]] = output->d[i]*1e6*molar_mass[i]/6.02214076e23;
+		atmosphere->concentration += output->d[i]*1e6;
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Refresh cache if system time moved away from the cache stamp.
+///
+/// Must be called with cache lock held.
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalNRLMSISE_00_Refresh(EVDS_OBJECT* earth, EVDS_INTERNAL_NRLMSISE_00_CACHE* cache, EVDS_REAL mjd) {
+	EVDS_REAL cadence;
+	if ((cache->generation > 0) && (fabs(mjd - cache->time) <= cache->cadence)) return;
+
+	//Read new inputs
+	EVDS_InternalNRLMSISE_00_ReadInputs(earth,&cache->aph,&cache->f107,&cache->f107a);
+	if (EVDS_Object_GetRealVariable(earth,"nrlmsise-00_cadence",&cadence,0) != EVDS_OK) {
+		cadence = EVDS_NRLMSISE_00_DEFAULT_CADENCE;
+	}
+
+	//Invalidate all nodes
+	cache->cadence = cadence/86400.0;
+	cache->time = mjd;
+	cache->generation++;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Get index of the cache grid node
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalNRLMSISE_00_GetNodeIndex(int ia, int ib, int it) {
+	return (it*EVDS_NRLMSISE_00_LATITUDE_NODES + ib)*EVDS_NRLMSISE_00_ALTITUDE_NODES + ia;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Evaluate values of the cache grid node.
+///
+/// Uses inputs captured from the cache, does not access the cache itself (can be called
+/// without holding the cache lock).
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalNRLMSISE_00_EvaluateNode(EVDS_REAL mjd, struct ap_array* aph, EVDS_REAL f107, EVDS_REAL f107a,
+										   int ia, int ib, int it, double* node) {
+	int i;
+	EVDS_REAL sec,longitude;
+	struct nrlmsise_output output;
+
+	//Longitude at which local solar time of the node is reached at cache time
+	sec = (mjd - floor(mjd))*86400.0;
+	longitude = 15.0*(it*EVDS_NRLMSISE_00_TIME_STEP - sec/3600.0);
+	longitude = fmod(longitude+540.0,360.0)-180.0;
+
+	//Evaluate model
+	EVDS_InternalNRLMSISE_00_Evaluate(mjd,aph,f107,f107a,
+		-90.0+ib*EVDS_NRLMSISE_00_LATITUDE_STEP,longitude,
+		ia*EVDS_NRLMSISE_00_ALTITUDE_STEP*1e3,&output);
+	for (i = 0; i < 9; i++) node[i] = log(output.d[i] > 1e-300 ? output.d[i] : 1e-300);
+	node[9] = output.t[0];
+	node[10] = output.t[1];
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Callback that returns atmospheric data according to NRLMSISE-00
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_NRLMSISE_00_GetAtmosphericData(EVDS_OBJECT* earth, EVDS_VECTOR* r, EVDS_ENVIRONMENT_ATMOSPHERE* atmosphere) {
+	int i,j,ia,ib,it,ja,jb,jt;
+	int generation,missing;
+	int valid[8];
+	double nodes[8][EVDS_NRLMSISE_00_NODE_SIZE];
+	EVDS_REAL mjd,cache_time,sec,lst;
+	EVDS_REAL fa,fb,ft;
+	EVDS_SYSTEM* system;
+	EVDS_VARIABLE* variable;
+	EVDS_GEODETIC_COORDINATE geocoord;
+	EVDS_INTERNAL_NRLMSISE_00_CACHE* cache = 0;
+	struct nrlmsise_output output;
+	struct ap_array aph;
+	EVDS_REAL f107,f107a;
+
+	//Read position and time
+	EVDS_Geodetic_FromVector(&geocoord,r,0);
+	EVDS_Object_GetSystem(earth,&system);
+	EVDS_System_GetTime(system,&mjd);
+
+	//Find cache
+	if (EVDS_Object_GetVariable(earth,"nrlmsise-00_cache",&variable) == EVDS_OK) {
+		EVDS_Variable_GetDataPointer(variable,(void**)&cache);
 	}
 
-	//Read back
-	atmosphere->density = output.d[5]*1e3;
-	atmosphere->pressure = 287*output.t[1]*output.d[5]*1e3;
-	atmosphere->temperature = output.t[1];
-	/*v->air.density_He	= 1e-3*output.d[0]*4.0/6.022e23;
-	v->air.density_O	= 1e-3*output.d[1]*16.0/6.022e23;
-	v->air.density_N2	= 1e-3*output.d[2]*28.0/6.022e23;
-	v->air.density_O2	= 1e-3*output.d[3]*32.0/6.022e23;
-	v->air.density_Ar	= 1e-3*output.d[4]*40.0/6.022e23;
-	v->air.density_H	= 1e-3*output.d[6]*1.0/6.022e23;
-	v->air.density_N	= 1e-3*output.d[7]*14.0/6.022e23;
-	v->air.density		= output.d[5]*1e3;
-	v->air.concentration_He	= output.d[0];
-	v->air.concentration_O	= output.d[1];
-	v->air.concentration_N2	= output.d[2];
-	v->air.concentration_O2	= output.d[3];
-	v->air.concentration_Ar	= output.d[4];
-	v->air.concentration_H	= output.d[6];
-	v->air.concentration_N	= output.d[7];
-	v->air.concentration = output.d[0]+output.d[1]+output.d[2]+
-	                       output.d[3]+output.d[4]+output.d[6]+
-	                       output.d[7];
-
-	v->air.temperature = output.t[1];
-	v->air.exospheric_temperature = output.t[0];
-	v->air.pressure = 287*output.t[1]*output.d[5]*1e3; //P = (R[air]T)/d
-
-	vmag = sqrt(v->sim.vx*v->sim.vx+v->sim.vy*v->sim.vy+v->sim.vz*v->sim.vz);
-	v->air.Q = (0.5)*vmag*vmag*v->air.density;*/
+	//Evaluate full model if no cache is present
+	if (!cache) {
+		EVDS_InternalNRLMSISE_00_ReadInputs(earth,&aph,&f107,&f107a);
+		EVDS_InternalNRLMSISE_00_Evaluate(mjd,&aph,f107,f107a,
+			geocoord.latitude,geocoord.longitude,geocoord.elevation,&output);
+		EVDS_InternalNRLMSISE_00_ReadOutput(&output,atmosphere);
+		return EVDS_OK;
+	}
+
+	//Refresh cache and capture its inputs
+#ifndef EVDS_SINGLETHREADED
+	SIMC_Lock_Enter(cache->lock);
+#endif
+	EVDS_InternalNRLMSISE_00_Refresh(earth,cache,mjd);
+	generation = cache->generation;
+	cache_time = cache->time;
+	aph = cache->aph;
+	f107 = cache->f107;
+	f107a = cache->f107a;
+#ifndef EVDS_SINGLETHREADED
+	SIMC_Lock_Leave(cache->lock);
+#endif
+
+	//Evaluate model directly above the grid
+	fa = (geocoord.elevation*1e-3)/EVDS_NRLMSISE_00_ALTITUDE_STEP;
+	if (fa >= EVDS_NRLMSISE_00_ALTITUDE_NODES-1) {
+		EVDS_InternalNRLMSISE_00_Evaluate(mjd,&aph,f107,f107a,
+			geocoord.latitude,geocoord.longitude,geocoord.elevation,&output);
+		EVDS_InternalNRLMSISE_00_ReadOutput(&output,atmosphere);
+		return EVDS_OK;
+	}
+	if (fa < 0.0) fa = 0.0;
+
+	//Local solar time at current time
+	sec = (mjd - floor(mjd))*86400.0;
+	lst = fmod(sec/3600.0 + geocoord.longitude/15.0 + 48.0,24.0);
+
+	//Find grid cell
+	fb = (geocoord.latitude+90.0)/EVDS_NRLMSISE_00_LATITUDE_STEP;
+	ft = lst/EVDS_NRLMSISE_00_TIME_STEP;
+	ia = (int)fa; if (ia > EVDS_NRLMSISE_00_ALTITUDE_NODES-2) ia = EVDS_NRLMSISE_00_ALTITUDE_NODES-2;
+	ib = (int)fb; if (ib > EVDS_NRLMSISE_00_LATITUDE_NODES-2) ib = EVDS_NRLMSISE_00_LATITUDE_NODES-2;
+	it = (int)ft; if (it > EVDS_NRLMSISE_00_TIME_NODES-2) it = EVDS_NRLMSISE_00_TIME_NODES-2;
+	if (ib < 0) ib = 0;
+	fa -= ia; fb -= ib; ft -= it;
+	if (fb < 0.0) fb = 0.0;
+	if (fb > 1.0) fb = 1.0;
+
+	//Copy nodes of the cell which are already present in the cache
+	missing = 0;
+#ifndef EVDS_SINGLETHREADED
+	SIMC_Lock_Enter(cache->lock);
+#endif
+	for (j = 0; j < 8; j++) {
+		int index = EVDS_InternalNRLMSISE_00_GetNodeIndex(ia+(j&1),ib+((j>>1)&1),it+(j>>2));
+		valid[j] = (cache->generation == generation) && (cache->node_generation[index] == generation);
+		if (valid[j]) {
+			memcpy(nodes[j],&cache->nodes[index*EVDS_NRLMSISE_00_NODE_SIZE],sizeof(nodes[j]));
+			cache->hits++;
+		} else {
+			missing++;
+			cache->misses++;
+		}
+	}
+#ifndef EVDS_SINGLETHREADED
+	SIMC_Lock_Leave(cache->lock);
+#endif
+
+	//Evaluate missing nodes without holding the lock, then publish them
+	if (missing) {
+		for (j = 0; j < 8; j++) {
+			if (!valid[j]) {
+				EVDS_InternalNRLMSISE_00_EvaluateNode(cache_time,&aph,f107,f107a,
+					ia+(j&1),ib+((j>>1)&1),it+(j>>2),nodes[j]);
+			}
+		}
+
+#ifndef EVDS_SINGLETHREADED
+		SIMC_Lock_Enter(cache->lock);
+#endif
+		if (cache->generation == generation) { //Nodes of an outdated generation are discarded
+			for (j = 0; j < 8; j++) {
+				int index = EVDS_InternalNRLMSISE_00_GetNodeIndex(ia+(j&1),ib+((j>>1)&1),it+(j>>2));
+				if ((!valid[j]) && (cache->node_generation[index] != generation)) {
+					memcpy(&cache->nodes[index*EVDS_NRLMSISE_00_NODE_SIZE],nodes[j],sizeof(nodes[j]));
+					cache->node_generation[index] = generation;
+				}
+			}
+		}
+#ifndef EVDS_SINGLETHREADED
+		SIMC_Lock_Leave(cache->lock);
+#endif
+	}
+
+	//Trilinear interpolation (logarithms of densities, temperatures)
+	memset(&output,0,sizeof(output));
+	for (jt = 0; jt < 2; jt++) {
+		for (jb = 0; jb < 2; jb++) {
+			for (ja = 0; ja < 2; ja++) {
+				double* node = nodes[ja + 2*jb + 4*jt];
+				double w = (ja ? fa : 1.0-fa)*(jb ? fb : 1.0-fb)*(jt ? ft : 1.0-ft);
+				for (i = 0; i < 9; i++) output.d[i] += w*node[i];
+				output.t[0] += w*node[9];
+				output.t[1] += w*node[10];
+			}
+		}
+	}
+	for (i = 0; i < 9; i++) output.d[i] = exp(output.d[i]);
+
+	EVDS_InternalNRLMSISE_00_ReadOutput(&output,atmosphere);
+	return EVDS_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Attach NRLMSISE-00 model and its evaluation cache to the planet.
+///
+/// Must be called before the planet is initialized. Sets "atmospheric_data" of the planet
+/// to EVDS_NRLMSISE_00_GetAtmosphericData() and creates a cache which is stored in
+/// the "nrlmsise-00_cache" variable.
+///
+/// @param[in] earth Planet which will use the model
+///
+/// @returns Error code
+/// @retval EVDS_OK Successfully completed
+/// @retval EVDS_ERROR_BAD_PARAMETER "earth" is null
+/// @retval EVDS_ERROR_BAD_STATE Planet is already initialized
+/// @retval EVDS_ERROR_MEMORY Unable to allocate the cache
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_NRLMSISE_00_Initialize(EVDS_OBJECT* earth) {
+	int nodes;
+	EVDS_VARIABLE* variable;
+	EVDS_INTERNAL_NRLMSISE_00_CACHE* cache;
+	if (!earth) return EVDS_ERROR_BAD_PARAMETER;
+
+	//Set callback
+	EVDS_ERRCHECK(EVDS_Object_AddVariable(earth,"atmospheric_data",EVDS_VARIABLE_TYPE_FUNCTION_PTR,&variable));
+	EVDS_Variable_SetFunctionPointer(variable,(void*)EVDS_NRLMSISE_00_GetAtmosphericData);
+	EVDS_ERRCHECK(EVDS_Object_AddVariable(earth,"nrlmsise-00_cache",EVDS_VARIABLE_TYPE_DATA_PTR,&variable));
+
+	//Create cache
+	nodes = EVDS_NRLMSISE_00_ALTITUDE_NODES*EVDS_NRLMSISE_00_LATITUDE_NODES*EVDS_NRLMSISE_00_TIME_NODES;
+	cache = (EVDS_INTERNAL_NRLMSISE_00_CACHE*)malloc(sizeof(EVDS_INTERNAL_NRLMSISE_00_CACHE));
+	if (!cache) return EVDS_ERROR_MEMORY;
+	memset(cache,0,sizeof(EVDS_INTERNAL_NRLMSISE_00_CACHE));
+	cache->nodes = (double*)malloc(sizeof(double)*EVDS_NRLMSISE_00_NODE_SIZE*nodes);
+	cache->node_generation = (int*)calloc(nodes,sizeof(int));
+	if ((!cache->nodes) || (!cache->node_generation)) {
+		free(cache->nodes);
+		free(cache->node_generation);
+		free(cache);
+		return EVDS_ERROR_MEMORY;
+	}
+#ifndef EVDS_SINGLETHREADED
+	cache->lock = SIMC_Lock_Create();
+#endif
+	EVDS_Variable_SetDataPointer(variable,cache);
+	return EVDS_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Free the NRLMSISE-00 evaluation cache of the planet.
+///
+/// Must be called before the planet is destroyed if EVDS_NRLMSISE_00_Initialize()
+/// was used.
+///
+/// @param[in] earth Planet which uses the model
+///
+/// @returns Error code
+/// @retval EVDS_OK Successfully completed
+/// @retval EVDS_ERROR_BAD_PARAMETER "earth" is null
+/// @retval EVDS_ERROR_NOT_FOUND Planet has no cache
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_NRLMSISE_00_Deinitialize(EVDS_OBJECT* earth) {
+	EVDS_VARIABLE* variable;
+	EVDS_INTERNAL_NRLMSISE_00_CACHE* cache = 0;
+	if (!earth) return EVDS_ERROR_BAD_PARAMETER;
+
+	EVDS_ERRCHECK(EVDS_Object_GetVariable(earth,"nrlmsise-00_cache",&variable));
+	EVDS_Variable_GetDataPointer(variable,(void**)&cache);
+	if (!cache) return EVDS_ERROR_NOT_FOUND;
+	EVDS_Variable_SetDataPointer(variable,0);
+
+#ifndef EVDS_SINGLETHREADED
+	SIMC_Lock_Destroy(cache->lock);
+#endif
+	free(cache->nodes);
+	free(cache->node_generation);
+	free(cache);
+	return EVDS_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Get statistics of the NRLMSISE-00 evaluation cache of the planet.
+///
+/// Every query inside the grid looks up 8 nodes. Lookups which find a node computed in the
+/// current generation of the cache are counted as hits, all other lookups require evaluating
+/// the model and are counted as misses. Generation is incremented every time the cache is
+/// refreshed (see "nrlmsise-00_cadence").
+///
+/// @param[in] earth Planet which uses the model
+/// @param[out] hits Number of node lookups served from the cache (may be null)
+/// @param[out] misses Number of node lookups which required evaluating the model (may be null)
+/// @param[out] generation Current generation of the cache (may be null)
+///
+/// @returns Error code
+/// @retval EVDS_OK Successfully completed
+/// @retval EVDS_ERROR_BAD_PARAMETER "earth" is null
+/// @retval EVDS_ERROR_NOT_FOUND Planet has no cache
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_NRLMSISE_00_GetCacheStatistics(EVDS_OBJECT* earth, int* hits, int* misses, int* generation) {
+	EVDS_VARIABLE* variable;
+	EVDS_INTERNAL_NRLMSISE_00_CACHE* cache = 0;
+	if (!earth) return EVDS_ERROR_BAD_PARAMETER;
+
+	EVDS_ERRCHECK(EVDS_Object_GetVariable(earth,"nrlmsise-00_cache",&variable));
+	EVDS_Variable_GetDataPointer(variable,(void**)&cache);
+	if (!cache) return EVDS_ERROR_NOT_FOUND;
+
+#ifndef EVDS_SINGLETHREADED
+	SIMC_Lock_Enter(cache->lock);
+#endif
+	if (hits) *hits = cache->hits;
+	if (misses) *misses = cache->misses;
+	if (generation) *generation = cache->generation;
+#ifndef EVDS_SINGLETHREADED
+	SIMC_Lock_Leave(cache->lock);
+#endif
 	return EVDS_OK;
-}
\ No newline at end of file
+}
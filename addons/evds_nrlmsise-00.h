@@ -36,6 +36,12 @@ extern "C" {
 
 // Atmospheric data callback
 int EVDS_NRLMSISE_00_GetAtmosphericData(EVDS_OBJECT* earth, EVDS_VECTOR* r, EVDS_ENVIRONMENT_ATMOSPHERE* atmosphere);
+// Attach model and its evaluation cache to the planet (before planet is initialized)
+int EVDS_NRLMSISE_00_Initialize(EVDS_OBJECT* earth);
+// Free evaluation cache of the planet
+int EVDS_NRLMSISE_00_Deinitialize(EVDS_OBJECT* earth);
+// Get statistics of the evaluation cache of the planet
+int EVDS_NRLMSISE_00_GetCacheStatistics(EVDS_OBJECT* earth, int* hits, int* misses, int* generation);
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @}
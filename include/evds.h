@@ -393,6 +393,10 @@ typedef int EVDS_Callback_Solve(EVDS_SYSTEM* system, EVDS_SOLVER* solver, EVDS_O
 typedef int EVDS_Callback_Integrate(EVDS_SYSTEM* system, EVDS_SOLVER* solver, EVDS_OBJECT* object,
 									EVDS_REAL delta_time, EVDS_STATE_VECTOR* state, EVDS_STATE_VECTOR_DERIVATIVE* derivative);
 
+/// Solver "Integrate" callback is re-entrant: it may be called for different objects from several threads
+/// at once, and it only depends on the objects own state and variables
+#define EVDS_SOLVER_FLAG_REENTRANT		1
+
 /// @}
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -416,6 +420,12 @@ typedef int EVDS_Callback_Integrate(EVDS_SYSTEM* system, EVDS_SOLVER* solver, EV
 /// @note The initialization callback must return EVDS_CLAIM_OBJECT or EVDS_IGNORE_OBJECT. It will be
 ///       called for every object created and initialized with EVDS_SYSTEM.
 ///
+/// Solvers whose EVDS_SOLVER::OnIntegrate callback only depends on the objects own state and variables
+/// may set EVDS_SOLVER_FLAG_REENTRANT in EVDS_SOLVER::flags. Derivatives of such objects may be computed
+/// by worker threads in parallel (see EVDS_System_ParallelFor()). The callback may still convert vectors
+/// through coordinates of its parents, worker threads see them in the same (intermediate) state as the
+/// thread which integrates the parent.
+///
 /// The EVDS_SOLVER::OnStartup callback is called right after the solver was registered with EVDS_SYSTEM.
 /// EVDS_SOLVER::OnShutdown callback will be called when EVDS_SYSTEM is destroyed. The solver may allocate and free
 /// its 'global' resources in these callbacks.
@@ -470,9 +480,23 @@ struct EVDS_SOLVER {
 
 	// User-defined data
 	void* userdata;										///< Pointer to user data
+
+	// Solver flags
+	int flags;											///< Solver flags (see EVDS_SOLVER_FLAG_REENTRANT)
 };
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// @ingroup EVDS_SYSTEM
+/// @{
+
+/// Called by worker threads for every item of a parallel job (see EVDS_System_ParallelFor())
+typedef int EVDS_Callback_Job(EVDS_SYSTEM* system, void* userdata, int index);
+
+/// @}
+////////////////////////////////////////////////////////////////////////////////
+
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @ingroup EVDS_SYSTEM
 /// @brief A list of global callbacks.
@@ -528,6 +552,8 @@ typedef int EVDS_Callback_SyntaxError(EVDS_OBJECT_LOADEX* info, const char* erro
 #define EVDS_OBJECT_LOADEX_DONT_INITIALIZE		128
 /// Use blocking initialization
 #define EVDS_OBJECT_LOADEX_BLOCKING_INITIALIZE	256
+/// Read the input as a stream instead of parsing the whole document first
+#define EVDS_OBJECT_LOADEX_STREAMING			512
 
 /// Save only children of the object passed into EVDS_Object_SaveEx()
 #define EVDS_OBJECT_SAVEEX_ONLY_CHILDREN		1
@@ -568,6 +594,7 @@ typedef int EVDS_Callback_SyntaxError(EVDS_OBJECT_LOADEX* info, const char* erro
 /// @c EVDS_OBJECT_LOADEX_ONLY_FIRST		| Only load the first object in file and skip all following.
 /// @c EVDS_OBJECT_LOADEX_NO_OBJECTS		| Do not load any objects from the file.
 /// @c EVDS_OBJECT_LOADEX_NO_DATABASES		| Do not load any databases from the file.
+/// @c EVDS_OBJECT_LOADEX_STREAMING		| Create objects while the input is read (for very large files).
 ///
 ///	See EVDS_Object_LoadEx() for more information.
 ////////////////////////////////////////////////////////////////////////////////
@@ -868,9 +895,15 @@ typedef struct EVDS_ENVIRONMENT_ATMOSPHERE_TAG {
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @ingroup EVDS_ENVIRONMENT
-/// @brief Structure describing the radiation environment (placeholder).
+/// @brief Structure describing the radiation environment.
 ////////////////////////////////////////////////////////////////////////////////
 typedef struct EVDS_ENVIRONMENT_RADIATION_TAG {
+	EVDS_REAL electron_flux;				///< Trapped electron integral flux [1/(m2 s)]
+	EVDS_REAL proton_flux;					///< Trapped proton integral flux [1/(m2 s)]
+	EVDS_REAL solar_flux;					///< Solar particle integral flux [1/(m2 s)]
+	EVDS_REAL dose_rate;					///< Absorbed dose rate [Gy/s]
+	EVDS_REAL L;							///< McIlwain L-shell parameter
+	EVDS_REAL B_B0;							///< Magnetic field strength relative to the equatorial field strength on the same field line
 	void* userdata;							///< Pointer to user data 
 } EVDS_ENVIRONMENT_RADIATION;
 
@@ -947,6 +980,16 @@ typedef int EVDS_Callback_GetRadiationData(EVDS_OBJECT* object, EVDS_VECTOR* r,
 /// Multi-dimensional interpolated function defined by polynomials or a table
 #define EVDS_VARIABLE_TYPE_FUNCTION		7
 
+/// Size of the lookup hint for functions (see EVDS_Variable_GetFunctionValueHint())
+#define EVDS_VARIABLE_FUNCTION_HINT_SIZE	3
+
+/// Function is not compiled (tables are interpolated directly)
+#define EVDS_VARIABLE_FUNCTION_COMPILE_NONE	0
+/// Function is compiled into a dense regular grid
+#define EVDS_VARIABLE_FUNCTION_COMPILE_GRID	1
+/// 1D function is replaced by a piecewise Chebyshev approximation
+#define EVDS_VARIABLE_FUNCTION_COMPILE_CHEBYSHEV	2
+
 /// @}
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -1061,6 +1104,13 @@ EVDS_API int EVDS_System_QueryByReference(EVDS_SYSTEM* system, EVDS_OBJECT* pare
 // Cleanup objects (mandatory to call once in a while, in multithreaded environment only)
 EVDS_API int EVDS_System_CleanupObjects(EVDS_SYSTEM* system);
 
+// Set number of worker threads used for parallel jobs
+EVDS_API int EVDS_System_SetWorkerThreads(EVDS_SYSTEM* system, int count);
+// Run a job for every index in [0, count) using worker threads
+EVDS_API int EVDS_System_ParallelFor(EVDS_SYSTEM* system, EVDS_Callback_Job* job, void* userdata, int count);
+// Wait until all objects with non-blocking initialization are initialized
+EVDS_API int EVDS_System_WaitForInitialization(EVDS_SYSTEM* system);
+
 // Load database from a file
 EVDS_API int EVDS_System_DatabaseFromFile(EVDS_SYSTEM* system, const char* filename);
 // Load database from a string
@@ -1167,6 +1217,16 @@ EVDS_API int EVDS_Object_SaveToFile(EVDS_OBJECT* object, const char* filename);
 EVDS_API int EVDS_Object_SaveToString(EVDS_OBJECT* object, char** description);
 // Save object. Extra information specified by info structure
 EVDS_API int EVDS_Object_SaveEx(EVDS_OBJECT* object, const char* filename, EVDS_OBJECT_SAVEEX* info);
+// Save object and its children into a binary snapshot
+EVDS_API int EVDS_Object_SaveBinary(EVDS_OBJECT* object, const char* filename);
+// Save object and its children into a binary snapshot in memory
+EVDS_API int EVDS_Object_SaveBinaryToMemory(EVDS_OBJECT* object, void** p_data, size_t* p_size);
+// Load objects from a binary snapshot. Will only return first pointer of all loaded objects (objects are not initialized)
+EVDS_API int EVDS_Object_LoadBinary(EVDS_OBJECT* parent, const char* filename, EVDS_OBJECT** p_object);
+// Load objects from a binary snapshot in memory (for example a memory-mapped file)
+EVDS_API int EVDS_Object_LoadBinaryFromMemory(EVDS_OBJECT* parent, const void* data, size_t size, EVDS_OBJECT** p_object);
+// Convert file between XML and binary snapshot formats
+EVDS_API int EVDS_Object_ConvertFile(EVDS_OBJECT* parent, const char* source, const char* target);
 // Destroy object (the data may remain in memory until object is free'd in other threads too)
 EVDS_API int EVDS_Object_Destroy(EVDS_OBJECT* object);
 
@@ -1364,6 +1424,12 @@ EVDS_API int EVDS_Variable_SetFunctionPointer(EVDS_VARIABLE* variable, void* dat
 EVDS_API int EVDS_Variable_GetFunctionPointer(EVDS_VARIABLE* variable, void** data);
 // Get value from a 1D/2D/3D function 
 EVDS_API int EVDS_Variable_GetFunctionValue(EVDS_VARIABLE* variable, EVDS_REAL x, EVDS_REAL y, EVDS_REAL z, EVDS_REAL* p_value);
+// Get value from a 1D/2D/3D function using a caller-held lookup hint
+EVDS_API int EVDS_Variable_GetFunctionValueHint(EVDS_VARIABLE* variable, EVDS_REAL x, EVDS_REAL y, EVDS_REAL z, int* hint, EVDS_REAL* p_value);
+// Get values from a 1D/2D/3D function for many sets of arguments
+EVDS_API int EVDS_Variable_GetFunctionValues(EVDS_VARIABLE* variable, const EVDS_REAL* x, const EVDS_REAL* y, const EVDS_REAL* z, int n, EVDS_REAL* out);
+// Compile a function into a faster representation
+EVDS_API int EVDS_Variable_CompileFunction(EVDS_VARIABLE* variable, int method);
 
 // Convert variable to a printable string
 EVDS_API int EVDS_Variable_ToString(EVDS_VARIABLE* variable, char* string, size_t max_length);
@@ -1555,6 +1621,16 @@ EVDS_API void EVDS_ShortVector_Multiply(EVDS_SHORT_VECTOR* target, EVDS_SHORT_VE
 ////////////////////////////////////////////////////////////////////////////////
 // Get acceleration due to gravity in the given position (local X Y Z acceleration, field)
 EVDS_API int EVDS_Environment_GetGravitationalField(EVDS_SYSTEM* system, EVDS_VECTOR* position, EVDS_REAL* phi, EVDS_VECTOR* field);
+// Get gravitational field in many positions at once (in coordinates of the first position)
+EVDS_API int EVDS_Environment_GetGravitationalFieldMany(EVDS_SYSTEM* system, EVDS_VECTOR* positions, int count, EVDS_REAL* phi, EVDS_VECTOR* field);
+// Get gravity gradient torque upon a body with the given inertia tensor
+EVDS_API int EVDS_Environment_GetGravityGradientTorque(EVDS_SYSTEM* system, EVDS_VECTOR* position, EVDS_VECTOR* Ix, EVDS_VECTOR* Iy, EVDS_VECTOR* Iz, EVDS_VECTOR* torque);
+// Set opening angle and smallest number of bodies for Barnes-Hut approximation of gravitational field
+EVDS_API int EVDS_Environment_SetGravityApproximation(EVDS_SYSTEM* system, EVDS_REAL opening_angle, int threshold);
+// Get planet with the smallest sphere of influence containing the given position
+EVDS_API int EVDS_Environment_GetDominantBody(EVDS_SYSTEM* system, EVDS_VECTOR* position, EVDS_OBJECT** p_planet);
+// Move vessels into propagator frames of their dominant bodies
+EVDS_API int EVDS_Environment_UpdatePatchedFrames(EVDS_SYSTEM* system);
 // Get magnetic field vector in the given position (local X Y Z magnetic field)
 EVDS_API int EVDS_Environment_GetMagneticField(EVDS_SYSTEM* system, EVDS_VECTOR* position, EVDS_VECTOR* field);
 // Get atmospheric parameters (including contents by elements)
@@ -1653,6 +1729,9 @@ EVDS_API int EVDS_Mesh_Destroy(EVDS_MESH* mesh);
 ///		updated from an ephemeris, orbital information, or be physically simulated.
 /// - @subpage EVDS_Solver_Modifier "Modifier"
 ///		Creates copies of its children according to a predefined pattern.
+/// - @subpage EVDS_Solver_ArticulatedBody "Articulated body"
+///		Tree of rigid links connected by revolute or prismatic joints (robotic arms,
+///		deployable booms), solved with the articulated body algorithm.
 ///
 ///
 /// The following propagators are available:
@@ -1710,6 +1789,8 @@ EVDS_API int EVDS_Wiring_Register(EVDS_SYSTEM* system);
 EVDS_API int EVDS_Modifier_Register(EVDS_SYSTEM* system);
 // Aerodynamic wing or aerodynamic surface
 EVDS_API int EVDS_Wing_Register(EVDS_SYSTEM* system);
+// Articulated body (tree of links connected by joints)
+EVDS_API int EVDS_ArticulatedBody_Register(EVDS_SYSTEM* system);
 
 // Forward euler propagator
 EVDS_API int EVDS_Propagator_ForwardEuler_Register(EVDS_SYSTEM* system);
@@ -1722,6 +1803,10 @@ EVDS_API int EVDS_Propagator_RK4_Register(EVDS_SYSTEM* system);
 EVDS_API int EVDS_RigidBody_UpdateDetaching(EVDS_SYSTEM* system);
 // Returns EVDS_OK if rigid body is consistent (solver was called at least once)
 EVDS_API int EVDS_RigidBody_IsConsistent(EVDS_OBJECT* object);
+// Returns EVDS_OK if rigid body is sleeping (at rest and not being integrated)
+EVDS_API int EVDS_RigidBody_IsSleeping(EVDS_OBJECT* object);
+// Wake up a sleeping rigid body (for example after a collision)
+EVDS_API int EVDS_RigidBody_Wake(EVDS_OBJECT* object);
 // Get total mass of rigid body. If called upon a child, returns total mass of the parent including all children
 EVDS_API int EVDS_RigidBody_GetTotalMass(EVDS_OBJECT* object, EVDS_REAL* p_mass);
 
@@ -1748,6 +1833,7 @@ EVDS_Gimbal_Register(system); \
 EVDS_Planet_Register(system); \
 EVDS_Wiring_Register(system); \
 EVDS_Modifier_Register(system); \
+EVDS_ArticulatedBody_Register(system); \
 EVDS_Propagator_ForwardEuler_Register(system); \
 EVDS_Propagator_Heun_Register(system); \
 EVDS_Propagator_RK4_Register(system);
@@ -33,6 +33,9 @@ extern "C" {
 #	define snprintf _snprintf
 #	define snscanf _snscanf
 #	define alloca _alloca
+#	define EVDS_THREAD_LOCAL __declspec(thread)
+#else
+#	define EVDS_THREAD_LOCAL __thread
 #endif
 
 
@@ -112,12 +115,19 @@ extern "C" {
 /// data type. These functions are scalar functions of multiple variables.
 /// Currently the maximum number of dimensions is arbitrarily limited to three (@c x, @c y, @c z).
 ///
-/// Linear interpolation is the only available interpolation type. Constant value is used for extrapolation
-/// beyond the boundaries defined by the function.
+/// Interpolation type is selected with the @c interpolation attribute. Linear interpolation is used by
+/// default, and @c spline selects a natural cubic spline. Each spline segment is defined by five parameters,
+/// according to equation:
+///		\f$f(x) = y_0 + b (x-x_0) + c (x-x_0)^2 + d (x-x_0)^3\f$
 ///
-/// @todo In future it will be possible to define a function curve as a set of approximating splines. Each
-///		spline segment will be defined by five parameters, according to equation:
-///		\f$f(x) = y0^2 + b (x-x0) + c (x-x0)^2 + d (x-x0)^2\f$
+/// Spline coefficients are computed when the function is loaded. If nodes of a spline are nested functions,
+/// a cubic Hermite spline through neighbouring nodes is used instead. Value in the first or last node is used
+/// for extrapolation beyond the boundaries defined by the function.
+///
+/// Multi-dimensional functions may be compiled into a dense regular grid by specifying @c compile="grid"
+/// attribute (or by calling EVDS_Variable_CompileFunction()). This speeds up evaluation of large nested
+/// tables, see EVDS_Variable_CompileFunction() for details. One-dimensional tables may be replaced by a
+/// piecewise Chebyshev approximation with @c compile="chebyshev" and an optional @c tolerance attribute.
 ///
 /// Each dimension is defined by an array of values and an array of nested functions. Each nested function
 /// represents a multi-dimensional function for the remaining set of variables. For example, the 
@@ -361,6 +371,31 @@ typedef struct EVDS_VARIABLE_FVALUE_SPLINE_TAG {
 /// Spline interpolation (y = y0 + b (x-x0) + c (x-x0)^2 + d (x-x0)^3
 #define EVDS_VARIABLE_FUNCTION_INTERPOLATION_SPLINE		1
 
+/// Variable does not affect mass properties
+#define EVDS_VARIABLE_MASS_NONE			0
+/// Variable defines mass properties of the object itself (mass, cm, jx, jy, jz)
+#define EVDS_VARIABLE_MASS_PARAMETER	1
+/// Variable stores aggregated mass properties of the object (total_mass, total_cm, total_ix, ...)
+#define EVDS_VARIABLE_MASS_TOTAL		2
+
+typedef struct EVDS_VARIABLE_FUNCTION_GRID_TAG {
+	int dimensions;							//Number of axes in the grid
+	int count[3];							//Number of nodes along every axis
+	int stride[3];							//Distance between neighbouring nodes in the values array
+	EVDS_REAL* axis[3];						//Sorted nodes along every axis
+	int is_uniform[3];						//Are nodes spaced uniformly along the axis
+	EVDS_REAL inv_step[3];					//Inverse of spacing between nodes (for uniform axes)
+	int is_cubic[3];						//Use cubic interpolation along the axis
+	EVDS_REAL* values;						//Values in grid nodes (last axis changes fastest)
+} EVDS_VARIABLE_FUNCTION_GRID;
+
+typedef struct EVDS_VARIABLE_FUNCTION_CHEBYSHEV_TAG {
+	int count;								//Number of pieces
+	EVDS_REAL* breaks;						//Boundaries of pieces (count+1 entries, increasing)
+	int* offset;							//Index of the first coefficient for every piece (count+1 entries)
+	EVDS_REAL* coefficients;				//Chebyshev series coefficients for all pieces
+} EVDS_VARIABLE_FUNCTION_CHEBYSHEV;
+
 typedef struct EVDS_VARIABLE_FUNCTION_TAG {
 	int interpolation;					//Interpolation method for this function
 	union {
@@ -371,8 +406,11 @@ typedef struct EVDS_VARIABLE_FUNCTION_TAG {
 
 	EVDS_REAL constant_value;				//Constant value of the function
 	int data_count;							//Size of the values table
+	int has_nested;							//Are there nested functions in the table (spline not precomputed)
 
 	int variable_order[3];					//Order of variables (for swizzling/reordering)
+	EVDS_VARIABLE_FUNCTION_GRID* grid;		//Compiled grid (null if function is not compiled)
+	EVDS_VARIABLE_FUNCTION_CHEBYSHEV* chebyshev; //Chebyshev approximation (null if function is not compiled)
 } EVDS_VARIABLE_FUNCTION;
 
 struct EVDS_VARIABLE_TAG {
@@ -393,6 +431,8 @@ struct EVDS_VARIABLE_TAG {
 	EVDS_VARIABLE* parent;					//Variable this variable belongs to (if nested)
 	EVDS_OBJECT* object;					//Object this parameter belongs to (0 if not a parameter)
 	EVDS_SYSTEM* system;					//System this variable belongs to
+	int mass_bearing;						//Does variable affect mass properties (EVDS_VARIABLE_MASS_*)
+	int gravity_bearing;					//Does variable affect gravitational, magnetic, radiation or atmospheric environment of a planet
 
 	// User-defined data
 	void* userdata;
@@ -533,12 +573,19 @@ struct EVDS_OBJECT_TAG {
 	SIMC_LIST* variables;					//List of variables
 	SIMC_LIST* children;					//Children objects
 	SIMC_LIST* raw_children;				//Children objects (raw list, including the uninitialized ones)
+	int children_revision;					//Incremented every time list of children (or their callbacks) changes
+	int pose_revision;						//Incremented every time position or orientation of the object changes
 
 	// Initialization-related information
 	int initialized;						//Is object initialized
+	int mass_dirty;							//Mass properties of this object or its children were changed
 #ifndef EVDS_SINGLETHREADED
 	SIMC_THREAD_ID initialize_thread;		//Thread that performs initialization
 	SIMC_THREAD_ID create_thread;			//Thread in which object was created
+	int init_scheduled;						//Object is waiting in the initialization pool
+	int init_waiting;						//Children and previous sibling that must be initialized before this object (initialization pool)
+	EVDS_OBJECT* init_parent;				//Scheduled parent waiting for this object (initialization pool)
+	EVDS_OBJECT* init_next;					//Scheduled next sibling waiting for this object (initialization pool)
 #endif
 
 	// Information for destroying the object
@@ -599,6 +646,74 @@ typedef struct EVDS_INTERNAL_TYPE_ENTRY_TAG {
 	SIMC_LIST* objects;		//List of objects with this type
 } EVDS_INTERNAL_TYPE_ENTRY;
 
+typedef struct EVDS_INTERNAL_GRAVITY_HARMONICS_TAG {
+	int degree;									//Truncation degree
+	EVDS_REAL radius;							//Reference radius of the model
+	EVDS_REAL* C;								//Fully normalized coefficients (up to "degree")
+	EVDS_REAL* S;
+	EVDS_REAL* f1;								//Gradient factors for V(n+1,m+1), V(n+1,m-1), V(n+1,m) (up to "degree")
+	EVDS_REAL* f2;
+	EVDS_REAL* fz;
+	EVDS_REAL* a;								//Column recursion coefficients (up to "degree"+1)
+	EVDS_REAL* b;
+	EVDS_REAL* c;								//Sectoral recursion coefficients (up to "degree"+1)
+} EVDS_INTERNAL_GRAVITY_HARMONICS;
+
+typedef struct EVDS_INTERNAL_RADIATION_TABLE_TAG {
+	int L_count;								//Number of nodes along L-shell
+	int B_count;								//Number of nodes along B/B0
+	EVDS_REAL* L;								//Nodes along L-shell
+	EVDS_REAL* B;								//Nodes along B/B0
+	EVDS_REAL* values;							//Logarithms of fluxes and dose rate in each node
+} EVDS_INTERNAL_RADIATION_TABLE;
+
+typedef struct EVDS_INTERNAL_GRAVITY_GRID_TAG {
+#ifndef EVDS_SINGLETHREADED
+	SIMC_LOCK_ID lock;							//Lock for building new blocks
+#endif
+	EVDS_REAL r_min;							//Radius of the lowest shell
+	EVDS_REAL dr,dlat,dlon;						//Grid steps
+	int nr,nlat,nlon;							//Number of cells
+	int br,blat,blon;							//Number of blocks
+	EVDS_REAL** blocks;							//Blocks of nodes (built when first used, 0 otherwise)
+} EVDS_INTERNAL_GRAVITY_GRID;
+
+typedef struct EVDS_INTERNAL_GRAVITY_TREE_NODE_TAG {
+	EVDS_REAL center[3];						//Center of the node cube
+	EVDS_REAL size;								//Size of the node cube
+	EVDS_REAL center_of_mass[3];				//Center of mass of all sources in the node
+	EVDS_REAL mu;								//Total gravitational parameter of all sources in the node
+	int children[8];							//Child nodes (-1 if empty)
+	int first,count;							//Range of sources in a leaf node (count is 0 for other nodes)
+} EVDS_INTERNAL_GRAVITY_TREE_NODE;
+
+typedef struct EVDS_INTERNAL_GRAVITY_SOURCE_TAG {
+	EVDS_OBJECT* object;						//Planet or constant gravity source
+	int is_constant;							//Source is a constant acceleration field
+	EVDS_REAL mu;								//Gravitational parameter (0 if not defined)
+	EVDS_REAL j2;								//Second zonal harmonic
+	EVDS_REAL radius;							//Planet radius
+	EVDS_REAL rs;								//Sphere of influence
+	int has_j2,has_radius,has_rs;				//Are optional parameters defined
+	EVDS_Callback_GetGravitationalField* callback; //Custom gravitational field (or 0)
+	EVDS_Callback_GetGravityGradientTorque* gradient_callback; //Custom gravity gradient torque (or 0)
+	EVDS_INTERNAL_GRAVITY_HARMONICS* harmonics;	//Spherical harmonics model (or 0)
+	EVDS_INTERNAL_GRAVITY_GRID* grid;			//Precomputed grid for spherical harmonics model (or 0)
+	EVDS_Callback_GetMagneticField* magnetic_callback; //Custom magnetic field (or 0)
+	EVDS_INTERNAL_GRAVITY_HARMONICS* magnetic;	//Spherical harmonics model of magnetic field (or 0)
+	EVDS_Callback_GetRadiationData* radiation_callback; //Custom radiation environment (or 0)
+	EVDS_INTERNAL_RADIATION_TABLE* radiation;	//Precomputed radiation flux table (or 0)
+	EVDS_Callback_GetAtmosphericData* atmosphere_callback; //Custom atmospheric model (or 0)
+	int has_us76;								//Planet uses built-in US Standard Atmosphere 1976
+	EVDS_GEODETIC_DATUM datum;					//Datum used for altitude above the planet
+	EVDS_VECTOR position;						//Position in root inertial space (acceleration for constant sources)
+	int pose_revision;							//Pose revision of the object and its parents when position was cached
+	int in_tree;								//Source is a point mass evaluated through the octree
+	int soi_parent;								//Source whose sphere of influence contains this one (-1 if none)
+	int soi_child;								//First source inside sphere of influence of this one (-1 if none)
+	int soi_sibling;							//Next source with the same parent in the hierarchy (-1 if none)
+} EVDS_INTERNAL_GRAVITY_SOURCE;
+
 struct EVDS_SYSTEM_TAG {
 	// Object data management
 #ifndef EVDS_SINGLETHREADED
@@ -613,6 +728,49 @@ struct EVDS_SYSTEM_TAG {
 	SIMC_LIST* databases;						// List of databases (each an EVDS_VARIABLE)
 	SIMC_QUEUE* sounds;							// List of sounds currently playing
 
+	// Worker threads for parallel jobs
+#ifndef EVDS_SINGLETHREADED
+	SIMC_LOCK_ID workers_lock;					// Lock for worker threads and current job
+	int workers_generation;						// Incremented when work is added or completed
+	int workers_count;							// Number of worker threads
+	int workers_running;						// Number of worker threads still running
+	int workers_shutdown;						// Worker threads must exit
+	EVDS_Callback_Job* job;						// Current parallel job (0 if none)
+	SIMC_THREAD_ID job_thread;					// Thread on whose behalf current job is processed
+	void* job_userdata;							// Userdata for current job
+	int job_count;								// Number of items in current job
+	int job_next;								// Next item to be processed
+	int job_completed;							// Number of processed items
+	int job_error;								// First error code returned by job
+
+	// Initialization pool (objects initialized by worker threads)
+	EVDS_OBJECT** init_ready;					// Queue of objects ready to be initialized (all children initialized)
+	int init_ready_first;						// Index of the first object in the queue
+	int init_ready_count;						// Number of objects ready to be initialized
+	int init_ready_capacity;					// Size of the "init_ready" array
+	int init_pending;							// Objects with non-blocking initialization still in progress
+#endif
+
+	// Compiled table of gravity sources
+#ifndef EVDS_SINGLETHREADED
+	SIMC_SRW_ID gravity_lock;					// Lock for the gravity sources table
+#endif
+	EVDS_INTERNAL_GRAVITY_SOURCE* gravity_sources;	// Planets and constant gravity sources
+	int gravity_sources_count;					// Number of gravity sources
+	int gravity_sources_revision;				// Value of "gravity_revision" when table was compiled
+	int gravity_revision;						// Incremented when gravity sources are added, removed or changed
+
+	// Octree of point mass gravity sources (Barnes-Hut approximation)
+	EVDS_INTERNAL_GRAVITY_TREE_NODE* gravity_tree;	// Nodes of the octree (root node is first)
+	int gravity_tree_count;						// Number of nodes in the octree (0 if not used)
+	int gravity_tree_capacity;					// Number of allocated nodes
+	int* gravity_tree_sources;					// Indices of gravity sources sorted by leaf nodes
+	EVDS_REAL gravity_opening_angle;			// Opening angle for the approximation (0 to disable)
+	int gravity_tree_threshold;					// Smallest number of point masses for which octree is used
+
+	// Hierarchy of spheres of influence
+	int gravity_soi_root;						// First source at the top of the hierarchy (-1 if no sources have a sphere of influence)
+
 	// Global callbacks
 	EVDS_GLOBAL_CALLBACKS callbacks;			// Global callbacks
 
@@ -658,21 +816,52 @@ struct EVDS_MESH_INTERNAL_TAG {
 int EVDS_InternalObject_SetPrivateStateVector(EVDS_OBJECT* object, EVDS_STATE_VECTOR* vector);
 // Get private state vector
 int EVDS_InternalObject_GetPrivateStateVector(EVDS_OBJECT* object, EVDS_STATE_VECTOR* vector);
+// Initialize object and its children using worker threads of the system
+int EVDS_InternalSystem_InitializeObject(EVDS_SYSTEM* system, EVDS_OBJECT* object, int is_blocking);
+// Wake up threads waiting for work or for completion of work
+void EVDS_InternalSystem_Signal(EVDS_SYSTEM* system);
+// Get thread on whose behalf the current thread integrates objects
+SIMC_THREAD_ID EVDS_InternalThread_GetIntegrateID();
 #endif
 
+// Initialize object (its children are initialized first if needed)
+void EVDS_InternalThread_Initialize_Object(EVDS_OBJECT* object);
+
 // Destroy object internal data
 int EVDS_InternalObject_DestroyData(EVDS_OBJECT* object);
+// Mark mass properties of the object and all its parents as changed
+void EVDS_InternalObject_InvalidateMass(EVDS_OBJECT* object);
+// Mark mass properties of the object and all its children as up to date
+void EVDS_InternalObject_ValidateMass(EVDS_OBJECT* object);
 // Destroy variable internal data
 int EVDS_InternalVariable_DestroyData(EVDS_VARIABLE* variable);
+// Invalidate mass properties after a mass-bearing variable was changed
+void EVDS_InternalVariable_InvalidateMass(EVDS_VARIABLE* variable);
+// Mark table of gravity sources as outdated if object is a gravity source
+void EVDS_InternalEnvironment_InvalidateGravity(EVDS_OBJECT* object);
+// Mark table of gravity sources as outdated if object or any of its children is a gravity source
+int EVDS_InternalEnvironment_InvalidateGravitySubtree(EVDS_OBJECT* object);
+// Free table of gravity sources
+void EVDS_InternalEnvironment_DestroyGravitySources(EVDS_SYSTEM* system);
 // Creates a new variable
 int EVDS_Variable_Create(EVDS_SYSTEM* system, const char* name, EVDS_VARIABLE_TYPE type, EVDS_VARIABLE** p_variable);
 // Creates a new variable as a copy of existing one
 int EVDS_Variable_Copy(EVDS_VARIABLE* source, EVDS_VARIABLE* variable);
 // Initialize function data
 int EVDS_InternalVariable_InitializeFunction(EVDS_VARIABLE* variable, EVDS_VARIABLE_FUNCTION* function, const char* data);
+// Initialize function data from a table of values
+int EVDS_InternalVariable_InitializeFunctionTable(EVDS_VARIABLE* variable, EVDS_VARIABLE_FUNCTION* function,
+												  const EVDS_REAL* entries, int count);
+// Get node of the function table by index
+EVDS_VARIABLE_FVALUE_LINEAR* EVDS_InternalVariable_GetFunctionNode(EVDS_VARIABLE_FUNCTION* function, int index);
 // Destroy function data
 int EVDS_InternalVariable_DestroyFunction(EVDS_VARIABLE* variable, EVDS_VARIABLE_FUNCTION* function);
 
+// Build trie of units of measurement
+void EVDS_Internal_InitializeUnitsTable();
+// Build hash table for remapping parameters of old files
+void EVDS_Internal_InitializeRemappingTable();
+
 // Global logging callback
 extern EVDS_Callback_Log* EVDS_Internal_LogCallback;
 // Log a message
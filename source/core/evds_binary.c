@@ -0,0 +1,860 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file
+////////////////////////////////////////////////////////////////////////////////
+/// Copyright (C) 2012-2015, Black Phoenix
+///
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the GNU Lesser General Public License as published by the Free Software
+/// Foundation; either version 2 of the License, or (at your option) any later
+/// version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+/// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+/// details.
+///
+/// You should have received a copy of the GNU Lesser General Public License along with
+/// this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+/// Place - Suite 330, Boston, MA  02111-1307, USA.
+///
+/// Further information about the GNU Lesser General Public License can also be found on
+/// the world wide web at http://www.gnu.org.
+////////////////////////////////////////////////////////////////////////////////
+/// @page EVDS_Binary Binary snapshots
+///
+/// Objects can be saved into a binary snapshot, which is loaded without any text parsing
+/// or unit conversion. The snapshot is a single block of memory:
+///	Section			| Contents
+///	----------------|--------------------------
+///	Header			| Magic "EVDB", byte order marker, format version, offsets and sizes of sections
+///	Reals			| All floating point values (state vectors, variable values, function tables)
+///	Objects			| Object records (children of an object are stored next to each other)
+///	Variables		| Variable records (attributes and nested variables are stored next to each other)
+///	Strings			| Null-terminated names and string values
+///
+/// All references inside the snapshot are indices into sections or offsets relative to the
+/// start of the snapshot, so the snapshot is relocatable: it can be memory-mapped by the
+/// application and passed into EVDS_Object_LoadBinaryFromMemory() directly. Snapshots are
+/// only portable between builds with the same byte order and the same size of EVDS_REAL.
+////////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "evds.h"
+
+
+/// Version of the binary snapshot format
+#define EVDS_BINARY_FORMAT_VERSION	1
+/// Byte order marker (written in native byte order)
+#define EVDS_BINARY_BYTE_ORDER		0x01020304
+/// Number of reals in the saved state vector of an object
+#define EVDS_BINARY_STATE_SIZE		19
+
+
+#ifndef DOXYGEN_INTERNAL_STRUCTS
+typedef struct EVDS_BINARY_HEADER_TAG {
+	char magic[4];							//Magic identifier ("EVDB")
+	unsigned int byte_order;				//Byte order marker
+	unsigned int format_version;			//Version of the snapshot format
+	unsigned int evds_version;				//Version of EVDS which saved the snapshot
+	unsigned int real_size;					//Size of EVDS_REAL in bytes
+	unsigned int size;						//Total size of the snapshot in bytes
+	unsigned int root_count;				//Number of root objects (first entries in objects table)
+	unsigned int object_count;				//Number of object records
+	unsigned int object_offset;				//Offset of objects table
+	unsigned int variable_count;			//Number of variable records
+	unsigned int variable_offset;			//Offset of variables table
+	unsigned int real_count;				//Number of reals
+	unsigned int real_offset;				//Offset of reals table
+	unsigned int string_size;				//Size of strings table in bytes
+	unsigned int string_offset;				//Offset of strings table
+	unsigned int reserved;					//Padding (reals must be aligned)
+} EVDS_BINARY_HEADER;
+
+typedef struct EVDS_BINARY_OBJECT_TAG {
+	unsigned int name;						//Offset of name in strings table
+	unsigned int type;						//Offset of type in strings table
+	unsigned int state;						//Index of state vector in reals table
+	unsigned int variables;					//Index of the first variable
+	unsigned int variable_count;			//Number of variables
+	unsigned int children;					//Index of the first child object
+	unsigned int child_count;				//Number of children objects
+} EVDS_BINARY_OBJECT;
+
+typedef struct EVDS_BINARY_VARIABLE_TAG {
+	unsigned int name;						//Offset of name in strings table
+	unsigned int type;						//Variable type
+	unsigned int flags;						//Vector derivative level
+	unsigned int data;						//Index in reals table or offset in strings table
+	unsigned int data_count;				//Number of reals or length of string
+	unsigned int attributes;				//Index of the first attribute
+	unsigned int attribute_count;			//Number of attributes
+	unsigned int nested;					//Index of the first nested variable
+	unsigned int nested_count;				//Number of nested variables
+} EVDS_BINARY_VARIABLE;
+
+typedef struct EVDS_INTERNAL_BINARY_TAG {
+	EVDS_BINARY_OBJECT* objects;			//Objects table
+	EVDS_BINARY_VARIABLE* variables;		//Variables table
+	EVDS_REAL* reals;						//Reals table
+	char* strings;							//Strings table
+	unsigned int object_count;				//Number of objects
+	unsigned int variable_count;			//Number of variables
+	unsigned int real_count;				//Number of reals
+	unsigned int string_count;				//Size of strings table
+	unsigned int object_capacity;			//Allocated number of objects
+	unsigned int variable_capacity;			//Allocated number of variables
+	unsigned int real_capacity;				//Allocated number of reals
+	unsigned int string_capacity;			//Allocated size of strings table
+} EVDS_INTERNAL_BINARY;
+#endif
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Reserve entries in one of the tables of the snapshot being written.
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalBinary_Reserve(void** data, unsigned int* count, unsigned int* capacity,
+								unsigned int n, size_t element_size, unsigned int* p_index) {
+	if (*count + n > *capacity) {
+		void* new_data;
+		unsigned int new_capacity = *capacity ? *capacity : 64;
+		while (new_capacity < *count + n) new_capacity *= 2;
+
+		new_data = realloc(*data,new_capacity*element_size);
+		if (!new_data) return EVDS_ERROR_MEMORY;
+		*data = new_data;
+		*capacity = new_capacity;
+	}
+	*p_index = *count;
+	*count += n;
+	return EVDS_OK;
+}
+#define EVDS_BINARY_RESERVE(table,n,p_index) \
+	EVDS_InternalBinary_Reserve((void**)&binary->table##s,&binary->table##_count,&binary->table##_capacity, \
+								(n),sizeof(*binary->table##s),(p_index))
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Check if variable can be saved (pointers are only valid in runtime)
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalBinary_IsSaved(EVDS_VARIABLE* variable) {
+	return (variable->type != EVDS_VARIABLE_TYPE_DATA_PTR) &&
+		   (variable->type != EVDS_VARIABLE_TYPE_FUNCTION_PTR);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Count variables in the list which will be saved
+////////////////////////////////////////////////////////////////////////////////
+unsigned int EVDS_InternalBinary_CountVariables(SIMC_LIST* list) {
+	unsigned int count = 0;
+	SIMC_LIST_ENTRY* entry;
+	if (!list) return 0;
+
+	entry = SIMC_List_GetFirst(list);
+	while (entry) {
+		if (EVDS_InternalBinary_IsSaved((EVDS_VARIABLE*)SIMC_List_GetData(list,entry))) count++;
+		entry = SIMC_List_GetNext(list,entry);
+	}
+	return count;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Add string to the strings table
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalBinary_AddString(EVDS_INTERNAL_BINARY* binary, const char* string, unsigned int* p_offset) {
+	unsigned int length = (unsigned int)strlen(string);
+	EVDS_ERRCHECK(EVDS_BINARY_RESERVE(string,length+1,p_offset));
+	memcpy(&binary->strings[*p_offset],string,length+1);
+	return EVDS_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Write a single variable into the reserved record
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalBinary_SaveVariable(EVDS_INTERNAL_BINARY* binary, EVDS_VARIABLE* variable, unsigned int index) {
+	int i;
+	unsigned int k;
+	size_t length;
+	SIMC_LIST_ENTRY* entry;
+	EVDS_BINARY_VARIABLE record = { 0 };
+
+	//Write name and value
+	EVDS_ERRCHECK(EVDS_InternalBinary_AddString(binary,variable->name,&record.name));
+	record.type = variable->type;
+	switch (variable->type) {
+		case EVDS_VARIABLE_TYPE_FLOAT:
+			record.data_count = 1;
+			EVDS_ERRCHECK(EVDS_BINARY_RESERVE(real,1,&record.data));
+			EVDS_ERRCHECK(EVDS_Variable_GetReal(variable,&binary->reals[record.data]));
+		break;
+		case EVDS_VARIABLE_TYPE_VECTOR: {
+			EVDS_VECTOR value;
+			EVDS_ERRCHECK(EVDS_Variable_GetVector(variable,&value));
+			record.flags = value.derivative_level;
+			record.data_count = 3;
+			EVDS_ERRCHECK(EVDS_BINARY_RESERVE(real,3,&record.data));
+			binary->reals[record.data+0] = value.x;
+			binary->reals[record.data+1] = value.y;
+			binary->reals[record.data+2] = value.z;
+		} break;
+		case EVDS_VARIABLE_TYPE_QUATERNION: {
+			EVDS_QUATERNION value;
+			EVDS_ERRCHECK(EVDS_Variable_GetQuaternion(variable,&value));
+			record.data_count = 4;
+			EVDS_ERRCHECK(EVDS_BINARY_RESERVE(real,4,&record.data));
+			for (i = 0; i < 4; i++) binary->reals[record.data+i] = value.q[i];
+		} break;
+		case EVDS_VARIABLE_TYPE_STRING:
+		case EVDS_VARIABLE_TYPE_NESTED:
+			EVDS_ERRCHECK(EVDS_Variable_GetString(variable,0,0,&length));
+			record.data_count = (unsigned int)length;
+			EVDS_ERRCHECK(EVDS_BINARY_RESERVE(string,record.data_count+1,&record.data));
+			EVDS_ERRCHECK(EVDS_Variable_GetString(variable,&binary->strings[record.data],length,0));
+			binary->strings[record.data+record.data_count] = 0;
+		break;
+		case EVDS_VARIABLE_TYPE_FUNCTION: {
+			EVDS_VARIABLE_FUNCTION* function = (EVDS_VARIABLE_FUNCTION*)variable->value;
+
+			//Only values from the table itself are saved, nested functions are saved as variables
+			for (i = 0; i < function->data_count; i++) {
+				if (!EVDS_InternalVariable_GetFunctionNode(function,i)->function) record.data_count += 2;
+			}
+			EVDS_ERRCHECK(EVDS_BINARY_RESERVE(real,record.data_count,&record.data));
+			k = record.data;
+			for (i = 0; i < function->data_count; i++) {
+				EVDS_VARIABLE_FVALUE_LINEAR* node = EVDS_InternalVariable_GetFunctionNode(function,i);
+				if (!node->function) {
+					binary->reals[k++] = node->x;
+					binary->reals[k++] = node->value;
+				}
+			}
+		} break;
+	}
+
+	//Reserve records for attributes and nested variables
+	record.attribute_count = EVDS_InternalBinary_CountVariables(variable->attributes);
+	record.nested_count = EVDS_InternalBinary_CountVariables(variable->list);
+	EVDS_ERRCHECK(EVDS_BINARY_RESERVE(variable,record.attribute_count,&record.attributes));
+	EVDS_ERRCHECK(EVDS_BINARY_RESERVE(variable,record.nested_count,&record.nested));
+	binary->variables[index] = record;
+
+	//Save attributes and nested variables
+	k = record.attributes;
+	if (variable->attributes) {
+		entry = SIMC_List_GetFirst(variable->attributes);
+		while (entry) {
+			EVDS_VARIABLE* child = (EVDS_VARIABLE*)SIMC_List_GetData(variable->attributes,entry);
+			if (EVDS_InternalBinary_IsSaved(child)) {
+				EVDS_ERRCHECK(EVDS_InternalBinary_SaveVariable(binary,child,k++));
+			}
+			entry = SIMC_List_GetNext(variable->attributes,entry);
+		}
+	}
+	k = record.nested;
+	if (variable->list) {
+		entry = SIMC_List_GetFirst(variable->list);
+		while (entry) {
+			EVDS_VARIABLE* child = (EVDS_VARIABLE*)SIMC_List_GetData(variable->list,entry);
+			if (EVDS_InternalBinary_IsSaved(child)) {
+				EVDS_ERRCHECK(EVDS_InternalBinary_SaveVariable(binary,child,k++));
+			}
+			entry = SIMC_List_GetNext(variable->list,entry);
+		}
+	}
+	return EVDS_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Write a single object into the reserved record
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalBinary_SaveObject(EVDS_INTERNAL_BINARY* binary, EVDS_OBJECT* object, unsigned int index) {
+	unsigned int k;
+	char name[257] = { 0 };
+	EVDS_REAL* state;
+	EVDS_STATE_VECTOR vector;
+	SIMC_LIST_ENTRY* entry;
+	EVDS_BINARY_OBJECT record = { 0 };
+
+	//Write name and type
+	EVDS_ERRCHECK(EVDS_Object_GetName(object,name,256));
+	EVDS_ERRCHECK(EVDS_InternalBinary_AddString(binary,name,&record.name));
+	EVDS_ERRCHECK(EVDS_Object_GetType(object,name,256));
+	EVDS_ERRCHECK(EVDS_InternalBinary_AddString(binary,name,&record.type));
+
+	//Write state vector
+	EVDS_ERRCHECK(EVDS_Object_GetStateVector(object,&vector));
+	EVDS_ERRCHECK(EVDS_BINARY_RESERVE(real,EVDS_BINARY_STATE_SIZE,&record.state));
+	state = &binary->reals[record.state];
+	state[0]  = vector.position.x;
+	state[1]  = vector.position.y;
+	state[2]  = vector.position.z;
+	state[3]  = vector.velocity.x;
+	state[4]  = vector.velocity.y;
+	state[5]  = vector.velocity.z;
+	state[6]  = vector.orientation.q[0];
+	state[7]  = vector.orientation.q[1];
+	state[8]  = vector.orientation.q[2];
+	state[9]  = vector.orientation.q[3];
+	state[10] = vector.angular_velocity.x;
+	state[11] = vector.angular_velocity.y;
+	state[12] = vector.angular_velocity.z;
+	state[13] = vector.acceleration.x;
+	state[14] = vector.acceleration.y;
+	state[15] = vector.acceleration.z;
+	state[16] = vector.angular_acceleration.x;
+	state[17] = vector.angular_acceleration.y;
+	state[18] = vector.angular_acceleration.z;
+
+	//Reserve records for variables and children
+	record.variable_count = EVDS_InternalBinary_CountVariables(object->variables);
+	EVDS_ERRCHECK(EVDS_BINARY_RESERVE(variable,record.variable_count,&record.variables));
+	entry = SIMC_List_GetFirst(object->raw_children);
+	while (entry) {
+		record.child_count++;
+		entry = SIMC_List_GetNext(object->raw_children,entry);
+	}
+	EVDS_ERRCHECK(EVDS_BINARY_RESERVE(object,record.child_count,&record.children));
+	binary->objects[index] = record;
+
+	//Save variables
+	k = record.variables;
+	entry = SIMC_List_GetFirst(object->variables);
+	while (entry) {
+		EVDS_VARIABLE* variable = (EVDS_VARIABLE*)SIMC_List_GetData(object->variables,entry);
+		if (EVDS_InternalBinary_IsSaved(variable)) {
+			EVDS_ERRCHECK(EVDS_InternalBinary_SaveVariable(binary,variable,k++));
+		}
+		entry = SIMC_List_GetNext(object->variables,entry);
+	}
+
+	//Save children
+	k = record.children;
+	entry = SIMC_List_GetFirst(object->raw_children);
+	while (entry) {
+		EVDS_OBJECT* child = (EVDS_OBJECT*)SIMC_List_GetData(object->raw_children,entry);
+		EVDS_ERRCHECK(EVDS_InternalBinary_SaveObject(binary,child,k++));
+		entry = SIMC_List_GetNext(object->raw_children,entry);
+	}
+	return EVDS_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Write snapshot of the object (or of its children only) into a block of memory
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalBinary_Save(EVDS_OBJECT* object, int only_children, void** p_data, size_t* p_size) {
+	int error_code;
+	unsigned int k,root_count;
+	size_t size;
+	char* data;
+	EVDS_BINARY_HEADER header = { { 'E', 'V', 'D', 'B' } };
+	EVDS_INTERNAL_BINARY binary = { 0 };
+	SIMC_LIST_ENTRY* entry;
+	*p_data = 0;
+
+	//Write root objects
+	if (only_children) {
+		root_count = 0;
+		entry = SIMC_List_GetFirst(object->raw_children);
+		while (entry) {
+			root_count++;
+			entry = SIMC_List_GetNext(object->raw_children,entry);
+		}
+		error_code = EVDS_InternalBinary_Reserve((void**)&binary.objects,&binary.object_count,&binary.object_capacity,
+			root_count,sizeof(EVDS_BINARY_OBJECT),&k);
+
+		entry = SIMC_List_GetFirst(object->raw_children);
+		while (entry && (error_code == EVDS_OK)) {
+			error_code = EVDS_InternalBinary_SaveObject(&binary,(EVDS_OBJECT*)SIMC_List_GetData(object->raw_children,entry),k++);
+			entry = SIMC_List_GetNext(object->raw_children,entry);
+		}
+	} else {
+		root_count = 1;
+		error_code = EVDS_InternalBinary_Reserve((void**)&binary.objects,&binary.object_count,&binary.object_capacity,
+			1,sizeof(EVDS_BINARY_OBJECT),&k);
+		if (error_code == EVDS_OK) error_code = EVDS_InternalBinary_SaveObject(&binary,object,k);
+	}
+
+	//Fill header and lay out sections
+	header.byte_order = EVDS_BINARY_BYTE_ORDER;
+	header.format_version = EVDS_BINARY_FORMAT_VERSION;
+	header.evds_version = EVDS_VERSION;
+	header.real_size = sizeof(EVDS_REAL);
+	header.root_count = root_count;
+	header.real_count = binary.real_count;
+	header.real_offset = sizeof(EVDS_BINARY_HEADER);
+	header.object_count = binary.object_count;
+	header.object_offset = header.real_offset + binary.real_count*sizeof(EVDS_REAL);
+	header.variable_count = binary.variable_count;
+	header.variable_offset = header.object_offset + binary.object_count*sizeof(EVDS_BINARY_OBJECT);
+	header.string_size = binary.string_count;
+	header.string_offset = header.variable_offset + binary.variable_count*sizeof(EVDS_BINARY_VARIABLE);
+	size = header.string_offset + binary.string_count;
+	header.size = (unsigned int)size;
+
+	//Write snapshot
+	data = 0;
+	if (error_code == EVDS_OK) {
+		data = (char*)malloc(size);
+		if (!data) error_code = EVDS_ERROR_MEMORY;
+	}
+	if (error_code == EVDS_OK) {
+		memcpy(data,&header,sizeof(EVDS_BINARY_HEADER));
+		if (binary.real_count)		memcpy(data+header.real_offset,binary.reals,binary.real_count*sizeof(EVDS_REAL));
+		if (binary.object_count)	memcpy(data+header.object_offset,binary.objects,binary.object_count*sizeof(EVDS_BINARY_OBJECT));
+		if (binary.variable_count)	memcpy(data+header.variable_offset,binary.variables,binary.variable_count*sizeof(EVDS_BINARY_VARIABLE));
+		if (binary.string_count)		memcpy(data+header.string_offset,binary.strings,binary.string_count);
+		*p_data = data;
+		*p_size = size;
+	}
+
+	if (binary.objects) free(binary.objects);
+	if (binary.variables) free(binary.variables);
+	if (binary.reals) free(binary.reals);
+	if (binary.strings) free(binary.strings);
+	return error_code;
+}
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Get string from the snapshot (returns null if offset is not valid)
+////////////////////////////////////////////////////////////////////////////////
+const char* EVDS_InternalBinary_GetString(const EVDS_BINARY_HEADER* header, unsigned int offset) {
+	const char* strings = (const char*)header + header->string_offset;
+	if (offset >= header->string_size) return 0;
+	if (!memchr(strings+offset,0,header->string_size-offset)) return 0;
+	return strings+offset;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Get reals from the snapshot (returns null if range is not valid)
+////////////////////////////////////////////////////////////////////////////////
+const EVDS_REAL* EVDS_InternalBinary_GetReals(const EVDS_BINARY_HEADER* header, unsigned int index, unsigned int count) {
+	if ((index > header->real_count) || (count > header->real_count - index)) return 0;
+	return (const EVDS_REAL*)((const char*)header + header->real_offset) + index;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Check if range of records is valid and follows the parent record
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalBinary_CheckRange(unsigned int first, unsigned int count, unsigned int parent, unsigned int total) {
+	if (count == 0) return 1;
+	return (first > parent) && (first < total) && (count <= total - first);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Load a single variable from the snapshot
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalBinary_LoadVariable(const EVDS_BINARY_HEADER* header, unsigned int index, EVDS_OBJECT* object,
+									 EVDS_VARIABLE* parent_variable, int is_attribute) {
+	unsigned int k;
+	const char* name;
+	const EVDS_REAL* reals = 0;
+	EVDS_VARIABLE* variable;
+	const EVDS_BINARY_VARIABLE* record =
+		(const EVDS_BINARY_VARIABLE*)((const char*)header + header->variable_offset) + index;
+
+	//Check record
+	name = EVDS_InternalBinary_GetString(header,record->name);
+	if (!name) return EVDS_ERROR_SYNTAX;
+	if (!EVDS_InternalBinary_CheckRange(record->attributes,record->attribute_count,index,header->variable_count)) return EVDS_ERROR_SYNTAX;
+	if (!EVDS_InternalBinary_CheckRange(record->nested,record->nested_count,index,header->variable_count)) return EVDS_ERROR_SYNTAX;
+	switch (record->type) {
+		case EVDS_VARIABLE_TYPE_FLOAT:
+		case EVDS_VARIABLE_TYPE_VECTOR:
+		case EVDS_VARIABLE_TYPE_QUATERNION:
+		case EVDS_VARIABLE_TYPE_FUNCTION:
+			reals = EVDS_InternalBinary_GetReals(header,record->data,record->data_count);
+			if (!reals) return EVDS_ERROR_SYNTAX;
+			if ((record->type == EVDS_VARIABLE_TYPE_FLOAT) && (record->data_count != 1)) return EVDS_ERROR_SYNTAX;
+			if ((record->type == EVDS_VARIABLE_TYPE_VECTOR) && (record->data_count != 3)) return EVDS_ERROR_SYNTAX;
+			if ((record->type == EVDS_VARIABLE_TYPE_QUATERNION) && (record->data_count != 4)) return EVDS_ERROR_SYNTAX;
+			if ((record->type == EVDS_VARIABLE_TYPE_FUNCTION) && (record->data_count % 2)) return EVDS_ERROR_SYNTAX;
+		break;
+		case EVDS_VARIABLE_TYPE_STRING:
+		case EVDS_VARIABLE_TYPE_NESTED:
+			if ((record->data >= header->string_size) ||
+				(record->data_count >= header->string_size - record->data)) return EVDS_ERROR_SYNTAX;
+		break;
+		default:
+			return EVDS_ERROR_SYNTAX;
+	}
+
+	//Add variable to object or to parent variable
+	if (!parent_variable) {
+		EVDS_ERRCHECK(EVDS_Object_AddVariable(object,name,record->type,&variable));
+	} else if (is_attribute) {
+		EVDS_ERRCHECK(EVDS_Variable_AddAttribute(parent_variable,name,record->type,&variable));
+	} else {
+		EVDS_ERRCHECK(EVDS_Variable_AddNested(parent_variable,name,record->type,&variable));
+	}
+
+	//Store data into variable
+	if (record->type == EVDS_VARIABLE_TYPE_FLOAT) {
+		EVDS_ERRCHECK(EVDS_Variable_SetReal(variable,reals[0]));
+	} else if (record->type == EVDS_VARIABLE_TYPE_VECTOR) {
+		EVDS_VECTOR vector = { 0 };
+		vector.x = reals[0];
+		vector.y = reals[1];
+		vector.z = reals[2];
+		vector.coordinate_system = object;
+		vector.derivative_level = record->flags;
+		EVDS_ERRCHECK(EVDS_Variable_SetVector(variable,&vector));
+	} else if (record->type == EVDS_VARIABLE_TYPE_QUATERNION) {
+		EVDS_QUATERNION q;
+		q.q[0] = reals[0];
+		q.q[1] = reals[1];
+		q.q[2] = reals[2];
+		q.q[3] = reals[3];
+		q.coordinate_system = object;
+		EVDS_ERRCHECK(EVDS_Variable_SetQuaternion(variable,&q));
+	} else if ((record->type == EVDS_VARIABLE_TYPE_STRING) ||
+			   ((record->type == EVDS_VARIABLE_TYPE_NESTED) && (record->data_count > 0))) {
+		const char* value = (const char*)header + header->string_offset + record->data;
+		EVDS_ERRCHECK(EVDS_Variable_SetString(variable,(char*)value,record->data_count));
+	}
+
+	//Load all attributes and nested variables
+	for (k = 0; k < record->attribute_count; k++) {
+		EVDS_ERRCHECK(EVDS_InternalBinary_LoadVariable(header,record->attributes+k,object,variable,1));
+	}
+	for (k = 0; k < record->nested_count; k++) {
+		EVDS_ERRCHECK(EVDS_InternalBinary_LoadVariable(header,record->nested+k,object,variable,0));
+	}
+
+	//Initialize function table
+	if (record->type == EVDS_VARIABLE_TYPE_FUNCTION) {
+		EVDS_VARIABLE_FUNCTION* function = (EVDS_VARIABLE_FUNCTION*)variable->value;
+		function->constant_value = 0.0;
+		EVDS_ERRCHECK(EVDS_InternalVariable_InitializeFunctionTable(variable,function,reals,record->data_count/2));
+	}
+	return EVDS_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Load a single object from the snapshot
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalBinary_LoadObject(const EVDS_BINARY_HEADER* header, unsigned int index, EVDS_OBJECT* parent,
+								   EVDS_OBJECT** p_object) {
+	unsigned int k;
+	const char *name,*type;
+	const EVDS_REAL* state;
+	EVDS_OBJECT* object;
+	EVDS_STATE_VECTOR vector;
+	const EVDS_BINARY_OBJECT* record =
+		(const EVDS_BINARY_OBJECT*)((const char*)header + header->object_offset) + index;
+
+	//Check record
+	name = EVDS_InternalBinary_GetString(header,record->name);
+	type = EVDS_InternalBinary_GetString(header,record->type);
+	state = EVDS_InternalBinary_GetReals(header,record->state,EVDS_BINARY_STATE_SIZE);
+	if ((!name) || (!type) || (!state)) return EVDS_ERROR_SYNTAX;
+	if (!EVDS_InternalBinary_CheckRange(record->children,record->child_count,index,header->object_count)) return EVDS_ERROR_SYNTAX;
+	if ((record->variable_count > 0) && ((record->variables >= header->variable_count) ||
+		(record->variable_count > header->variable_count - record->variables))) return EVDS_ERROR_SYNTAX;
+
+	//Create object
+	EVDS_ERRCHECK(EVDS_Object_Create(parent,&object));
+	if (p_object) *p_object = object;
+	EVDS_Object_SetName(object,name);
+	EVDS_Object_SetType(object,type);
+
+	//Set state vector (same way as when loading from XML)
+	EVDS_Object_SetPosition(object,parent,state[0],state[1],state[2]);
+	EVDS_Object_SetVelocity(object,parent,state[3],state[4],state[5]);
+	EVDS_Object_SetAngularVelocity(object,parent,state[10],state[11],state[12]);
+	EVDS_Object_GetStateVector(object,&vector);
+	vector.orientation.q[0] = state[6];
+	vector.orientation.q[1] = state[7];
+	vector.orientation.q[2] = state[8];
+	vector.orientation.q[3] = state[9];
+	vector.orientation.coordinate_system = parent;
+	EVDS_Vector_Set(&vector.acceleration,EVDS_VECTOR_ACCELERATION,parent,state[13],state[14],state[15]);
+	EVDS_Vector_Set(&vector.angular_acceleration,EVDS_VECTOR_ANGULAR_ACCELERATION,parent,state[16],state[17],state[18]);
+	EVDS_Object_SetStateVector(object,&vector);
+
+	//Load variables and children
+	for (k = 0; k < record->variable_count; k++) {
+		EVDS_ERRCHECK(EVDS_InternalBinary_LoadVariable(header,record->variables+k,object,0,0));
+	}
+	for (k = 0; k < record->child_count; k++) {
+		EVDS_ERRCHECK(EVDS_InternalBinary_LoadObject(header,record->children+k,object,0));
+	}
+	return EVDS_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Check header of the snapshot
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalBinary_CheckHeader(const EVDS_BINARY_HEADER* header, size_t size) {
+	if (size < sizeof(EVDS_BINARY_HEADER)) return EVDS_ERROR_SYNTAX;
+	if (memcmp(header->magic,"EVDB",4) != 0) return EVDS_ERROR_SYNTAX;
+	if (header->byte_order != EVDS_BINARY_BYTE_ORDER) return EVDS_ERROR_SYNTAX;
+	if (header->format_version > EVDS_BINARY_FORMAT_VERSION) return EVDS_ERROR_SYNTAX;
+	if (header->real_size != sizeof(EVDS_REAL)) return EVDS_ERROR_SYNTAX;
+	if ((header->size > size) || (header->size < sizeof(EVDS_BINARY_HEADER))) return EVDS_ERROR_SYNTAX;
+	if (header->root_count > header->object_count) return EVDS_ERROR_SYNTAX;
+
+	//Check sections
+	if ((header->real_offset % sizeof(EVDS_REAL)) ||
+		(header->real_offset > header->size) ||
+		(header->real_count > (header->size - header->real_offset)/sizeof(EVDS_REAL))) return EVDS_ERROR_SYNTAX;
+	if ((header->object_offset % sizeof(unsigned int)) ||
+		(header->object_offset > header->size) ||
+		(header->object_count > (header->size - header->object_offset)/sizeof(EVDS_BINARY_OBJECT))) return EVDS_ERROR_SYNTAX;
+	if ((header->variable_offset % sizeof(unsigned int)) ||
+		(header->variable_offset > header->size) ||
+		(header->variable_count > (header->size - header->variable_offset)/sizeof(EVDS_BINARY_VARIABLE))) return EVDS_ERROR_SYNTAX;
+	if ((header->string_offset > header->size) ||
+		(header->string_size > header->size - header->string_offset)) return EVDS_ERROR_SYNTAX;
+	return EVDS_OK;
+}
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Save object and its children into a binary snapshot.
+///
+/// See @ref EVDS_Binary for the description of the format. Variables storing pointers
+/// (@c EVDS_VARIABLE_TYPE_DATA_PTR and @c EVDS_VARIABLE_TYPE_FUNCTION_PTR) are not saved.
+///
+/// @param[in] object Object to save
+/// @param[in] filename Pointer to a null-terminated filename
+///
+/// @returns Error code
+/// @retval EVDS_OK Successfully completed
+/// @retval EVDS_ERROR_BAD_PARAMETER "object" is null
+/// @retval EVDS_ERROR_BAD_PARAMETER "filename" is null
+/// @retval EVDS_ERROR_FILE File could not be written
+/// @retval EVDS_ERROR_MEMORY Could not allocate memory for the snapshot
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_Object_SaveBinary(EVDS_OBJECT* object, const char* filename) {
+	FILE* f;
+	void* data;
+	size_t size;
+	int error_code = EVDS_OK;
+	if (!object) return EVDS_ERROR_BAD_PARAMETER;
+	if (!filename) return EVDS_ERROR_BAD_PARAMETER;
+
+	EVDS_ERRCHECK(EVDS_InternalBinary_Save(object,0,&data,&size));
+	f = fopen(filename,"wb");
+	if (!f) {
+		error_code = EVDS_ERROR_FILE;
+	} else {
+		if (fwrite(data,1,size,f) != size) error_code = EVDS_ERROR_FILE;
+		fclose(f);
+	}
+	free(data);
+	return error_code;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Save object and its children into a binary snapshot in memory.
+///
+/// @note The snapshot must be free'd by the application.
+///
+/// @param[in] object Object to save
+/// @param[out] p_data Pointer to the snapshot will be written here
+/// @param[out] p_size Size of the snapshot in bytes will be written here
+///
+/// @returns Error code
+/// @retval EVDS_OK Successfully completed
+/// @retval EVDS_ERROR_BAD_PARAMETER "object" is null
+/// @retval EVDS_ERROR_BAD_PARAMETER "p_data" is null
+/// @retval EVDS_ERROR_BAD_PARAMETER "p_size" is null
+/// @retval EVDS_ERROR_MEMORY Could not allocate memory for the snapshot
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_Object_SaveBinaryToMemory(EVDS_OBJECT* object, void** p_data, size_t* p_size) {
+	if (!object) return EVDS_ERROR_BAD_PARAMETER;
+	if (!p_data) return EVDS_ERROR_BAD_PARAMETER;
+	if (!p_size) return EVDS_ERROR_BAD_PARAMETER;
+	return EVDS_InternalBinary_Save(object,0,p_data,p_size);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Load objects from a binary snapshot in memory and return the first object.
+///
+/// Snapshot is only read and may be memory-mapped by the application. Objects are created
+/// directly from the records of the snapshot, no text parsing or unit conversion is done.
+/// Loaded objects are not initialized.
+///
+/// @param[in] parent Parent object
+/// @param[in] data Pointer to the snapshot
+/// @param[in] size Size of the snapshot in bytes
+/// @param[out] p_object Pointer to first object will be written here (can be null)
+///
+/// @returns Error code
+/// @retval EVDS_OK Successfully completed
+/// @retval EVDS_ERROR_BAD_PARAMETER "parent" is null
+/// @retval EVDS_ERROR_BAD_PARAMETER "data" is null
+/// @retval EVDS_ERROR_SYNTAX Snapshot is damaged, or was saved by an incompatible build
+/// @retval EVDS_ERROR_MEMORY Could not allocate memory for EVDS_OBJECT
+/// @retval EVDS_ERROR_MEMORY Could not allocate memory for EVDS_VARIABLE
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_Object_LoadBinaryFromMemory(EVDS_OBJECT* parent, const void* data, size_t size, EVDS_OBJECT** p_object) {
+	unsigned int k;
+	const EVDS_BINARY_HEADER* header = (const EVDS_BINARY_HEADER*)data;
+	if (!parent) return EVDS_ERROR_BAD_PARAMETER;
+	if (!data) return EVDS_ERROR_BAD_PARAMETER;
+	if (p_object) *p_object = 0;
+
+	EVDS_ERRCHECK(EVDS_InternalBinary_CheckHeader(header,size));
+	for (k = 0; k < header->root_count; k++) {
+		EVDS_ERRCHECK(EVDS_InternalBinary_LoadObject(header,k,parent,(k == 0) ? p_object : 0));
+	}
+	return EVDS_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Read whole file into memory
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalBinary_ReadFile(const char* filename, char** p_data, size_t* p_size) {
+	FILE* f;
+	long size;
+	f = fopen(filename,"rb");
+	if (!f) return EVDS_ERROR_FILE;
+
+	fseek(f,0,SEEK_END);
+	size = ftell(f);
+	fseek(f,0,SEEK_SET);
+	if (size < 0) {
+		fclose(f);
+		return EVDS_ERROR_FILE;
+	}
+
+	*p_data = (char*)malloc(size > 0 ? size : 1);
+	if (!*p_data) {
+		fclose(f);
+		return EVDS_ERROR_MEMORY;
+	}
+	*p_size = fread(*p_data,1,size,f);
+	fclose(f);
+	return EVDS_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Load objects from a binary snapshot file and return the first object.
+///
+/// The whole file is read with a single read operation, see EVDS_Object_LoadBinaryFromMemory().
+/// Loaded objects are not initialized.
+///
+/// @param[in] parent Parent object
+/// @param[in] filename Pointer to a null-terminated filename
+/// @param[out] p_object Pointer to first object will be written here (can be null)
+///
+/// @returns Error code
+/// @retval EVDS_OK Successfully completed
+/// @retval EVDS_ERROR_BAD_PARAMETER "parent" is null
+/// @retval EVDS_ERROR_BAD_PARAMETER "filename" is null
+/// @retval EVDS_ERROR_FILE File could not be opened (not found or not accessible)
+/// @retval EVDS_ERROR_SYNTAX Snapshot is damaged, or was saved by an incompatible build
+/// @retval EVDS_ERROR_MEMORY Could not allocate memory for EVDS_OBJECT
+/// @retval EVDS_ERROR_MEMORY Could not allocate memory for EVDS_VARIABLE
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_Object_LoadBinary(EVDS_OBJECT* parent, const char* filename, EVDS_OBJECT** p_object) {
+	int error_code;
+	char* data;
+	size_t size;
+	if (!parent) return EVDS_ERROR_BAD_PARAMETER;
+	if (!filename) return EVDS_ERROR_BAD_PARAMETER;
+	if (p_object) *p_object = 0;
+
+	EVDS_ERRCHECK(EVDS_InternalBinary_ReadFile(filename,&data,&size));
+	error_code = EVDS_Object_LoadBinaryFromMemory(parent,data,size,p_object);
+	free(data);
+	return error_code;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Convert file between XML and binary snapshot formats.
+///
+/// If the source file is a binary snapshot, it is converted into an XML file. Otherwise
+/// the source XML file is converted into a binary snapshot. All objects from the source
+/// file are converted (databases are not stored in binary snapshots).
+///
+/// Objects are temporarily loaded under the given parent object (without initializing them)
+/// and are destroyed after the conversion.
+///
+/// @param[in] parent Parent object used for loading objects
+/// @param[in] source Pointer to a null-terminated source filename
+/// @param[in] target Pointer to a null-terminated target filename
+///
+/// @returns Error code
+/// @retval EVDS_OK Successfully completed
+/// @retval EVDS_ERROR_BAD_PARAMETER "parent" is null
+/// @retval EVDS_ERROR_BAD_PARAMETER "source" is null
+/// @retval EVDS_ERROR_BAD_PARAMETER "target" is null
+/// @retval EVDS_ERROR_FILE File could not be read or written
+/// @retval EVDS_ERROR_SYNTAX Syntax error in source file
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_Object_ConvertFile(EVDS_OBJECT* parent, const char* source, const char* target) {
+	int error_code;
+	char* data;
+	size_t size;
+	EVDS_OBJECT* container;
+	if (!parent) return EVDS_ERROR_BAD_PARAMETER;
+	if (!source) return EVDS_ERROR_BAD_PARAMETER;
+	if (!target) return EVDS_ERROR_BAD_PARAMETER;
+
+	//Load all objects under a temporary container
+	EVDS_ERRCHECK(EVDS_InternalBinary_ReadFile(source,&data,&size));
+	error_code = EVDS_Object_Create(parent,&container);
+	if (error_code != EVDS_OK) {
+		free(data);
+		return error_code;
+	}
+
+	if ((size >= 4) && (memcmp(data,"EVDB",4) == 0)) {
+		//Binary snapshot to XML
+		error_code = EVDS_Object_LoadBinaryFromMemory(container,data,size,0);
+		if (error_code == EVDS_OK) {
+			EVDS_OBJECT_SAVEEX info = { 0 };
+			info.flags = EVDS_OBJECT_SAVEEX_ONLY_CHILDREN;
+			error_code = EVDS_Object_SaveEx(container,target,&info);
+		}
+	} else {
+		//XML to binary snapshot
+		EVDS_OBJECT_LOADEX info = { 0 };
+		info.flags = EVDS_OBJECT_LOADEX_DONT_INITIALIZE | EVDS_OBJECT_LOADEX_NO_DATABASES;
+		error_code = EVDS_Object_LoadEx(container,source,&info);
+		free(data);
+		data = 0;
+
+		if (error_code == EVDS_OK) {
+			error_code = EVDS_InternalBinary_Save(container,1,(void**)&data,&size);
+		}
+		if (error_code == EVDS_OK) {
+			FILE* f = fopen(target,"wb");
+			if (!f) {
+				error_code = EVDS_ERROR_FILE;
+			} else {
+				if (fwrite(data,1,size,f) != size) error_code = EVDS_ERROR_FILE;
+				fclose(f);
+			}
+		}
+	}
+
+	if (data) free(data);
+	EVDS_Object_Destroy(container);
+	return error_code;
+}
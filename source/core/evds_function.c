@@ -28,6 +28,13 @@
 #include "evds.h"
 #include "sim_xml.h"
 
+/// Maximum number of values in a compiled function grid
+#define EVDS_VARIABLE_FUNCTION_GRID_MAX_SIZE 1048576
+/// Maximum degree of polynomials in Chebyshev approximation
+#define EVDS_VARIABLE_FUNCTION_CHEBYSHEV_DEGREE 16
+/// Maximum number of times a piece of Chebyshev approximation can be bisected
+#define EVDS_VARIABLE_FUNCTION_CHEBYSHEV_DEPTH 48
+
 
 
 
@@ -48,25 +55,106 @@ int EVDS_InternalVariable_CompareEntries_Spline(const EVDS_VARIABLE_FVALUE_SPLIN
 
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief Initialize function data structure
+/// @brief Get node of the function table by index.
+///
+/// Linear and spline nodes start with the same fields (nested function, X value, value),
+/// so nodes of both tables can be accessed as linear nodes.
+////////////////////////////////////////////////////////////////////////////////
+EVDS_VARIABLE_FVALUE_LINEAR* EVDS_InternalVariable_GetFunctionNode(EVDS_VARIABLE_FUNCTION* function, int index) {
+	if (function->interpolation == EVDS_VARIABLE_FUNCTION_INTERPOLATION_SPLINE) {
+		return (EVDS_VARIABLE_FVALUE_LINEAR*)&function->spline[index];
+	} else {
+		return &function->linear[index];
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Compute coefficients of the natural cubic spline.
+///
+/// Coefficients are only computed for tables which consist of values. If any node of the
+/// table is a nested function, the nodes values depend on other arguments, and a local
+/// cubic interpolation is used instead (see EVDS_InternalVariable_GetFunction_Spline()).
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalVariable_ComputeSpline(EVDS_VARIABLE_FUNCTION* function) {
+	int i,n = function->data_count;
+	EVDS_VARIABLE_FVALUE_SPLINE* spline = function->spline;
+	EVDS_REAL *h,*mu,*z;
+	EVDS_REAL alpha,l;
+
+	//Check if spline can be precomputed
+	function->has_nested = 0;
+	for (i = 0; i < n; i++) {
+		if (spline[i].function) function->has_nested = 1;
+		spline[i].b = 0.0;
+		spline[i].c = 0.0;
+		spline[i].d = 0.0;
+	}
+	if (function->has_nested || (n < 2)) return EVDS_OK;
+
+	//Allocate temporary arrays
+	h = (EVDS_REAL*)malloc(sizeof(EVDS_REAL)*3*n);
+	if (!h) return EVDS_ERROR_MEMORY;
+	mu = h + n;
+	z = mu + n;
+
+	//Solve tridiagonal system for the second derivatives (natural boundary conditions)
+	for (i = 0; i < n-1; i++) {
+		h[i] = spline[i+1].x - spline[i].x;
+	}
+	mu[0] = 0.0;
+	z[0] = 0.0;
+	for (i = 1; i < n-1; i++) {
+		alpha = 0.0;
+		if (h[i]   > 0.0) alpha += 3.0*(spline[i+1].value - spline[i].value)/h[i];
+		if (h[i-1] > 0.0) alpha -= 3.0*(spline[i].value - spline[i-1].value)/h[i-1];
+
+		l = 2.0*(spline[i+1].x - spline[i-1].x) - h[i-1]*mu[i-1];
+		if (l <= 0.0) { //Duplicate nodes
+			mu[i] = 0.0;
+			z[i] = 0.0;
+			continue;
+		}
+		mu[i] = h[i]/l;
+		z[i] = (alpha - h[i-1]*z[i-1])/l;
+	}
+
+	//Back substitution
+	spline[n-1].c = 0.0;
+	for (i = n-2; i >= 0; i--) {
+		spline[i].c = z[i] - mu[i]*spline[i+1].c;
+		if (h[i] > 0.0) {
+			spline[i].b = (spline[i+1].value - spline[i].value)/h[i] - h[i]*(spline[i+1].c + 2.0*spline[i].c)/3.0;
+			spline[i].d = (spline[i+1].c - spline[i].c)/(3.0*h[i]);
+		} else {
+			spline[i].b = 0.0;
+			spline[i].d = 0.0;
+		}
+	}
+	free(h);
+	return EVDS_OK;
+}
+
+
+/// Forward declarations for compiled functions
+int EVDS_InternalVariable_CompileGrid(EVDS_VARIABLE_FUNCTION* function);
+int EVDS_InternalVariable_CompileChebyshev(EVDS_VARIABLE_FUNCTION* function, EVDS_REAL tolerance);
+void EVDS_InternalVariable_DestroyGrid(EVDS_VARIABLE_FUNCTION* function);
+void EVDS_InternalVariable_DestroyChebyshev(EVDS_VARIABLE_FUNCTION* function);
+int EVDS_InternalVariable_GetChebyshevTolerance(EVDS_VARIABLE* variable, EVDS_VARIABLE_FUNCTION* function, EVDS_REAL* p_tolerance);
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Initialize function data structure from text data
 ////////////////////////////////////////////////////////////////////////////////
 int EVDS_InternalVariable_InitializeFunction(EVDS_VARIABLE* variable, EVDS_VARIABLE_FUNCTION* function, const char* data) {
-	int i;
-	SIMC_LIST_ENTRY* entry;
+	int i,count,error_code;
 	char *ptr,*end_ptr;
 	EVDS_REAL x,value;
-	EVDS_REAL avg_value;
-	EVDS_VARIABLE* temp_var;
-	int avg_count;
-
-	//Select interpolation type
-	function->interpolation = EVDS_VARIABLE_FUNCTION_INTERPOLATION_LINEAR;
-
-	//Count total number of entries
-	function->data_count = 0;
-	i = 0;
+	EVDS_REAL* entries = 0;
 
 	//Calculate number of data entries
+	count = 0;
 	if (data) {
 		ptr = (char*)data;
 		while (1) {
@@ -80,10 +168,63 @@ int EVDS_InternalVariable_InitializeFunction(EVDS_VARIABLE* variable, EVDS_VARIA
 			ptr = end_ptr;
 
 			//Count an extra entry if both are valid numbers
-			function->data_count++;
+			count++;
+		}
+	}
+
+	//Read pairs of values
+	if (count > 0) {
+		entries = (EVDS_REAL*)malloc(sizeof(EVDS_REAL)*2*count);
+		if (!entries) return EVDS_ERROR_MEMORY;
+
+		ptr = (char*)data;
+		for (i = 0; i < count; i++) {
+			EVDS_StringToReal(ptr,&ptr,&entries[2*i+0]);
+			EVDS_StringToReal(ptr,&ptr,&entries[2*i+1]);
 		}
 	}
 
+	error_code = EVDS_InternalVariable_InitializeFunctionTable(variable,function,entries,count);
+	if (entries) free(entries);
+	return error_code;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Initialize function data structure.
+///
+/// The table is built from "count" pairs of (x, value) stored in "entries", and from all
+/// nested functions of the variable.
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalVariable_InitializeFunctionTable(EVDS_VARIABLE* variable, EVDS_VARIABLE_FUNCTION* function,
+												  const EVDS_REAL* entries, int count) {
+	int i;
+	SIMC_LIST_ENTRY* entry;
+	EVDS_REAL x,value;
+	EVDS_REAL avg_value;
+	EVDS_VARIABLE* temp_var;
+	EVDS_VARIABLE_FVALUE_LINEAR* node;
+	size_t node_size;
+	int avg_count;
+
+	//Select interpolation type
+	function->interpolation = EVDS_VARIABLE_FUNCTION_INTERPOLATION_LINEAR;
+	if (EVDS_Variable_GetAttribute(variable,"interpolation",&temp_var) == EVDS_OK) {
+		char interpolation[64] = { 0 };
+		EVDS_Variable_GetString(temp_var,interpolation,63,0);
+		if (strcmp(interpolation,"spline") == 0) {
+			function->interpolation = EVDS_VARIABLE_FUNCTION_INTERPOLATION_SPLINE;
+		}
+	}
+	if (function->interpolation == EVDS_VARIABLE_FUNCTION_INTERPOLATION_SPLINE) {
+		node_size = sizeof(EVDS_VARIABLE_FVALUE_SPLINE);
+	} else {
+		node_size = sizeof(EVDS_VARIABLE_FVALUE_LINEAR);
+	}
+
+	//Count total number of entries
+	function->data_count = count;
+
 	//Calculate number of nested functions
 	entry = SIMC_List_GetFirst(variable->list);
 	while (entry) {
@@ -94,8 +235,8 @@ int EVDS_InternalVariable_InitializeFunction(EVDS_VARIABLE* variable, EVDS_VARIA
 
 
 	//Allocate table
-	function->data = malloc(sizeof(EVDS_VARIABLE_FVALUE_LINEAR)*function->data_count);
-	memset(function->data,0,sizeof(EVDS_VARIABLE_FVALUE_LINEAR)*function->data_count);
+	function->data = malloc(node_size*function->data_count);
+	memset(function->data,0,node_size*function->data_count);
 
 	//Compute average value (to determine constant)
 	avg_count = 0;
@@ -103,28 +244,16 @@ int EVDS_InternalVariable_InitializeFunction(EVDS_VARIABLE* variable, EVDS_VARIA
 
 
 	//Fill table with data entries
-	if (data) {
-		ptr = (char*)data;
-		while (1) {
-			//Parse strings
-			EVDS_StringToReal(ptr,&end_ptr,&x);
-			if (end_ptr == ptr) break;
-			ptr = end_ptr;
-
-			EVDS_StringToReal(ptr,&end_ptr,&value);
-			if (end_ptr == ptr) break;
-			ptr = end_ptr;
+	for (i = 0; i < count; i++) {
+		//Write entry
+		node = EVDS_InternalVariable_GetFunctionNode(function,i);
+		node->x = entries[2*i+0];
+		node->value = entries[2*i+1];
+		node->function = 0;
 
-			//Write entry
-			function->linear[i].x = x;
-			function->linear[i].value = value;
-			function->linear[i].function = 0;
-
-			//Accumulate
-			avg_value += value;
-			avg_count++;
-			i++;
-		}
+		//Accumulate
+		avg_value += node->value;
+		avg_count++;
 	}
 
 	//Compute constant value
@@ -151,9 +280,10 @@ int EVDS_InternalVariable_InitializeFunction(EVDS_VARIABLE* variable, EVDS_VARIA
 		EVDS_Variable_GetReal(nested_function,&value);
 
 		//FIXME: check if type is "data"
-		function->linear[i].x = x;
-		function->linear[i].value = value;
-		function->linear[i].function = nested_function->value;
+		node = EVDS_InternalVariable_GetFunctionNode(function,i);
+		node->x = x;
+		node->value = value;
+		node->function = nested_function->value;
 		i++;
 
 		entry = SIMC_List_GetNext(variable->list,entry);
@@ -166,6 +296,7 @@ int EVDS_InternalVariable_InitializeFunction(EVDS_VARIABLE* variable, EVDS_VARIA
 		break;
 		case EVDS_VARIABLE_FUNCTION_INTERPOLATION_SPLINE:
 			qsort(function->spline,function->data_count,sizeof(EVDS_VARIABLE_FVALUE_SPLINE),EVDS_InternalVariable_CompareEntries_Spline);
+			EVDS_ERRCHECK(EVDS_InternalVariable_ComputeSpline(function));
 		break;
 	}
 
@@ -183,6 +314,23 @@ int EVDS_InternalVariable_InitializeFunction(EVDS_VARIABLE* variable, EVDS_VARIA
 			}
 		}
 	}
+
+	//Compile function if requested
+	if (EVDS_Variable_GetAttribute(variable,"compile",&temp_var) == EVDS_OK) {
+		char compile[64] = { 0 };
+		EVDS_Variable_GetString(temp_var,compile,63,0);
+		if (strcmp(compile,"grid") == 0) {
+			EVDS_ERRCHECK(EVDS_InternalVariable_CompileGrid(function));
+		} else if (strcmp(compile,"chebyshev") == 0) {
+			EVDS_REAL tolerance;
+			int error_code;
+			EVDS_InternalVariable_GetChebyshevTolerance(variable,function,&tolerance);
+
+			//Table is used directly if it can not be approximated within tolerance
+			error_code = EVDS_InternalVariable_CompileChebyshev(function,tolerance);
+			if (error_code == EVDS_ERROR_MEMORY) return error_code;
+		}
+	}
 	return EVDS_OK;
 }
 
@@ -190,32 +338,114 @@ int EVDS_InternalVariable_InitializeFunction(EVDS_VARIABLE* variable, EVDS_VARIA
 /// @brief Destroy function data structure
 ////////////////////////////////////////////////////////////////////////////////
 int EVDS_InternalVariable_DestroyFunction(EVDS_VARIABLE* variable, EVDS_VARIABLE_FUNCTION* function) {
+	EVDS_InternalVariable_DestroyGrid(function);
+	EVDS_InternalVariable_DestroyChebyshev(function);
+	if (function->data) free(function->data);
+	function->data = 0;
+	function->data_count = 0;
 	return EVDS_OK;
 }
 
 
 /// Forward declarations for interpolation functions
 int EVDS_InternalVariable_GetFunction_Linear(EVDS_VARIABLE_FUNCTION* function, 
-											 EVDS_REAL x, EVDS_REAL y, EVDS_REAL z, EVDS_REAL* p_value);
+											 EVDS_REAL x, EVDS_REAL y, EVDS_REAL z, int* hint, int hint_size, EVDS_REAL* p_value);
 int EVDS_InternalVariable_GetFunction_Spline(EVDS_VARIABLE_FUNCTION* function, 
-											 EVDS_REAL x, EVDS_REAL y, EVDS_REAL z, EVDS_REAL* p_value);
+											 EVDS_REAL x, EVDS_REAL y, EVDS_REAL z, int* hint, int hint_size, EVDS_REAL* p_value);
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Find interpolation segment which contains the given value.
+///
+/// Returns index of the segment "i", so that \f$x_i < x \leq x_{i+1}\f$. The value must be
+/// strictly inside the table. If hint is given, the segment it points to and its neighbours
+/// are checked first (so lookups for slowly changing arguments take constant time), and
+/// binary search is used otherwise. Index of the found segment is written back into the hint.
+///
+/// Nodes are read from an array of structures: "nodes" points to X value of the first node, and
+/// "stride" is the size of every structure in bytes.
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalVariable_FindSegment(const char* nodes, size_t stride, int count, EVDS_REAL x, int* hint) {
+	int lo,hi,mid;
+
+	//Check segment pointed to by the hint, and segments next to it
+	if (hint) {
+		lo = *hint;
+		if ((lo >= 0) && (lo < count-1)) {
+			if (x > *(const EVDS_REAL*)(nodes + lo*stride)) {
+				if (x <= *(const EVDS_REAL*)(nodes + (lo+1)*stride)) return lo;
+				if ((lo+2 < count) && (x <= *(const EVDS_REAL*)(nodes + (lo+2)*stride))) return (*hint = lo+1);
+			} else if ((lo > 0) && (x > *(const EVDS_REAL*)(nodes + (lo-1)*stride))) {
+				return (*hint = lo-1);
+			}
+		}
+	}
+
+	//Binary search (x[lo] < x <= x[hi])
+	lo = 0;
+	hi = count-1;
+	while (hi - lo > 1) {
+		mid = (lo + hi) / 2;
+		if (x > *(const EVDS_REAL*)(nodes + mid*stride)) {
+			lo = mid;
+		} else {
+			hi = mid;
+		}
+	}
+	if (hint) *hint = lo;
+	return lo;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Find interpolation segment in the function table.
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalVariable_FindFunctionSegment(EVDS_VARIABLE_FUNCTION* function, EVDS_REAL x, int* hint) {
+	if (function->interpolation == EVDS_VARIABLE_FUNCTION_INTERPOLATION_SPLINE) {
+		return EVDS_InternalVariable_FindSegment((const char*)&function->spline[0].x,
+			sizeof(EVDS_VARIABLE_FVALUE_SPLINE),function->data_count,x,hint);
+	} else {
+		return EVDS_InternalVariable_FindSegment((const char*)&function->linear[0].x,
+			sizeof(EVDS_VARIABLE_FVALUE_LINEAR),function->data_count,x,hint);
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Interpolate with a cubic Hermite spline inside segment between nodes 1 and 2.
+///
+/// Slopes in the nodes are estimated from the neighbouring nodes 0 and 3. If there is no
+/// neighbouring node, it must be equal to the node of the segment.
+////////////////////////////////////////////////////////////////////////////////
+EVDS_REAL EVDS_InternalVariable_CubicHermite(const EVDS_REAL* x, const EVDS_REAL* v, EVDS_REAL t) {
+	EVDS_REAL h = x[2] - x[1];
+	EVDS_REAL m1,m2;
+	if (h <= 0.0) return v[1];
+
+	//Slopes in the nodes of the segment
+	m1 = (x[2] > x[0]) ? (v[2] - v[0])/(x[2] - x[0]) : (v[2] - v[1])/h;
+	m2 = (x[3] > x[1]) ? (v[3] - v[1])/(x[3] - x[1]) : (v[2] - v[1])/h;
+
+	//Hermite basis
+	return (2*t*t*t - 3*t*t + 1)*v[1] + (t*t*t - 2*t*t + t)*h*m1 +
+		   (-2*t*t*t + 3*t*t)*v[2] + (t*t*t - t*t)*h*m2;
+}
 
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief Get functions value at node by index (to be called from linear interpolation function)
 ////////////////////////////////////////////////////////////////////////////////
 int EVDS_InternalVariable_GetFunctionValue_Linear(EVDS_VARIABLE_FUNCTION* function,
-														int index, EVDS_REAL y, EVDS_REAL z, EVDS_REAL* p_value) {
+														int index, EVDS_REAL y, EVDS_REAL z, int* hint, int hint_size, EVDS_REAL* p_value) {
 	if (!function->linear[index].function) { //Use the raw value from data table
 		*p_value = function->linear[index].value;
 	} else { //Select value from nested function and use the right interpolating function
 		EVDS_VARIABLE_FUNCTION* nested_function = function->linear[index].function;
 		switch (nested_function->interpolation) {
 			case EVDS_VARIABLE_FUNCTION_INTERPOLATION_LINEAR:
-				return EVDS_InternalVariable_GetFunction_Linear(nested_function,y,z,0.0,p_value);
+				return EVDS_InternalVariable_GetFunction_Linear(nested_function,y,z,0.0,(hint_size > 1) ? hint+1 : 0,hint_size-1,p_value);
 			case EVDS_VARIABLE_FUNCTION_INTERPOLATION_SPLINE:
-				break;
-				//return EVDS_InternalVariable_GetFunction_Spline(nested_function,y,z,0.0,p_value);
+				return EVDS_InternalVariable_GetFunction_Spline(nested_function,y,z,0.0,(hint_size > 1) ? hint+1 : 0,hint_size-1,p_value);
 		}
 	}
 	return EVDS_OK;
@@ -226,19 +456,18 @@ int EVDS_InternalVariable_GetFunctionValue_Linear(EVDS_VARIABLE_FUNCTION* functi
 /// @brief Get functions value at node by index (to be called from spline interpolation function)
 ////////////////////////////////////////////////////////////////////////////////
 int EVDS_InternalVariable_GetFunctionValue_Spline(EVDS_VARIABLE_FUNCTION* function,
-														int index, EVDS_REAL y, EVDS_REAL z, EVDS_REAL* p_value) {
-	/*if (!function->spline[index].function) { //Use the raw value from data table
+														int index, EVDS_REAL y, EVDS_REAL z, int* hint, int hint_size, EVDS_REAL* p_value) {
+	if (!function->spline[index].function) { //Use the raw value from data table
 		*p_value = function->spline[index].value;
 	} else { //Select value from nested function and use the right interpolating function
 		EVDS_VARIABLE_FUNCTION* nested_function = function->spline[index].function;
 		switch (nested_function->interpolation) {
 			case EVDS_VARIABLE_FUNCTION_INTERPOLATION_LINEAR:
-				return EVDS_InternalVariable_GetFunction_Linear(nested_function,y,z,0.0,p_value);
+				return EVDS_InternalVariable_GetFunction_Linear(nested_function,y,z,0.0,(hint_size > 1) ? hint+1 : 0,hint_size-1,p_value);
 			case EVDS_VARIABLE_FUNCTION_INTERPOLATION_SPLINE:
-				break;
-				//return EVDS_InternalVariable_GetFunction_Spline(nested_function,y,z,0.0,p_value);
+				return EVDS_InternalVariable_GetFunction_Spline(nested_function,y,z,0.0,(hint_size > 1) ? hint+1 : 0,hint_size-1,p_value);
 		}
-	}*/
+	}
 	return EVDS_OK;
 }
 
@@ -247,9 +476,10 @@ int EVDS_InternalVariable_GetFunctionValue_Spline(EVDS_VARIABLE_FUNCTION* functi
 /// @brief Get value from a linear function.
 ///
 /// If additional variables are required for nested functions, then 'y' and 'z' are used.
+/// Hint (if given) is an array of "hint_size" segment indices, one per dimension of the function.
 ////////////////////////////////////////////////////////////////////////////////
 int EVDS_InternalVariable_GetFunction_Linear(EVDS_VARIABLE_FUNCTION* function, 
-											 EVDS_REAL x, EVDS_REAL y, EVDS_REAL z, EVDS_REAL* p_value) {
+											 EVDS_REAL x, EVDS_REAL y, EVDS_REAL z, int* hint, int hint_size, EVDS_REAL* p_value) {
 	int i;
 	EVDS_REAL vi,vj,xi,xj;
 
@@ -259,25 +489,21 @@ int EVDS_InternalVariable_GetFunction_Linear(EVDS_VARIABLE_FUNCTION* function,
 		return EVDS_OK;
 	}
 	if (function->data_count == 1) {
-		return EVDS_InternalVariable_GetFunctionValue_Linear(function,0,y,z,p_value);
+		return EVDS_InternalVariable_GetFunctionValue_Linear(function,0,y,z,hint,hint_size,p_value);
 	}
 	if (x <= function->linear[0].x) {
-		return EVDS_InternalVariable_GetFunctionValue_Linear(function,0,y,z,p_value);
+		return EVDS_InternalVariable_GetFunctionValue_Linear(function,0,y,z,hint,hint_size,p_value);
 	}
 	if (x >= function->linear[function->data_count-1].x) {
-		return EVDS_InternalVariable_GetFunctionValue_Linear(function,function->data_count-1,y,z,p_value);
+		return EVDS_InternalVariable_GetFunctionValue_Linear(function,function->data_count-1,y,z,hint,hint_size,p_value);
 	}
 
 	//Find interpolation segment
-	for (i = function->data_count-1; i >= 0; i--) {
-		if (x > function->linear[i].x) {
-			break;
-		}
-	}
+	i = EVDS_InternalVariable_FindFunctionSegment(function,x,hint);
 
 	//Linear interpolation
-	EVDS_InternalVariable_GetFunctionValue_Linear(function,i,  y,z,&vi);
-	EVDS_InternalVariable_GetFunctionValue_Linear(function,i+1,y,z,&vj);
+	EVDS_InternalVariable_GetFunctionValue_Linear(function,i,  y,z,hint,hint_size,&vi);
+	EVDS_InternalVariable_GetFunctionValue_Linear(function,i+1,y,z,hint,hint_size,&vj);
 	xi = function->linear[i  ].x;
 	xj = function->linear[i+1].x;
 
@@ -286,10 +512,621 @@ int EVDS_InternalVariable_GetFunction_Linear(EVDS_VARIABLE_FUNCTION* function,
 }
 
 
+
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief Get value from a 1D/2D/3D function
+/// @brief Get value from a spline function.
+///
+/// If table consists of values, the natural cubic spline is evaluated:
+/// \f[
+///		y = y_i + b_i (x-x_i) + c_i (x-x_i)^2 + d_i (x-x_i)^3
+/// \f]
+/// with coefficients precomputed when the function is initialized.
+///
+/// If nodes of the table are nested functions, their values depend on 'y' and 'z', so the
+/// spline can not be precomputed. A cubic Hermite spline through the two nodes of the segment
+/// is used instead, with slopes estimated from the neighbouring nodes. Only four nested
+/// functions are evaluated per call.
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalVariable_GetFunction_Spline(EVDS_VARIABLE_FUNCTION* function, 
+											 EVDS_REAL x, EVDS_REAL y, EVDS_REAL z, int* hint, int hint_size, EVDS_REAL* p_value) {
+	int i;
+	EVDS_REAL dx;
+	EVDS_VARIABLE_FVALUE_SPLINE* spline = function->spline;
+
+	//Check for edge cases
+	if (function->data_count == 0) {
+		*p_value = function->constant_value;
+		return EVDS_OK;
+	}
+	if (function->data_count == 1) {
+		return EVDS_InternalVariable_GetFunctionValue_Spline(function,0,y,z,hint,hint_size,p_value);
+	}
+	if (x <= spline[0].x) {
+		return EVDS_InternalVariable_GetFunctionValue_Spline(function,0,y,z,hint,hint_size,p_value);
+	}
+	if (x >= spline[function->data_count-1].x) {
+		return EVDS_InternalVariable_GetFunctionValue_Spline(function,function->data_count-1,y,z,hint,hint_size,p_value);
+	}
+
+	//Find interpolation segment
+	i = EVDS_InternalVariable_FindFunctionSegment(function,x,hint);
+	dx = x - spline[i].x;
+
+	if (!function->has_nested) { //Precomputed spline
+		*p_value = spline[i].value + dx*(spline[i].b + dx*(spline[i].c + dx*spline[i].d));
+	} else { //Cubic Hermite spline through nested functions
+		EVDS_REAL xs[4],vs[4];
+		int i0 = (i > 0) ? i-1 : i;
+		int i3 = (i+2 < function->data_count) ? i+2 : i+1;
+
+		EVDS_InternalVariable_GetFunctionValue_Spline(function,i,  y,z,hint,hint_size,&vs[1]);
+		EVDS_InternalVariable_GetFunctionValue_Spline(function,i+1,y,z,hint,hint_size,&vs[2]);
+		vs[0] = vs[1];
+		vs[3] = vs[2];
+		if (i0 != i)   EVDS_InternalVariable_GetFunctionValue_Spline(function,i0,y,z,hint,hint_size,&vs[0]);
+		if (i3 != i+1) EVDS_InternalVariable_GetFunctionValue_Spline(function,i3,y,z,hint,hint_size,&vs[3]);
+
+		xs[0] = spline[i0].x;
+		xs[1] = spline[i].x;
+		xs[2] = spline[i+1].x;
+		xs[3] = spline[i3].x;
+		*p_value = EVDS_InternalVariable_CubicHermite(xs,vs,(xs[2] > xs[1]) ? dx/(xs[2] - xs[1]) : 0.0);
+	}
+	return EVDS_OK;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Get value from a function table using the right interpolating function.
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalVariable_GetFunction(EVDS_VARIABLE_FUNCTION* function,
+									  EVDS_REAL x, EVDS_REAL y, EVDS_REAL z, int* hint, int hint_size, EVDS_REAL* p_value) {
+	switch (function->interpolation) {
+		case EVDS_VARIABLE_FUNCTION_INTERPOLATION_LINEAR:
+			return EVDS_InternalVariable_GetFunction_Linear(function,x,y,z,hint,hint_size,p_value);
+		case EVDS_VARIABLE_FUNCTION_INTERPOLATION_SPLINE:
+			return EVDS_InternalVariable_GetFunction_Spline(function,x,y,z,hint,hint_size,p_value);
+	}
+	return EVDS_OK;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Compare two real values (for sorting grid axes)
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalVariable_CompareReals(const void* v1, const void* v2) {
+	if (*((const EVDS_REAL*)v1) < *((const EVDS_REAL*)v2)) return -1;
+	if (*((const EVDS_REAL*)v1) > *((const EVDS_REAL*)v2)) return 1;
+	return 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Get number of dimensions of the function (depth of nested tables).
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalVariable_GetFunctionDepth(EVDS_VARIABLE_FUNCTION* function) {
+	int i,depth,nested_depth;
+	if (function->data_count == 0) return 0;
+
+	depth = 1;
+	for (i = 0; i < function->data_count; i++) {
+		EVDS_VARIABLE_FVALUE_LINEAR* node = EVDS_InternalVariable_GetFunctionNode(function,i);
+		if (node->function) {
+			nested_depth = 1+EVDS_InternalVariable_GetFunctionDepth(node->function);
+			if (nested_depth > depth) depth = nested_depth;
+		}
+	}
+	return depth;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Collect X values of all tables at every depth of the function.
+///
+/// If "axis" is null, only the number of nodes is counted.
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalVariable_CollectGridNodes(EVDS_VARIABLE_FUNCTION* function, int depth,
+											EVDS_VARIABLE_FUNCTION_GRID* grid) {
+	int i;
+	if (function->data_count == 0) return;
+
+	//Interpolation along the axis is defined by the first table found on it
+	if (grid->count[depth] == 0) {
+		grid->is_cubic[depth] = function->interpolation == EVDS_VARIABLE_FUNCTION_INTERPOLATION_SPLINE;
+	}
+	for (i = 0; i < function->data_count; i++) {
+		EVDS_VARIABLE_FVALUE_LINEAR* node = EVDS_InternalVariable_GetFunctionNode(function,i);
+		if (grid->axis[depth]) grid->axis[depth][grid->count[depth]] = node->x;
+		grid->count[depth]++;
+		if (node->function) {
+			EVDS_InternalVariable_CollectGridNodes(node->function,depth+1,grid);
+		}
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Destroy grid of a compiled function
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalVariable_DestroyGrid(EVDS_VARIABLE_FUNCTION* function) {
+	int d;
+	if (!function->grid) return;
+	for (d = 0; d < 3; d++) {
+		if (function->grid->axis[d]) free(function->grid->axis[d]);
+	}
+	if (function->grid->values) free(function->grid->values);
+	free(function->grid);
+	function->grid = 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Compile function into a dense regular grid.
+///
+/// Nodes along every axis of the grid are the union of X values of all tables on the
+/// same nesting depth. Values in the grid are computed by evaluating the original function
+/// in every grid point, so rectilinear linear tables are reproduced exactly.
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalVariable_CompileGrid(EVDS_VARIABLE_FUNCTION* function) {
+	int d,i,n,index[3];
+	size_t size;
+	EVDS_REAL v[3];
+	EVDS_VARIABLE_FUNCTION_GRID* grid;
+
+	//Check if function can be represented by a grid
+	n = EVDS_InternalVariable_GetFunctionDepth(function);
+	if (n == 0) return EVDS_OK;
+	if (n > 3) return EVDS_ERROR_BAD_STATE;
+
+	//Create new grid
+	EVDS_InternalVariable_DestroyGrid(function);
+	grid = (EVDS_VARIABLE_FUNCTION_GRID*)malloc(sizeof(EVDS_VARIABLE_FUNCTION_GRID));
+	if (!grid) return EVDS_ERROR_MEMORY;
+	memset(grid,0,sizeof(EVDS_VARIABLE_FUNCTION_GRID));
+	grid->dimensions = n;
+
+	//Count nodes and allocate axes
+	EVDS_InternalVariable_CollectGridNodes(function,0,grid);
+	for (d = 0; d < n; d++) {
+		grid->axis[d] = (EVDS_REAL*)malloc(sizeof(EVDS_REAL)*(grid->count[d] > 0 ? grid->count[d] : 1));
+		if (!grid->axis[d]) {
+			function->grid = grid;
+			EVDS_InternalVariable_DestroyGrid(function);
+			return EVDS_ERROR_MEMORY;
+		}
+		grid->count[d] = 0;
+	}
+
+	//Fill axes, sort them and remove duplicate nodes
+	EVDS_InternalVariable_CollectGridNodes(function,0,grid);
+	size = 1;
+	for (d = 0; d < n; d++) {
+		if (grid->count[d] == 0) {
+			grid->axis[d][0] = 0.0;
+			grid->count[d] = 1;
+		}
+		qsort(grid->axis[d],grid->count[d],sizeof(EVDS_REAL),EVDS_InternalVariable_CompareReals);
+
+		i = 1;
+		for (index[0] = 1; index[0] < grid->count[d]; index[0]++) {
+			if (grid->axis[d][index[0]] > grid->axis[d][i-1]) {
+				grid->axis[d][i++] = grid->axis[d][index[0]];
+			}
+		}
+		grid->count[d] = i;
+		size *= grid->count[d];
+	}
+
+	//Check if grid is not too large
+	if (size > EVDS_VARIABLE_FUNCTION_GRID_MAX_SIZE) {
+		function->grid = grid;
+		EVDS_InternalVariable_DestroyGrid(function);
+		return EVDS_ERROR_MEMORY;
+	}
+
+	//Detect axes with uniform spacing between nodes
+	for (d = 0; d < n; d++) {
+		EVDS_REAL range = grid->axis[d][grid->count[d]-1] - grid->axis[d][0];
+		EVDS_REAL step = (grid->count[d] > 1) ? range / (grid->count[d]-1) : 0.0;
+
+		grid->is_uniform[d] = (grid->count[d] > 1);
+		for (i = 1; i < grid->count[d]; i++) {
+			if (fabs(grid->axis[d][i] - (grid->axis[d][0] + i*step)) > 1e-9*range) {
+				grid->is_uniform[d] = 0;
+				break;
+			}
+		}
+		if (grid->is_uniform[d]) grid->inv_step[d] = 1.0/step;
+	}
+
+	//Compute strides (last axis changes fastest)
+	grid->stride[n-1] = 1;
+	for (d = n-2; d >= 0; d--) {
+		grid->stride[d] = grid->stride[d+1]*grid->count[d+1];
+	}
+
+	//Evaluate function in every node of the grid
+	grid->values = (EVDS_REAL*)malloc(sizeof(EVDS_REAL)*size);
+	if (!grid->values) {
+		function->grid = grid;
+		EVDS_InternalVariable_DestroyGrid(function);
+		return EVDS_ERROR_MEMORY;
+	}
+	for (i = 0; i < (int)size; i++) {
+		for (d = 0; d < 3; d++) {
+			index[d] = (d < n) ? (i / grid->stride[d]) % grid->count[d] : 0;
+			v[d] = (d < n) ? grid->axis[d][index[d]] : 0.0;
+		}
+		EVDS_InternalVariable_GetFunction(function,v[0],v[1],v[2],0,0,&grid->values[i]);
+	}
+
+	function->grid = grid;
+	return EVDS_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Get value from a compiled function (interpolate along one axis of the grid).
+///
+/// Segment along uniform axes is computed directly, other axes use the segment search with
+/// the lookup hint.
+////////////////////////////////////////////////////////////////////////////////
+EVDS_REAL EVDS_InternalVariable_GetGridValue(EVDS_VARIABLE_FUNCTION_GRID* grid, int d, int offset,
+											 const EVDS_REAL* v, int* hint) {
+	int i,k;
+	EVDS_REAL t,xs[4],vs[4];
+	EVDS_REAL* axis = grid->axis[d];
+	int count = grid->count[d];
+
+	//Find segment and position inside of it
+	if ((count == 1) || (v[d] <= axis[0])) {
+		i = 0;
+		t = 0.0;
+	} else if (v[d] >= axis[count-1]) {
+		i = count-2;
+		t = 1.0;
+	} else {
+		if (grid->is_uniform[d]) {
+			i = (int)((v[d] - axis[0])*grid->inv_step[d]);
+			if (i > count-2) i = count-2;
+		} else {
+			i = EVDS_InternalVariable_FindSegment((const char*)axis,sizeof(EVDS_REAL),count,v[d],hint ? &hint[d] : 0);
+		}
+		t = (v[d] - axis[i])/(axis[i+1] - axis[i]);
+	}
+
+	//Last axis reads values from the grid
+	if (d == grid->dimensions-1) {
+		const EVDS_REAL* values = &grid->values[offset];
+		if (count == 1) return values[0];
+		if (!grid->is_cubic[d]) return values[i] + (values[i+1] - values[i])*t;
+
+		for (k = 0; k < 4; k++) {
+			int j = i-1+k;
+			if (j < 0) j = 0;
+			if (j > count-1) j = count-1;
+			xs[k] = axis[j];
+			vs[k] = values[j];
+		}
+		return EVDS_InternalVariable_CubicHermite(xs,vs,t);
+	}
+
+	//Interpolate between hyperplanes of the grid
+	if (count == 1) return EVDS_InternalVariable_GetGridValue(grid,d+1,offset,v,hint);
+	if (!grid->is_cubic[d]) {
+		vs[1] = EVDS_InternalVariable_GetGridValue(grid,d+1,offset+i*grid->stride[d],v,hint);
+		vs[2] = EVDS_InternalVariable_GetGridValue(grid,d+1,offset+(i+1)*grid->stride[d],v,hint);
+		return vs[1] + (vs[2] - vs[1])*t;
+	}
+
+	for (k = 0; k < 4; k++) {
+		int j = i-1+k;
+		if (j < 0) j = 0;
+		if (j > count-1) j = count-1;
+		xs[k] = axis[j];
+		if ((k > 0) && (xs[k] == xs[k-1])) {
+			vs[k] = vs[k-1];
+		} else {
+			vs[k] = EVDS_InternalVariable_GetGridValue(grid,d+1,offset+j*grid->stride[d],v,hint);
+		}
+	}
+	return EVDS_InternalVariable_CubicHermite(xs,vs,t);
+}
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Destroy Chebyshev approximation of a compiled function
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalVariable_DestroyChebyshev(EVDS_VARIABLE_FUNCTION* function) {
+	if (!function->chebyshev) return;
+	if (function->chebyshev->breaks) free(function->chebyshev->breaks);
+	if (function->chebyshev->offset) free(function->chebyshev->offset);
+	if (function->chebyshev->coefficients) free(function->chebyshev->coefficients);
+	free(function->chebyshev);
+	function->chebyshev = 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Evaluate Chebyshev series with Clenshaw recurrence at u (-1..1).
+////////////////////////////////////////////////////////////////////////////////
+EVDS_REAL EVDS_InternalVariable_GetChebyshevSeries(const EVDS_REAL* c, int m, EVDS_REAL u) {
+	int j;
+	EVDS_REAL b0,b1,b2;
+	b1 = 0.0;
+	b2 = 0.0;
+	for (j = m - 1; j > 0; j--) {
+		b0 = 2.0*u*b1 - b2 + c[j];
+		b2 = b1;
+		b1 = b0;
+	}
+	return u*b1 - b2 + c[0];
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Get value from a Chebyshev approximation (evaluated with Clenshaw recurrence).
+///
+/// The piece is found by a binary search over piece boundaries.
+////////////////////////////////////////////////////////////////////////////////
+EVDS_REAL EVDS_InternalVariable_GetChebyshevValue(EVDS_VARIABLE_FUNCTION_CHEBYSHEV* chebyshev, EVDS_REAL x) {
+	int k,lo,hi;
+	EVDS_REAL a,b,u;
+	const EVDS_REAL* breaks = chebyshev->breaks;
+
+	//Find piece
+	lo = 0;
+	hi = chebyshev->count;
+	if (x < breaks[0]) x = breaks[0];
+	if (x > breaks[hi]) x = breaks[hi];
+	while (hi - lo > 1) {
+		k = (lo + hi)/2;
+		if (x >= breaks[k]) lo = k;
+		else hi = k;
+	}
+
+	//Position inside of the piece (-1..1)
+	a = breaks[lo];
+	b = breaks[lo+1];
+	u = (2.0*x - a - b)/(b - a);
+	return EVDS_InternalVariable_GetChebyshevSeries(
+		&chebyshev->coefficients[chebyshev->offset[lo]],
+		chebyshev->offset[lo+1] - chebyshev->offset[lo],u);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Fit piecewise Chebyshev approximation to a 1D function within given tolerance.
+///
+/// The whole table is fitted first. In every piece the function is interpolated in the
+/// Chebyshev nodes by a polynomial of degree EVDS_VARIABLE_FUNCTION_CHEBYSHEV_DEGREE,
+/// which is then truncated to the lowest degree that still fits the tolerance. Error is
+/// checked against the original table in all table nodes inside of the piece and in a set
+/// of points between them.
+///
+/// A piece which does not fit is bisected and both halves are fitted separately. If a node
+/// of the table lies near the middle of the piece, the piece is split in that node instead,
+/// so that kinks of linear tables become boundaries of pieces. Pieces are processed left to
+/// right, so they are stored in order.
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalVariable_CompileChebyshev(EVDS_VARIABLE_FUNCTION* function, EVDS_REAL tolerance) {
+	int i,j,m,n,fits,failed,node,capacity,stack_count;
+	EVDS_REAL x0,x1,a,b,width,middle,split,distance,value,error;
+	EVDS_REAL f[EVDS_VARIABLE_FUNCTION_CHEBYSHEV_DEGREE+1];
+	EVDS_REAL c[EVDS_VARIABLE_FUNCTION_CHEBYSHEV_DEGREE+1];
+	EVDS_REAL stack_a[EVDS_VARIABLE_FUNCTION_CHEBYSHEV_DEPTH+1];
+	EVDS_REAL stack_b[EVDS_VARIABLE_FUNCTION_CHEBYSHEV_DEPTH+1];
+	int stack_depth[EVDS_VARIABLE_FUNCTION_CHEBYSHEV_DEPTH+1];
+	EVDS_VARIABLE_FUNCTION_CHEBYSHEV* chebyshev;
+	n = EVDS_VARIABLE_FUNCTION_CHEBYSHEV_DEGREE+1;
+
+	//Only 1D tables can be approximated
+	if (EVDS_InternalVariable_GetFunctionDepth(function) != 1) return EVDS_ERROR_BAD_STATE;
+	if (function->data_count < 2) return EVDS_OK;
+	if (tolerance <= 0.0) return EVDS_ERROR_BAD_PARAMETER;
+	x0 = EVDS_InternalVariable_GetFunctionNode(function,0)->x;
+	x1 = EVDS_InternalVariable_GetFunctionNode(function,function->data_count-1)->x;
+	if (x1 <= x0) return EVDS_OK;
+
+	//Create new approximation
+	EVDS_InternalVariable_DestroyChebyshev(function);
+	chebyshev = (EVDS_VARIABLE_FUNCTION_CHEBYSHEV*)malloc(sizeof(EVDS_VARIABLE_FUNCTION_CHEBYSHEV));
+	if (!chebyshev) return EVDS_ERROR_MEMORY;
+	memset(chebyshev,0,sizeof(EVDS_VARIABLE_FUNCTION_CHEBYSHEV));
+	function->chebyshev = chebyshev;
+
+	capacity = 16;
+	chebyshev->breaks = (EVDS_REAL*)malloc(sizeof(EVDS_REAL)*(capacity+1));
+	chebyshev->offset = (int*)malloc(sizeof(int)*(capacity+1));
+	chebyshev->coefficients = (EVDS_REAL*)malloc(sizeof(EVDS_REAL)*capacity*n);
+	if ((!chebyshev->breaks) || (!chebyshev->offset) || (!chebyshev->coefficients)) {
+		EVDS_InternalVariable_DestroyChebyshev(function);
+		return EVDS_ERROR_MEMORY;
+	}
+	chebyshev->breaks[0] = x0;
+	chebyshev->offset[0] = 0;
+
+	//Fit pieces from left to right, the piece on top of the stack is always the leftmost one
+	node = 0;
+	stack_a[0] = x0;
+	stack_b[0] = x1;
+	stack_depth[0] = 0;
+	stack_count = 1;
+	failed = 0;
+	while ((stack_count > 0) && (!failed)) {
+		int k = chebyshev->count;
+		stack_count--;
+		a = stack_a[stack_count];
+		b = stack_b[stack_count];
+		width = b - a;
+
+		//Interpolate in Chebyshev nodes
+		for (i = 0; i < n; i++) {
+			EVDS_REAL u = cos(EVDS_PI*(i + 0.5)/n);
+			EVDS_REAL x = a + width*0.5*(u + 1.0);
+			EVDS_InternalVariable_GetFunction(function,x,0.0,0.0,0,0,&f[i]);
+		}
+		for (j = 0; j < n; j++) {
+			c[j] = 0.0;
+			for (i = 0; i < n; i++) {
+				c[j] += f[i]*cos(EVDS_PI*j*(i + 0.5)/n);
+			}
+			c[j] *= (j == 0) ? 1.0/n : 2.0/n;
+		}
+
+		//Truncate series while truncation error is small
+		error = 0.0;
+		for (m = n; m > 1; m--) {
+			if (error + fabs(c[m-1]) > 0.25*tolerance) break;
+			error += fabs(c[m-1]);
+		}
+
+		//Check error inside the piece and in the table nodes which belong to it
+		fits = 1;
+		for (i = 0; fits && (i < 2*n); i++) {
+			EVDS_REAL x = a + width*((EVDS_REAL)i)/(2*n);
+			EVDS_InternalVariable_GetFunction(function,x,0.0,0.0,0,0,&value);
+			if (fabs(EVDS_InternalVariable_GetChebyshevSeries(c,m,(2.0*x - a - b)/width) - value) > tolerance) fits = 0;
+		}
+		for (i = node; fits && (i < function->data_count); i++) {
+			EVDS_REAL x = EVDS_InternalVariable_GetFunctionNode(function,i)->x;
+			if (x > b) break;
+			EVDS_InternalVariable_GetFunction(function,x,0.0,0.0,0,0,&value);
+			if (fabs(EVDS_InternalVariable_GetChebyshevSeries(c,m,(2.0*x - a - b)/width) - value) > tolerance) fits = 0;
+		}
+
+		//Split the piece
+		if (!fits) {
+			int depth = stack_depth[stack_count];
+			if (depth >= EVDS_VARIABLE_FUNCTION_CHEBYSHEV_DEPTH) {
+				failed = 1;
+				break;
+			}
+
+			//Split in the table node closest to the middle, if there is one in the middle half
+			middle = 0.5*(a + b);
+			split = middle;
+			distance = 0.25*width;
+			for (i = node; i < function->data_count; i++) {
+				EVDS_REAL x = EVDS_InternalVariable_GetFunctionNode(function,i)->x;
+				if (x >= b) break;
+				if ((x > a) && (fabs(x - middle) < distance)) {
+					distance = fabs(x - middle);
+					split = x;
+				}
+			}
+
+			//Right half is fitted after the left half
+			stack_a[stack_count] = split;
+			stack_b[stack_count] = b;
+			stack_depth[stack_count] = depth+1;
+			stack_a[stack_count+1] = a;
+			stack_b[stack_count+1] = split;
+			stack_depth[stack_count+1] = depth+1;
+			stack_count += 2;
+			continue;
+		}
+
+		//Grow storage for pieces
+		if (k == capacity) {
+			EVDS_REAL* new_breaks;
+			EVDS_REAL* new_coefficients;
+			int* new_offset;
+			if (2*capacity*n > EVDS_VARIABLE_FUNCTION_GRID_MAX_SIZE) {
+				failed = 1;
+				break;
+			}
+			capacity *= 2;
+			new_breaks = (EVDS_REAL*)realloc(chebyshev->breaks,sizeof(EVDS_REAL)*(capacity+1));
+			if (new_breaks) chebyshev->breaks = new_breaks;
+			new_offset = (int*)realloc(chebyshev->offset,sizeof(int)*(capacity+1));
+			if (new_offset) chebyshev->offset = new_offset;
+			new_coefficients = (EVDS_REAL*)realloc(chebyshev->coefficients,sizeof(EVDS_REAL)*capacity*n);
+			if (new_coefficients) chebyshev->coefficients = new_coefficients;
+			if ((!new_breaks) || (!new_offset) || (!new_coefficients)) {
+				EVDS_InternalVariable_DestroyChebyshev(function);
+				return EVDS_ERROR_MEMORY;
+			}
+		}
+
+		//Store the piece
+		for (j = 0; j < m; j++) {
+			chebyshev->coefficients[chebyshev->offset[k]+j] = c[j];
+		}
+		chebyshev->offset[k+1] = chebyshev->offset[k]+m;
+		chebyshev->breaks[k+1] = b;
+		chebyshev->count = k+1;
+		while ((node < function->data_count) && (EVDS_InternalVariable_GetFunctionNode(function,node)->x <= b)) node++;
+	}
+
+	//Tolerance can not be met
+	if (failed) {
+		EVDS_InternalVariable_DestroyChebyshev(function);
+		return EVDS_ERROR_BAD_STATE;
+	}
+	return EVDS_OK;
+}
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Get value from a 1D/2D/3D function.
+///
+/// Interpolation segment is found with a binary search in every dimension of the table.
+/// See EVDS_Variable_GetFunctionValueHint() for faster lookups when the function is
+/// evaluated repeatedly for slowly changing arguments.
+///
+/// @param[in] variable Variable
+/// @param[in] x First argument of the function
+/// @param[in] y Second argument of the function (for 2D/3D functions)
+/// @param[in] z Third argument of the function (for 3D functions)
+/// @param[out] p_value Function value will be written here
+///
+/// @returns Error code
+/// @retval EVDS_OK Successfully completed
+/// @retval EVDS_ERROR_BAD_PARAMETER "variable" is null
+/// @retval EVDS_ERROR_BAD_PARAMETER "p_value" is null
+/// @retval EVDS_ERROR_BAD_STATE Variable type invalid (must be EVDS_VARIABLE_TYPE_FUNCTION or EVDS_VARIABLE_TYPE_FLOAT)
+/// @retval EVDS_ERROR_INVALID_OBJECT Variable belongs to an object that was destroyed
 ////////////////////////////////////////////////////////////////////////////////
 int EVDS_Variable_GetFunctionValue(EVDS_VARIABLE* variable, EVDS_REAL x, EVDS_REAL y, EVDS_REAL z, EVDS_REAL* p_value) {
+	return EVDS_Variable_GetFunctionValueHint(variable,x,y,z,0,p_value);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Get value from a 1D/2D/3D function using a caller-held lookup hint.
+///
+/// Hint is an array of EVDS_VARIABLE_FUNCTION_HINT_SIZE integers which remembers the
+/// interpolation segment last used in every dimension of the table. It must be initialized
+/// to zero by the caller and kept between calls. When arguments change slowly (for example
+/// when a thrust curve is evaluated at every integration step), the segment is found in
+/// constant time instead of a binary search.
+///
+/// Every caller (or thread) evaluating the function must keep its own hint. A hint may be
+/// reused for a different function, this only makes the first lookup slower.
+///
+/// @param[in] variable Variable
+/// @param[in] x First argument of the function
+/// @param[in] y Second argument of the function (for 2D/3D functions)
+/// @param[in] z Third argument of the function (for 3D functions)
+/// @param[in,out] hint Array of segment indices (may be null)
+/// @param[out] p_value Function value will be written here
+///
+/// @returns Error code
+/// @retval EVDS_OK Successfully completed
+/// @retval EVDS_ERROR_BAD_PARAMETER "variable" is null
+/// @retval EVDS_ERROR_BAD_PARAMETER "p_value" is null
+/// @retval EVDS_ERROR_BAD_STATE Variable type invalid (must be EVDS_VARIABLE_TYPE_FUNCTION or EVDS_VARIABLE_TYPE_FLOAT)
+/// @retval EVDS_ERROR_INVALID_OBJECT Variable belongs to an object that was destroyed
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_Variable_GetFunctionValueHint(EVDS_VARIABLE* variable, EVDS_REAL x, EVDS_REAL y, EVDS_REAL z,
+									   int* hint, EVDS_REAL* p_value) {
 	EVDS_REAL v[3] = { 0.0 };
 	EVDS_VARIABLE_FUNCTION* function;
 	if (!variable) return EVDS_ERROR_BAD_PARAMETER;
@@ -316,13 +1153,241 @@ int EVDS_Variable_GetFunctionValue(EVDS_VARIABLE* variable, EVDS_REAL x, EVDS_RE
 	v[function->variable_order[1]] = y;
 	v[function->variable_order[2]] = z;
 
+	//Use compiled grid or approximation if available
+	if (function->grid) {
+		*p_value = EVDS_InternalVariable_GetGridValue(function->grid,0,0,v,hint);
+		return EVDS_OK;
+	}
+	if (function->chebyshev) {
+		*p_value = EVDS_InternalVariable_GetChebyshevValue(function->chebyshev,v[0]);
+		return EVDS_OK;
+	}
+
 	//Select the right interpolating function
-	switch (function->interpolation) {
-		case EVDS_VARIABLE_FUNCTION_INTERPOLATION_LINEAR:
-			return EVDS_InternalVariable_GetFunction_Linear(function,v[0],v[1],v[2],p_value);
-		case EVDS_VARIABLE_FUNCTION_INTERPOLATION_SPLINE:
-			break;
-			//return EVDS_InternalVariable_GetFunction_Spline(function,v[0],v[1],v[2],p_value);
+	return EVDS_InternalVariable_GetFunction(function,v[0],v[1],v[2],hint,hint ? EVDS_VARIABLE_FUNCTION_HINT_SIZE : 0,p_value);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Get values from a 1D/2D/3D function for many sets of arguments.
+///
+/// Evaluates the function in "n" points, where i-th point is (x[i], y[i], z[i]). Arguments
+/// are checked and reordered only once per call, and a single lookup hint is shared between
+/// the points, so this is much faster than calling EVDS_Variable_GetFunctionValue() in a loop
+/// when the same table is evaluated for many wing strips or ensemble members.
+///
+/// One- and two-dimensional functions compiled into a grid with uniform linear axes (see
+/// EVDS_Variable_CompileFunction()) are evaluated by branch-free loops which the compiler can
+/// vectorize. All other functions (cubic or non-uniform grids, 3D grids, Chebyshev approximations
+/// and tables which were not compiled) are evaluated point by point.
+///
+/// @param[in] variable Variable
+/// @param[in] x Array of first arguments of the function
+/// @param[in] y Array of second arguments of the function (may be null if not used)
+/// @param[in] z Array of third arguments of the function (may be null if not used)
+/// @param[in] n Number of points
+/// @param[out] out Array of "n" function values
+///
+/// @returns Error code
+/// @retval EVDS_OK Successfully completed
+/// @retval EVDS_ERROR_BAD_PARAMETER "variable" is null
+/// @retval EVDS_ERROR_BAD_PARAMETER "out" is null
+/// @retval EVDS_ERROR_BAD_PARAMETER "n" is negative
+/// @retval EVDS_ERROR_BAD_STATE Variable type invalid (must be EVDS_VARIABLE_TYPE_FUNCTION or EVDS_VARIABLE_TYPE_FLOAT)
+/// @retval EVDS_ERROR_INVALID_OBJECT Variable belongs to an object that was destroyed
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_Variable_GetFunctionValues(EVDS_VARIABLE* variable, const EVDS_REAL* x, const EVDS_REAL* y, const EVDS_REAL* z,
+									int n, EVDS_REAL* out) {
+	int i,d;
+	EVDS_REAL value;
+	EVDS_REAL v[3];
+	const EVDS_REAL* args[3];
+	const EVDS_REAL* src[3] = { 0 };
+	int hint[EVDS_VARIABLE_FUNCTION_HINT_SIZE] = { 0 };
+	EVDS_VARIABLE_FUNCTION* function;
+	EVDS_VARIABLE_FUNCTION_GRID* grid;
+	if (!variable) return EVDS_ERROR_BAD_PARAMETER;
+	if (!out) return EVDS_ERROR_BAD_PARAMETER;
+	if (n < 0) return EVDS_ERROR_BAD_PARAMETER;
+	if ((variable->type != EVDS_VARIABLE_TYPE_FLOAT) &&
+		(variable->type != EVDS_VARIABLE_TYPE_FUNCTION))return EVDS_ERROR_BAD_STATE;
+#ifndef EVDS_SINGLETHREADED
+	if (variable->object && variable->object->destroyed) return EVDS_ERROR_INVALID_OBJECT;
+#endif
+
+	//Float constants and empty tables return a constant value
+	function = (EVDS_VARIABLE_FUNCTION*)variable->value;
+	if ((variable->type == EVDS_VARIABLE_TYPE_FLOAT) || (function->data_count == 0)) {
+		EVDS_ERRCHECK(EVDS_Variable_GetReal(variable,&value));
+		for (i = 0; i < n; i++) out[i] = value;
+		return EVDS_OK;
 	}
+
+	//Remap the parameters correctly
+	args[0] = x;
+	args[1] = y;
+	args[2] = z;
+	for (d = 0; d < 3; d++) {
+		src[function->variable_order[d]] = args[d];
+	}
+
+	//Fast path for uniform linear 1D grids
+	grid = function->grid;
+	if (grid && (grid->dimensions == 1) && (grid->count[0] > 1) &&
+		grid->is_uniform[0] && (!grid->is_cubic[0]) && src[0]) {
+		const EVDS_REAL* values = grid->values;
+		const EVDS_REAL* s = src[0];
+		EVDS_REAL x0 = grid->axis[0][0];
+		EVDS_REAL inv_step = grid->inv_step[0];
+		EVDS_REAL last = (EVDS_REAL)(grid->count[0]-1);
+		int last_segment = grid->count[0]-2;
+
+		for (i = 0; i < n; i++) {
+			EVDS_REAL t = (s[i] - x0)*inv_step;
+			int k;
+			t = (t < 0.0) ? 0.0 : ((t > last) ? last : t);
+			k = (int)t;
+			k = (k > last_segment) ? last_segment : k;
+			out[i] = values[k] + (values[k+1] - values[k])*(t - k);
+		}
+		return EVDS_OK;
+	}
+
+	//Fast path for uniform bilinear 2D grids
+	if (grid && (grid->dimensions == 2) && (grid->count[0] > 1) && (grid->count[1] > 1) &&
+		grid->is_uniform[0] && grid->is_uniform[1] && (!grid->is_cubic[0]) && (!grid->is_cubic[1]) &&
+		src[0] && src[1]) {
+		const EVDS_REAL* values = grid->values;
+		const EVDS_REAL* s0 = src[0];
+		const EVDS_REAL* s1 = src[1];
+		EVDS_REAL x0 = grid->axis[0][0];
+		EVDS_REAL y0 = grid->axis[1][0];
+		EVDS_REAL inv_step0 = grid->inv_step[0];
+		EVDS_REAL inv_step1 = grid->inv_step[1];
+		EVDS_REAL last0 = (EVDS_REAL)(grid->count[0]-1);
+		EVDS_REAL last1 = (EVDS_REAL)(grid->count[1]-1);
+		int last_segment0 = grid->count[0]-2;
+		int last_segment1 = grid->count[1]-2;
+		int stride0 = grid->stride[0];
+		int stride1 = grid->stride[1];
+
+		for (i = 0; i < n; i++) {
+			EVDS_REAL t0 = (s0[i] - x0)*inv_step0;
+			EVDS_REAL t1 = (s1[i] - y0)*inv_step1;
+			EVDS_REAL a,b;
+			int k0,k1,k;
+			t0 = (t0 < 0.0) ? 0.0 : ((t0 > last0) ? last0 : t0);
+			t1 = (t1 < 0.0) ? 0.0 : ((t1 > last1) ? last1 : t1);
+			k0 = (int)t0;
+			k1 = (int)t1;
+			k0 = (k0 > last_segment0) ? last_segment0 : k0;
+			k1 = (k1 > last_segment1) ? last_segment1 : k1;
+			k = k0*stride0 + k1*stride1;
+			a = values[k]         + (values[k+stride1]         - values[k])        *(t1 - k1);
+			b = values[k+stride0] + (values[k+stride0+stride1] - values[k+stride0])*(t1 - k1);
+			out[i] = a + (b - a)*(t0 - k0);
+		}
+		return EVDS_OK;
+	}
+
+	//Generic evaluation with a shared lookup hint
+	for (i = 0; i < n; i++) {
+		for (d = 0; d < 3; d++) {
+			v[d] = src[d] ? src[d][i] : 0.0;
+		}
+
+		if (grid) {
+			out[i] = EVDS_InternalVariable_GetGridValue(grid,0,0,v,hint);
+		} else if (function->chebyshev) {
+			out[i] = EVDS_InternalVariable_GetChebyshevValue(function->chebyshev,v[0]);
+		} else {
+			EVDS_InternalVariable_GetFunction(function,v[0],v[1],v[2],hint,EVDS_VARIABLE_FUNCTION_HINT_SIZE,&out[i]);
+		}
+	}
+	return EVDS_OK;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Get tolerance for the Chebyshev approximation of a function
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalVariable_GetChebyshevTolerance(EVDS_VARIABLE* variable, EVDS_VARIABLE_FUNCTION* function, EVDS_REAL* p_tolerance) {
+	int i;
+	EVDS_VARIABLE* temp_var;
+	if (EVDS_Variable_GetAttribute(variable,"tolerance",&temp_var) == EVDS_OK) {
+		return EVDS_Variable_GetReal(temp_var,p_tolerance);
+	}
+
+	//Default tolerance is relative to values in the table
+	*p_tolerance = 0.0;
+	for (i = 0; i < function->data_count; i++) {
+		EVDS_REAL value = fabs(EVDS_InternalVariable_GetFunctionNode(function,i)->value);
+		if (value > *p_tolerance) *p_tolerance = value;
+	}
+	*p_tolerance = (*p_tolerance > 0.0) ? 1e-6*(*p_tolerance) : 1e-6;
 	return EVDS_OK;
-}
\ No newline at end of file
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Compile a function into a faster representation. @evds_init_only
+///
+/// Nested function tables are compiled into a dense regular grid (@c EVDS_VARIABLE_FUNCTION_COMPILE_GRID).
+/// Nodes along every axis of the grid are the union of X values of all tables on the same depth
+/// of nesting. Evaluating a compiled function requires no pointer chasing through nested tables,
+/// and segments along axes with uniform spacing are found without a search.
+///
+/// Linear tables with the same nodes in every nested table (rectilinear tables) are reproduced
+/// exactly. If nested tables have different nodes, the grid is an approximation which is exact in
+/// all grid nodes. Spline axes are interpolated with a cubic Hermite spline through the grid nodes.
+///
+/// One-dimensional tables can be replaced by a piecewise Chebyshev approximation
+/// (@c EVDS_VARIABLE_FUNCTION_COMPILE_CHEBYSHEV). The approximation is built from pieces which are
+/// bisected only where the function does not fit the tolerance (nodes of the table are preferred
+/// as boundaries of pieces). Every piece is evaluated with the Clenshaw recurrence. Maximum
+/// absolute error is defined by the @c tolerance attribute of the variable (by default it is
+/// 10<sup>-6</sup> of the largest absolute value in the table).
+///
+/// @c EVDS_VARIABLE_FUNCTION_COMPILE_NONE removes the compiled representation.
+///
+/// Functions can also be compiled when loaded by specifying attribute @c compile="grid" or
+/// @c compile="chebyshev". If a function can not be approximated within the tolerance when
+/// loaded, the table is used directly.
+///
+/// @param[in] variable Variable
+/// @param[in] method Compilation method
+///
+/// @returns Error code
+/// @retval EVDS_OK Successfully completed
+/// @retval EVDS_ERROR_BAD_PARAMETER "variable" is null
+/// @retval EVDS_ERROR_BAD_PARAMETER Unknown compilation method
+/// @retval EVDS_ERROR_BAD_STATE Variable type invalid (must be EVDS_VARIABLE_TYPE_FUNCTION)
+/// @retval EVDS_ERROR_BAD_STATE Function has more than three dimensions
+/// @retval EVDS_ERROR_BAD_STATE Chebyshev approximation requested for a function which is not 1D
+/// @retval EVDS_ERROR_BAD_STATE Function can not be approximated within the tolerance
+/// @retval EVDS_ERROR_BAD_PARAMETER Tolerance is not positive
+/// @retval EVDS_ERROR_MEMORY Error allocating grid, or grid is too large
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_Variable_CompileFunction(EVDS_VARIABLE* variable, int method) {
+	EVDS_REAL tolerance;
+	EVDS_VARIABLE_FUNCTION* function;
+	if (!variable) return EVDS_ERROR_BAD_PARAMETER;
+	if (variable->type != EVDS_VARIABLE_TYPE_FUNCTION) return EVDS_ERROR_BAD_STATE;
+
+	function = (EVDS_VARIABLE_FUNCTION*)variable->value;
+	switch (method) {
+		case EVDS_VARIABLE_FUNCTION_COMPILE_NONE:
+			EVDS_InternalVariable_DestroyGrid(function);
+			EVDS_InternalVariable_DestroyChebyshev(function);
+			return EVDS_OK;
+		case EVDS_VARIABLE_FUNCTION_COMPILE_GRID:
+			EVDS_InternalVariable_DestroyChebyshev(function);
+			return EVDS_InternalVariable_CompileGrid(function);
+		case EVDS_VARIABLE_FUNCTION_COMPILE_CHEBYSHEV:
+			EVDS_InternalVariable_DestroyGrid(function);
+			EVDS_InternalVariable_GetChebyshevTolerance(variable,function,&tolerance);
+			return EVDS_InternalVariable_CompileChebyshev(function,tolerance);
+	}
+	return EVDS_ERROR_BAD_PARAMETER;
+}
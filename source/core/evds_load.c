@@ -54,6 +54,13 @@ struct {
 const int EVDS_Internal_ParameterRemappingTableCount = 
 	sizeof(EVDS_Internal_ParameterRemappingTable) / sizeof(EVDS_Internal_ParameterRemappingTable[0]);
 
+////////////////////////////////////////////////////////////////////////////////
+/// Hash table of parameter remapping table entries (index + 1, 0 if slot is empty)
+////////////////////////////////////////////////////////////////////////////////
+#define EVDS_INTERNAL_REMAPPING_HASH_SIZE	64
+int EVDS_Internal_ParameterRemappingHash[EVDS_INTERNAL_REMAPPING_HASH_SIZE];
+int EVDS_Internal_ParameterRemappingHashReady = 0;
+
 
 ////////////////////////////////////////////////////////////////////////////////
 /// Table of object names that must be renamed (for backwards compatibility)
@@ -71,6 +78,77 @@ const int EVDS_Internal_ObjectRemappingTableCount =
 
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Hash of object type and parameter name (FNV-1a)
+////////////////////////////////////////////////////////////////////////////////
+unsigned int EVDS_Internal_RemappingHash(const char* object_type, const char* name) {
+	unsigned int hash = 2166136261u;
+	int i;
+	for (i = 0; (i < 256) && object_type[i]; i++) {
+		hash = (hash ^ (unsigned char)object_type[i]) * 16777619u;
+	}
+	hash = hash * 16777619u; //Separator between type and name
+	while (*name) {
+		hash = (hash ^ (unsigned char)(*name)) * 16777619u;
+		name++;
+	}
+	return hash;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Build hash table for the parameter remapping table.
+///
+/// Called when a system is created, so that remapping a parameter does not depend on the
+/// number of entries in the remapping table. Entries are inserted in table order, so the first
+/// matching entry in the table is always found first. The table is built by the first system,
+/// before files can be loaded from other threads (see EVDS_System_Create()).
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_Internal_InitializeRemappingTable() {
+	int i;
+	unsigned int slot;
+	if (EVDS_Internal_ParameterRemappingHashReady) return;
+
+	memset(EVDS_Internal_ParameterRemappingHash,0,sizeof(EVDS_Internal_ParameterRemappingHash));
+	for (i = 0; i < EVDS_Internal_ParameterRemappingTableCount; i++) {
+		slot = EVDS_Internal_RemappingHash(EVDS_Internal_ParameterRemappingTable[i].object_type,
+										   EVDS_Internal_ParameterRemappingTable[i].old_name);
+		slot = slot % EVDS_INTERNAL_REMAPPING_HASH_SIZE;
+		while (EVDS_Internal_ParameterRemappingHash[slot]) {
+			slot = (slot + 1) % EVDS_INTERNAL_REMAPPING_HASH_SIZE;
+		}
+		EVDS_Internal_ParameterRemappingHash[slot] = i+1;
+	}
+	EVDS_Internal_ParameterRemappingHashReady = 1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Get new name of a parameter stored in file of given version.
+///
+/// @returns New parameter name or the old name if parameter must not be renamed
+////////////////////////////////////////////////////////////////////////////////
+char* EVDS_Internal_RemapParameter(const char* object_type, char* name, int version) {
+	unsigned int slot;
+	int i;
+
+	slot = EVDS_Internal_RemappingHash(object_type,name) % EVDS_INTERNAL_REMAPPING_HASH_SIZE;
+	while (EVDS_Internal_ParameterRemappingHash[slot]) {
+		i = EVDS_Internal_ParameterRemappingHash[slot]-1;
+
+		//Check if remapping criteria are satisfied
+		if (((version <= EVDS_Internal_ParameterRemappingTable[i].last_version) ||
+			 (EVDS_Internal_ParameterRemappingTable[i].last_version == 0)) &&
+			(strncmp(object_type,EVDS_Internal_ParameterRemappingTable[i].object_type,256) == 0) &&
+			(strcmp(name,EVDS_Internal_ParameterRemappingTable[i].old_name) == 0)) {
+			return EVDS_Internal_ParameterRemappingTable[i].new_name;
+		}
+		slot = (slot + 1) % EVDS_INTERNAL_REMAPPING_HASH_SIZE;
+	}
+	return name;
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief Load parameter from the XML file
 ///
@@ -79,7 +157,6 @@ const int EVDS_Internal_ObjectRemappingTableCount =
 int EVDS_Internal_LoadParameter(EVDS_OBJECT* object, EVDS_VARIABLE* parent_variable, 
 								SIMC_XML_DOCUMENT* doc, SIMC_XML_ELEMENT* element, SIMC_XML_ATTRIBUTE* attribute,
 								EVDS_OBJECT_LOADEX* info, int nested_in_function) {
-	int i;
 	char* value;
 	char* name;
 	char* vector_type;
@@ -87,6 +164,7 @@ int EVDS_Internal_LoadParameter(EVDS_OBJECT* object, EVDS_VARIABLE* parent_varia
 	double real_value;
 	double x,y,z,w;
 	EVDS_VARIABLE* variable;
+	EVDS_OBJECT* related_object;
 	EVDS_VARIABLE_TYPE type = EVDS_VARIABLE_TYPE_NESTED; //Nested unless specified otherwise
 	SIMC_XML_ELEMENT* nested_element;
 	SIMC_XML_ATTRIBUTE* nested_attribute;
@@ -121,22 +199,9 @@ int EVDS_Internal_LoadParameter(EVDS_OBJECT* object, EVDS_VARIABLE* parent_varia
 
 
 	//Remap parameter name (to provide compatibility with old file versions)
-	for (i = 0; i < EVDS_Internal_ParameterRemappingTableCount; i++) {
-		//Find object relevant to the variable
-		EVDS_OBJECT* related_object = object;
-		if ((!related_object) && (parent_variable)) related_object = parent_variable->object;
-
-		//Check if remapping criteria are satisfied
-		if ((related_object) &&
-			((info->version <= EVDS_Internal_ParameterRemappingTable[i].last_version) ||
-			 (EVDS_Internal_ParameterRemappingTable[i].last_version == 0)) &&
-			(strncmp(related_object->type,EVDS_Internal_ParameterRemappingTable[i].object_type,256) == 0) &&
-			(strcmp(name,EVDS_Internal_ParameterRemappingTable[i].old_name) == 0)) {
-			//Use new name if object type matches, and old parameter name is used
-			name = EVDS_Internal_ParameterRemappingTable[i].new_name;
-			break;
-		}
-	}
+	related_object = object;
+	if ((!related_object) && (parent_variable)) related_object = parent_variable->object;
+	if (related_object) name = EVDS_Internal_RemapParameter(related_object->type,name,info->version);
 
 
 	//Try to guess data type based on value (if type is not defined)
@@ -293,12 +358,11 @@ int EVDS_Internal_LoadParameter(EVDS_OBJECT* object, EVDS_VARIABLE* parent_varia
 
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief Load object from the XML file
+/// @brief Create object and set its state from attributes of the XML element
 ////////////////////////////////////////////////////////////////////////////////
-int EVDS_Internal_LoadObject(EVDS_OBJECT* parent, SIMC_XML_DOCUMENT* doc, SIMC_XML_ELEMENT* root, EVDS_OBJECT** p_object,
-							 EVDS_OBJECT_LOADEX* info) {
+int EVDS_Internal_LoadObjectAttributes(EVDS_OBJECT* parent, SIMC_XML_DOCUMENT* doc, SIMC_XML_ELEMENT* root,
+									   EVDS_OBJECT** p_object) {
 	EVDS_OBJECT* object;
-	SIMC_XML_ELEMENT* element;
 	char *name, *type;
 	double x,y,z,vx,vy,vz,pitch,yaw,roll;
 	double q0,q1,q2,q3;//,time;
@@ -393,6 +457,21 @@ int EVDS_Internal_LoadObject(EVDS_OBJECT* parent, SIMC_XML_DOCUMENT* doc, SIMC_X
 	EVDS_Object_SetName(object,name);
 	EVDS_Object_SetType(object,type);
 	if (uid > 0.0) EVDS_Object_SetUID(object,(unsigned int)uid);
+	return EVDS_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Load object from the XML file
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_Internal_LoadObject(EVDS_OBJECT* parent, SIMC_XML_DOCUMENT* doc, SIMC_XML_ELEMENT* root, EVDS_OBJECT** p_object,
+							 EVDS_OBJECT_LOADEX* info) {
+	EVDS_OBJECT* object;
+	SIMC_XML_ELEMENT* element;
+
+	//Create object
+	EVDS_ERRCHECK(EVDS_Internal_LoadObjectAttributes(parent,doc,root,&object));
+	if (p_object) *p_object = object;
 
 	//Read parameters
 	EVDS_ERRCHECK(SIMC_XML_GetElement(doc,root,&element,"parameter"));
@@ -422,6 +501,65 @@ int EVDS_Internal_LoadObject(EVDS_OBJECT* parent, SIMC_XML_DOCUMENT* doc, SIMC_X
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Pass object loaded directly under the EVDS tag to the application.
+///
+/// @param[out] p_stop Set to 1 if no more objects must be loaded from this EVDS tag
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_Internal_LoadFileObject(EVDS_OBJECT* object, EVDS_OBJECT** p_object, EVDS_OBJECT_LOADEX* info, int* p_stop) {
+	*p_stop = 0;
+	if (p_object && (*p_object == 0)) {
+		*p_object = object;
+	} else if (info->flags != 0xFFFFFFFF) {
+		if (!info->firstObject) {
+			info->firstObject = object;
+			if (info->flags & EVDS_OBJECT_LOADEX_ONLY_FIRST) {
+				*p_stop = 1;
+				return EVDS_OK;
+			}
+		}
+		if (info->OnLoadObject) {
+			EVDS_ERRCHECK(info->OnLoadObject(info,object));
+		}
+	} else {
+		if (info->flags == 0xFFFFFFFF) {
+			EVDS_Object_Initialize(object, 1); //FIXME: should default be blocking or non-blocking?
+		} else {
+			if (!(info->flags & EVDS_OBJECT_LOADEX_DONT_INITIALIZE)) {
+				EVDS_Object_Initialize(object, info->flags & EVDS_OBJECT_LOADEX_BLOCKING_INITIALIZE);
+			}
+		}
+	}
+	return EVDS_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Load database entries from the XML file
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_Internal_LoadDatabase(EVDS_OBJECT* parent, SIMC_XML_DOCUMENT* doc, SIMC_XML_ELEMENT* element,
+							   EVDS_OBJECT_LOADEX* info) {
+	char* name;
+	SIMC_XML_ELEMENT* nested;
+	EVDS_VARIABLE* database;
+
+	//Create new database or find existing one
+	EVDS_ERRCHECK(SIMC_XML_GetAttribute(doc,element,"name",&name));
+	if (EVDS_System_GetDatabaseByName(parent->system,name,&database) != EVDS_OK) {
+		EVDS_ERRCHECK(EVDS_Variable_Create(parent->system,name,EVDS_VARIABLE_TYPE_NESTED,&database));
+		SIMC_List_Append(parent->system->databases,database);
+	}
+
+	//Load all entries
+	EVDS_ERRCHECK(SIMC_XML_GetElement(doc,element,&nested,"entry"));
+	while (nested) {
+		EVDS_ERRCHECK(EVDS_Internal_LoadParameter(0,database,doc,nested,0,info,0));
+		EVDS_ERRCHECK(SIMC_XML_Iterate(doc,element,&nested,"entry"));
+	}
+	return EVDS_OK;
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief Load a single "file" (EVDS tag) from XML file
 ////////////////////////////////////////////////////////////////////////////////
@@ -434,28 +572,10 @@ int EVDS_Internal_LoadFile(EVDS_OBJECT* parent, SIMC_XML_DOCUMENT* doc, SIMC_XML
 		EVDS_ERRCHECK(SIMC_XML_GetElement(doc,root,&element,"object"));
 		while (element) {
 			EVDS_OBJECT* object;
+			int stop;
 			EVDS_ERRCHECK(EVDS_Internal_LoadObject(parent,doc,element,&object,info));
-			if (p_object && (*p_object == 0)) {
-				*p_object = object;
-			} else if (info->flags != 0xFFFFFFFF) {
-				if (!info->firstObject) {
-					info->firstObject = object;
-					if (info->flags & EVDS_OBJECT_LOADEX_ONLY_FIRST) {
-						break;
-					}
-				}
-				if (info->OnLoadObject) {
-					EVDS_ERRCHECK(info->OnLoadObject(info,object));
-				}
-			} else {
-				if (info->flags == 0xFFFFFFFF) {
-					EVDS_Object_Initialize(object, 1); //FIXME: should default be blocking or non-blocking?
-				} else {
-					if (!(info->flags & EVDS_OBJECT_LOADEX_DONT_INITIALIZE)) {
-						EVDS_Object_Initialize(object, info->flags & EVDS_OBJECT_LOADEX_BLOCKING_INITIALIZE);
-					}
-				}
-			}
+			EVDS_ERRCHECK(EVDS_Internal_LoadFileObject(object,p_object,info,&stop));
+			if (stop) break;
 
 			EVDS_ERRCHECK(SIMC_XML_Iterate(doc,root,&element,"object"));
 		}
@@ -465,24 +585,7 @@ int EVDS_Internal_LoadFile(EVDS_OBJECT* parent, SIMC_XML_DOCUMENT* doc, SIMC_XML
 	if ((info->flags == 0xFFFFFFFF) || (!(info->flags & EVDS_OBJECT_LOADEX_NO_DATABASES))) {
 		EVDS_ERRCHECK(SIMC_XML_GetElement(doc,root,&element,"database"));
 		while (element) {
-			char* name;
-			SIMC_XML_ELEMENT* nested;
-			EVDS_VARIABLE* database;
-
-			//Create new database or find existing one
-			EVDS_ERRCHECK(SIMC_XML_GetAttribute(doc,element,"name",&name));
-			if (EVDS_System_GetDatabaseByName(parent->system,name,&database) != EVDS_OK) {
-				EVDS_ERRCHECK(EVDS_Variable_Create(parent->system,name,EVDS_VARIABLE_TYPE_NESTED,&database));
-				SIMC_List_Append(parent->system->databases,database);
-			}
-
-			//Load all entries
-			EVDS_ERRCHECK(SIMC_XML_GetElement(doc,element,&nested,"entry"));
-			while (nested) {
-				EVDS_ERRCHECK(EVDS_Internal_LoadParameter(0,database,doc,nested,0,info,0));
-				EVDS_ERRCHECK(SIMC_XML_Iterate(doc,element,&nested,"entry"));
-			}
-
+			EVDS_ERRCHECK(EVDS_Internal_LoadDatabase(parent,doc,element,info));
 			EVDS_ERRCHECK(SIMC_XML_Iterate(doc,root,&element,"database"));
 		}
 	}
@@ -505,13 +608,13 @@ int EVDS_Internal_ParseFile(EVDS_OBJECT* parent, SIMC_XML_DOCUMENT* doc,
 	if (!info) info = &default_info;
 	default_info.flags = 0xFFFFFFFF;
 
-	//Read file version
-	EVDS_ERRCHECK(SIMC_XML_GetRootElement(doc,&root,"EVDS"));
-	EVDS_ERRCHECK(SIMC_XML_GetAttributeInt(doc,root,"version",&version));
-	info->version = version;
-
 	//Load single object or multiple objects
+	EVDS_ERRCHECK(SIMC_XML_GetRootElement(doc,&root,"EVDS"));
 	if (root) {
+		//Read file version
+		EVDS_ERRCHECK(SIMC_XML_GetAttributeInt(doc,root,"version",&version));
+		info->version = version;
+
 		//Load a single object
 		EVDS_ERRCHECK(EVDS_Internal_LoadFile(parent,doc,root,p_object,info));
 	} else {
@@ -530,6 +633,468 @@ int EVDS_Internal_ParseFile(EVDS_OBJECT* parent, SIMC_XML_DOCUMENT* doc,
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief State of the streaming loader (see EVDS_OBJECT_LOADEX_STREAMING).
+///
+/// Input is read in chunks into a sliding window. Only the markup that is still required
+/// (the tag being read, or the parameter or database element being captured) is kept in
+/// the window, and only the chain of currently open elements is kept on the stack.
+////////////////////////////////////////////////////////////////////////////////
+#define EVDS_INTERNAL_STREAM_CHUNK			65536
+
+#define EVDS_INTERNAL_STREAM_SKIP			0 //Element which is not loaded
+#define EVDS_INTERNAL_STREAM_DATA			1 //DATA tag
+#define EVDS_INTERNAL_STREAM_FILE			2 //EVDS tag
+#define EVDS_INTERNAL_STREAM_OBJECT			3 //Object tag
+
+#define EVDS_INTERNAL_STREAM_TAG_NONE		0 //End of input
+#define EVDS_INTERNAL_STREAM_TAG_START		1 //Start tag
+#define EVDS_INTERNAL_STREAM_TAG_END		2 //End tag
+#define EVDS_INTERNAL_STREAM_TAG_EMPTY		3 //Self-closing tag
+#define EVDS_INTERNAL_STREAM_TAG_OTHER		4 //Comment, declaration or CDATA section
+
+#ifndef DOXYGEN_INTERNAL_STRUCTS
+typedef struct EVDS_INTERNAL_STREAM_LEVEL_TAG {
+	int type;						//Type of the open element
+	EVDS_OBJECT* object;			//Object created for the element
+} EVDS_INTERNAL_STREAM_LEVEL;
+
+typedef struct EVDS_INTERNAL_STREAM_TAG {
+	FILE* file;						//File being read (null if reading from description)
+	const char* description;		//Remaining part of the description
+	size_t description_size;		//Remaining size of the description
+
+	char* buffer;					//Window into the input
+	size_t size;					//Number of bytes in the window
+	size_t capacity;				//Size of the window buffer
+	size_t position;				//Offset at which next tag is searched for
+
+	EVDS_INTERNAL_STREAM_LEVEL* levels;	//Stack of open elements
+	int level_count;				//Number of open elements
+	int level_capacity;				//Size of the stack
+
+	int capture_depth;				//Nesting depth inside the captured element
+	size_t capture_start;			//Offset of the captured element in the window
+
+	char* tag;						//Start tag converted into a standalone element
+	size_t tag_capacity;			//Size of the start tag buffer
+
+	int has_root;					//Root element was read
+	int skip_objects;				//Skip remaining objects in the current EVDS tag
+} EVDS_INTERNAL_STREAM;
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Report syntax error in the streamed input
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalStream_SyntaxError(EVDS_OBJECT_LOADEX* info, const char* error) {
+	if (info->OnSyntaxError) info->OnSyntaxError(info,error);
+	return EVDS_ERROR_SYNTAX;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Read next chunk of input into the window.
+///
+/// Data before offset "p_keep" (and before the captured element) is discarded. The offset
+/// is updated to match the new window contents.
+///
+/// @param[out] p_count Number of bytes read (zero at the end of input)
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalStream_Fill(EVDS_INTERNAL_STREAM* stream, size_t* p_keep, size_t* p_count) {
+	size_t keep = *p_keep;
+	size_t count;
+
+	//Drop data which is no longer needed
+	if (stream->capture_depth && (stream->capture_start < keep)) keep = stream->capture_start;
+	if (keep > 0) {
+		memmove(stream->buffer,stream->buffer+keep,stream->size-keep);
+		stream->size -= keep;
+		if (stream->capture_depth) stream->capture_start -= keep;
+		*p_keep -= keep;
+	}
+
+	//Grow the window (with one extra byte for null terminator)
+	if (stream->size + EVDS_INTERNAL_STREAM_CHUNK + 1 > stream->capacity) {
+		char* buffer;
+		size_t capacity = stream->capacity ? stream->capacity : EVDS_INTERNAL_STREAM_CHUNK + 1;
+		while (stream->size + EVDS_INTERNAL_STREAM_CHUNK + 1 > capacity) capacity *= 2;
+
+		buffer = (char*)realloc(stream->buffer,capacity);
+		if (!buffer) return EVDS_ERROR_MEMORY;
+		stream->buffer = buffer;
+		stream->capacity = capacity;
+	}
+
+	//Read next chunk
+	if (stream->file) {
+		count = fread(stream->buffer+stream->size,1,EVDS_INTERNAL_STREAM_CHUNK,stream->file);
+	} else {
+		count = stream->description_size;
+		if (count > EVDS_INTERNAL_STREAM_CHUNK) count = EVDS_INTERNAL_STREAM_CHUNK;
+		memcpy(stream->buffer+stream->size,stream->description,count);
+		stream->description += count;
+		stream->description_size -= count;
+	}
+	stream->size += count;
+	*p_count = count;
+	return EVDS_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Make sure byte at "offset" after the tag start is present in the window
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalStream_Require(EVDS_INTERNAL_STREAM* stream, size_t* p_start, size_t offset, int* p_available) {
+	size_t count = 1;
+	while ((*p_start + offset >= stream->size) && (count > 0)) {
+		EVDS_ERRCHECK(EVDS_InternalStream_Fill(stream,p_start,&count));
+	}
+	*p_available = (*p_start + offset < stream->size);
+	return EVDS_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Check if markup in the window starts with the given prefix
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalStream_HasPrefix(EVDS_INTERNAL_STREAM* stream, size_t start, const char* prefix) {
+	size_t length = strlen(prefix);
+	return (start + length <= stream->size) && (memcmp(stream->buffer+start,prefix,length) == 0);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Check if tag between "start" and "end" has the given name
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalStream_IsTag(EVDS_INTERNAL_STREAM* stream, size_t start, size_t end, const char* name) {
+	size_t length = strlen(name);
+	char* tag = stream->buffer+start+1;
+	char c;
+
+	if (*tag == '/') tag++;
+	if (tag + length >= stream->buffer+end) return 0;
+	if (strncmp(tag,name,length) != 0) return 0;
+	c = tag[length];
+	return (c == '>') || (c == '/') || (c == ' ') || (c == '\t') || (c == '\r') || (c == '\n');
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Find next markup in the input.
+///
+/// Text between tags is skipped. Offsets of the markup are valid until the next call.
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalStream_NextTag(EVDS_INTERNAL_STREAM* stream, EVDS_OBJECT_LOADEX* info,
+								size_t* p_start, size_t* p_end, int* p_kind) {
+	const char* terminator = ">";
+	size_t terminator_length;
+	size_t start = stream->position;
+	size_t i;
+	char quote = 0;
+	int available;
+
+	//Skip text up to the next markup
+	while (1) {
+		char* next;
+		EVDS_ERRCHECK(EVDS_InternalStream_Require(stream,&start,0,&available));
+		if (!available) {
+			stream->position = start;
+			*p_kind = EVDS_INTERNAL_STREAM_TAG_NONE;
+			return EVDS_OK;
+		}
+
+		next = (char*)memchr(stream->buffer+start,'<',stream->size-start);
+		if (next) {
+			start = next - stream->buffer;
+			break;
+		}
+		start = stream->size;
+	}
+
+	//Determine how the markup is terminated
+	EVDS_ERRCHECK(EVDS_InternalStream_Require(stream,&start,8,&available));
+	if (EVDS_InternalStream_HasPrefix(stream,start,"<!--")) {
+		terminator = "-->";
+	} else if (EVDS_InternalStream_HasPrefix(stream,start,"<![CDATA[")) {
+		terminator = "]]>";
+	} else if (EVDS_InternalStream_HasPrefix(stream,start,"<?")) {
+		terminator = "?>";
+	}
+	terminator_length = strlen(terminator);
+
+	//Find end of the markup
+	for (i = 1; ; i++) {
+		char c;
+		EVDS_ERRCHECK(EVDS_InternalStream_Require(stream,&start,i,&available));
+		if (!available) return EVDS_InternalStream_SyntaxError(info,"Unexpected end of file inside a tag");
+
+		c = stream->buffer[start+i];
+		if (terminator_length == 1) { //Quoted attribute values may contain '>'
+			if (quote) {
+				if (c == quote) quote = 0;
+			} else if ((c == '"') || (c == '\'')) {
+				quote = c;
+			} else if (c == '>') {
+				break;
+			}
+		} else if ((c == '>') && (i + 1 >= terminator_length) &&
+			(memcmp(stream->buffer+start+i+1-terminator_length,terminator,terminator_length) == 0)) {
+			break;
+		}
+	}
+	*p_start = start;
+	*p_end = start+i+1;
+	stream->position = *p_end;
+
+	//Determine type of the markup
+	if ((terminator_length > 1) || (stream->buffer[start+1] == '!')) {
+		*p_kind = EVDS_INTERNAL_STREAM_TAG_OTHER;
+	} else if (stream->buffer[start+1] == '/') {
+		*p_kind = EVDS_INTERNAL_STREAM_TAG_END;
+	} else if (stream->buffer[start+i-1] == '/') {
+		*p_kind = EVDS_INTERNAL_STREAM_TAG_EMPTY;
+	} else {
+		*p_kind = EVDS_INTERNAL_STREAM_TAG_START;
+	}
+	return EVDS_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Parse attributes of a start tag by reading it as a standalone element
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalStream_ParseTag(EVDS_INTERNAL_STREAM* stream, EVDS_OBJECT_LOADEX* info, size_t start, size_t end,
+								 int kind, const char* name, SIMC_XML_DOCUMENT** p_doc, SIMC_XML_ELEMENT** p_element) {
+	size_t length = end - start;
+
+	//Copy the tag and make it self-closing
+	if (length + 2 > stream->tag_capacity) {
+		char* tag = (char*)realloc(stream->tag,length + 2);
+		if (!tag) return EVDS_ERROR_MEMORY;
+		stream->tag = tag;
+		stream->tag_capacity = length + 2;
+	}
+	memcpy(stream->tag,stream->buffer+start,length);
+	if (kind == EVDS_INTERNAL_STREAM_TAG_START) {
+		stream->tag[length-1] = '/';
+		stream->tag[length++] = '>';
+	}
+	stream->tag[length] = 0;
+
+	EVDS_ERRCHECK(SIMC_XML_OpenString(stream->tag,p_doc,info->OnSyntaxError,info));
+	EVDS_ERRCHECK(SIMC_XML_GetRootElement(*p_doc,p_element,name));
+	if (!(*p_element)) {
+		SIMC_XML_Close(*p_doc);
+		return EVDS_InternalStream_SyntaxError(info,"Malformed tag");
+	}
+	return EVDS_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Load captured parameter or database element which ends at "end"
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalStream_LoadCaptured(EVDS_OBJECT* parent, EVDS_INTERNAL_STREAM* stream, EVDS_OBJECT_LOADEX* info,
+									 size_t end) {
+	EVDS_INTERNAL_STREAM_LEVEL* level = &stream->levels[stream->level_count-1];
+	SIMC_XML_DOCUMENT* doc;
+	SIMC_XML_ELEMENT* element;
+	char last;
+	int error;
+
+	//Parse the element as a standalone document
+	last = stream->buffer[end];
+	stream->buffer[end] = 0;
+	error = SIMC_XML_OpenString(stream->buffer+stream->capture_start,&doc,info->OnSyntaxError,info);
+	stream->buffer[end] = last;
+	if (error != EVDS_OK) return error;
+
+	//Load parameter into the object or entries into the database
+	if (level->type == EVDS_INTERNAL_STREAM_OBJECT) {
+		error = SIMC_XML_GetRootElement(doc,&element,"parameter");
+		if ((error == EVDS_OK) && element) {
+			error = EVDS_Internal_LoadParameter(level->object,0,doc,element,0,info,0);
+		}
+	} else {
+		error = SIMC_XML_GetRootElement(doc,&element,"database");
+		if ((error == EVDS_OK) && element) {
+			error = EVDS_Internal_LoadDatabase(parent,doc,element,info);
+		}
+	}
+	SIMC_XML_Close(doc);
+	return error;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Close the innermost open element
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalStream_EndElement(EVDS_INTERNAL_STREAM* stream, EVDS_OBJECT_LOADEX* info, size_t start, size_t end) {
+	EVDS_INTERNAL_STREAM_LEVEL* level;
+	const char* names[] = { 0, "DATA", "EVDS", "object" };
+
+	if (stream->level_count == 0) return EVDS_InternalStream_SyntaxError(info,"Unexpected closing tag");
+	level = &stream->levels[--stream->level_count];
+	if ((level->type != EVDS_INTERNAL_STREAM_SKIP) &&
+		(!EVDS_InternalStream_IsTag(stream,start,end,names[level->type]))) {
+		return EVDS_InternalStream_SyntaxError(info,"Mismatched closing tag");
+	}
+
+	//Objects directly under the EVDS tag are complete once they are closed
+	if ((level->type == EVDS_INTERNAL_STREAM_OBJECT) && (stream->level_count > 0) &&
+		(stream->levels[stream->level_count-1].type == EVDS_INTERNAL_STREAM_FILE)) {
+		int stop;
+		EVDS_ERRCHECK(EVDS_Internal_LoadFileObject(level->object,0,info,&stop));
+		if (stop) stream->skip_objects = 1;
+	}
+	return EVDS_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Open new element (objects are created as soon as their start tag is read)
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalStream_StartElement(EVDS_OBJECT* parent, EVDS_INTERNAL_STREAM* stream, EVDS_OBJECT_LOADEX* info,
+									 size_t start, size_t end, int kind) {
+	SIMC_XML_DOCUMENT* doc;
+	SIMC_XML_ELEMENT* element;
+	EVDS_INTERNAL_STREAM_LEVEL* level;
+	EVDS_OBJECT* object = 0;
+	int type = EVDS_INTERNAL_STREAM_SKIP;
+	int top = -1;
+	int error;
+
+	if (stream->level_count > 0) top = stream->levels[stream->level_count-1].type;
+
+	//Parameters and databases are captured whole and loaded once closed
+	if (((top == EVDS_INTERNAL_STREAM_OBJECT) && EVDS_InternalStream_IsTag(stream,start,end,"parameter")) ||
+		((top == EVDS_INTERNAL_STREAM_FILE) && EVDS_InternalStream_IsTag(stream,start,end,"database") &&
+		 (!(info->flags & EVDS_OBJECT_LOADEX_NO_DATABASES)))) {
+		stream->capture_start = start;
+		if (kind == EVDS_INTERNAL_STREAM_TAG_EMPTY) {
+			return EVDS_InternalStream_LoadCaptured(parent,stream,info,end);
+		}
+		stream->capture_depth = 1;
+		return EVDS_OK;
+	}
+
+	//Determine type of the element
+	if (top == -1) {
+		if (stream->has_root) return EVDS_InternalStream_SyntaxError(info,"More than one root element");
+		if (EVDS_InternalStream_IsTag(stream,start,end,"EVDS")) {
+			type = EVDS_INTERNAL_STREAM_FILE;
+		} else if (EVDS_InternalStream_IsTag(stream,start,end,"DATA")) {
+			type = EVDS_INTERNAL_STREAM_DATA;
+		} else {
+			return EVDS_InternalStream_SyntaxError(info,"Expected EVDS or DATA root element");
+		}
+		stream->has_root = 1;
+	} else if ((top == EVDS_INTERNAL_STREAM_DATA) && EVDS_InternalStream_IsTag(stream,start,end,"EVDS")) {
+		type = EVDS_INTERNAL_STREAM_FILE;
+	} else if ((top == EVDS_INTERNAL_STREAM_FILE) && EVDS_InternalStream_IsTag(stream,start,end,"object") &&
+			   (!(info->flags & EVDS_OBJECT_LOADEX_NO_OBJECTS)) && (!stream->skip_objects)) {
+		type = EVDS_INTERNAL_STREAM_OBJECT;
+	} else if ((top == EVDS_INTERNAL_STREAM_OBJECT) && EVDS_InternalStream_IsTag(stream,start,end,"object")) {
+		type = EVDS_INTERNAL_STREAM_OBJECT;
+	}
+
+	//Read file version from the root element, create objects
+	if (top == -1) {
+		EVDS_ERRCHECK(EVDS_InternalStream_ParseTag(stream,info,start,end,kind,
+			(type == EVDS_INTERNAL_STREAM_FILE) ? "EVDS" : "DATA",&doc,&element));
+		error = SIMC_XML_GetAttributeInt(doc,element,"version",&info->version);
+		SIMC_XML_Close(doc);
+		if (error != EVDS_OK) return error;
+	}
+	if (type == EVDS_INTERNAL_STREAM_FILE) {
+		stream->skip_objects = 0;
+	} else if (type == EVDS_INTERNAL_STREAM_OBJECT) {
+		if (top == EVDS_INTERNAL_STREAM_OBJECT) parent = stream->levels[stream->level_count-1].object;
+
+		EVDS_ERRCHECK(EVDS_InternalStream_ParseTag(stream,info,start,end,kind,"object",&doc,&element));
+		error = EVDS_Internal_LoadObjectAttributes(parent,doc,element,&object);
+		SIMC_XML_Close(doc);
+		if (error != EVDS_OK) return error;
+	}
+
+	//Push element on the stack
+	if (stream->level_count == stream->level_capacity) {
+		int capacity = stream->level_capacity ? 2*stream->level_capacity : 16;
+		level = (EVDS_INTERNAL_STREAM_LEVEL*)realloc(stream->levels,capacity*sizeof(EVDS_INTERNAL_STREAM_LEVEL));
+		if (!level) return EVDS_ERROR_MEMORY;
+		stream->levels = level;
+		stream->level_capacity = capacity;
+	}
+	level = &stream->levels[stream->level_count++];
+	level->type = type;
+	level->object = object;
+
+	//Self-closing elements are closed right away
+	if (kind == EVDS_INTERNAL_STREAM_TAG_EMPTY) {
+		return EVDS_InternalStream_EndElement(stream,info,start,end);
+	}
+	return EVDS_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Load objects from file or description without building the whole document.
+///
+/// Objects are created as soon as their start tag is read, parameters and databases are
+/// loaded as their elements are closed, and objects directly under the EVDS tag are passed
+/// to @c OnLoadObject once they are closed. Memory use is bounded by the nesting depth
+/// and the size of the largest single parameter rather than by the size of the input.
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_Internal_LoadStream(EVDS_OBJECT* parent, const char* filename, EVDS_OBJECT_LOADEX* info) {
+	EVDS_INTERNAL_STREAM stream = { 0 };
+	size_t start,end;
+	int kind;
+	int error = EVDS_OK;
+
+	//Open input
+	if (info->description) {
+		stream.description = info->description;
+		stream.description_size = strlen(info->description);
+	} else {
+		stream.file = fopen(filename,"rb");
+		if (!stream.file) return EVDS_ERROR_FILE;
+	}
+
+	//Process markup as it is read
+	while (error == EVDS_OK) {
+		error = EVDS_InternalStream_NextTag(&stream,info,&start,&end,&kind);
+		if ((error != EVDS_OK) || (kind == EVDS_INTERNAL_STREAM_TAG_NONE)) break;
+		if (kind == EVDS_INTERNAL_STREAM_TAG_OTHER) continue;
+
+		if (stream.capture_depth > 0) {
+			if (kind == EVDS_INTERNAL_STREAM_TAG_START) stream.capture_depth++;
+			if (kind == EVDS_INTERNAL_STREAM_TAG_END) stream.capture_depth--;
+			if (stream.capture_depth == 0) {
+				error = EVDS_InternalStream_LoadCaptured(parent,&stream,info,end);
+			}
+		} else if (kind == EVDS_INTERNAL_STREAM_TAG_END) {
+			error = EVDS_InternalStream_EndElement(&stream,info,start,end);
+		} else {
+			error = EVDS_InternalStream_StartElement(parent,&stream,info,start,end,kind);
+		}
+	}
+
+	//Check that the document is complete
+	if ((error == EVDS_OK) && ((!stream.has_root) || (stream.level_count > 0) || (stream.capture_depth > 0))) {
+		error = EVDS_InternalStream_SyntaxError(info,"Unexpected end of file");
+	}
+
+	//Clean up
+	if (stream.file) fclose(stream.file);
+	if (stream.buffer) free(stream.buffer);
+	if (stream.levels) free(stream.levels);
+	if (stream.tag) free(stream.tag);
+	return error;
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief Load object from XML file and return the first object in file.
 ///
@@ -603,6 +1168,13 @@ EVDS_OBJECT_LOADEX EVDS_Internal_LoadEx = {
 ///
 /// @c OnSyntaxError callback is called if the description contains XML syntax errors.
 ///
+/// If @c EVDS_OBJECT_LOADEX_STREAMING flag is set, the input is read in chunks instead of
+/// being parsed into a complete document first. Objects are created while the file is being
+/// read and @c OnLoadObject is called as soon as each object is closed, so the memory used
+/// by the loader depends only on nesting depth and on size of the largest parameter.
+/// Elements are loaded in the order they appear in the input, so databases used by
+/// objects during @c OnLoadObject must precede them.
+///
 /// This function is used to load multiple objects, for example:
 /// ~~~{.c}
 ///		int EVDS_Internal_OnLoadObject(EVDS_SYSTEM* system, EVDS_OBJECT_LOADEX* info, EVDS_OBJECT* object) {
@@ -635,6 +1207,7 @@ int EVDS_Object_LoadEx(EVDS_OBJECT* parent, const char* filename, EVDS_OBJECT_LO
 	if (!parent) return EVDS_ERROR_BAD_PARAMETER;
 	if (!info) info = &EVDS_Internal_LoadEx;
 	if ((!info->description) && (!filename)) return EVDS_ERROR_BAD_PARAMETER;
+	if (info->flags & EVDS_OBJECT_LOADEX_STREAMING) return EVDS_Internal_LoadStream(parent,filename,info);
 
 	if (info->description) {
 		EVDS_ERRCHECK(SIMC_XML_OpenString(info->description,&doc,info->OnSyntaxError,info));
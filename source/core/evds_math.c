@@ -69,7 +69,7 @@ void EVDS_Vector_ShortConvert(EVDS_VECTOR* target, EVDS_VECTOR* vector, EVDS_OBJ
 
 	//Get correct state vectors (differentiate between public and private state vector)
 #ifndef EVDS_SINGLETHREADED
-	if (SIMC_Thread_GetUniqueID() == child_coordinates->integrate_thread) {
+	if (EVDS_InternalThread_GetIntegrateID() == child_coordinates->integrate_thread) {
 		child_state = &child_coordinates->private_state;
 	} else if (SIMC_Thread_GetUniqueID() == child_coordinates->render_thread) {
 		child_state = &child_coordinates->render_state;
@@ -401,7 +401,7 @@ void EVDS_Quaternion_ShortConvert(EVDS_QUATERNION* target, EVDS_QUATERNION* q, E
 
 	//Get correct state vectors (differentiate between public and private state vector)
 #ifndef EVDS_SINGLETHREADED
-	if (SIMC_Thread_GetUniqueID() == child_coordinates->integrate_thread) {
+	if (EVDS_InternalThread_GetIntegrateID() == child_coordinates->integrate_thread) {
 		child_state = &child_coordinates->private_state;
 	} else if (SIMC_Thread_GetUniqueID() == child_coordinates->render_thread) {
 		child_state = &child_coordinates->render_state;
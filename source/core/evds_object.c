@@ -188,7 +188,7 @@ int EVDS_Object_Integrate(EVDS_OBJECT* object, EVDS_REAL delta_time, EVDS_STATE_
 #endif
 	}
 #ifndef EVDS_SINGLETHREADED
-	object->integrate_thread = SIMC_Thread_GetUniqueID();
+	object->integrate_thread = EVDS_InternalThread_GetIntegrateID();
 #endif
 
 	//Initialize derivative
@@ -508,6 +508,7 @@ void EVDS_InternalThread_Initialize_Object(EVDS_OBJECT* object) {
 		object->type_entry = SIMC_List_Append(objects_list,object);
 		object->type_list = objects_list;
 	}
+	EVDS_InternalEnvironment_InvalidateGravity(object);
 
 	//Unlock objects type (no longer relevant)
 	SIMC_SRW_LeaveRead(object->type_lock);
@@ -515,6 +516,8 @@ void EVDS_InternalThread_Initialize_Object(EVDS_OBJECT* object) {
 	//Add to list of parent's children
 	if (object->parent) {		
 		object->parent_entry = SIMC_List_Append(object->parent->children,object);
+		object->parent->children_revision++;
+		EVDS_InternalObject_InvalidateMass(object->parent);
 	}
 
 	//Post-initialization callback
@@ -527,6 +530,24 @@ void EVDS_InternalThread_Initialize_Object(EVDS_OBJECT* object) {
 }
 
 
+#ifndef EVDS_SINGLETHREADED
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Thread for non-blocking initialization of a single object.
+///
+/// Used when system has no worker threads (see EVDS_System_WaitForInitialization()).
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalThread_Initialize_Pending(EVDS_OBJECT* object) {
+	EVDS_SYSTEM* system = object->system;
+	EVDS_InternalThread_Initialize_Object(object);
+
+	SIMC_Lock_Enter(system->workers_lock);
+	system->init_pending--;
+	SIMC_Lock_Leave(system->workers_lock);
+	EVDS_InternalSystem_Signal(system);
+}
+#endif
+
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief Initialize the object.
 ///
@@ -534,6 +555,14 @@ void EVDS_InternalThread_Initialize_Object(EVDS_OBJECT* object) {
 /// The call can be blocking (in current thread), or a new thread may be created for the object
 /// to finish initialization in.
 ///
+/// If the system has worker threads (see EVDS_System_SetWorkerThreads()), the object and all of its
+/// children are initialized by the worker threads instead, each object as a separate item, and no
+/// new threads are created. Objects are initialized only after all of their children, and children of
+/// one object are initialized in the order they are listed (as in serial initialization), while
+/// independent objects and subtrees are initialized in parallel. A blocking call returns once the object is
+/// initialized, and the calling thread initializes objects along with the worker threads meanwhile.
+/// Use EVDS_System_WaitForInitialization() to wait until all non-blocking initializations complete.
+///
 /// @note The objects ownership will be transferred to the initializing thread if non-blocking
 ///       initialization is used. This will prevent the main thread from accessing object data
 ///       until it finishes initializing. For example, EVDS_Object_GetName() will fail from the main
@@ -594,17 +623,27 @@ void EVDS_InternalThread_Initialize_Object(EVDS_OBJECT* object) {
 /// @retval EVDS_OK Successfully completed (does not report state of initialization)
 /// @retval EVDS_ERROR_BAD_PARAMETER "object" is null
 /// @retval EVDS_ERROR_BAD_STATE Object is already initialized
+/// @retval EVDS_ERROR_BAD_STATE Object is already being initialized by worker threads
+/// @retval EVDS_ERROR_MEMORY Could not allocate memory for the initialization queue
 ////////////////////////////////////////////////////////////////////////////////
 int EVDS_Object_Initialize(EVDS_OBJECT* object, int is_blocking) {
 	if (!object) return EVDS_ERROR_BAD_PARAMETER;
 	if (object->initialized) return EVDS_ERROR_BAD_STATE;
 
 #ifndef EVDS_SINGLETHREADED
+	if (object->system->workers_count > 0) {
+		return EVDS_InternalSystem_InitializeObject(object->system,object,is_blocking);
+	}
+
 	if (is_blocking) {
 		EVDS_InternalThread_Initialize_Object(object);
 	} else {
+		SIMC_Lock_Enter(object->system->workers_lock);
+		object->system->init_pending++;
+		SIMC_Lock_Leave(object->system->workers_lock);
+
 		object->create_thread = SIMC_THREAD_BAD_ID;
-		SIMC_Thread_Create(EVDS_InternalThread_Initialize_Object,object);
+		SIMC_Thread_Create(EVDS_InternalThread_Initialize_Pending,object);
 	}
 #else
 	EVDS_InternalThread_Initialize_Object(object);
@@ -677,6 +716,11 @@ int EVDS_Object_Destroy(EVDS_OBJECT* object) {
 	if (object->parent && object->rparent_entry) SIMC_List_Remove(object->parent->raw_children,object->rparent_entry);
 	if (object->type_entry) SIMC_List_Remove(object->type_list,object->type_entry);
 #endif
+	if (object->parent && object->parent_entry) {
+		object->parent->children_revision++;
+		EVDS_InternalObject_InvalidateMass(object->parent);
+	}
+	if (object->type_entry) EVDS_InternalEnvironment_InvalidateGravity(object);
 
 	//Request all children destroyed first (stop iteration so the raw children list will not be locked)
 	entry = SIMC_List_GetFirst(object->raw_children);
@@ -861,6 +905,7 @@ int EVDS_Object_Create(EVDS_OBJECT* parent, EVDS_OBJECT** p_object) {
 	object->system = system;
 	object->parent = parent;
 	object->initialized = 0;
+	object->mass_dirty = 1;
 #ifndef EVDS_SINGLETHREADED
 	object->initialize_thread = SIMC_THREAD_BAD_ID;
 	object->integrate_thread = SIMC_THREAD_BAD_ID;
@@ -1362,6 +1407,7 @@ int EVDS_Object_SetCallback_OnIntegrate(EVDS_OBJECT* object, EVDS_Callback_Integ
 #endif
 
 	object->integrate = p_callback;
+	if (object->parent) object->parent->children_revision++; //Parent may cache which children produce forces
 	return EVDS_OK;
 }
 
@@ -2153,6 +2199,48 @@ int EVDS_Object_GetParentObjectByType(EVDS_OBJECT* object, const char* type, EVD
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Mark mass properties of the object and all its parents as changed.
+///
+/// Solvers which aggregate mass properties of children (see EVDS_Solver_RigidBody)
+/// will only recompute them for objects which were marked as changed.
+///
+/// Parents of a changed object are always marked as changed as well (flags are only cleared
+/// for entire subtrees, see EVDS_InternalObject_ValidateMass()), so the walk stops at the
+/// first object which is already marked.
+///
+/// The flag is a plain integer, which is only ever set here and cleared by the solver before
+/// it reads mass properties. A change made while the solver runs is either included in the
+/// aggregated totals, or leaves the object marked for the next solver call.
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalObject_InvalidateMass(EVDS_OBJECT* object) {
+	while (object && (!object->mass_dirty)) {
+		object->mass_dirty = 1;
+		object = object->parent;
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Mark mass properties of the object and all its children as up to date.
+///
+/// Called by the solver which aggregates mass properties of the object before it reads
+/// them. Children which are not aggregating solvers themselves (for example static bodies)
+/// would otherwise remain marked as changed forever. Only marked children are visited.
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalObject_ValidateMass(EVDS_OBJECT* object) {
+	SIMC_LIST_ENTRY* entry;
+
+	object->mass_dirty = 0;
+	entry = SIMC_List_GetFirst(object->children);
+	while (entry) {
+		EVDS_OBJECT* child = (EVDS_OBJECT*)SIMC_List_GetData(object->children,entry);
+		if (child->mass_dirty) EVDS_InternalObject_ValidateMass(child);
+		entry = SIMC_List_GetNext(object->children,entry);
+	}
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief Fixes values of "parent_level" in all objects after parent has changed
 ////////////////////////////////////////////////////////////////////////////////
@@ -2206,6 +2294,8 @@ int EVDS_Object_SetParent(EVDS_OBJECT* object, EVDS_OBJECT* new_parent) {
 	if (object->parent && object->parent_entry) {
 		SIMC_List_GetFirst(object->parent->children);
 		SIMC_List_Remove(object->parent->children,object->parent_entry);
+		object->parent->children_revision++;
+		EVDS_InternalObject_InvalidateMass(object->parent);
 	}
 	if (object->parent && object->rparent_entry) {
 		SIMC_List_GetFirst(object->parent->raw_children);
@@ -2228,6 +2318,10 @@ int EVDS_Object_SetParent(EVDS_OBJECT* object, EVDS_OBJECT* new_parent) {
 		EVDS_Vector_Convert(&object->state.angular_velocity,		&vector.angular_velocity,new_parent);
 		EVDS_Vector_Convert(&object->state.angular_acceleration,	&vector.angular_acceleration,new_parent);
 	SIMC_SRW_LeaveRead(object->state_lock);
+	object->pose_revision++;
+
+	//Gravity sources in the subtree are now located in different coordinates
+	EVDS_InternalEnvironment_InvalidateGravitySubtree(object);
 
 	//Make sure the object has a unique name
 	EVDS_Object_SetUniqueName(object,0);
@@ -2236,6 +2330,8 @@ int EVDS_Object_SetParent(EVDS_OBJECT* object, EVDS_OBJECT* new_parent) {
 	object->rparent_entry = SIMC_List_Append(new_parent->raw_children,object);
 	if (object->parent_entry) { //Object was listed amongst initialized children in old parent
 		object->parent_entry = SIMC_List_Append(new_parent->children,object);
+		new_parent->children_revision++;
+		EVDS_InternalObject_InvalidateMass(new_parent);
 	}
 	return EVDS_OK;
 }
@@ -2307,7 +2403,7 @@ int EVDS_Object_GetStateVector(EVDS_OBJECT* object, EVDS_STATE_VECTOR* vector) {
 
 	// If object is being integrated, return private state vector instead
 #ifndef EVDS_SINGLETHREADED
-	if (SIMC_Thread_GetUniqueID() == object->integrate_thread) {
+	if (EVDS_InternalThread_GetIntegrateID() == object->integrate_thread) {
 		return EVDS_InternalObject_GetPrivateStateVector(object, vector);
 	}
 #endif
@@ -2358,6 +2454,7 @@ int EVDS_Object_GetStateVector(EVDS_OBJECT* object, EVDS_STATE_VECTOR* vector) {
 ////////////////////////////////////////////////////////////////////////////////
 int EVDS_Object_SetStateVector(EVDS_OBJECT* object, EVDS_STATE_VECTOR* vector) {
 	EVDS_STATE_VECTOR new_vector;
+	int pose_changed;
 	if (!object) return EVDS_ERROR_BAD_PARAMETER;
 	if (!vector) return EVDS_ERROR_BAD_PARAMETER;
 #ifndef EVDS_SINGLETHREADED
@@ -2366,7 +2463,7 @@ int EVDS_Object_SetStateVector(EVDS_OBJECT* object, EVDS_STATE_VECTOR* vector) {
 
 	// If object is being integrated, any changes to its state vector must reflect in private state vector instead
 #ifndef EVDS_SINGLETHREADED
-	if (SIMC_Thread_GetUniqueID() == object->integrate_thread) {
+	if (EVDS_InternalThread_GetIntegrateID() == object->integrate_thread) {
 		return EVDS_InternalObject_SetPrivateStateVector(object, vector);
 	}
 #endif
@@ -2389,6 +2486,11 @@ int EVDS_Object_SetStateVector(EVDS_OBJECT* object, EVDS_STATE_VECTOR* vector) {
 
 	//Copy new state vector and reset vector positions/velocities
 	SIMC_SRW_EnterWrite(object->state_lock);
+		//Position and orientation of the object within parent affect parents mass properties
+		pose_changed = (object->state.position.x != new_vector.position.x) ||
+					   (object->state.position.y != new_vector.position.y) ||
+					   (object->state.position.z != new_vector.position.z) ||
+					   (memcmp(object->state.orientation.q,new_vector.orientation.q,sizeof(EVDS_REAL)*4) != 0);
 		memcpy(&object->state,&new_vector,sizeof(EVDS_STATE_VECTOR));
 
 		//Objects state vector is always specified in parent coordinates, all vectors
@@ -2409,6 +2511,12 @@ int EVDS_Object_SetStateVector(EVDS_OBJECT* object, EVDS_STATE_VECTOR* vector) {
 #ifndef EVDS_SINGLETHREADED
 	memcpy(&object->private_state,&new_vector,sizeof(EVDS_STATE_VECTOR)); //FIXME: this must be locked!!
 #endif
+
+	//Parent must recompute its mass properties
+	if (pose_changed) {
+		object->pose_revision++;
+		EVDS_InternalObject_InvalidateMass(object->parent);
+	}
 	return EVDS_OK;
 }
 
@@ -2621,6 +2729,10 @@ int EVDS_InternalObject_SetPosition(EVDS_OBJECT* object, int use_cm, EVDS_OBJECT
 		object->state.position.pcoordinate_system = 0;
 		object->state.position.vcoordinate_system = 0;
 	SIMC_SRW_LeaveWrite(object->state_lock);
+	object->pose_revision++;
+
+	//Parent must recompute its mass properties
+	EVDS_InternalObject_InvalidateMass(object->parent);
 	return EVDS_OK;
 }
 
@@ -2683,6 +2795,10 @@ int EVDS_InternalObject_SetOrientationQuaternion(EVDS_OBJECT* object, int use_cm
 	SIMC_SRW_EnterWrite(object->state_lock);
 		EVDS_Quaternion_Convert(&object->state.orientation,q,object->parent);
 	SIMC_SRW_LeaveWrite(object->state_lock);
+	object->pose_revision++;
+
+	//Parent must recompute its mass properties
+	EVDS_InternalObject_InvalidateMass(object->parent);
 	return EVDS_OK;
 }
 
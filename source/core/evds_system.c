@@ -102,6 +102,8 @@ int EVDS_System_CleanupObjects(EVDS_SYSTEM* system) {
 ///
 /// EVDS threading subsystem will be initialized with the first EVDS_System_Create call. At
 /// least one system object must be created to make use of the SIMC threading functions.
+/// Lookup tables for units of measurement and old parameter names are also built by
+/// the first call, so it must complete before other threads start using EVDS.
 ///
 /// The built-in databases (materials, airfoils) will be automatically loaded when
 /// system is created.
@@ -137,12 +139,23 @@ int EVDS_System_Create(EVDS_SYSTEM** p_system) {
 	SIMC_Thread_Initialize();
 	SIMC_List_Create(&system->deleted_objects,1);
 	system->cleanup_working = SIMC_Lock_Create();
+	system->workers_lock = SIMC_Lock_Create();
+	system->gravity_lock = SIMC_SRW_Create();
 #endif
 
 	//Set system to realtime by default
 	system->time = EVDS_REALTIME;
 	//Start counting objects from an arbitrary value
 	system->uid_counter = 100000;
+	//Approximate gravity of large number of planets by default
+	system->gravity_opening_angle = 0.5;
+	system->gravity_tree_threshold = 256;
+	//No sphere of influence hierarchy until gravity sources are compiled
+	system->gravity_soi_root = -1;
+
+	//Lookup tables used when parsing files
+	EVDS_Internal_InitializeUnitsTable();
+	EVDS_Internal_InitializeRemappingTable();
 
 	//Data structures
 	SIMC_List_Create(&system->object_types,1);
@@ -228,6 +241,9 @@ int EVDS_System_Destroy(EVDS_SYSTEM* system) {
 	SIMC_LIST_ENTRY* entry;
 	if (!system) return EVDS_ERROR_BAD_PARAMETER;
 
+	//Stop worker threads
+	EVDS_System_SetWorkerThreads(system,0);
+
 	//Remove objects pending for deleting
 	EVDS_System_CleanupObjects(system);
 
@@ -261,9 +277,15 @@ int EVDS_System_Destroy(EVDS_SYSTEM* system) {
 #ifndef EVDS_SINGLETHREADED
 	SIMC_Lock_Leave(system->cleanup_working);
 	SIMC_Lock_Destroy(system->cleanup_working);
+	SIMC_Lock_Destroy(system->workers_lock);
+	if (system->init_ready) free(system->init_ready);
+	SIMC_SRW_Destroy(system->gravity_lock);
 	SIMC_List_Destroy(system->deleted_objects);
 #endif
 
+	//Clean up table of gravity sources
+	EVDS_InternalEnvironment_DestroyGravitySources(system);
+
 	//Clean up lookup tables
 	entry = system->object_types->first;
 	while (entry) {
@@ -1015,4 +1037,552 @@ int EVDS_System_SetGlobalCallbacks(EVDS_SYSTEM* system, EVDS_GLOBAL_CALLBACKS* p
 
 	memcpy(&system->callbacks,p_callbacks,sizeof(EVDS_GLOBAL_CALLBACKS));
 	return EVDS_OK;
-}
\ No newline at end of file
+}
+
+#ifndef EVDS_SINGLETHREADED
+/// Longest time (in seconds) a thread sleeps between checks of the worker signal
+#define EVDS_INTERNAL_SIGNAL_MAX_SLEEP	0.001
+
+//Thread on whose behalf this thread processes an item of a parallel job
+EVDS_THREAD_LOCAL SIMC_THREAD_ID EVDS_Internal_JobThread;
+EVDS_THREAD_LOCAL int EVDS_Internal_IsJobThread = 0;
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Get current generation of the worker signal.
+///
+/// Must be read before checking for work, and then passed to EVDS_InternalSystem_Wait().
+/// This way a signal raised after the check is never lost.
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalSystem_GetSignalGeneration(EVDS_SYSTEM* system) {
+	int generation;
+	SIMC_Lock_Enter(system->workers_lock);
+	generation = system->workers_generation;
+	SIMC_Lock_Leave(system->workers_lock);
+	return generation;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Wake up threads waiting for work or for completion of work.
+///
+/// Raised when new items of a parallel job or new objects for initialization become
+/// available, and when a job, an initialization or a worker thread finishes. Must not
+/// be called with workers lock entered.
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalSystem_Signal(EVDS_SYSTEM* system) {
+	SIMC_Lock_Enter(system->workers_lock);
+	system->workers_generation++;
+	SIMC_Lock_Leave(system->workers_lock);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Wait until signal is raised after the given generation.
+///
+/// The waiting thread yields first and then sleeps between checks of the signal, doubling
+/// the sleep time up to EVDS_INTERNAL_SIGNAL_MAX_SLEEP. Threads waiting for a short time
+/// (between items of consecutive parallel jobs) wake up quickly, while idle worker threads
+/// do not keep the processor busy.
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalSystem_Wait(EVDS_SYSTEM* system, int generation) {
+	double delay = 0.0;
+	while (EVDS_InternalSystem_GetSignalGeneration(system) == generation) {
+		SIMC_Thread_Sleep(delay);
+		delay = (delay == 0.0) ? 1e-6 : 2.0*delay;
+		if (delay > EVDS_INTERNAL_SIGNAL_MAX_SLEEP) delay = EVDS_INTERNAL_SIGNAL_MAX_SLEEP;
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Get thread on whose behalf the current thread integrates objects.
+///
+/// Worker threads processing items of a parallel job act on behalf of the thread which
+/// started the job. This way objects integrated by that thread are seen in their private
+/// (intermediate) state by the worker threads too, just like they would be if the items
+/// were processed sequentially (see EVDS_Object_Integrate()).
+////////////////////////////////////////////////////////////////////////////////
+SIMC_THREAD_ID EVDS_InternalThread_GetIntegrateID() {
+	if (EVDS_Internal_IsJobThread) return EVDS_Internal_JobThread;
+	return SIMC_Thread_GetUniqueID();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Take next item of the current parallel job and process it.
+///
+/// @returns 1 if an item was processed, 0 if there are no items left
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalSystem_ProcessJobItem(EVDS_SYSTEM* system) {
+	int index = -1;
+	int error_code, completed;
+	int was_job_thread;
+	void* userdata = 0;
+	EVDS_Callback_Job* job = 0;
+	SIMC_THREAD_ID job_thread, previous_job_thread;
+
+	//Fetch next item
+	SIMC_Lock_Enter(system->workers_lock);
+	if (system->job && (system->job_next < system->job_count)) {
+		index = system->job_next++;
+		job = system->job;
+		userdata = system->job_userdata;
+		job_thread = system->job_thread;
+	}
+	SIMC_Lock_Leave(system->workers_lock);
+	if (index < 0) return 0;
+
+	//Process it on behalf of the thread which started the job
+	was_job_thread = EVDS_Internal_IsJobThread;
+	previous_job_thread = EVDS_Internal_JobThread;
+	EVDS_Internal_JobThread = job_thread;
+	EVDS_Internal_IsJobThread = 1;
+	error_code = job(system,userdata,index);
+	EVDS_Internal_JobThread = previous_job_thread;
+	EVDS_Internal_IsJobThread = was_job_thread;
+
+	//Mark item as completed
+	SIMC_Lock_Enter(system->workers_lock);
+	if ((error_code != EVDS_OK) && (system->job_error == EVDS_OK)) system->job_error = error_code;
+	system->job_completed++;
+	completed = (system->job_completed == system->job_count);
+	SIMC_Lock_Leave(system->workers_lock);
+
+	//Wake up the thread which started the job
+	if (completed) EVDS_InternalSystem_Signal(system);
+	return 1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Add object to the end of the queue of objects ready to be initialized.
+///
+/// Must be called with workers lock entered.
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalSystem_PushReady(EVDS_SYSTEM* system, EVDS_OBJECT* object) {
+	int index = (system->init_ready_first + system->init_ready_count) % system->init_ready_capacity;
+	system->init_ready[index] = object;
+	system->init_ready_count++;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Take next object from the initialization pool and initialize it.
+///
+/// All children and the previous sibling of the object are already initialized at this
+/// point. Once the object is initialized, its next sibling and its parent may become ready.
+/// Objects are taken in the order they became ready.
+///
+/// @returns 1 if an object was initialized, 0 if no objects are ready
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalSystem_ProcessInitialization(EVDS_SYSTEM* system) {
+	EVDS_OBJECT* object = 0;
+	EVDS_OBJECT* parent;
+	EVDS_OBJECT* next;
+
+	//Fetch next object
+	SIMC_Lock_Enter(system->workers_lock);
+	if (system->init_ready_count > 0) {
+		object = system->init_ready[system->init_ready_first];
+		system->init_ready_first = (system->init_ready_first + 1) % system->init_ready_capacity;
+		system->init_ready_count--;
+	}
+	SIMC_Lock_Leave(system->workers_lock);
+	if (!object) return 0;
+
+	//Initialize it and mark next sibling and parent as ready if they no longer wait for it
+	EVDS_InternalThread_Initialize_Object(object);
+	SIMC_Lock_Enter(system->workers_lock);
+	parent = object->init_parent;
+	next = object->init_next;
+	object->init_parent = 0;
+	object->init_next = 0;
+	object->init_scheduled = 0;
+	system->init_pending--;
+	if (next) {
+		next->init_waiting--;
+		if (next->init_waiting == 0) EVDS_InternalSystem_PushReady(system,next);
+	}
+	if (parent) {
+		parent->init_waiting--;
+		if (parent->init_waiting == 0) EVDS_InternalSystem_PushReady(system,parent);
+	}
+	SIMC_Lock_Leave(system->workers_lock);
+
+	//Wake up worker threads (parent may have become ready) and threads waiting for initialization
+	EVDS_InternalSystem_Signal(system);
+	return 1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Count objects in the subtree that must be added to the initialization pool
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalSystem_CountUnscheduled(EVDS_OBJECT* object) {
+	SIMC_LIST_ENTRY* entry;
+	int count = 1;
+
+	entry = SIMC_List_GetFirst(object->raw_children);
+	while (entry) {
+		EVDS_OBJECT* child = (EVDS_OBJECT*)SIMC_List_GetData(object->raw_children,entry);
+		if ((!child->initialized) && (!child->init_scheduled)) {
+			count += EVDS_InternalSystem_CountUnscheduled(child);
+		}
+		entry = SIMC_List_GetNext(object->raw_children,entry);
+	}
+	return count;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Add object and its uninitialized children to the initialization pool.
+///
+/// Must be called with workers lock entered. Children of one object are initialized in
+/// the order they are listed, like in serial initialization: every scheduled child also
+/// waits for the previous scheduled sibling (solvers may look up siblings which were
+/// initialized before, for example engines look up their fuel tanks). Subtrees of the
+/// children are still initialized in parallel.
+///
+/// @param[in] previous Previous sibling the object must wait for (can be null)
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalSystem_ScheduleObject(EVDS_SYSTEM* system, EVDS_OBJECT* object, EVDS_OBJECT* previous) {
+	SIMC_LIST_ENTRY* entry;
+	EVDS_OBJECT* previous_child = 0;
+
+	object->init_scheduled = 1;
+	object->init_waiting = 0;
+	object->init_parent = 0;
+	object->init_next = 0;
+	system->init_pending++;
+
+	//Object waits for the previous sibling
+	if (previous) {
+		previous->init_next = object;
+		object->init_waiting++;
+	}
+
+	//Object waits for all of its uninitialized children
+	entry = SIMC_List_GetFirst(object->raw_children);
+	while (entry) {
+		EVDS_OBJECT* child = (EVDS_OBJECT*)SIMC_List_GetData(object->raw_children,entry);
+		if (!child->initialized) {
+			if (!child->init_scheduled) {
+				EVDS_InternalSystem_ScheduleObject(system,child,previous_child);
+				previous_child = child;
+			}
+			if (!child->init_parent) {
+				child->init_parent = object;
+				object->init_waiting++;
+			}
+		}
+		entry = SIMC_List_GetNext(object->raw_children,entry);
+	}
+
+	//Objects without uninitialized children are ready right away
+	if (object->init_waiting == 0) EVDS_InternalSystem_PushReady(system,object);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Initialize object and its children using worker threads of the system.
+///
+/// Every object in the subtree is initialized as a separate item by the worker threads,
+/// and objects are only initialized after all their children are. Blocking call will
+/// initialize objects in the calling thread as well until the object is initialized.
+///
+/// The object is renamed to a unique name by the calling thread before it is scheduled, so
+/// that objects initialized by separate calls never pick the same name. Children are
+/// renamed when they are initialized (siblings are never initialized at the same time).
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalSystem_InitializeObject(EVDS_SYSTEM* system, EVDS_OBJECT* object, int is_blocking) {
+	int i, count, scheduled, generation;
+
+	//Object must have a unique name before any of its siblings are scheduled
+	EVDS_Object_SetUniqueName(object,0);
+
+	//Object may have been initialized by a worker since the caller checked it
+	SIMC_Lock_Enter(system->workers_lock);
+	if (object->init_scheduled || object->initialized) {
+		SIMC_Lock_Leave(system->workers_lock);
+		return EVDS_ERROR_BAD_STATE;
+	}
+
+	//Make sure there is enough space for every object that may become ready
+	count = system->init_pending + EVDS_InternalSystem_CountUnscheduled(object);
+	if (count > system->init_ready_capacity) {
+		EVDS_OBJECT** ready = (EVDS_OBJECT**)malloc(count*sizeof(EVDS_OBJECT*));
+		if (!ready) {
+			SIMC_Lock_Leave(system->workers_lock);
+			return EVDS_ERROR_MEMORY;
+		}
+
+		//Move queued objects to the start of the new queue
+		for (i = 0; i < system->init_ready_count; i++) {
+			ready[i] = system->init_ready[(system->init_ready_first + i) % system->init_ready_capacity];
+		}
+		if (system->init_ready) free(system->init_ready);
+		system->init_ready = ready;
+		system->init_ready_first = 0;
+		system->init_ready_capacity = count;
+	}
+
+	//Add object to the pool
+	if (!is_blocking) object->create_thread = SIMC_THREAD_BAD_ID;
+	EVDS_InternalSystem_ScheduleObject(system,object,0);
+	SIMC_Lock_Leave(system->workers_lock);
+	EVDS_InternalSystem_Signal(system);
+
+	//Help worker threads until the object is initialized, block while other threads are busy
+	if (is_blocking) {
+		while (1) {
+			generation = EVDS_InternalSystem_GetSignalGeneration(system);
+			SIMC_Lock_Enter(system->workers_lock);
+			scheduled = object->init_scheduled;
+			SIMC_Lock_Leave(system->workers_lock);
+			if (!scheduled) break;
+
+			if (!EVDS_InternalSystem_ProcessInitialization(system)) {
+				EVDS_InternalSystem_Wait(system,generation);
+			}
+		}
+	}
+	return EVDS_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Worker thread which processes items of parallel jobs and initializes objects.
+///
+/// Idle worker sleeps until new items are added (see EVDS_InternalSystem_Signal()).
+/// Items of parallel jobs take priority over objects waiting for initialization.
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalThread_Worker(EVDS_SYSTEM* system) {
+	int generation;
+	while (1) {
+		generation = EVDS_InternalSystem_GetSignalGeneration(system);
+
+		//Check if thread must exit
+		SIMC_Lock_Enter(system->workers_lock);
+		if (system->workers_shutdown) {
+			system->workers_running--;
+			SIMC_Lock_Leave(system->workers_lock);
+			EVDS_InternalSystem_Signal(system);
+			return;
+		}
+		SIMC_Lock_Leave(system->workers_lock);
+
+		//Process items or wait for them
+		if ((!EVDS_InternalSystem_ProcessJobItem(system)) &&
+			(!EVDS_InternalSystem_ProcessInitialization(system))) {
+			EVDS_InternalSystem_Wait(system,generation);
+		}
+	}
+}
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Set number of worker threads used for parallel jobs.
+///
+/// Worker threads are used by EVDS_System_ParallelFor() (for example by the rigid body
+/// solver to compute forces of many children objects in parallel) and for initializing
+/// objects (see EVDS_Object_Initialize()). By default system has no worker threads, all
+/// parallel jobs are executed in the calling thread, and every non-blocking initialization
+/// creates a thread of its own.
+///
+/// Existing worker threads are stopped before new ones are started. Objects which are
+/// still being initialized are initialized before that (see EVDS_System_WaitForInitialization()).
+/// This call must not be made while a parallel job is running.
+///
+/// @evds_st No effect, returns EVDS_OK.
+///
+/// @param[in] system Pointer to system
+/// @param[in] count Number of worker threads (0 to disable worker threads)
+///
+/// @returns Error code
+/// @retval EVDS_OK Successfully completed
+/// @retval EVDS_ERROR_BAD_PARAMETER "system" is null
+/// @retval EVDS_ERROR_BAD_PARAMETER "count" is negative
+/// @retval EVDS_ERROR_BAD_STATE A parallel job is currently running
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_System_SetWorkerThreads(EVDS_SYSTEM* system, int count) {
+#ifndef EVDS_SINGLETHREADED
+	int i, running, generation;
+#endif
+	if (!system) return EVDS_ERROR_BAD_PARAMETER;
+	if (count < 0) return EVDS_ERROR_BAD_PARAMETER;
+#ifndef EVDS_SINGLETHREADED
+	if (system->job) return EVDS_ERROR_BAD_STATE;
+
+	//Finish initializing objects
+	EVDS_System_WaitForInitialization(system);
+
+	//Stop existing worker threads
+	SIMC_Lock_Enter(system->workers_lock);
+	system->workers_shutdown = 1;
+	SIMC_Lock_Leave(system->workers_lock);
+	EVDS_InternalSystem_Signal(system);
+	while (1) {
+		generation = EVDS_InternalSystem_GetSignalGeneration(system);
+		SIMC_Lock_Enter(system->workers_lock);
+		running = system->workers_running;
+		SIMC_Lock_Leave(system->workers_lock);
+		if (running == 0) break;
+		EVDS_InternalSystem_Wait(system,generation);
+	}
+
+	//Start new worker threads
+	system->workers_shutdown = 0;
+	system->workers_count = count;
+	system->workers_running = count;
+	for (i = 0; i < count; i++) {
+		SIMC_Thread_Create(EVDS_InternalThread_Worker,system);
+	}
+#endif
+	return EVDS_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Run a job for every index in range \f$[0, count)\f$ using worker threads.
+///
+/// The calling thread processes items along with the worker threads, and the call returns
+/// only after all items have been processed. Items may be processed in any order, so the
+/// job must store per-item results separately; reducing them in index order after this call
+/// keeps results deterministic regardless of the number of threads.
+///
+/// Items are processed on behalf of the calling thread: objects which it is integrating
+/// are seen by the job in their private (intermediate) state, same as if the items were
+/// processed by the calling thread itself.
+///
+/// If system has no worker threads (see EVDS_System_SetWorkerThreads()), or if another
+/// parallel job is already running (for example when called from inside a job), all items
+/// are processed sequentially in the calling thread.
+///
+/// Example of use:
+/// ~~~{.c}
+///		int Job(EVDS_SYSTEM* system, void* userdata, int index) {
+///			EVDS_REAL* results = (EVDS_REAL*)userdata;
+///			results[index] = index*index;
+///			return EVDS_OK;
+///		}
+///		...
+///		EVDS_System_ParallelFor(system,Job,results,100);
+/// ~~~
+///
+/// @param[in] system Pointer to system
+/// @param[in] job Callback called for every item
+/// @param[in] userdata Pointer passed to the callback
+/// @param[in] count Number of items
+///
+/// @returns Error code
+/// @retval EVDS_OK Successfully completed
+/// @retval EVDS_ERROR_BAD_PARAMETER "system" is null
+/// @retval EVDS_ERROR_BAD_PARAMETER "job" is null
+/// @retval ... First error code returned by the job callback
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_System_ParallelFor(EVDS_SYSTEM* system, EVDS_Callback_Job* job, void* userdata, int count) {
+	int i, error_code;
+#ifndef EVDS_SINGLETHREADED
+	int completed, generation;
+	int is_parallel = 0;
+#endif
+	if (!system) return EVDS_ERROR_BAD_PARAMETER;
+	if (!job) return EVDS_ERROR_BAD_PARAMETER;
+	if (count <= 0) return EVDS_OK;
+
+#ifndef EVDS_SINGLETHREADED
+	//Try to start a new parallel job
+	SIMC_Lock_Enter(system->workers_lock);
+	if ((system->workers_count > 0) && (!system->job) && (count > 1)) {
+		system->job = job;
+		system->job_thread = EVDS_InternalThread_GetIntegrateID();
+		system->job_userdata = userdata;
+		system->job_count = count;
+		system->job_next = 0;
+		system->job_completed = 0;
+		system->job_error = EVDS_OK;
+		is_parallel = 1;
+	}
+	SIMC_Lock_Leave(system->workers_lock);
+
+	if (is_parallel) {
+		//Process items in this thread as well
+		EVDS_InternalSystem_Signal(system);
+		while (EVDS_InternalSystem_ProcessJobItem(system)) ;
+
+		//Wait until worker threads finish remaining items
+		while (1) {
+			generation = EVDS_InternalSystem_GetSignalGeneration(system);
+			SIMC_Lock_Enter(system->workers_lock);
+			completed = (system->job_completed == system->job_count);
+			if (completed) {
+				system->job = 0;
+				error_code = system->job_error;
+			}
+			SIMC_Lock_Leave(system->workers_lock);
+			if (completed) break;
+			EVDS_InternalSystem_Wait(system,generation);
+		}
+		return error_code;
+	}
+#endif
+
+	//Process all items sequentially
+	for (i = 0; i < count; i++) {
+		error_code = job(system,userdata,i);
+		if (error_code != EVDS_OK) return error_code;
+	}
+	return EVDS_OK;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Wait until all objects with non-blocking initialization are initialized.
+///
+/// This is a completion barrier for non-blocking EVDS_Object_Initialize() calls. The
+/// calling thread initializes objects along with the worker threads while waiting.
+/// Objects which failed to initialize are destroyed as usual, so the application must
+/// check state of every object with EVDS_Object_IsInitialized() if needed.
+///
+/// Example of use:
+/// ~~~{.c}
+///		EVDS_System_SetWorkerThreads(system,8);
+///		EVDS_Object_LoadEx(root,"scenario.evds",&info); //Calls EVDS_Object_Initialize(object,0)
+///		EVDS_System_WaitForInitialization(system);
+/// ~~~
+///
+/// @note This function must not be called from solver or initialization callbacks.
+///
+/// @evds_st Returns right away, since all initialization is blocking.
+///
+/// @param[in] system Pointer to system
+///
+/// @returns Error code
+/// @retval EVDS_OK Successfully completed
+/// @retval EVDS_ERROR_BAD_PARAMETER "system" is null
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_System_WaitForInitialization(EVDS_SYSTEM* system) {
+#ifndef EVDS_SINGLETHREADED
+	int pending, generation;
+#endif
+	if (!system) return EVDS_ERROR_BAD_PARAMETER;
+
+#ifndef EVDS_SINGLETHREADED
+	while (1) {
+		generation = EVDS_InternalSystem_GetSignalGeneration(system);
+		SIMC_Lock_Enter(system->workers_lock);
+		pending = system->init_pending;
+		SIMC_Lock_Leave(system->workers_lock);
+		if (pending == 0) break;
+
+		//Objects may also be initialized by worker threads or in threads of their own
+		if (!EVDS_InternalSystem_ProcessInitialization(system)) {
+			EVDS_InternalSystem_Wait(system,generation);
+		}
+	}
+#endif
+	return EVDS_OK;
+}
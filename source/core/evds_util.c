@@ -153,9 +153,208 @@ const int EVDS_Internal_UnitsTableCount =
 	sizeof(EVDS_Internal_UnitsTable) / sizeof(EVDS_Internal_UnitsTable[0]);
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Trie of unit names (see EVDS_Internal_InitializeUnitsTable())
+////////////////////////////////////////////////////////////////////////////////
+#define EVDS_INTERNAL_UNITS_TRIE_SIZE	256
+struct {
+	char character;		/// Character leading to this node
+	short child;		/// First child node (0 if none)
+	short sibling;		/// Next node with the same parent (0 if none)
+	short unit;			/// Index of unit which ends at this node (-1 if none)
+} EVDS_Internal_UnitsTrie[EVDS_INTERNAL_UNITS_TRIE_SIZE];
+int EVDS_Internal_UnitsTrieSize = 0;
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Exactly representable powers of ten
+////////////////////////////////////////////////////////////////////////////////
+const double EVDS_Internal_PowersOf10[] = {
+	1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Build trie of unit names.
+///
+/// Called when a system is created, so that unit lookup does not depend on number of
+/// units in the table. The trie is built by the first system, which is created before
+/// other threads use EVDS (same as the threading subsystem, see EVDS_System_Create()).
+/// Later calls return right away.
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_Internal_InitializeUnitsTable() {
+	int i,node,next;
+	int size = 1;
+	const char* ptr;
+	if (EVDS_Internal_UnitsTrieSize) return;
+
+	//Root node
+	EVDS_Internal_UnitsTrie[0].character = 0;
+	EVDS_Internal_UnitsTrie[0].child = 0;
+	EVDS_Internal_UnitsTrie[0].sibling = 0;
+	EVDS_Internal_UnitsTrie[0].unit = -1;
+
+	//Add every unit name
+	for (i = 0; i < EVDS_Internal_UnitsTableCount; i++) {
+		node = 0;
+		for (ptr = EVDS_Internal_UnitsTable[i].name; *ptr; ptr++) {
+			next = EVDS_Internal_UnitsTrie[node].child;
+			while (next && (EVDS_Internal_UnitsTrie[next].character != *ptr)) {
+				next = EVDS_Internal_UnitsTrie[next].sibling;
+			}
+
+			//Add new node
+			if (!next) {
+				if (size == EVDS_INTERNAL_UNITS_TRIE_SIZE) break;
+				next = size++;
+				EVDS_Internal_UnitsTrie[next].character = *ptr;
+				EVDS_Internal_UnitsTrie[next].child = 0;
+				EVDS_Internal_UnitsTrie[next].sibling = EVDS_Internal_UnitsTrie[node].child;
+				EVDS_Internal_UnitsTrie[next].unit = -1;
+				EVDS_Internal_UnitsTrie[node].child = next;
+			}
+			node = next;
+		}
+		if ((!(*ptr)) && (EVDS_Internal_UnitsTrie[node].unit < 0)) EVDS_Internal_UnitsTrie[node].unit = i;
+	}
+	EVDS_Internal_UnitsTrieSize = size;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Find the longest unit name which the string starts with.
+///
+/// If no system was created yet, the units table is searched directly.
+///
+/// @returns Index of the unit in units table or -1 if string does not start with a unit
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_Internal_FindUnit(const char* str, int* p_length) {
+	const char* ptr = str;
+	int node = 0;
+	int unit = -1;
+
+	*p_length = 0;
+	if (!EVDS_Internal_UnitsTrieSize) {
+		int i,length;
+		for (i = 0; i < EVDS_Internal_UnitsTableCount; i++) {
+			length = (int)strlen(EVDS_Internal_UnitsTable[i].name);
+			if ((length > *p_length) && (strncmp(str,EVDS_Internal_UnitsTable[i].name,length) == 0)) {
+				unit = i;
+				*p_length = length;
+			}
+		}
+		return unit;
+	}
+
+	while (*ptr) {
+		int next = EVDS_Internal_UnitsTrie[node].child;
+		while (next && (EVDS_Internal_UnitsTrie[next].character != *ptr)) {
+			next = EVDS_Internal_UnitsTrie[next].sibling;
+		}
+		if (!next) break;
+
+		node = next;
+		ptr++;
+		if (EVDS_Internal_UnitsTrie[node].unit >= 0) {
+			unit = EVDS_Internal_UnitsTrie[node].unit;
+			*p_length = (int)(ptr - str);
+		}
+	}
+	return unit;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Parse a decimal number, same as strtod().
+///
+/// Numbers with up to 15 significant digits and small exponents are converted with a single
+/// exactly rounded multiplication or division. All other numbers (and special values such
+/// as infinities or hexadecimal numbers) are passed to strtod().
+////////////////////////////////////////////////////////////////////////////////
+double EVDS_Internal_ParseReal(const char* str, char** str_end) {
+	const char* ptr = str;
+	double mantissa = 0.0;
+	int digits = 0;
+	int exponent = 0;
+	int has_digits = 0;
+	int is_negative = 0;
+
+	//Skip whitespace and read sign
+	while ((*ptr == ' ') || ((*ptr >= '\t') && (*ptr <= '\r'))) ptr++;
+	if (*ptr == '-') {
+		is_negative = 1;
+		ptr++;
+	} else if (*ptr == '+') {
+		ptr++;
+	}
+
+	//Read integer and fractional parts (leading zeros are not significant)
+	while ((*ptr >= '0') && (*ptr <= '9')) {
+		if (digits || (*ptr != '0')) {
+			mantissa = mantissa*10.0 + (*ptr - '0');
+			digits++;
+		}
+		has_digits = 1;
+		ptr++;
+	}
+	if (*ptr == '.') {
+		ptr++;
+		while ((*ptr >= '0') && (*ptr <= '9')) {
+			if (digits || (*ptr != '0')) {
+				mantissa = mantissa*10.0 + (*ptr - '0');
+				digits++;
+			}
+			exponent--;
+			has_digits = 1;
+			ptr++;
+		}
+	}
+	if ((!has_digits) || (digits > 15) || (*ptr == 'x') || (*ptr == 'X')) return strtod(str,str_end);
+
+	//Read exponent
+	if ((*ptr == 'e') || (*ptr == 'E')) {
+		const char* exponent_ptr = ptr+1;
+		int exponent_value = 0;
+		int exponent_negative = 0;
+
+		if (*exponent_ptr == '-') {
+			exponent_negative = 1;
+			exponent_ptr++;
+		} else if (*exponent_ptr == '+') {
+			exponent_ptr++;
+		}
+		if ((*exponent_ptr >= '0') && (*exponent_ptr <= '9')) {
+			while ((*exponent_ptr >= '0') && (*exponent_ptr <= '9')) {
+				if (exponent_value < 10000) exponent_value = exponent_value*10 + (*exponent_ptr - '0');
+				exponent_ptr++;
+			}
+			exponent += exponent_negative ? -exponent_value : exponent_value;
+			ptr = exponent_ptr;
+		}
+	}
+
+	//Mantissa is exact, so result is exact only if the power of ten is exact too
+	if (mantissa == 0.0) {
+		exponent = 0;
+	} else if ((exponent < -22) || (exponent > 22)) {
+		return strtod(str,str_end);
+	}
+	if (str_end) *str_end = (char*)ptr;
+	if (exponent < 0) {
+		mantissa /= EVDS_Internal_PowersOf10[-exponent];
+	} else {
+		mantissa *= EVDS_Internal_PowersOf10[exponent];
+	}
+	return is_negative ? -mantissa : mantissa;
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief Convert a string to EVDS_REAL, accounting for units of measurement, returning EVDS_REAL in metric units.
 ///
+/// If several units match the text following the number, the longest unit name is used.
+///
 /// @param[in] str Pointer to input string
 /// @param[out] str_end Pointer to what follows after the real number in the input string (can be null)
 /// @param[out] p_value The read value will be written here
@@ -167,7 +366,7 @@ const int EVDS_Internal_UnitsTableCount =
 /// @retval EVDS_ERROR_SYNTAX Could not parse string in its entirety as an EVDS_REAL
 ////////////////////////////////////////////////////////////////////////////////
 int EVDS_StringToReal(const char* str, char** str_end, EVDS_REAL* p_value) {
-	int i;
+	int unit, length;
 	char* end;
 	EVDS_REAL value;
 	if (!str) return EVDS_ERROR_BAD_PARAMETER;
@@ -177,7 +376,7 @@ int EVDS_StringToReal(const char* str, char** str_end, EVDS_REAL* p_value) {
 	while (*str == ' ') str++;
 
 	//Get value itself
-	value = strtod(str,&end);
+	value = EVDS_Internal_ParseReal(str,&end);
 	if (str_end) *str_end = end;
 
 	//Check if EPS must be added or subtracted
@@ -186,13 +385,11 @@ int EVDS_StringToReal(const char* str, char** str_end, EVDS_REAL* p_value) {
 
 	//Check if units of measurements can be parsed
 	while (*end == ' ') end++;
-	for (i = 0; i < EVDS_Internal_UnitsTableCount; i++) {
-		if (strncmp(end,EVDS_Internal_UnitsTable[i].name,strlen(EVDS_Internal_UnitsTable[i].name)) == 0) {
-			value *= EVDS_Internal_UnitsTable[i].scale_factor;
-			value += EVDS_Internal_UnitsTable[i].offset_factor;
-			end += strlen(EVDS_Internal_UnitsTable[i].name);
-			break;
-		}
+	unit = EVDS_Internal_FindUnit(end,&length);
+	if (unit >= 0) {
+		value *= EVDS_Internal_UnitsTable[unit].scale_factor;
+		value += EVDS_Internal_UnitsTable[unit].offset_factor;
+		end += length;
 	}
 
 	//Return and check if entire input string was parsed
@@ -675,6 +675,37 @@ int EVDS_Variable_SetName(EVDS_VARIABLE* variable, const char* name) {
 
 	//Store it
 	strncpy(variable->name,clean_name,64);
+
+	//Check if variable affects mass properties of the object
+	variable->mass_bearing = EVDS_VARIABLE_MASS_NONE;
+	if ((strcmp(variable->name,"mass") == 0) ||
+		(strcmp(variable->name,"cm") == 0) ||
+		(strcmp(variable->name,"jx") == 0) ||
+		(strcmp(variable->name,"jy") == 0) ||
+		(strcmp(variable->name,"jz") == 0)) {
+		variable->mass_bearing = EVDS_VARIABLE_MASS_PARAMETER;
+	}
+	if ((strcmp(variable->name,"total_mass") == 0) ||
+		(strcmp(variable->name,"total_cm") == 0) ||
+		(strcmp(variable->name,"total_ix") == 0) ||
+		(strcmp(variable->name,"total_iy") == 0) ||
+		(strcmp(variable->name,"total_iz") == 0)) {
+		variable->mass_bearing = EVDS_VARIABLE_MASS_TOTAL;
+	}
+
+	//Check if variable affects gravitational, magnetic, radiation or atmospheric environment (if object is a planet)
+	variable->gravity_bearing = (strcmp(variable->name,"mass") == 0) ||
+								(strncmp(variable->name,"gravity.",8) == 0) ||
+								(strncmp(variable->name,"magnetic.",9) == 0) ||
+								(strncmp(variable->name,"radiation.",10) == 0) ||
+								(strncmp(variable->name,"atmosphere.",11) == 0) ||
+								(strncmp(variable->name,"geometry.",9) == 0) ||
+								(strcmp(variable->name,"gravitational_field") == 0) ||
+								(strcmp(variable->name,"gravity_gradient_torque") == 0) ||
+								(strcmp(variable->name,"magnetic_field") == 0) ||
+								(strcmp(variable->name,"radiation_data") == 0) ||
+								(strcmp(variable->name,"atmospheric_data") == 0) ||
+								(strcmp(variable->name,"acceleration") == 0);
 	return EVDS_OK;
 }
 
@@ -780,6 +811,22 @@ int EVDS_Variable_GetAttributes(EVDS_VARIABLE* variable, SIMC_LIST** p_list) {
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Invalidate mass properties after a mass-bearing variable was changed.
+///
+/// Changes to mass parameters of the object invalidate the object itself, changes
+/// to aggregated (total) mass properties only invalidate its parents.
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalVariable_InvalidateMass(EVDS_VARIABLE* variable) {
+	if (!variable->object) return;
+	if (variable->mass_bearing == EVDS_VARIABLE_MASS_PARAMETER) {
+		EVDS_InternalObject_InvalidateMass(variable->object);
+	} else if (variable->mass_bearing == EVDS_VARIABLE_MASS_TOTAL) {
+		EVDS_InternalObject_InvalidateMass(variable->object->parent);
+	}
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief Set a floating point (real) value.
 ///
@@ -799,6 +846,14 @@ int EVDS_Variable_SetReal(EVDS_VARIABLE* variable, EVDS_REAL value) {
 	if (variable->object && variable->object->destroyed) return EVDS_ERROR_INVALID_OBJECT;
 #endif
 
+	//Only invalidate mass properties or gravity sources if value has actually changed
+	if ((variable->mass_bearing || variable->gravity_bearing) && (*((double*)variable->value) != value)) {
+		*((double*)variable->value) = value;
+		if (variable->mass_bearing) EVDS_InternalVariable_InvalidateMass(variable);
+		if (variable->gravity_bearing) EVDS_InternalEnvironment_InvalidateGravity(variable->object);
+		return EVDS_OK;
+	}
+
 	*((double*)variable->value) = value;
 	return EVDS_OK;
 }
@@ -870,6 +925,9 @@ int EVDS_Variable_SetString(EVDS_VARIABLE* variable, char* value, size_t length)
 #ifndef EVDS_SINGLETHREADED
 	SIMC_Lock_Leave(variable->lock);
 #endif
+
+	//Gravity models may be defined by strings (tables of coefficients)
+	if (variable->gravity_bearing) EVDS_InternalEnvironment_InvalidateGravity(variable->object);
 	return EVDS_OK;
 }
 
@@ -1019,6 +1077,14 @@ int EVDS_Variable_SetVector(EVDS_VARIABLE* variable, EVDS_VECTOR* value) {
 	if (variable->object && variable->object->destroyed) return EVDS_ERROR_INVALID_OBJECT;
 #endif
 
+	//Only invalidate mass properties or gravity sources if value has actually changed
+	if ((variable->mass_bearing || variable->gravity_bearing) && (memcmp(variable->value,value,sizeof(EVDS_VECTOR)) != 0)) {
+		memcpy((EVDS_VECTOR*)variable->value,value,sizeof(EVDS_VECTOR));
+		if (variable->mass_bearing) EVDS_InternalVariable_InvalidateMass(variable);
+		if (variable->gravity_bearing) EVDS_InternalEnvironment_InvalidateGravity(variable->object);
+		return EVDS_OK;
+	}
+
 	memcpy((EVDS_VECTOR*)variable->value,value,sizeof(EVDS_VECTOR));
 	return EVDS_OK;
 }
@@ -1118,6 +1184,7 @@ int EVDS_Variable_SetFunctionPointer(EVDS_VARIABLE* variable, void* data) {
 	if (variable->object && variable->object->destroyed) return EVDS_ERROR_INVALID_OBJECT;
 #endif
 	variable->value = data;
+	if (variable->gravity_bearing) EVDS_InternalEnvironment_InvalidateGravity(variable->object);
 	return EVDS_OK;
 }
 
@@ -20,285 +20,2806 @@
 /// Further information about the GNU Lesser General Public License can also be found on
 /// the world wide web at http://www.gnu.org.
 ////////////////////////////////////////////////////////////////////////////////
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
 #include "evds.h"
 #include "math.h"
 
+//Highest supported degree of the spherical harmonics gravity model
+#define EVDS_ENVIRONMENT_MAX_HARMONICS_DEGREE	360
+//Number of cells along each side of a gravity grid block
+#define EVDS_ENVIRONMENT_GRID_BLOCK				8
+//Number of nodes along each side of a gravity grid block (includes margin for cubic interpolation)
+#define EVDS_ENVIRONMENT_GRID_BLOCK_NODES		(EVDS_ENVIRONMENT_GRID_BLOCK+3)
+//Largest number of sources in a leaf of the gravity octree
+#define EVDS_ENVIRONMENT_TREE_LEAF				4
+//Largest depth of the gravity octree
+#define EVDS_ENVIRONMENT_TREE_DEPTH				32
+//Number of values stored per node of radiation table (electron, proton, solar flux, dose rate)
+#define EVDS_ENVIRONMENT_RADIATION_CHANNELS		4
+//Boltzmann constant
+#define EVDS_ENVIRONMENT_BOLTZMANN				1.380649e-23
+//Avogadro constant
+#define EVDS_ENVIRONMENT_AVOGADRO				6.02214076e23
 
 
 
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Free spherical harmonics gravity model
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalEnvironment_DestroyHarmonics(EVDS_INTERNAL_GRAVITY_HARMONICS* harmonics) {
+	if (!harmonics) return;
+	if (harmonics->C) free(harmonics->C);
+	if (harmonics->a) free(harmonics->a);
+	free(harmonics);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Read next line from the table of spherical harmonics coefficients.
+///
+/// Lines are read in "n m C S" format. Additional columns (standard deviations) are ignored,
+/// Fortran-style exponents (@c 1.0D-03) are accepted. Lines starting with @c gfc or @c gfct
+/// keywords (ICGEM format) are accepted, all other lines which do not start with a number
+/// (file headers) are skipped.
+///
+/// @returns 1 if line contains a coefficient, 0 otherwise
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalEnvironment_ReadHarmonicsLine(const char** p_line, const char* table_end,
+											   int* n, int* m, EVDS_REAL* C, EVDS_REAL* S) {
+	char buffer[256];
+	char *ptr, *end;
+	const char* line_end = *p_line;
+	size_t length;
+
+	//Copy single line into buffer
+	while ((line_end < table_end) && (*line_end != '\n') && (*line_end != '\0')) line_end++;
+	length = line_end - (*p_line);
+	if (length > sizeof(buffer)-1) length = sizeof(buffer)-1;
+	memcpy(buffer,*p_line,length);
+	buffer[length] = '\0';
+	*p_line = line_end+1;
+
+	//Convert Fortran exponents
+	for (ptr = buffer; *ptr; ptr++) {
+		if ((*ptr == 'D') || (*ptr == 'd')) *ptr = 'E';
+	}
+
+	//Skip keyword
+	ptr = buffer;
+	while ((*ptr == ' ') || (*ptr == '\t')) ptr++;
+	if (strncmp(ptr,"gfc",3) == 0) {
+		while (*ptr && (*ptr != ' ') && (*ptr != '\t')) ptr++;
+	}
+
+	//Read "n m C S"
+	*n = strtol(ptr,&end,10);	if (end == ptr) return 0; ptr = end;
+	*m = strtol(ptr,&end,10);	if (end == ptr) return 0; ptr = end;
+	*C = strtod(ptr,&end);		if (end == ptr) return 0; ptr = end;
+	*S = strtod(ptr,&end);		if (end == ptr) *S = 0.0;
+	return (*n >= 0) && (*m >= 0) && (*m <= *n);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Load table of spherical harmonics coefficients and precompute recursion coefficients.
+///
+/// Coefficients must be fully normalized. Coefficients above the truncation degree are ignored.
+/// If degree is zero, the highest degree found in the table is used.
+////////////////////////////////////////////////////////////////////////////////
+EVDS_INTERNAL_GRAVITY_HARMONICS* EVDS_InternalEnvironment_LoadHarmonics(const char* table, size_t length,
+																		 int degree, EVDS_REAL radius) {
+	EVDS_INTERNAL_GRAVITY_HARMONICS* harmonics;
+	const char* table_end = table + length;
+	const char* line;
+	int n,m,count,count1;
+	EVDS_REAL C,S;
+
+	//Find highest degree in the table
+	if (degree <= 0) {
+		line = table;
+		while (line < table_end) {
+			if (EVDS_InternalEnvironment_ReadHarmonicsLine(&line,table_end,&n,&m,&C,&S) && (n > degree)) degree = n;
+		}
+	}
+	if ((degree <= 0) || (radius <= 0.0)) return 0;
+	if (degree > EVDS_ENVIRONMENT_MAX_HARMONICS_DEGREE) degree = EVDS_ENVIRONMENT_MAX_HARMONICS_DEGREE;
+	count = (degree+1)*(degree+2)/2;
+	count1 = (degree+2)*(degree+3)/2;
+
+	//Allocate model (coefficients and factors are stored in two blocks)
+	harmonics = (EVDS_INTERNAL_GRAVITY_HARMONICS*)malloc(sizeof(EVDS_INTERNAL_GRAVITY_HARMONICS));
+	if (!harmonics) return 0;
+	harmonics->degree = degree;
+	harmonics->radius = radius;
+	harmonics->C = (EVDS_REAL*)malloc(sizeof(EVDS_REAL)*count*5);
+	harmonics->a = (EVDS_REAL*)malloc(sizeof(EVDS_REAL)*(count1*2+degree+2));
+	if ((!harmonics->C) || (!harmonics->a)) {
+		EVDS_InternalEnvironment_DestroyHarmonics(harmonics);
+		return 0;
+	}
+	memset(harmonics->C,0,sizeof(EVDS_REAL)*count*5);
+	memset(harmonics->a,0,sizeof(EVDS_REAL)*(count1*2+degree+2));
+	harmonics->S  = harmonics->C + count;
+	harmonics->f1 = harmonics->C + count*2;
+	harmonics->f2 = harmonics->C + count*3;
+	harmonics->fz = harmonics->C + count*4;
+	harmonics->b  = harmonics->a + count1;
+	harmonics->c  = harmonics->a + count1*2;
+
+	//Read coefficients (central term is always present)
+	harmonics->C[0] = 1.0;
+	line = table;
+	while (line < table_end) {
+		if (EVDS_InternalEnvironment_ReadHarmonicsLine(&line,table_end,&n,&m,&C,&S) && (n <= degree)) {
+			harmonics->C[n*(n+1)/2+m] = C;
+			harmonics->S[n*(n+1)/2+m] = S;
+		}
+	}
+
+	//Recursion coefficients for V(n,m), W(n,m) up to degree+1
+	for (m = 1; m <= degree+1; m++) {
+		harmonics->c[m] = (m == 1) ? sqrt(3.0) : sqrt((2.0*m+1.0)/(2.0*m));
+	}
+	for (n = 1; n <= degree+1; n++) {
+		for (m = 0; m < n; m++) {
+			harmonics->a[n*(n+1)/2+m] = sqrt((2.0*n-1.0)*(2.0*n+1.0)/((n-m)*(n+m)));
+			if (n-m > 1) {
+				harmonics->b[n*(n+1)/2+m] = sqrt((2.0*n+1.0)*(n+m-1.0)*(n-m-1.0)/((n-m)*(n+m)*(2.0*n-3.0)));
+			}
+		}
+	}
+
+	//Gradient factors (normalization ratios between degree n and n+1 terms)
+	for (n = 0; n <= degree; n++) {
+		EVDS_REAL k = (2.0*n+1.0)/(2.0*n+3.0);
+		for (m = 0; m <= n; m++) {
+			int i = n*(n+1)/2+m;
+			if (m == 0) {
+				harmonics->f1[i] = 2.0*sqrt(0.5*k*(n+1.0)*(n+2.0));
+			} else {
+				harmonics->f1[i] = sqrt(k*(n+m+1.0)*(n+m+2.0));
+				harmonics->f2[i] = sqrt((m == 1 ? 2.0 : 1.0)*k*(n-m+1.0)*(n-m+2.0));
+			}
+			harmonics->fz[i] = sqrt(k*(n+m+1.0)*(n-m+1.0));
+		}
+	}
+	return harmonics;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Evaluate spherical harmonics gravity model.
+///
+/// Uses fully normalized Cunningham recursions for \f$V_{nm}\f$, \f$W_{nm}\f$. Recursion
+/// is evaluated column by column (by order), so only a single column is kept in memory.
+///
+/// @param[in] harmonics Gravity model
+/// @param[in] mu Gravitational parameter
+/// @param[in] r Position in planet body-fixed coordinates
+/// @param[out] phi Gravitational potential
+/// @param[out] g Gravitational acceleration in planet body-fixed coordinates
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalEnvironment_EvaluateHarmonics(EVDS_INTERNAL_GRAVITY_HARMONICS* harmonics, EVDS_REAL mu,
+												EVDS_VECTOR* r, EVDS_REAL* phi, EVDS_VECTOR* g) {
+	EVDS_REAL V[EVDS_ENVIRONMENT_MAX_HARMONICS_DEGREE+3];
+	EVDS_REAL W[EVDS_ENVIRONMENT_MAX_HARMONICS_DEGREE+3];
+	EVDS_REAL Vmm,Wmm; //Sectoral terms
+	EVDS_REAL r2,rho,xr,yr,zr,R2r2;
+	EVDS_REAL U,ax,ay,az;
+	int N = harmonics->degree;
+	int n,m;
+
+	//Initial values
+	r2 = r->x*r->x + r->y*r->y + r->z*r->z;
+	rho = harmonics->radius/r2;
+	xr = r->x*rho;
+	yr = r->y*rho;
+	zr = r->z*rho;
+	R2r2 = harmonics->radius*rho;
+	Vmm = harmonics->radius/sqrt(r2);
+	Wmm = 0.0;
+	U = ax = ay = az = 0.0;
+
+	//Compute recursions column by column, accumulate all terms which use current column
+	for (m = 0; m <= N+1; m++) {
+		//Sectoral term
+		if (m > 0) {
+			EVDS_REAL Vprev = Vmm;
+			Vmm = harmonics->c[m]*(xr*Vprev - yr*Wmm);
+			Wmm = harmonics->c[m]*(xr*Wmm  + yr*Vprev);
+		}
+		V[m] = Vmm;
+		W[m] = Wmm;
+
+		//Remaining terms in this column
+		for (n = m+1; n <= N+1; n++) {
+			EVDS_REAL a = harmonics->a[n*(n+1)/2+m];
+			EVDS_REAL b = harmonics->b[n*(n+1)/2+m];
+			V[n] = a*zr*V[n-1] - (n-m > 1 ? b*R2r2*V[n-2] : 0.0);
+			W[n] = a*zr*W[n-1] - (n-m > 1 ? b*R2r2*W[n-2] : 0.0);
+		}
+
+		//Potential and acceleration terms
+		for (n = (m > 0 ? m-1 : 0); n <= N; n++) {
+			int i;
+			EVDS_REAL Vn1 = V[n+1];
+			EVDS_REAL Wn1 = W[n+1];
+
+			//Potential and z-acceleration from term (n,m)
+			if (n >= m) {
+				i = n*(n+1)/2+m;
+				U  += harmonics->C[i]*V[n] + harmonics->S[i]*W[n];
+				az += harmonics->fz[i]*(-harmonics->C[i]*Vn1 - harmonics->S[i]*Wn1);
+			}
+
+			//x,y-acceleration from term (n,m-1)
+			if (m > 0) {
+				i = n*(n+1)/2+m-1;
+				ax += 0.5*harmonics->f1[i]*(-harmonics->C[i]*Vn1 - harmonics->S[i]*Wn1);
+				ay += 0.5*harmonics->f1[i]*(-harmonics->C[i]*Wn1 + harmonics->S[i]*Vn1);
+			}
+
+			//x,y-acceleration from term (n,m+1)
+			if (n >= m+1) {
+				i = n*(n+1)/2+m+1;
+				ax += 0.5*harmonics->f2[i]*( harmonics->C[i]*Vn1 + harmonics->S[i]*Wn1);
+				ay += 0.5*harmonics->f2[i]*(-harmonics->C[i]*Wn1 + harmonics->S[i]*Vn1);
+			}
+		}
+	}
+
+	//Scale and write back results
+	*phi = -(mu/harmonics->radius)*U;
+	g->x = (mu/(harmonics->radius*harmonics->radius))*ax;
+	g->y = (mu/(harmonics->radius*harmonics->radius))*ay;
+	g->z = (mu/(harmonics->radius*harmonics->radius))*az;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Load spherical harmonics model of magnetic field.
+///
+/// Coefficients must be Schmidt semi-normalized (IGRF, WMM), they are converted to the
+/// fully normalized form used by EVDS_InternalEnvironment_EvaluateHarmonics(). Scale
+/// converts coefficients to tesla. The model is evaluated with \f$\mu = R^2\f$, which
+/// returns magnetic potential with the opposite sign.
+////////////////////////////////////////////////////////////////////////////////
+EVDS_INTERNAL_GRAVITY_HARMONICS* EVDS_InternalEnvironment_LoadMagneticHarmonics(const char* table, size_t length,
+																				 int degree, EVDS_REAL radius, EVDS_REAL scale) {
+	int n,m;
+	EVDS_INTERNAL_GRAVITY_HARMONICS* harmonics;
+
+	harmonics = EVDS_InternalEnvironment_LoadHarmonics(table,length,degree,radius);
+	if (!harmonics) return 0;
+
+	//No monopole term, convert from Schmidt semi-normalized coefficients
+	harmonics->C[0] = 0.0;
+	harmonics->S[0] = 0.0;
+	for (n = 1; n <= harmonics->degree; n++) {
+		for (m = 0; m <= n; m++) {
+			harmonics->C[n*(n+1)/2+m] *= scale/sqrt(2.0*n+1.0);
+			harmonics->S[n*(n+1)/2+m] *= scale/sqrt(2.0*n+1.0);
+		}
+	}
+	return harmonics;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Free precomputed gravity grid
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalEnvironment_DestroyGrid(EVDS_INTERNAL_GRAVITY_GRID* grid) {
+	int i;
+	if (!grid) return;
+	if (grid->blocks) {
+		for (i = 0; i < grid->br*grid->blat*grid->blon; i++) {
+			if (grid->blocks[i]) free(grid->blocks[i]);
+		}
+		free(grid->blocks);
+	}
+#ifndef EVDS_SINGLETHREADED
+	SIMC_Lock_Destroy(grid->lock);
+#endif
+	free(grid);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Create an empty gravity grid between two radii.
+///
+/// Only the index of blocks is allocated, blocks themselves are built when they are first used.
+////////////////////////////////////////////////////////////////////////////////
+EVDS_INTERNAL_GRAVITY_GRID* EVDS_InternalEnvironment_CreateGrid(EVDS_REAL r_min, EVDS_REAL r_max,
+																EVDS_REAL step, EVDS_REAL radial_step) {
+	EVDS_INTERNAL_GRAVITY_GRID* grid;
+	int count;
+	if ((step <= 0.0) || (radial_step <= 0.0) || (r_max <= r_min) || (r_min <= 0.0)) return 0;
+
+	grid = (EVDS_INTERNAL_GRAVITY_GRID*)malloc(sizeof(EVDS_INTERNAL_GRAVITY_GRID));
+	if (!grid) return 0;
+	grid->nr = (int)ceil((r_max - r_min)/radial_step);
+	grid->nlat = (int)ceil(EVDS_PI/step);
+	grid->nlon = 2*grid->nlat;
+	grid->r_min = r_min;
+	grid->dr = (r_max - r_min)/grid->nr;
+	grid->dlat = EVDS_PI/grid->nlat;
+	grid->dlon = 2.0*EVDS_PI/grid->nlon;
+	grid->br = (grid->nr + EVDS_ENVIRONMENT_GRID_BLOCK - 1)/EVDS_ENVIRONMENT_GRID_BLOCK;
+	grid->blat = (grid->nlat + EVDS_ENVIRONMENT_GRID_BLOCK - 1)/EVDS_ENVIRONMENT_GRID_BLOCK;
+	grid->blon = (grid->nlon + EVDS_ENVIRONMENT_GRID_BLOCK - 1)/EVDS_ENVIRONMENT_GRID_BLOCK;
+
+	count = grid->br*grid->blat*grid->blon;
+	grid->blocks = (EVDS_REAL**)malloc(sizeof(EVDS_REAL*)*count);
+	if (!grid->blocks) {
+		free(grid);
+		return 0;
+	}
+	memset(grid->blocks,0,sizeof(EVDS_REAL*)*count);
+#ifndef EVDS_SINGLETHREADED
+	grid->lock = SIMC_Lock_Create();
+#endif
+	return grid;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Build a single block of gravity grid.
+///
+/// Each node stores deviation of the spherical harmonics model from the central field
+/// (potential and acceleration in planet body-fixed coordinates). Nodes past the poles
+/// are computed for the mirrored position, which keeps interpolation stencils valid.
+////////////////////////////////////////////////////////////////////////////////
+EVDS_REAL* EVDS_InternalEnvironment_BuildGridBlock(EVDS_INTERNAL_GRAVITY_GRID* grid, EVDS_INTERNAL_GRAVITY_HARMONICS* harmonics,
+												   EVDS_REAL mu, int bi, int bj, int bk) {
+	int i,j,k;
+	EVDS_REAL* node;
+	EVDS_REAL* block = (EVDS_REAL*)malloc(sizeof(EVDS_REAL)*4*
+		EVDS_ENVIRONMENT_GRID_BLOCK_NODES*EVDS_ENVIRONMENT_GRID_BLOCK_NODES*EVDS_ENVIRONMENT_GRID_BLOCK_NODES);
+	if (!block) return 0;
+
+	node = block;
+	for (i = 0; i < EVDS_ENVIRONMENT_GRID_BLOCK_NODES; i++) {
+		EVDS_REAL r = grid->r_min + (bi*EVDS_ENVIRONMENT_GRID_BLOCK + i - 1)*grid->dr;
+		for (j = 0; j < EVDS_ENVIRONMENT_GRID_BLOCK_NODES; j++) {
+			EVDS_REAL lat = -0.5*EVDS_PI + (bj*EVDS_ENVIRONMENT_GRID_BLOCK + j - 1)*grid->dlat;
+			for (k = 0; k < EVDS_ENVIRONMENT_GRID_BLOCK_NODES; k++) {
+				EVDS_REAL lon = -EVDS_PI + (bk*EVDS_ENVIRONMENT_GRID_BLOCK + k - 1)*grid->dlon;
+				EVDS_REAL phi,r3;
+				EVDS_VECTOR p,g;
+
+				//Compute deviation from central field
+				p.x = r*cos(lat)*cos(lon);
+				p.y = r*cos(lat)*sin(lon);
+				p.z = r*sin(lat);
+				r3 = r*r*r;
+				EVDS_InternalEnvironment_EvaluateHarmonics(harmonics,mu,&p,&phi,&g);
+				node[0] = phi + mu/r;
+				node[1] = g.x + mu*p.x/r3;
+				node[2] = g.y + mu*p.y/r3;
+				node[3] = g.z + mu*p.z/r3;
+				node += 4;
+			}
+		}
+	}
+	return block;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Evaluate gravitational field using the precomputed grid.
+///
+/// Central field is computed exactly, deviation from the central field is interpolated
+/// with tricubic Lagrange interpolation in \f$(r, \theta, \lambda)\f$. Interpolation error
+/// along each axis is bounded by:
+/// \f[
+///		|\epsilon| \le \frac{3}{128} h^4 \max|f^{(4)}|
+/// \f]
+/// For a degree \f$n\f$ harmonic term the angular derivatives scale as \f$n^4\f$, so the
+/// relative error for the highest degree terms is approximately \f$0.023 (N \Delta\theta)^4\f$
+/// (for example \f$2 \cdot 10^{-4}\f$ for \f$N = 70\f$ with 0.25 degree grid).
+///
+/// Blocks of grid nodes are built when first required.
+///
+/// @returns 1 if position is within the grid, 0 otherwise
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalEnvironment_EvaluateGrid(EVDS_INTERNAL_GRAVITY_GRID* grid, EVDS_INTERNAL_GRAVITY_HARMONICS* harmonics,
+										  EVDS_REAL mu, EVDS_VECTOR* p, EVDS_REAL* phi, EVDS_VECTOR* g) {
+	EVDS_REAL r,r3,u,v,w;
+	EVDS_REAL wr[4],wlat[4],wlon[4];
+	EVDS_REAL result[4] = { 0.0, 0.0, 0.0, 0.0 };
+	EVDS_REAL* block;
+	int i,j,k,bi,bj,bk,index;
+	int a,b,c;
+
+	//Find cell
+	r = sqrt(p->x*p->x + p->y*p->y + p->z*p->z);
+	u = (r - grid->r_min)/grid->dr;
+	if ((u < 0.0) || (u >= grid->nr)) return 0;
+	v = (asin(p->z/r) + 0.5*EVDS_PI)/grid->dlat;
+	w = (atan2(p->y,p->x) + EVDS_PI)/grid->dlon;
+	i = (int)u; if (i > grid->nr-1) i = grid->nr-1;
+	j = (int)v; if (j > grid->nlat-1) j = grid->nlat-1;
+	k = (int)w; if (k > grid->nlon-1) k = grid->nlon-1;
+	u -= i;
+	v -= j;
+	w -= k;
+
+	//Find block (build if required)
+	bi = i/EVDS_ENVIRONMENT_GRID_BLOCK;
+	bj = j/EVDS_ENVIRONMENT_GRID_BLOCK;
+	bk = k/EVDS_ENVIRONMENT_GRID_BLOCK;
+	index = (bi*grid->blat + bj)*grid->blon + bk;
+	block = grid->blocks[index];
+	if (!block) {
+#ifndef EVDS_SINGLETHREADED
+		SIMC_Lock_Enter(grid->lock);
+#endif
+		block = grid->blocks[index];
+		if (!block) {
+			block = EVDS_InternalEnvironment_BuildGridBlock(grid,harmonics,mu,bi,bj,bk);
+			grid->blocks[index] = block;
+		}
+#ifndef EVDS_SINGLETHREADED
+		SIMC_Lock_Leave(grid->lock);
+#endif
+		if (!block) return 0;
+	}
+
+	//Cubic Lagrange weights for nodes -1, 0, 1, 2
+#define EVDS_LAGRANGE_WEIGHTS(wt,t) \
+	wt[0] = -(t)*((t)-1.0)*((t)-2.0)/6.0; \
+	wt[1] = ((t)+1.0)*((t)-1.0)*((t)-2.0)/2.0; \
+	wt[2] = -((t)+1.0)*(t)*((t)-2.0)/2.0; \
+	wt[3] = ((t)+1.0)*(t)*((t)-1.0)/6.0;
+	EVDS_LAGRANGE_WEIGHTS(wr,u);
+	EVDS_LAGRANGE_WEIGHTS(wlat,v);
+	EVDS_LAGRANGE_WEIGHTS(wlon,w);
+#undef EVDS_LAGRANGE_WEIGHTS
+
+	//Interpolate deviation (stencil starts at local node index of the cell)
+	i -= bi*EVDS_ENVIRONMENT_GRID_BLOCK;
+	j -= bj*EVDS_ENVIRONMENT_GRID_BLOCK;
+	k -= bk*EVDS_ENVIRONMENT_GRID_BLOCK;
+	for (a = 0; a < 4; a++) {
+		for (b = 0; b < 4; b++) {
+			EVDS_REAL* node = block + 4*(((i+a)*EVDS_ENVIRONMENT_GRID_BLOCK_NODES + (j+b))*EVDS_ENVIRONMENT_GRID_BLOCK_NODES + k);
+			EVDS_REAL wab = wr[a]*wlat[b];
+			for (c = 0; c < 4; c++) {
+				EVDS_REAL wabc = wab*wlon[c];
+				result[0] += wabc*node[0];
+				result[1] += wabc*node[1];
+				result[2] += wabc*node[2];
+				result[3] += wabc*node[3];
+				node += 4;
+			}
+		}
+	}
+
+	//Add central field
+	r3 = r*r*r;
+	*phi = result[0] - mu/r;
+	g->x = result[1] - mu*p->x/r3;
+	g->y = result[2] - mu*p->y/r3;
+	g->z = result[3] - mu*p->z/r3;
+	return 1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Check if gravity source is a point mass (can be approximated by the octree)
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalEnvironment_IsPointMass(EVDS_INTERNAL_GRAVITY_SOURCE* source) {
+	return (!source->is_constant) && (!source->callback) && (!source->harmonics) &&
+		   (!(source->has_j2 && source->has_radius)) && (!source->has_rs) && (source->mu != 0.0);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Build node of the gravity octree (and all its children)
+///
+/// Sources in range are sorted into octants, so every leaf references a continuous range
+/// of "gravity_tree_sources".
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalEnvironment_BuildTreeNode(EVDS_SYSTEM* system, int node, int first, int count,
+										   int* temporary, int depth) {
+	EVDS_INTERNAL_GRAVITY_TREE_NODE* tree_node = &system->gravity_tree[node];
+	int octant_first[8],octant_count[8];
+	EVDS_REAL center[3],size;
+	int i,j;
+
+	//Compute mass and center of mass
+	tree_node->mu = 0.0;
+	tree_node->center_of_mass[0] = 0.0;
+	tree_node->center_of_mass[1] = 0.0;
+	tree_node->center_of_mass[2] = 0.0;
+	for (i = first; i < first+count; i++) {
+		EVDS_INTERNAL_GRAVITY_SOURCE* source = &system->gravity_sources[system->gravity_tree_sources[i]];
+		tree_node->mu += source->mu;
+		tree_node->center_of_mass[0] += source->mu*source->position.x;
+		tree_node->center_of_mass[1] += source->mu*source->position.y;
+		tree_node->center_of_mass[2] += source->mu*source->position.z;
+	}
+	tree_node->center_of_mass[0] /= tree_node->mu;
+	tree_node->center_of_mass[1] /= tree_node->mu;
+	tree_node->center_of_mass[2] /= tree_node->mu;
+	for (i = 0; i < 8; i++) tree_node->children[i] = -1;
+	tree_node->first = first;
+	tree_node->count = 0;
+
+	//Check if node must be a leaf
+	if ((count <= EVDS_ENVIRONMENT_TREE_LEAF) || (depth >= EVDS_ENVIRONMENT_TREE_DEPTH)) {
+		tree_node->count = count;
+		return EVDS_OK;
+	}
+
+	//Sort sources into octants
+	center[0] = tree_node->center[0];
+	center[1] = tree_node->center[1];
+	center[2] = tree_node->center[2];
+	size = tree_node->size;
+	for (i = 0; i < 8; i++) octant_count[i] = 0;
+	for (i = first; i < first+count; i++) {
+		EVDS_INTERNAL_GRAVITY_SOURCE* source = &system->gravity_sources[system->gravity_tree_sources[i]];
+		int octant = (source->position.x > center[0] ? 1 : 0) |
+					 (source->position.y > center[1] ? 2 : 0) |
+					 (source->position.z > center[2] ? 4 : 0);
+		temporary[i] = octant;
+		octant_count[octant]++;
+	}
+	octant_first[0] = 0;
+	for (i = 1; i < 8; i++) octant_first[i] = octant_first[i-1] + octant_count[i-1];
+	for (i = first; i < first+count; i++) {
+		int octant = temporary[i];
+		temporary[i] = system->gravity_tree_sources[i];
+		temporary[i] |= octant << 28;
+	}
+	for (j = 0; j < 8; j++) {
+		int k = first + octant_first[j];
+		for (i = first; i < first+count; i++) {
+			if ((temporary[i] >> 28) == j) system->gravity_tree_sources[k++] = temporary[i] & 0x0FFFFFFF;
+		}
+	}
+
+	//Create child nodes
+	for (j = 0; j < 8; j++) {
+		int child;
+		if (!octant_count[j]) continue;
+
+		//Allocate new node
+		if (system->gravity_tree_count == system->gravity_tree_capacity) {
+			EVDS_INTERNAL_GRAVITY_TREE_NODE* nodes;
+			int capacity = system->gravity_tree_capacity*2;
+			nodes = (EVDS_INTERNAL_GRAVITY_TREE_NODE*)realloc(system->gravity_tree,
+				sizeof(EVDS_INTERNAL_GRAVITY_TREE_NODE)*capacity);
+			if (!nodes) return EVDS_ERROR_MEMORY;
+			system->gravity_tree = nodes;
+			system->gravity_tree_capacity = capacity;
+		}
+		child = system->gravity_tree_count++;
+		system->gravity_tree[node].children[j] = child;
+
+		system->gravity_tree[child].size = 0.5*size;
+		system->gravity_tree[child].center[0] = center[0] + ((j & 1) ? 0.25 : -0.25)*size;
+		system->gravity_tree[child].center[1] = center[1] + ((j & 2) ? 0.25 : -0.25)*size;
+		system->gravity_tree[child].center[2] = center[2] + ((j & 4) ? 0.25 : -0.25)*size;
+		EVDS_ERRCHECK(EVDS_InternalEnvironment_BuildTreeNode(system,child,first+octant_first[j],octant_count[j],
+			temporary,depth+1));
+	}
+	return EVDS_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Build octree of point mass gravity sources.
+///
+/// The octree is only built if opening angle is not zero and there are at least
+/// "gravity_tree_threshold" point masses, otherwise the field is computed by direct summation.
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalEnvironment_BuildGravityTree(EVDS_SYSTEM* system) {
+	EVDS_REAL min[3],max[3];
+	int* temporary;
+	int i,count,error_code;
+
+	//Count point masses
+	system->gravity_tree_count = 0;
+	count = 0;
+	for (i = 0; i < system->gravity_sources_count; i++) {
+		system->gravity_sources[i].in_tree = 0;
+		if (EVDS_InternalEnvironment_IsPointMass(&system->gravity_sources[i])) count++;
+	}
+	if ((system->gravity_opening_angle <= 0.0) || (count < system->gravity_tree_threshold) || (count == 0)) {
+		return EVDS_OK;
+	}
+
+	//Allocate arrays
+	if (system->gravity_tree_capacity < 2*count) {
+		if (system->gravity_tree) free(system->gravity_tree);
+		if (system->gravity_tree_sources) free(system->gravity_tree_sources);
+		system->gravity_tree_capacity = 2*count;
+		system->gravity_tree = (EVDS_INTERNAL_GRAVITY_TREE_NODE*)malloc(
+			sizeof(EVDS_INTERNAL_GRAVITY_TREE_NODE)*system->gravity_tree_capacity);
+		system->gravity_tree_sources = (int*)malloc(sizeof(int)*system->gravity_tree_capacity);
+		if ((!system->gravity_tree) || (!system->gravity_tree_sources)) {
+			EVDS_InternalEnvironment_DestroyGravitySources(system);
+			return EVDS_ERROR_MEMORY;
+		}
+	}
+	temporary = (int*)malloc(sizeof(int)*count);
+	if (!temporary) return EVDS_ERROR_MEMORY;
+
+	//Find bounding box
+	count = 0;
+	for (i = 0; i < system->gravity_sources_count; i++) {
+		EVDS_INTERNAL_GRAVITY_SOURCE* source = &system->gravity_sources[i];
+		if (!EVDS_InternalEnvironment_IsPointMass(source)) continue;
+		if (count == 0) {
+			min[0] = max[0] = source->position.x;
+			min[1] = max[1] = source->position.y;
+			min[2] = max[2] = source->position.z;
+		}
+		if (source->position.x < min[0]) min[0] = source->position.x;
+		if (source->position.y < min[1]) min[1] = source->position.y;
+		if (source->position.z < min[2]) min[2] = source->position.z;
+		if (source->position.x > max[0]) max[0] = source->position.x;
+		if (source->position.y > max[1]) max[1] = source->position.y;
+		if (source->position.z > max[2]) max[2] = source->position.z;
+		system->gravity_tree_sources[count++] = i;
+	}
+
+	//Create root node and build the tree
+	system->gravity_tree_count = 1;
+	system->gravity_tree[0].center[0] = 0.5*(min[0]+max[0]);
+	system->gravity_tree[0].center[1] = 0.5*(min[1]+max[1]);
+	system->gravity_tree[0].center[2] = 0.5*(min[2]+max[2]);
+	system->gravity_tree[0].size = max[0]-min[0];
+	if (max[1]-min[1] > system->gravity_tree[0].size) system->gravity_tree[0].size = max[1]-min[1];
+	if (max[2]-min[2] > system->gravity_tree[0].size) system->gravity_tree[0].size = max[2]-min[2];
+	system->gravity_tree[0].size = system->gravity_tree[0].size*(1.0+EVDS_EPS) + EVDS_EPS;
+	error_code = EVDS_InternalEnvironment_BuildTreeNode(system,0,0,count,temporary,0);
+	free(temporary);
+	if (error_code != EVDS_OK) {
+		system->gravity_tree_count = 0;
+		return error_code;
+	}
+
+	//Mark sources which are now evaluated through the octree
+	for (i = 0; i < count; i++) {
+		system->gravity_sources[system->gravity_tree_sources[i]].in_tree = 1;
+	}
+	return EVDS_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Evaluate gravitational field of point masses using the octree.
+///
+/// Nodes which are seen at an angle smaller than the opening angle are replaced with
+/// a single point mass in the nodes center of mass. Nodes containing the position are
+/// always opened.
+///
+/// @param[in] system System
+/// @param[in] p Position in root inertial space
+/// @param[out] phi Gravitational potential (added to the value)
+/// @param[out] g Gravitational field in root inertial space (added to the value)
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalEnvironment_EvaluateTree(EVDS_SYSTEM* system, EVDS_VECTOR* p, EVDS_REAL* phi, EVDS_VECTOR* g) {
+	int stack[8*(EVDS_ENVIRONMENT_TREE_DEPTH+1)];
+	int stack_size = 1;
+	EVDS_REAL theta2 = system->gravity_opening_angle*system->gravity_opening_angle;
+	stack[0] = 0;
+
+	while (stack_size > 0) {
+		EVDS_INTERNAL_GRAVITY_TREE_NODE* node = &system->gravity_tree[stack[--stack_size]];
+		EVDS_REAL dx,dy,dz,r2,r;
+		int i;
+
+		if (node->count > 0) { //Leaf node: direct summation
+			for (i = node->first; i < node->first+node->count; i++) {
+				EVDS_INTERNAL_GRAVITY_SOURCE* source = &system->gravity_sources[system->gravity_tree_sources[i]];
+#ifndef EVDS_SINGLETHREADED
+				if (source->object->integrate_thread == EVDS_InternalThread_GetIntegrateID()) continue;
+#endif
+				dx = source->position.x - p->x;
+				dy = source->position.y - p->y;
+				dz = source->position.z - p->z;
+				r2 = dx*dx + dy*dy + dz*dz;
+				if (r2 < EVDS_EPS) continue; //Planets dont pull themselves
+				r = sqrt(r2);
+				if (source->has_radius && (r < source->radius*0.9)) continue; //Too close to the planet
+
+				*phi -= source->mu/r;
+				g->x += source->mu*dx/(r2*r);
+				g->y += source->mu*dy/(r2*r);
+				g->z += source->mu*dz/(r2*r);
+			}
+		} else {
+			EVDS_REAL half = 0.5*node->size;
+			int inside = (fabs(p->x - node->center[0]) <= half) &&
+						 (fabs(p->y - node->center[1]) <= half) &&
+						 (fabs(p->z - node->center[2]) <= half);
+
+			dx = node->center_of_mass[0] - p->x;
+			dy = node->center_of_mass[1] - p->y;
+			dz = node->center_of_mass[2] - p->z;
+			r2 = dx*dx + dy*dy + dz*dz;
+			if ((!inside) && (node->size*node->size < theta2*r2)) { //Far node: single point mass
+				r = sqrt(r2);
+				*phi -= node->mu/r;
+				g->x += node->mu*dx/(r2*r);
+				g->y += node->mu*dy/(r2*r);
+				g->z += node->mu*dz/(r2*r);
+			} else { //Open node
+				for (i = 0; i < 8; i++) {
+					if (node->children[i] >= 0) stack[stack_size++] = node->children[i];
+				}
+			}
+		}
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Mark table of gravity sources as outdated if object is a gravity source.
+///
+/// Must be called when a planet or a constant gravity source is added or removed, or when
+/// one of its gravity-related variables is changed.
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalEnvironment_InvalidateGravity(EVDS_OBJECT* object) {
+	if (!object) return;
+	if ((strncmp(object->type,"planet",256) == 0) ||
+		(strncmp(object->type,"constant_gravity",256) == 0)) {
+		object->system->gravity_revision++;
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Mark table of gravity sources as outdated if object or any of its children is a gravity source.
+///
+/// Must be called when object is moved to a new parent. Objects which are not gravity sources
+/// (for example vessels) are not part of the table, so moving them keeps the compiled table.
+///
+/// @returns 1 if table was marked as outdated, 0 otherwise
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalEnvironment_InvalidateGravitySubtree(EVDS_OBJECT* object) {
+	SIMC_LIST_ENTRY* entry;
+	if ((strncmp(object->type,"planet",256) == 0) ||
+		(strncmp(object->type,"constant_gravity",256) == 0)) {
+		object->system->gravity_revision++;
+		return 1;
+	}
+
+	entry = SIMC_List_GetFirst(object->raw_children);
+	while (entry) {
+		if (EVDS_InternalEnvironment_InvalidateGravitySubtree(
+			(EVDS_OBJECT*)SIMC_List_GetData(object->raw_children,entry))) {
+			SIMC_List_Stop(object->raw_children,entry);
+			return 1;
+		}
+		entry = SIMC_List_GetNext(object->raw_children,entry);
+	}
+	return 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Free radiation flux table
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalEnvironment_DestroyRadiationTable(EVDS_INTERNAL_RADIATION_TABLE* table) {
+	if (!table) return;
+	if (table->L) free(table->L);
+	if (table->values) free(table->values);
+	free(table);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Compare two real numbers (for sorting)
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalEnvironment_CompareReal(const void* v1, const void* v2) {
+	if (*((const EVDS_REAL*)v1) > *((const EVDS_REAL*)v2)) return 1;
+	if (*((const EVDS_REAL*)v1) < *((const EVDS_REAL*)v2)) return -1;
+	return 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Sort array of reals and remove duplicates. Returns new number of elements.
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalEnvironment_SortUnique(EVDS_REAL* values, int count) {
+	int i,unique = 0;
+	qsort(values,count,sizeof(EVDS_REAL),EVDS_InternalEnvironment_CompareReal);
+	for (i = 0; i < count; i++) {
+		if ((unique == 0) || (values[i] != values[unique-1])) values[unique++] = values[i];
+	}
+	return unique;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Find interval of a sorted array of nodes which contains the given value.
+///
+/// Returns index of the first node of the interval and relative position inside the
+/// interval. Values outside of the array are clamped to its ends.
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalEnvironment_FindInterval(EVDS_REAL* nodes, int count, EVDS_REAL x, EVDS_REAL* t) {
+	int lo = 0, hi = count-1;
+	*t = 0.0;
+	if ((count < 2) || (x <= nodes[0])) return 0;
+	if (x >= nodes[count-1]) {
+		*t = 1.0;
+		return count-2;
+	}
+	while (hi - lo > 1) {
+		int mid = (lo+hi)/2;
+		if (nodes[mid] > x) hi = mid; else lo = mid;
+	}
+	*t = (x - nodes[lo])/(nodes[hi] - nodes[lo]);
+	return lo;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Load radiation flux table.
+///
+/// Each line of the table contains "L B/B0 electron_flux proton_flux solar_flux dose_rate"
+/// values, lines which do not start with a number are skipped. Entries form a rectilinear
+/// grid over L-shell and B/B0. Nodes missing from the table have zero flux.
+////////////////////////////////////////////////////////////////////////////////
+EVDS_INTERNAL_RADIATION_TABLE* EVDS_InternalEnvironment_LoadRadiationTable(const char* text, size_t length) {
+	EVDS_INTERNAL_RADIATION_TABLE* table;
+	const char* text_end = text + length;
+	const char* line;
+	EVDS_REAL* rows;
+	int i,j,k,row_count = 0,row_capacity = 64;
+
+	//Read all rows of the table
+	rows = (EVDS_REAL*)malloc(sizeof(EVDS_REAL)*6*row_capacity);
+	if (!rows) return 0;
+	line = text;
+	while (line < text_end) {
+		char buffer[256];
+		char *ptr, *end;
+		const char* line_end = line;
+		size_t line_length;
+		EVDS_REAL row[6] = { 0 };
+
+		//Copy single line into buffer
+		while ((line_end < text_end) && (*line_end != '\n') && (*line_end != '\0')) line_end++;
+		line_length = line_end - line;
+		if (line_length > sizeof(buffer)-1) line_length = sizeof(buffer)-1;
+		memcpy(buffer,line,line_length);
+		buffer[line_length] = '\0';
+		line = line_end+1;
+
+		//Read numbers (at least L and B/B0 must be present)
+		ptr = buffer;
+		for (k = 0; k < 6; k++) {
+			row[k] = strtod(ptr,&end);
+			if (end == ptr) break;
+			ptr = end;
+		}
+		if ((k < 2) || (row[0] <= 0.0)) continue;
+
+		//Store row
+		if (row_count == row_capacity) {
+			EVDS_REAL* new_rows;
+			row_capacity *= 2;
+			new_rows = (EVDS_REAL*)realloc(rows,sizeof(EVDS_REAL)*6*row_capacity);
+			if (!new_rows) {
+				free(rows);
+				return 0;
+			}
+			rows = new_rows;
+		}
+		memcpy(&rows[6*row_count],row,sizeof(row));
+		row_count++;
+	}
+	if (row_count == 0) {
+		free(rows);
+		return 0;
+	}
+
+	//Allocate table (nodes along both axes are stored in one block)
+	table = (EVDS_INTERNAL_RADIATION_TABLE*)malloc(sizeof(EVDS_INTERNAL_RADIATION_TABLE));
+	if (!table) {
+		free(rows);
+		return 0;
+	}
+	table->L = (EVDS_REAL*)malloc(sizeof(EVDS_REAL)*2*row_count);
+	table->values = 0;
+	if (!table->L) {
+		EVDS_InternalEnvironment_DestroyRadiationTable(table);
+		free(rows);
+		return 0;
+	}
+	table->B = table->L + row_count;
+
+	//Find grid nodes
+	for (i = 0; i < row_count; i++) {
+		table->L[i] = rows[6*i+0];
+		table->B[i] = rows[6*i+1];
+	}
+	table->L_count = EVDS_InternalEnvironment_SortUnique(table->L,row_count);
+	table->B_count = EVDS_InternalEnvironment_SortUnique(table->B,row_count);
+
+	//Fill grid with logarithms of values (missing nodes have zero flux)
+	table->values = (EVDS_REAL*)malloc(sizeof(EVDS_REAL)*EVDS_ENVIRONMENT_RADIATION_CHANNELS*table->L_count*table->B_count);
+	if (!table->values) {
+		EVDS_InternalEnvironment_DestroyRadiationTable(table);
+		free(rows);
+		return 0;
+	}
+	for (i = 0; i < EVDS_ENVIRONMENT_RADIATION_CHANNELS*table->L_count*table->B_count; i++) {
+		table->values[i] = -700.0;
+	}
+	for (i = 0; i < row_count; i++) {
+		EVDS_REAL t;
+		int iL = EVDS_InternalEnvironment_FindInterval(table->L,table->L_count,rows[6*i+0],&t);
+		int iB;
+		if (t > 0.5) iL++;
+		iB = EVDS_InternalEnvironment_FindInterval(table->B,table->B_count,rows[6*i+1],&t);
+		if (t > 0.5) iB++;
+
+		for (j = 0; j < EVDS_ENVIRONMENT_RADIATION_CHANNELS; j++) {
+			EVDS_REAL value = rows[6*i+2+j];
+			table->values[(iL*table->B_count+iB)*EVDS_ENVIRONMENT_RADIATION_CHANNELS+j] = (value > 0.0) ? log(value) : -700.0;
+		}
+	}
+	free(rows);
+	return table;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Interpolate radiation flux table (bilinear interpolation of logarithms).
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalEnvironment_EvaluateRadiationTable(EVDS_INTERNAL_RADIATION_TABLE* table,
+													 EVDS_REAL L, EVDS_REAL B_B0,
+													 EVDS_ENVIRONMENT_RADIATION* radiation) {
+	EVDS_REAL tL,tB,result[EVDS_ENVIRONMENT_RADIATION_CHANNELS];
+	int iL,iB,iL1,iB1,j;
+
+	iL = EVDS_InternalEnvironment_FindInterval(table->L,table->L_count,L,&tL);
+	iB = EVDS_InternalEnvironment_FindInterval(table->B,table->B_count,B_B0,&tB);
+	iL1 = (table->L_count > 1) ? iL+1 : iL;
+	iB1 = (table->B_count > 1) ? iB+1 : iB;
+
+	for (j = 0; j < EVDS_ENVIRONMENT_RADIATION_CHANNELS; j++) {
+		EVDS_REAL v00 = table->values[(iL *table->B_count+iB )*EVDS_ENVIRONMENT_RADIATION_CHANNELS+j];
+		EVDS_REAL v01 = table->values[(iL *table->B_count+iB1)*EVDS_ENVIRONMENT_RADIATION_CHANNELS+j];
+		EVDS_REAL v10 = table->values[(iL1*table->B_count+iB )*EVDS_ENVIRONMENT_RADIATION_CHANNELS+j];
+		EVDS_REAL v11 = table->values[(iL1*table->B_count+iB1)*EVDS_ENVIRONMENT_RADIATION_CHANNELS+j];
+		EVDS_REAL v = (1.0-tL)*((1.0-tB)*v00 + tB*v01) + tL*((1.0-tB)*v10 + tB*v11);
+		result[j] = (v > -600.0) ? exp(v) : 0.0;
+	}
+	radiation->electron_flux = result[0];
+	radiation->proton_flux = result[1];
+	radiation->solar_flux = result[2];
+	radiation->dose_rate = result[3];
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Compute dipole L-shell and B/B0 coordinates of a point.
+///
+/// Dipole axis and strength are taken from the degree 1 terms of the planet magnetic
+/// field model. If planet has no magnetic field model, an axial dipole is assumed.
+///
+/// @param[in] source Planet
+/// @param[in] r Position in planet body-fixed coordinates
+/// @param[out] L McIlwain L-shell parameter
+/// @param[out] B_B0 Field strength relative to the equatorial field strength on the same field line
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalEnvironment_GetMagneticCoordinates(EVDS_INTERNAL_GRAVITY_SOURCE* source, EVDS_VECTOR* r,
+													 EVDS_REAL* L, EVDS_REAL* B_B0) {
+	EVDS_REAL radius,r_length,sin_lat,cos2_lat;
+	EVDS_REAL ax = 0.0, ay = 0.0, az = 1.0, B_dipole = 0.0;
+
+	//Dipole axis (direction to geomagnetic north pole)
+	radius = source->radius;
+	if (source->magnetic) {
+		EVDS_REAL g10 = sqrt(3.0)*source->magnetic->C[1];
+		EVDS_REAL g11 = sqrt(3.0)*source->magnetic->C[2];
+		EVDS_REAL h11 = sqrt(3.0)*source->magnetic->S[2];
+		B_dipole = sqrt(g10*g10 + g11*g11 + h11*h11);
+		radius = source->magnetic->radius;
+		if (B_dipole > 0.0) {
+			ax = -g11/B_dipole;
+			ay = -h11/B_dipole;
+			az = -g10/B_dipole;
+		}
+	}
+
+	//Dipole magnetic latitude and L-shell
+	r_length = sqrt(r->x*r->x + r->y*r->y + r->z*r->z);
+	sin_lat = (r->x*ax + r->y*ay + r->z*az)/r_length;
+	cos2_lat = 1.0 - sin_lat*sin_lat;
+	if (cos2_lat < EVDS_EPS) cos2_lat = EVDS_EPS;
+	*L = r_length/(radius*cos2_lat);
+
+	//Field strength relative to the field line equator
+	if (B_dipole > 0.0) {
+		EVDS_REAL potential;
+		EVDS_VECTOR B;
+		EVDS_Vector_Initialize(B);
+		EVDS_InternalEnvironment_EvaluateHarmonics(source->magnetic,radius*radius,r,&potential,&B);
+		*B_B0 = sqrt(B.x*B.x + B.y*B.y + B.z*B.z)*(*L)*(*L)*(*L)/B_dipole;
+	} else {
+		*B_B0 = sqrt(1.0 + 3.0*sin_lat*sin_lat)/(cos2_lat*cos2_lat*cos2_lat);
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Free table of gravity sources
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalEnvironment_DestroyGravitySources(EVDS_SYSTEM* system) {
+	int i;
+	for (i = 0; i < system->gravity_sources_count; i++) {
+		EVDS_InternalEnvironment_DestroyHarmonics(system->gravity_sources[i].harmonics);
+		EVDS_InternalEnvironment_DestroyGrid(system->gravity_sources[i].grid);
+		EVDS_InternalEnvironment_DestroyHarmonics(system->gravity_sources[i].magnetic);
+		EVDS_InternalEnvironment_DestroyRadiationTable(system->gravity_sources[i].radiation);
+	}
+	if (system->gravity_sources) free(system->gravity_sources);
+	system->gravity_sources = 0;
+	system->gravity_sources_count = 0;
+	system->gravity_soi_root = -1;
+
+	//Free octree
+	if (system->gravity_tree) free(system->gravity_tree);
+	if (system->gravity_tree_sources) free(system->gravity_tree_sources);
+	system->gravity_tree = 0;
+	system->gravity_tree_sources = 0;
+	system->gravity_tree_count = 0;
+	system->gravity_tree_capacity = 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Get pose revision of the object and all its parents.
+///
+/// Pose revisions only increase, so the sum changes every time the object or any of
+/// its parents moves.
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalEnvironment_GetPoseRevision(EVDS_OBJECT* object) {
+	int revision = 0;
+	while (object) {
+		revision += object->pose_revision;
+		object = object->parent;
+	}
+	return revision;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Update cached position of a gravity source in root inertial space
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalEnvironment_UpdateGravitySource(EVDS_SYSTEM* system, EVDS_INTERNAL_GRAVITY_SOURCE* source) {
+	EVDS_STATE_VECTOR state;
+	if (source->is_constant) return;
+
+	source->pose_revision = EVDS_InternalEnvironment_GetPoseRevision(source->object);
+	EVDS_Object_GetStateVector(source->object,&state);
+	EVDS_Vector_Convert(&source->position,&state.position,system->inertial_space);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Build hierarchy of spheres of influence.
+///
+/// Parent of a source with a sphere of influence is the source with the smallest sphere
+/// of influence which contains it and is larger than its own. Sources without a sphere
+/// of influence are not part of the hierarchy (they are always evaluated).
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalEnvironment_BuildSphereOfInfluence(EVDS_SYSTEM* system) {
+	int i,j;
+
+	//Find parent of every source
+	system->gravity_soi_root = -1;
+	for (i = 0; i < system->gravity_sources_count; i++) {
+		EVDS_INTERNAL_GRAVITY_SOURCE* source = &system->gravity_sources[i];
+		source->soi_parent = -1;
+		source->soi_child = -1;
+		source->soi_sibling = -1;
+		if (source->is_constant || (!source->has_rs)) continue;
+
+		for (j = 0; j < system->gravity_sources_count; j++) {
+			EVDS_INTERNAL_GRAVITY_SOURCE* parent = &system->gravity_sources[j];
+			EVDS_REAL dx,dy,dz;
+			if (parent->is_constant || (!parent->has_rs) || (parent->rs <= source->rs)) continue;
+			if ((source->soi_parent >= 0) && (parent->rs >= system->gravity_sources[source->soi_parent].rs)) continue;
+
+			dx = source->position.x - parent->position.x;
+			dy = source->position.y - parent->position.y;
+			dz = source->position.z - parent->position.z;
+			if (dx*dx + dy*dy + dz*dz < parent->rs*parent->rs) source->soi_parent = j;
+		}
+	}
+
+	//Link lists of children (in order of sources)
+	for (i = system->gravity_sources_count-1; i >= 0; i--) {
+		EVDS_INTERNAL_GRAVITY_SOURCE* source = &system->gravity_sources[i];
+		if (source->is_constant || (!source->has_rs)) continue;
+		if (source->soi_parent >= 0) {
+			source->soi_sibling = system->gravity_sources[source->soi_parent].soi_child;
+			system->gravity_sources[source->soi_parent].soi_child = i;
+		} else {
+			source->soi_sibling = system->gravity_soi_root;
+			system->gravity_soi_root = i;
+		}
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Compile table of gravity sources (planets and constant gravity sources).
+///
+/// Parameters of all gravity sources are fetched once, so evaluating gravitational
+/// field does not require any variable lookups.
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalEnvironment_CompileGravitySources(EVDS_SYSTEM* system) {
+	SIMC_LIST *planets, *constant_sources;
+	SIMC_LIST_ENTRY* entry;
+	EVDS_INTERNAL_GRAVITY_SOURCE* source;
+	int revision = system->gravity_revision;
+	int count = 0;
+
+	//Count all gravity sources
+	EVDS_System_GetObjectsByType(system,"planet",&planets);
+	EVDS_System_GetObjectsByType(system,"constant_gravity",&constant_sources);
+	entry = SIMC_List_GetFirst(planets);
+	while (entry) {
+		count++;
+		entry = SIMC_List_GetNext(planets,entry);
+	}
+	entry = SIMC_List_GetFirst(constant_sources);
+	while (entry) {
+		count++;
+		entry = SIMC_List_GetNext(constant_sources,entry);
+	}
+
+	//Allocate new table
+	EVDS_InternalEnvironment_DestroyGravitySources(system);
+	if (count > 0) {
+		system->gravity_sources = (EVDS_INTERNAL_GRAVITY_SOURCE*)malloc(sizeof(EVDS_INTERNAL_GRAVITY_SOURCE)*count);
+		if (!system->gravity_sources) return EVDS_ERROR_MEMORY;
+		memset(system->gravity_sources,0,sizeof(EVDS_INTERNAL_GRAVITY_SOURCE)*count);
+	}
+
+	//Constant sources
+	source = system->gravity_sources;
+	entry = SIMC_List_GetFirst(constant_sources);
+	while (entry && (system->gravity_sources_count < count)) {
+		EVDS_VARIABLE* acceleration_var;
+		source->object = (EVDS_OBJECT*)SIMC_List_GetData(constant_sources,entry);
+		source->is_constant = 1;
+		if (EVDS_Object_GetVariable(source->object,"acceleration",&acceleration_var) == EVDS_OK) {
+			EVDS_Variable_GetVector(acceleration_var,&source->position);
+			source->position.derivative_level = EVDS_VECTOR_ACCELERATION;
+
+			source++;
+			system->gravity_sources_count++;
+		}
+		entry = SIMC_List_GetNext(constant_sources,entry);
+	}
+
+	//Planets
+	entry = SIMC_List_GetFirst(planets);
+	while (entry && (system->gravity_sources_count < count)) {
+		EVDS_VARIABLE* variable;
+		EVDS_REAL mass;
+		source->object = (EVDS_OBJECT*)SIMC_List_GetData(planets,entry);
+		source->is_constant = 0;
+
+		//Get planets parameters
+		source->has_j2 = EVDS_Object_GetRealVariable(source->object,"gravity.j2",&source->j2,&variable) == EVDS_OK;
+		source->has_rs = EVDS_Object_GetRealVariable(source->object,"gravity.rs",&source->rs,&variable) == EVDS_OK;
+		source->has_radius = EVDS_Object_GetRealVariable(source->object,"geometry.radius",&source->radius,&variable) == EVDS_OK;
+
+		//Get custom gravitational field callback
+		if (EVDS_Object_GetVariable(source->object,"gravitational_field",&variable) == EVDS_OK) {
+			EVDS_Variable_GetFunctionPointer(variable,(void**)(&source->callback));
+		} else {
+			source->callback = 0;
+		}
+
+		//Get custom gravity gradient torque callback
+		if (EVDS_Object_GetVariable(source->object,"gravity_gradient_torque",&variable) == EVDS_OK) {
+			EVDS_Variable_GetFunctionPointer(variable,(void**)(&source->gradient_callback));
+		} else {
+			source->gradient_callback = 0;
+		}
+
+		//Calculate mu for the planet
+		if (EVDS_Object_GetRealVariable(source->object,"gravity.mu",&source->mu,&variable) != EVDS_OK) {
+			if (EVDS_Object_GetRealVariable(source->object,"mass",&mass,&variable) == EVDS_OK) {
+				source->mu = 6.6738480e-11 * mass;
+			} else {
+				source->mu = 0.0;
+			}
+		}
+
+		//Load spherical harmonics model
+		source->harmonics = 0;
+		if ((!source->callback) && (source->mu != 0.0) &&
+			(EVDS_Object_GetVariable(source->object,"gravity.harmonics",&variable) == EVDS_OK)) {
+			EVDS_REAL degree,harmonics_radius;
+			size_t length;
+			char* table;
+
+			//Truncation degree and reference radius of the model (planet radius by default)
+			EVDS_Object_GetRealVariable(source->object,"gravity.harmonics_degree",&degree,0);
+			if (EVDS_Object_GetRealVariable(source->object,"gravity.harmonics_radius",&harmonics_radius,0) != EVDS_OK) {
+				harmonics_radius = source->radius;
+			}
+
+			//Parse table of coefficients
+			if (EVDS_Variable_GetString(variable,0,0,&length) == EVDS_OK) {
+				table = (char*)malloc(length+1);
+				if (table) {
+					EVDS_Variable_GetString(variable,table,length,0);
+					source->harmonics = EVDS_InternalEnvironment_LoadHarmonics(table,length,(int)(degree+0.5),harmonics_radius);
+					free(table);
+				}
+			}
+		}
+
+		//Create precomputed grid for the spherical harmonics model
+		source->grid = 0;
+		if (source->harmonics) {
+			EVDS_REAL step,radial_step,altitude;
+			EVDS_Object_GetRealVariable(source->object,"gravity.grid_resolution",&step,0);
+			if (EVDS_Object_GetRealVariable(source->object,"gravity.grid_radial_resolution",&radial_step,0) != EVDS_OK) {
+				radial_step = source->harmonics->radius*EVDS_RAD(step);
+			}
+			if (EVDS_Object_GetRealVariable(source->object,"gravity.grid_altitude",&altitude,0) != EVDS_OK) {
+				altitude = 2000e3;
+			}
+			source->grid = EVDS_InternalEnvironment_CreateGrid(source->harmonics->radius,
+				source->harmonics->radius+altitude,EVDS_RAD(step),radial_step);
+		}
+
+		//Get custom magnetic field callback
+		if (EVDS_Object_GetVariable(source->object,"magnetic_field",&variable) == EVDS_OK) {
+			EVDS_Variable_GetFunctionPointer(variable,(void**)(&source->magnetic_callback));
+		} else {
+			source->magnetic_callback = 0;
+		}
+
+		//Load magnetic field model (harmonics table or a tilted dipole)
+		source->magnetic = 0;
+		if (!source->magnetic_callback) {
+			EVDS_REAL degree,magnetic_radius,b0;
+			size_t length;
+			char* table;
+
+			if (EVDS_Object_GetRealVariable(source->object,"magnetic.harmonics_radius",&magnetic_radius,0) != EVDS_OK) {
+				magnetic_radius = source->radius;
+			}
+			if (EVDS_Object_GetVariable(source->object,"magnetic.harmonics",&variable) == EVDS_OK) {
+				EVDS_Object_GetRealVariable(source->object,"magnetic.harmonics_degree",&degree,0);
+				if (EVDS_Variable_GetString(variable,0,0,&length) == EVDS_OK) {
+					table = (char*)malloc(length+1);
+					if (table) {
+						EVDS_Variable_GetString(variable,table,length,0);
+						source->magnetic = EVDS_InternalEnvironment_LoadMagneticHarmonics(table,length,
+							(int)(degree+0.5),magnetic_radius,1e-9);
+						free(table);
+					}
+				}
+			} else if (EVDS_Object_GetRealVariable(source->object,"magnetic.dipole",&b0,0) == EVDS_OK) {
+				EVDS_REAL pole_latitude,pole_longitude;
+				char dipole[256];
+
+				if (EVDS_Object_GetRealVariable(source->object,"magnetic.pole_latitude",&pole_latitude,0) != EVDS_OK) {
+					pole_latitude = 90.0;
+				}
+				EVDS_Object_GetRealVariable(source->object,"magnetic.pole_longitude",&pole_longitude,0);
+
+				//Dipole terms g(1,0), g(1,1), h(1,1) for the given geomagnetic north pole
+				sprintf(dipole,"1 0 %.17g 0\n1 1 %.17g %.17g\n",
+					-b0*sin(EVDS_RAD(pole_latitude)),
+					-b0*cos(EVDS_RAD(pole_latitude))*cos(EVDS_RAD(pole_longitude)),
+					-b0*cos(EVDS_RAD(pole_latitude))*sin(EVDS_RAD(pole_longitude)));
+				source->magnetic = EVDS_InternalEnvironment_LoadMagneticHarmonics(dipole,strlen(dipole),
+					1,magnetic_radius,1.0);
+			}
+		}
+
+		//Get custom radiation environment callback or load radiation flux table
+		source->radiation = 0;
+		if (EVDS_Object_GetVariable(source->object,"radiation_data",&variable) == EVDS_OK) {
+			EVDS_Variable_GetFunctionPointer(variable,(void**)(&source->radiation_callback));
+		} else {
+			size_t length;
+			char* table;
+
+			source->radiation_callback = 0;
+			if ((EVDS_Object_GetVariable(source->object,"radiation.table",&variable) == EVDS_OK) &&
+				(EVDS_Variable_GetString(variable,0,0,&length) == EVDS_OK)) {
+				table = (char*)malloc(length+1);
+				if (table) {
+					EVDS_Variable_GetString(variable,table,length,0);
+					source->radiation = EVDS_InternalEnvironment_LoadRadiationTable(table,length);
+					free(table);
+				}
+			}
+		}
+
+		//Get custom atmospheric model or the built-in one
+		source->has_us76 = 0;
+		if (EVDS_Object_GetVariable(source->object,"atmospheric_data",&variable) == EVDS_OK) {
+			EVDS_Variable_GetFunctionPointer(variable,(void**)(&source->atmosphere_callback));
+		} else {
+			source->atmosphere_callback = 0;
+			if (EVDS_Object_GetVariable(source->object,"atmosphere.model",&variable) == EVDS_OK) {
+				char model[64] = { 0 };
+				EVDS_Variable_GetString(variable,model,63,0);
+				source->has_us76 = strcmp(model,"us76") == 0;
+			}
+		}
+		EVDS_Geodetic_DatumFromObject(&source->datum,source->object);
+
+		//Not enough information to compute gravity, magnetic field, radiation or atmosphere for this planet
+		if ((source->mu != 0.0) || (source->callback) || (source->gradient_callback) || (source->magnetic) || (source->magnetic_callback) ||
+			(source->radiation) || (source->radiation_callback) || (source->atmosphere_callback) || (source->has_us76)) {
+			EVDS_InternalEnvironment_UpdateGravitySource(system,source);
+			source++;
+			system->gravity_sources_count++;
+		}
+		entry = SIMC_List_GetNext(planets,entry);
+	}
+
+	system->gravity_sources_revision = revision;
+	EVDS_InternalEnvironment_BuildSphereOfInfluence(system);
+	return EVDS_InternalEnvironment_BuildGravityTree(system);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Check if table of gravity sources must be recompiled or cached positions updated
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalEnvironment_IsGravityOutdated(EVDS_SYSTEM* system) {
+	int i;
+	if (system->gravity_sources_revision != system->gravity_revision) return 1;
+	for (i = 0; i < system->gravity_sources_count; i++) {
+		EVDS_INTERNAL_GRAVITY_SOURCE* source = &system->gravity_sources[i];
+		if ((!source->is_constant) &&
+			(source->pose_revision != EVDS_InternalEnvironment_GetPoseRevision(source->object))) return 1;
+	}
+	return 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Recompile table of gravity sources and update cached positions if required
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalEnvironment_UpdateGravitySources(EVDS_SYSTEM* system) {
+	int i;
+	int moved = 0;
+	if (system->gravity_sources_revision != system->gravity_revision) {
+		return EVDS_InternalEnvironment_CompileGravitySources(system);
+	}
+	for (i = 0; i < system->gravity_sources_count; i++) {
+		EVDS_INTERNAL_GRAVITY_SOURCE* source = &system->gravity_sources[i];
+		if ((!source->is_constant) &&
+			(source->pose_revision != EVDS_InternalEnvironment_GetPoseRevision(source->object))) {
+			EVDS_InternalEnvironment_UpdateGravitySource(system,source);
+			moved = 1;
+		}
+	}
+
+	//Rebuild hierarchy and octree once all sources moved to their new positions
+	if (moved) {
+		EVDS_InternalEnvironment_BuildSphereOfInfluence(system);
+	}
+	if (moved && system->gravity_tree_count) {
+		return EVDS_InternalEnvironment_BuildGravityTree(system);
+	}
+	return EVDS_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Make sure table of gravity sources is up to date and lock it for reading
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalEnvironment_EnterGravitySources(EVDS_SYSTEM* system) {
+#ifndef EVDS_SINGLETHREADED
+	SIMC_SRW_EnterRead(system->gravity_lock);
+	if (EVDS_InternalEnvironment_IsGravityOutdated(system)) {
+		SIMC_SRW_LeaveRead(system->gravity_lock);
+		SIMC_SRW_EnterWrite(system->gravity_lock);
+		EVDS_InternalEnvironment_UpdateGravitySources(system);
+		SIMC_SRW_LeaveWrite(system->gravity_lock);
+		SIMC_SRW_EnterRead(system->gravity_lock);
+	}
+#else
+	EVDS_InternalEnvironment_UpdateGravitySources(system);
+#endif
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Release read lock on the table of gravity sources
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalEnvironment_LeaveGravitySources(EVDS_SYSTEM* system) {
+#ifndef EVDS_SINGLETHREADED
+	SIMC_SRW_LeaveRead(system->gravity_lock);
+#endif
+}
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Add gravitational field of a single source to the total field
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalEnvironment_AddSourceField(EVDS_INTERNAL_GRAVITY_SOURCE* source, EVDS_VECTOR* position,
+											 EVDS_REAL* total_phi, EVDS_VECTOR* total_field) {
+	EVDS_OBJECT* target_coordinates = position->coordinate_system;
+	EVDS_REAL mu = source->mu;
+	EVDS_REAL j2 = source->j2;
+	EVDS_REAL radius = source->radius;
+	EVDS_REAL rs = source->rs;
+
+	//Initialize temporary vectors
+	EVDS_REAL r2,r;
+	EVDS_VECTOR G0,Gr,Gn,Ga;
+	EVDS_REAL Gphi = 0.0;
+
+	//Constant sources: reinterpret vector as acceleration and add to total field
+	if (source->is_constant) {
+		EVDS_Vector_Add(total_field,total_field,&source->position);
+		*total_phi += 0; // FIXME
+		return;
+	}
+
+#ifndef EVDS_SINGLETHREADED
+	//Planets dont pull themselves (cached position may differ from the private state)
+	if (source->object->integrate_thread == EVDS_InternalThread_GetIntegrateID()) return;
+#endif
+
+	EVDS_Vector_Initialize(G0);
+	EVDS_Vector_Initialize(Gr);
+	EVDS_Vector_Initialize(Gn);
+	EVDS_Vector_Initialize(Ga);
+
+	//Get planet position in position vector coordinates
+	EVDS_Vector_Convert(&G0,&source->position,target_coordinates);
+
+	//Calculate radius-vector
+	EVDS_Vector_Subtract(&Gr,position,&G0);
+	EVDS_Vector_Dot(&r2,&Gr,&Gr);
+	r = sqrt(r2);
+
+	//Check if inside the planet itself
+	if (source->has_radius && (r < radius*0.9)) {
+		return; //Too close to the planet
+	}
+
+	//Check if position of source vector matches with planets position
+	if (r2 < EVDS_EPS) {
+		return; //Planets dont pull themselves
+	}
+
+	//Check if outside of sphere of influence
+	if (source->has_rs && (r2 > rs*rs)) {
+		return; //Too far for gravity to have a meaningful influence
+	}
+
+	//Compute gravity acceleration from custom callback or stock code
+	if (source->callback) {
+		source->callback(source->object,&Gr,&Gphi,&Ga);
+		EVDS_Vector_Add(total_field,total_field,&Ga);
+		*total_phi += Gphi;
+	} else {
+		if (source->harmonics || (source->has_j2 && source->has_radius)) { //Non-spherical model
+			EVDS_VECTOR Gb;
+
+			//Get position in planet body-fixed coordinates
+			EVDS_Vector_Initialize(Gb);
+			EVDS_Vector_Convert(&Gb,position,source->object);
+
+			if (source->grid && EVDS_InternalEnvironment_EvaluateGrid(source->grid,source->harmonics,mu,&Gb,&Gphi,&Ga)) {
+				//Field interpolated from precomputed grid
+			} else if (source->harmonics) {
+				EVDS_InternalEnvironment_EvaluateHarmonics(source->harmonics,mu,&Gb,&Gphi,&Ga);
+			} else {
+				EVDS_REAL z2r2 = (Gb.z*Gb.z)/r2;
+				EVDS_REAL k = (3.0/2.0)*j2*(radius*radius)/r2;
+
+				//Potential
+				Gphi = -(mu/r)*(1 - k*(z2r2 - 1.0/3.0));
+
+				//Acceleration
+				Ga.x = -(mu/(r2*r))*Gb.x*(1 + k*(1 - 5*z2r2));
+				Ga.y = -(mu/(r2*r))*Gb.y*(1 + k*(1 - 5*z2r2));
+				Ga.z = -(mu/(r2*r))*Gb.z*(1 + k*(3 - 5*z2r2));
+			}
+
+			//Rotate acceleration into target coordinates (as a force, to avoid adding fictitious accelerations)
+			Ga.coordinate_system = source->object;
+			Ga.derivative_level = EVDS_VECTOR_FORCE;
+			EVDS_Vector_Convert(&Ga,&Ga,target_coordinates);
+		} else { //Spherical model
+			//Potential
+			Gphi = -mu/r;
+
+			//Acceleration
+			EVDS_Vector_Normalize(&Gn,&Gr);
+			EVDS_Vector_Multiply(&Ga,&Gn,-mu/r2);
+		}
+
+		//Reinterpret vector as acceleration, add to total acceleration
+		Ga.derivative_level = EVDS_VECTOR_ACCELERATION;
+		EVDS_Vector_Add(total_field,total_field,&Ga);
+		*total_phi += Gphi;
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Check if position (in root inertial space) is inside sphere of influence of the source
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalEnvironment_IsInsideSphereOfInfluence(EVDS_INTERNAL_GRAVITY_SOURCE* source, EVDS_VECTOR* root_position) {
+	EVDS_REAL dx = root_position->x - source->position.x;
+	EVDS_REAL dy = root_position->y - source->position.y;
+	EVDS_REAL dz = root_position->z - source->position.z;
+	return dx*dx + dy*dy + dz*dz < source->rs*source->rs;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Add gravitational field of sources in the hierarchy of spheres of influence.
+///
+/// Only sources whose sphere of influence contains the position are evaluated, and
+/// the hierarchy is descended only into such sources.
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalEnvironment_AddHierarchyField(EVDS_SYSTEM* system, int first, EVDS_VECTOR* root_position,
+												EVDS_VECTOR* position, EVDS_REAL* total_phi, EVDS_VECTOR* total_field) {
+	int i;
+	for (i = first; i >= 0; i = system->gravity_sources[i].soi_sibling) {
+		EVDS_INTERNAL_GRAVITY_SOURCE* source = &system->gravity_sources[i];
+		if (!EVDS_InternalEnvironment_IsInsideSphereOfInfluence(source,root_position)) continue;
+
+		EVDS_InternalEnvironment_AddSourceField(source,position,total_phi,total_field);
+		if (source->soi_child >= 0) {
+			EVDS_InternalEnvironment_AddHierarchyField(system,source->soi_child,root_position,position,total_phi,total_field);
+		}
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Find the dominant source (the deepest sphere of influence which contains position).
+///
+/// @returns Index of the source or -1 if position is not inside any sphere of influence
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalEnvironment_GetDominantSource(EVDS_SYSTEM* system, EVDS_VECTOR* root_position) {
+	int i,found,dominant = -1;
+	int first = system->gravity_soi_root;
+
+	while (first >= 0) {
+		found = -1;
+		for (i = first; i >= 0; i = system->gravity_sources[i].soi_sibling) {
+			EVDS_INTERNAL_GRAVITY_SOURCE* source = &system->gravity_sources[i];
+			if (EVDS_InternalEnvironment_IsInsideSphereOfInfluence(source,root_position) &&
+				((found < 0) || (source->rs < system->gravity_sources[found].rs))) found = i;
+		}
+		if (found < 0) break;
+		dominant = found;
+		first = system->gravity_sources[found].soi_child;
+	}
+	return dominant;
+}
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Returns gravitational field in the given position.
+///
+/// This function iterates through all objects which can produce gravitational field.
+/// Gravitational field is defined as:
+/// \f[
+///		\mathbf{g} = \frac{\mathbf{F}}{m} = -\nabla\Phi
+/// \f]
+///
+/// This function searches for objects with the "planet" type. If planet has a custom callback
+/// defined, the callback is used (some planets may provide a more detailed gravitational field
+/// model).
+///
+/// The following variables may be used when computing gravitational field
+/// (only the smallest sufficient set of these variables is required):
+/// Variable			| Description
+/// --------------------|-------------------------------------------------------
+/// mass				| Mass of the planet (in \f$kg\f$)
+/// gravity.mu			| Gravitational parameter of the planet (in \f$m^3 s^{-2}\f$)
+/// gravity.j2			| Second spherical harmonic \f$J_2\f$
+/// gravity.rs			| Sphere of influence
+/// gravity.harmonics	| Table of fully normalized spherical harmonics coefficients
+/// gravity.harmonics_degree | Truncation degree of the spherical harmonics model (entire table by default)
+/// gravity.harmonics_radius | Reference radius of the spherical harmonics model (planet radius by default)
+/// gravity.grid_resolution | Angular step of the precomputed gravity grid in degrees (grid is not used if not defined)
+/// gravity.grid_radial_resolution | Radial step of the precomputed gravity grid (same as angular step by default)
+/// gravity.grid_altitude | Highest altitude covered by the precomputed gravity grid (2000 km by default)
+/// geometry.radius		| Planet radius (required if 'j2' is specified)
+/// gravitational_field | Function pointer to EVDS_Callback_GetGravitationalField
+///
+/// Gravitational field is returned as an acceleration vector in same coordinates as position.
+/// If sphere of influence is defined, gravitational calculations for this planet will be omitted
+/// when an object is outside of this sphere. This may be unwanted if small perturbations must
+/// be accounted for.
+///
+/// Planets with spheres of influence form a hierarchy (a moon is a child of the planet whose
+/// sphere of influence contains it). The hierarchy is rebuilt when planets move, and it is
+/// descended only into spheres which contain the position, so each position is evaluated only
+/// against its dominant body, its ancestors and planets without a sphere of influence. See
+/// EVDS_Environment_UpdatePatchedFrames() for moving vessels between frames of dominant bodies.
+///
+/// Additionally the gravitational potential field in the current location is returned, unless
+/// no pointer to write the value back is given.
+///
+/// The following equations are used for planets with spherical gravity:
+/// \f{eqnarray*}{
+///		\Phi &=& \frac{\mu}{r} \\
+///		\mathbf{g} &=& -\frac{\mu}{r^2}
+/// \f}
+///
+/// If table of spherical harmonics coefficients is specified, the spherical harmonics
+/// are used to calculate total gravitational field:
+/// \f{eqnarray*}{
+///		\Phi &=& -\frac{\mu}{r}[1 + 
+///			\sum\limits_{n=2}^N (\frac{R}{r})^n
+///			\sum\limits_{m=0}^n \bar{P}_{nm} sin(\theta)
+///				[\bar{C}_{nm} cos(m \lambda) + \bar{S}_{nm} sin(m \lambda)]
+///			] \\
+///		\mathbf{g} &=& -\nabla\Phi
+/// \f}
+/// where:
+///  - \f$R\f$ is the reference radius of the gravity model.
+///  - \f$\bar{P}_{nm}\f$ is the fully normalized Legendre associated function.
+///  - \f$\bar{C}_{nm}\f$, \f$\bar{S}_{nm}\f$ are the fully normalized spherical harmonics.
+///  - \f$\theta\f$ is the geocentric latitude (in planet body-fixed coordinates).
+///  - \f$\lambda\f$ is the geocentric longitude (in planet body-fixed coordinates).
+///
+/// The field is evaluated with fully normalized Cunningham recursions. All recursion
+/// coefficients are precomputed when the planet is added to the table of gravity sources.
+/// Coefficients are specified as a string table with "n m C S" entries per line (EGM and
+/// ICGEM @c gfc formats are accepted, see EVDS_InternalEnvironment_ReadHarmonicsLine()):
+/// ~~~{.xml}
+///	<parameter name="gravity.harmonics" type="string">
+///		2 0 -0.484165143790815D-03 0.0
+///		2 1 -0.206615509074176D-09 0.138441389137979D-08
+///		...
+///	</parameter>
+///	<parameter name="gravity.harmonics_degree">70</parameter>
+///	<parameter name="gravity.harmonics_radius">6378136.3</parameter>
+/// ~~~
+///
+/// Evaluating a high-degree model is expensive, so it may be replaced with a precomputed
+/// grid of shells around the planet (see EVDS_InternalEnvironment_EvaluateGrid()). Blocks of
+/// the grid are built only in regions where the field is actually evaluated.
+///
+/// If only the \f$J_2\f$ factor is specified, a simplified model is used:
+/// \f{eqnarray*}{
+///		\Phi &=& -\frac{\mu}{r}\left[1 - \frac{3}{2} J_2 (\frac{R}{r})^2
+///			\left(\frac{z^2}{r^2} - \frac{1}{3}\right) \right] \\
+///		\mathbf{g}_x &=& -\frac{\mu x}{r^3}\left[1 + \frac{3}{2} J_2 (\frac{R}{r})^2
+///			\left(1 - 5\frac{z^2}{r^2}\right) \right] \\
+///		\mathbf{g}_y &=& -\frac{\mu y}{r^3}\left[1 + \frac{3}{2} J_2 (\frac{R}{r})^2
+///			\left(1 - 5\frac{z^2}{r^2}\right) \right] \\
+///		\mathbf{g}_z &=& -\frac{\mu z}{r^3}\left[1 + \frac{3}{2} J_2 (\frac{R}{r})^2
+///			\left(3 - 5\frac{z^2}{r^2}\right) \right]
+/// \f}
+///
+///
+/// These are the suggested values for solar system major bodies:
+/// Name	| Mass (kg)						| \f$J_2\f$
+/// --------|-------------------------------|----------------
+/// Sun		| \f$1.99 \cdot 10^{30}\f$		| N/A
+/// Mercury | \f$3.30 \cdot 10^{23}\f$		| \f$60 \cdot 10^{-6}\f$
+/// Venus	| \f$4.87 \cdot 10^{24}\f$		| \f$4.458 \cdot 10^{-6}\f$
+/// Earth	| \f$5.97 \cdot 10^{24}\f$		| \f$1.08263 \cdot 10^{-3}\f$
+/// Mars	| \f$6.42 \cdot 10^{23}\f$		| \f$1.96045 \cdot 10^{-3}\f$
+/// Jupiter	| \f$1.90 \cdot 10^{27}\f$		| \f$14.736 \cdot 10^{-3}\f$
+/// Saturn	| \f$5.68 \cdot 10^{26}\f$		| \f$16.298 \cdot 10^{-3}\f$
+/// Uranus	| \f$8.68 \cdot 10^{25}\f$		| \f$3.34343 \cdot 10^{-3}\f$
+/// Neptune	| \f$1.02 \cdot 10^{26}\f$		| \f$3.411 \cdot 10^{-3}\f$
+/// Moon	| \f$7.35 \cdot 10^{22}\f$		| \f$202.7 \cdot 10^{-6}\f$
+///
+/// @param[in] system Pointer to the system object
+/// @param[in] position Position, in which gravity field must be calculated
+/// @param[out] field Total gravitational field in the position
+///
+/// @returns Error code
+/// @retval EVDS_OK Completed successfully
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_Environment_GetGravitationalField(EVDS_SYSTEM* system, EVDS_VECTOR* position, EVDS_REAL* phi, EVDS_VECTOR* field) {
+	int i;
+	EVDS_OBJECT* target_coordinates;
+	EVDS_VECTOR total_field,root_position;
+	EVDS_REAL total_phi;
+
+	//Check input
+	if (!system) return EVDS_ERROR_BAD_PARAMETER;
+	if (!position) return EVDS_ERROR_BAD_PARAMETER;
+	target_coordinates = position->coordinate_system;
+
+	//Start accumulating total field and potential
+	EVDS_Vector_Set(&total_field,EVDS_VECTOR_ACCELERATION,target_coordinates,0.0,0.0,0.0);
+	total_phi = 0.0;
+
+	//Make sure table of gravity sources is up to date
+	EVDS_InternalEnvironment_EnterGravitySources(system);
+
+	//Position in root inertial space (for the octree and spheres of influence)
+	if ((system->gravity_tree_count > 0) || (system->gravity_soi_root >= 0)) {
+		EVDS_Vector_Initialize(root_position);
+		EVDS_Vector_Convert(&root_position,position,system->inertial_space);
+	}
+
+	//Add field of point masses approximated with an octree
+	if (system->gravity_tree_count > 0) {
+		EVDS_VECTOR Gt;
+		EVDS_REAL Gphi = 0.0;
+		EVDS_Vector_Set(&Gt,EVDS_VECTOR_FORCE,system->inertial_space,0.0,0.0,0.0);
+		EVDS_InternalEnvironment_EvaluateTree(system,&root_position,&Gphi,&Gt);
+
+		//Rotate acceleration into target coordinates (as a force, to avoid adding fictitious accelerations)
+		EVDS_Vector_Convert(&Gt,&Gt,target_coordinates);
+		Gt.derivative_level = EVDS_VECTOR_ACCELERATION;
+		EVDS_Vector_Add(&total_field,&total_field,&Gt);
+		total_phi += Gphi;
+	}
+
+	//Iterate through gravity sources outside of the hierarchy of spheres of influence
+	for (i = 0; i < system->gravity_sources_count; i++) {
+		EVDS_INTERNAL_GRAVITY_SOURCE* source = &system->gravity_sources[i];
+		if (source->in_tree) continue; //Point masses evaluated through the octree
+		if ((!source->is_constant) && source->has_rs) continue; //Evaluated through the hierarchy
+		EVDS_InternalEnvironment_AddSourceField(source,position,&total_phi,&total_field);
+	}
+
+	//Descend the hierarchy of spheres of influence
+	if (system->gravity_soi_root >= 0) {
+		EVDS_InternalEnvironment_AddHierarchyField(system,system->gravity_soi_root,&root_position,position,&total_phi,&total_field);
+	}
+	EVDS_InternalEnvironment_LeaveGravitySources(system);
+
+	//Write back information
+	if (phi) *phi = total_phi;
+	if (field) EVDS_Vector_Copy(field,&total_field);
+	return EVDS_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Get transformation of coordinates from one object to another.
+///
+/// Returns origin of the source object and its axes in target coordinates, so that
+/// \f$\mathbf{p}_{target} = \mathbf{o} + \sum_k p_k \mathbf{a}_k\f$.
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalEnvironment_GetFrameTransform(EVDS_OBJECT* source, EVDS_OBJECT* target,
+												EVDS_REAL* origin, EVDS_REAL* axes) {
+	EVDS_VECTOR v;
+	int k;
+
+	EVDS_Vector_Set(&v,EVDS_VECTOR_POSITION,source,0.0,0.0,0.0);
+	EVDS_Vector_Convert(&v,&v,target);
+	origin[0] = v.x;
+	origin[1] = v.y;
+	origin[2] = v.z;
+	for (k = 0; k < 3; k++) {
+		EVDS_Vector_Set(&v,EVDS_VECTOR_DIRECTION,source,k == 0,k == 1,k == 2);
+		EVDS_Vector_Convert(&v,&v,target);
+		axes[3*k+0] = v.x;
+		axes[3*k+1] = v.y;
+		axes[3*k+2] = v.z;
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Add gravitational field of a single source to the field in many points.
+///
+/// Positions and accumulated values are stored as separate arrays of coordinates. Frame
+/// conversions are done once per source, and the loop for spherical sources has no
+/// branches, so it can be vectorized by the compiler.
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalEnvironment_AddSourceFieldMany(EVDS_SYSTEM* system, EVDS_INTERNAL_GRAVITY_SOURCE* source,
+												 EVDS_OBJECT* target_coordinates, int count,
+												 EVDS_REAL* x, EVDS_REAL* y, EVDS_REAL* z,
+												 EVDS_REAL* rx, EVDS_REAL* ry, EVDS_REAL* rz, EVDS_REAL* w,
+												 EVDS_REAL* phi, EVDS_REAL* gx, EVDS_REAL* gy, EVDS_REAL* gz) {
+	int i,k;
+	EVDS_VECTOR G0;
+	EVDS_REAL mu = source->mu;
+	EVDS_REAL min_r2 = source->has_radius ? (0.9*source->radius)*(0.9*source->radius) : 0.0;
+	EVDS_REAL max_r2 = source->has_rs ? source->rs*source->rs : 1e300;
+
+	//Points outside of sphere of influence of the source or its ancestors are not evaluated
+	for (i = 0; i < count; i++) w[i] = 1.0;
+	if (source->has_rs) {
+		for (i = 0; i < count; i++) {
+			EVDS_VECTOR root_position;
+			root_position.x = rx[i];
+			root_position.y = ry[i];
+			root_position.z = rz[i];
+			for (k = (int)(source - system->gravity_sources); k >= 0; k = system->gravity_sources[k].soi_parent) {
+				if (!EVDS_InternalEnvironment_IsInsideSphereOfInfluence(&system->gravity_sources[k],&root_position)) {
+					w[i] = 0.0;
+					break;
+				}
+			}
+		}
+	}
+
+	//Get planet position in target coordinates
+	EVDS_Vector_Initialize(G0);
+	EVDS_Vector_Convert(&G0,&source->position,target_coordinates);
+
+	if (source->callback) { //Custom callback
+		for (i = 0; i < count; i++) {
+			EVDS_VECTOR Gr,Ga,total_field;
+			EVDS_REAL r2,Gphi = 0.0;
+
+			EVDS_Vector_Set(&Gr,EVDS_VECTOR_POSITION,target_coordinates,x[i]-G0.x,y[i]-G0.y,z[i]-G0.z);
+			r2 = Gr.x*Gr.x + Gr.y*Gr.y + Gr.z*Gr.z;
+			if ((w[i] == 0.0) || (r2 < min_r2) || (r2 < EVDS_EPS) || (r2 > max_r2)) continue;
+
+			EVDS_Vector_Initialize(Ga);
+			EVDS_Vector_Set(&total_field,EVDS_VECTOR_ACCELERATION,target_coordinates,0.0,0.0,0.0);
+			source->callback(source->object,&Gr,&Gphi,&Ga);
+			EVDS_Vector_Add(&total_field,&total_field,&Ga);
+			phi[i] += Gphi;
+			gx[i] += total_field.x;
+			gy[i] += total_field.y;
+			gz[i] += total_field.z;
+		}
+	} else if (source->harmonics || (source->has_j2 && source->has_radius)) { //Non-spherical model
+		EVDS_REAL origin[3],axes[9];
+		EVDS_InternalEnvironment_GetFrameTransform(source->object,target_coordinates,origin,axes);
+
+		for (i = 0; i < count; i++) {
+			EVDS_VECTOR Gb,Ga;
+			EVDS_REAL r2,r,Gphi = 0.0;
+			EVDS_REAL dx = x[i]-G0.x;
+			EVDS_REAL dy = y[i]-G0.y;
+			EVDS_REAL dz = z[i]-G0.z;
+			r2 = dx*dx + dy*dy + dz*dz;
+			if ((w[i] == 0.0) || (r2 < min_r2) || (r2 < EVDS_EPS) || (r2 > max_r2)) continue;
+			r = sqrt(r2);
+
+			//Radius-vector from the origin of planet body-fixed coordinates
+			dx = x[i]-origin[0];
+			dy = y[i]-origin[1];
+			dz = z[i]-origin[2];
+
+			//Position in planet body-fixed coordinates
+			EVDS_Vector_Set(&Gb,EVDS_VECTOR_POSITION,source->object,
+				dx*axes[0] + dy*axes[1] + dz*axes[2],
+				dx*axes[3] + dy*axes[4] + dz*axes[5],
+				dx*axes[6] + dy*axes[7] + dz*axes[8]);
+			EVDS_Vector_Initialize(Ga);
+
+			if (source->grid && EVDS_InternalEnvironment_EvaluateGrid(source->grid,source->harmonics,mu,&Gb,&Gphi,&Ga)) {
+				//Field interpolated from precomputed grid
+			} else if (source->harmonics) {
+				EVDS_InternalEnvironment_EvaluateHarmonics(source->harmonics,mu,&Gb,&Gphi,&Ga);
+			} else {
+				EVDS_REAL z2r2 = (Gb.z*Gb.z)/r2;
+				EVDS_REAL k2 = (3.0/2.0)*source->j2*(source->radius*source->radius)/r2;
+
+				Gphi = -(mu/r)*(1 - k2*(z2r2 - 1.0/3.0));
+				Ga.x = -(mu/(r2*r))*Gb.x*(1 + k2*(1 - 5*z2r2));
+				Ga.y = -(mu/(r2*r))*Gb.y*(1 + k2*(1 - 5*z2r2));
+				Ga.z = -(mu/(r2*r))*Gb.z*(1 + k2*(3 - 5*z2r2));
+			}
+
+			//Rotate acceleration into target coordinates
+			phi[i] += Gphi;
+			gx[i] += Ga.x*axes[0] + Ga.y*axes[3] + Ga.z*axes[6];
+			gy[i] += Ga.x*axes[1] + Ga.y*axes[4] + Ga.z*axes[7];
+			gz[i] += Ga.x*axes[2] + Ga.y*axes[5] + Ga.z*axes[8];
+		}
+	} else { //Spherical model
+		for (i = 0; i < count; i++) {
+			EVDS_REAL dx = x[i]-G0.x;
+			EVDS_REAL dy = y[i]-G0.y;
+			EVDS_REAL dz = z[i]-G0.z;
+			EVDS_REAL r2 = dx*dx + dy*dy + dz*dz;
+			EVDS_REAL inside = ((w[i] != 0.0) && (r2 >= min_r2) && (r2 >= EVDS_EPS) && (r2 <= max_r2)) ? 1.0 : 0.0;
+			EVDS_REAL inv_r = inside/sqrt(r2 + (1.0 - inside));
+			EVDS_REAL k = mu*inv_r*inv_r*inv_r;
+
+			phi[i] -= mu*inv_r;
+			gx[i] -= k*dx;
+			gy[i] -= k*dy;
+			gz[i] -= k*dz;
+		}
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Returns gravitational field in many positions at once.
+///
+/// Produces the same result as calling EVDS_Environment_GetGravitationalField() for every
+/// position, but the table of gravity sources is locked and checked once, all frame
+/// conversions are done once per gravity source, and the field of spherical sources is
+/// accumulated in a branch-free loop over arrays of coordinates (which is vectorized by
+/// the compiler).
+///
+/// This should be used when field is required in many points at once (for example, mass
+/// samples of a body for computing gravity gradient torque, beads of a discretized tether,
+/// or members of an ensemble).
+///
+/// All fields are returned in coordinates of the first position. Positions specified in
+/// other coordinate systems are converted into these coordinates first.
+///
+/// @param[in] system Pointer to the system object
+/// @param[in] positions Array of positions in which gravity field must be calculated
+/// @param[in] count Number of positions
+/// @param[out] phi Array of gravitational potentials (may be null)
+/// @param[out] field Array of gravitational fields (may be null)
+///
+/// @returns Error code
+/// @retval EVDS_OK Completed successfully
+/// @retval EVDS_ERROR_BAD_PARAMETER "system" is null
+/// @retval EVDS_ERROR_BAD_PARAMETER "positions" is null
+/// @retval EVDS_ERROR_BAD_PARAMETER "count" is negative
+/// @retval EVDS_ERROR_MEMORY Unable to allocate temporary arrays
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_Environment_GetGravitationalFieldMany(EVDS_SYSTEM* system, EVDS_VECTOR* positions, int count,
+											   EVDS_REAL* phi, EVDS_VECTOR* field) {
+	int i,j;
+	EVDS_OBJECT* target_coordinates;
+	EVDS_REAL *block,*x,*y,*z,*rx,*ry,*rz,*w,*gphi,*gx,*gy,*gz;
+	EVDS_REAL origin[3],axes[9];
+
+	//Check input
+	if (!system) return EVDS_ERROR_BAD_PARAMETER;
+	if (!positions) return EVDS_ERROR_BAD_PARAMETER;
+	if (count < 0) return EVDS_ERROR_BAD_PARAMETER;
+	if (count == 0) return EVDS_OK;
+	target_coordinates = positions[0].coordinate_system;
+
+	//Allocate arrays of coordinates and accumulated values
+	block = (EVDS_REAL*)malloc(sizeof(EVDS_REAL)*count*11);
+	if (!block) return EVDS_ERROR_MEMORY;
+	x = block;		y = x + count;		z = y + count;
+	rx = z + count;	ry = rx + count;	rz = ry + count;
+	w = rz + count;	gphi = w + count;
+	gx = gphi + count; gy = gx + count;	gz = gy + count;
+
+	//Read positions in target coordinates
+	for (i = 0; i < count; i++) {
+		if (positions[i].coordinate_system != target_coordinates) {
+			EVDS_VECTOR position;
+			EVDS_Vector_Initialize(position);
+			EVDS_Vector_Convert(&position,&positions[i],target_coordinates);
+			x[i] = position.x;
+			y[i] = position.y;
+			z[i] = position.z;
+		} else {
+			x[i] = positions[i].x;
+			y[i] = positions[i].y;
+			z[i] = positions[i].z;
+		}
+		gphi[i] = gx[i] = gy[i] = gz[i] = 0.0;
+	}
+
+	//Make sure table of gravity sources is up to date
+	EVDS_InternalEnvironment_EnterGravitySources(system);
+
+	//Positions in root inertial space (for the octree and spheres of influence)
+	if ((system->gravity_tree_count > 0) || (system->gravity_soi_root >= 0)) {
+		EVDS_InternalEnvironment_GetFrameTransform(target_coordinates,system->inertial_space,origin,axes);
+		for (i = 0; i < count; i++) {
+			rx[i] = origin[0] + x[i]*axes[0] + y[i]*axes[3] + z[i]*axes[6];
+			ry[i] = origin[1] + x[i]*axes[1] + y[i]*axes[4] + z[i]*axes[7];
+			rz[i] = origin[2] + x[i]*axes[2] + y[i]*axes[5] + z[i]*axes[8];
+		}
+	}
+
+	//Add field of point masses approximated with an octree
+	if (system->gravity_tree_count > 0) {
+		for (i = 0; i < count; i++) {
+			EVDS_VECTOR root_position,Gt;
+			EVDS_REAL Gphi = 0.0;
+			EVDS_Vector_Set(&root_position,EVDS_VECTOR_POSITION,system->inertial_space,rx[i],ry[i],rz[i]);
+			EVDS_Vector_Set(&Gt,EVDS_VECTOR_FORCE,system->inertial_space,0.0,0.0,0.0);
+			EVDS_InternalEnvironment_EvaluateTree(system,&root_position,&Gphi,&Gt);
+
+			//Rotate acceleration into target coordinates
+			gphi[i] += Gphi;
+			gx[i] += Gt.x*axes[0] + Gt.y*axes[1] + Gt.z*axes[2];
+			gy[i] += Gt.x*axes[3] + Gt.y*axes[4] + Gt.z*axes[5];
+			gz[i] += Gt.x*axes[6] + Gt.y*axes[7] + Gt.z*axes[8];
+		}
+	}
+
+	//Iterate through all gravity sources
+	for (j = 0; j < system->gravity_sources_count; j++) {
+		EVDS_INTERNAL_GRAVITY_SOURCE* source = &system->gravity_sources[j];
+		if (source->in_tree) continue; //Point masses evaluated through the octree
+
+		//Constant sources: same acceleration in all positions
+		if (source->is_constant) {
+			EVDS_VECTOR Ga;
+			EVDS_Vector_Initialize(Ga);
+			EVDS_Vector_Convert(&Ga,&source->position,target_coordinates);
+			for (i = 0; i < count; i++) {
+				gx[i] += Ga.x;
+				gy[i] += Ga.y;
+				gz[i] += Ga.z;
+			}
+			continue;
+		}
+
+#ifndef EVDS_SINGLETHREADED
+		//Planets dont pull themselves (cached position may differ from the private state)
+		if (source->object->integrate_thread == EVDS_InternalThread_GetIntegrateID()) continue;
+#endif
+		EVDS_InternalEnvironment_AddSourceFieldMany(system,source,target_coordinates,count,
+			x,y,z,rx,ry,rz,w,gphi,gx,gy,gz);
+	}
+	EVDS_InternalEnvironment_LeaveGravitySources(system);
+
+	//Write back information
+	for (i = 0; i < count; i++) {
+		if (phi) phi[i] = gphi[i];
+		if (field) EVDS_Vector_Set(&field[i],EVDS_VECTOR_ACCELERATION,target_coordinates,gx[i],gy[i],gz[i]);
+	}
+	free(block);
+	return EVDS_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Returns gravity gradient torque upon a rigid body.
+///
+/// Gravity gradient torque is computed in closed form from the total inertia tensor of the
+/// body, so it costs only a few operations per planet (regardless of how many parts the
+/// body consists of):
+/// \f[
+///		\mathbf{T} = \sum \frac{3\mu}{r^3} \hat{\mathbf{r}} \times (I \cdot \hat{\mathbf{r}})
+/// \f]
+/// where:
+///  - \f$\mu\f$ is the gravitational parameter of the planet.
+///  - \f$\mathbf{r}\f$ is the radius-vector from the planet to the center of mass of the body.
+///  - \f$I\f$ is the inertia tensor of the body.
+///
+/// Same checks as in EVDS_Environment_GetGravitationalField() are used to skip planets which
+/// do not affect the body. Constant gravity sources produce no gravity gradient. Point masses
+/// which are approximated with the octree in the gravitational field are summed directly here,
+/// since a nearby massive body may dominate the gradient.
+///
+/// Planet may override the stock model with a custom callback stored in the
+/// "gravity_gradient_torque" function pointer variable (see EVDS_Callback_GetGravityGradientTorque).
+/// The callback receives the radius-vector from planet to center of mass of the body in
+/// coordinates of the body (so the body can be found from the coordinate system of the
+/// vector), and must return torque in the same coordinates.
+///
+/// @param[in] system Pointer to the system object
+/// @param[in] position Center of mass of the body (in body coordinates)
+/// @param[in] Ix First row of the inertia tensor (in same coordinates as position)
+/// @param[in] Iy Second row of the inertia tensor
+/// @param[in] Iz Third row of the inertia tensor
+/// @param[out] torque Total gravity gradient torque (in same coordinates as position)
+///
+/// @returns Error code
+/// @retval EVDS_OK Completed successfully
+/// @retval EVDS_ERROR_BAD_PARAMETER "system" is null
+/// @retval EVDS_ERROR_BAD_PARAMETER "position" is null
+/// @retval EVDS_ERROR_BAD_PARAMETER Inertia tensor is not specified
+/// @retval EVDS_ERROR_BAD_PARAMETER "torque" is null
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief Returns gravitational field in the given position.
+int EVDS_Environment_GetGravityGradientTorque(EVDS_SYSTEM* system, EVDS_VECTOR* position,
+											  EVDS_VECTOR* Ix, EVDS_VECTOR* Iy, EVDS_VECTOR* Iz, EVDS_VECTOR* torque) {
+	int i;
+	EVDS_OBJECT* target_coordinates;
+	EVDS_VECTOR total_torque;
+
+	//Check input
+	if (!system) return EVDS_ERROR_BAD_PARAMETER;
+	if (!position) return EVDS_ERROR_BAD_PARAMETER;
+	if ((!Ix) || (!Iy) || (!Iz)) return EVDS_ERROR_BAD_PARAMETER;
+	if (!torque) return EVDS_ERROR_BAD_PARAMETER;
+	target_coordinates = position->coordinate_system;
+
+	//Start accumulating total torque
+	EVDS_Vector_Set(&total_torque,EVDS_VECTOR_TORQUE,target_coordinates,0.0,0.0,0.0);
+
+	//Make sure table of gravity sources is up to date
+	EVDS_InternalEnvironment_EnterGravitySources(system);
+	for (i = 0; i < system->gravity_sources_count; i++) {
+		EVDS_INTERNAL_GRAVITY_SOURCE* source = &system->gravity_sources[i];
+		EVDS_VECTOR G0,Gr,Gn,In,T;
+		EVDS_REAL r2,r;
+
+		//Constant sources have no gradient
+		if (source->is_constant) continue;
+		if ((source->mu == 0.0) && (!source->gradient_callback)) continue;
+
+#ifndef EVDS_SINGLETHREADED
+		//Planets dont pull themselves (cached position may differ from the private state)
+		if (source->object->integrate_thread == EVDS_InternalThread_GetIntegrateID()) continue;
+#endif
+
+		//Get radius-vector from planet to the body
+		EVDS_Vector_Initialize(G0);
+		EVDS_Vector_Initialize(Gr);
+		EVDS_Vector_Convert(&G0,&source->position,target_coordinates);
+		EVDS_Vector_Subtract(&Gr,position,&G0);
+		EVDS_Vector_Dot(&r2,&Gr,&Gr);
+		r = sqrt(r2);
+
+		//Skip planets which do not affect the body
+		if (source->has_radius && (r < source->radius*0.9)) continue;
+		if (r2 < EVDS_EPS) continue;
+		if (source->has_rs && (r2 > source->rs*source->rs)) continue;
+
+		//Compute torque from custom callback or stock code
+		EVDS_Vector_Set(&T,EVDS_VECTOR_TORQUE,target_coordinates,0.0,0.0,0.0);
+		if (source->gradient_callback) {
+			source->gradient_callback(source->object,&Gr,&T);
+		} else {
+			EVDS_Vector_Initialize(Gn);
+			EVDS_Vector_Initialize(In);
+			EVDS_Vector_Normalize(&Gn,&Gr);
+			EVDS_Tensor_MultiplyByVector(&In,Ix,Iy,Iz,&Gn); //I*r
+			EVDS_Vector_Cross(&T,&Gn,&In); //r x (I*r)
+			EVDS_Vector_Multiply(&T,&T,3.0*source->mu/(r2*r));
+		}
+
+		//Reinterpret vector as torque, add to total torque
+		T.derivative_level = EVDS_VECTOR_TORQUE;
+		EVDS_Vector_Add(&total_torque,&total_torque,&T);
+	}
+	EVDS_InternalEnvironment_LeaveGravitySources(system);
+
+	//Write back information
+	EVDS_Vector_Copy(torque,&total_torque);
+	return EVDS_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Set parameters of the Barnes-Hut approximation of gravitational field.
 ///
-/// This function iterates through all objects which can produce gravitational field.
-/// Gravitational field is defined as:
-/// \f[
-///		\mathbf{g} = \frac{\mathbf{F}}{m} = -\nabla\Phi
-/// \f]
+/// If there are at least @c threshold planets which are simple point masses (no custom callbacks,
+/// harmonics, \f$J_2\f$ or sphere of influence), they are sorted into an octree. Groups of planets
+/// which are seen at an angle smaller than @c opening_angle (in radians, size of the group
+/// divided by distance to it) are replaced by a single point mass, reducing cost of
+/// EVDS_Environment_GetGravitationalField() from \f$O(N)\f$ to \f$O(log N)\f$.
 ///
-/// This function searches for objects with the "planet" type. If planet has a custom callback
-/// defined, the callback is used (some planets may provide a more detailed gravitational field
-/// model).
+/// The octree is rebuilt when planets move, so it is rebuilt at most once per system step.
+/// By default opening angle is 0.5 and threshold is 256 planets. Setting opening angle to zero
+/// disables the approximation.
 ///
-/// The following variables may be used when computing gravitational field
-/// (only the smallest sufficient set of these variables is required):
-/// Variable			| Description
-/// --------------------|-------------------------------------------------------
-/// mass				| Mass of the planet (in \f$kg\f$)
-/// gravity.mu			| Gravitational parameter of the planet (in \f$m^3 s^{-2}\f$)
-/// gravity.j2			| Second spherical harmonic \f$J_2\f$
-/// gravity.rs			| Sphere of influence
-/// geometry.radius		| Planet radius (required if 'j2' is specified)
-/// gravitational_field | Function pointer to EVDS_Callback_GetGravitationalField
+/// @param[in] system Pointer to the system object
+/// @param[in] opening_angle Opening angle (0 to always use direct summation)
+/// @param[in] threshold Smallest number of point masses for which the approximation is used
 ///
-/// Gravitational field is returned as an acceleration vector in same coordinates as position.
-/// If sphere of influence is defined, gravitational calculations for this planet will be omitted
-/// when an object is outside of this sphere. This may be unwanted if small perturbations must
-/// be accounted for.
+/// @returns Error code
+/// @retval EVDS_OK Completed successfully
+/// @retval EVDS_ERROR_BAD_PARAMETER "system" is null
+/// @retval EVDS_ERROR_BAD_PARAMETER "opening_angle" is negative
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_Environment_SetGravityApproximation(EVDS_SYSTEM* system, EVDS_REAL opening_angle, int threshold) {
+	if (!system) return EVDS_ERROR_BAD_PARAMETER;
+	if (opening_angle < 0.0) return EVDS_ERROR_BAD_PARAMETER;
+
+#ifndef EVDS_SINGLETHREADED
+	SIMC_SRW_EnterWrite(system->gravity_lock);
+#endif
+	system->gravity_opening_angle = opening_angle;
+	system->gravity_tree_threshold = threshold;
+	system->gravity_revision++;
+#ifndef EVDS_SINGLETHREADED
+	SIMC_SRW_LeaveWrite(system->gravity_lock);
+#endif
+	return EVDS_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Returns the dominant body in the given position.
 ///
-/// Additionally the gravitational potential field in the current location is returned, unless
-/// no pointer to write the value back is given.
+/// Dominant body is the planet with the smallest sphere of influence ("gravity.rs" variable)
+/// which contains the position (see EVDS_Environment_GetGravitationalField()).
 ///
-/// The following equations are used for planets with spherical gravity:
-/// \f{eqnarray*}{
-///		\Phi &=& \frac{\mu}{r} \\
-///		\mathbf{g} &=& -\frac{\mu}{r^2}
-/// \f}
+/// @param[in] system Pointer to the system object
+/// @param[in] position Position for which dominant body must be found
+/// @param[out] p_planet Pointer to the dominant body will be written here
 ///
-/// If perturbation factor \f$J_2\f$ is specified, the spherical harmonics are used to calculate
-/// total gravitational field:
-/// \f{eqnarray*}{
-///		\Phi &=& -\frac{\mu}{r}[1 + 
-///			\sum\limits_{n=2}^\infty (\frac{R}{\mu})^n
-///			\sum\limits_{m=0}^n P_{nm} sin(\theta)
-///				[C_{nm} cos(m \lambda) + S_{nm} sin(m \lambda)]
-///			] \\
-///		\mathbf{g} &=& -\nabla\Phi
-/// \f}
-/// where:
-///  - \f$R\f$ is the planets radius.
-///  - \f$P_{nm}\f$ is the Legendre associated function.
-///  - \f$C_{nm}\f$, \f$S_{nm}\f$ are the spherical harmonics.
-///  - \f$\theta\f$ is the geocentric latitude.
-///  - \f$\lambda\f$ is the geocentric longitude.
+/// @returns Error code
+/// @retval EVDS_OK Completed successfully
+/// @retval EVDS_ERROR_BAD_PARAMETER "system" is null
+/// @retval EVDS_ERROR_BAD_PARAMETER "position" is null
+/// @retval EVDS_ERROR_BAD_PARAMETER "p_planet" is null
+/// @retval EVDS_ERROR_NOT_FOUND Position is not inside any sphere of influence
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_Environment_GetDominantBody(EVDS_SYSTEM* system, EVDS_VECTOR* position, EVDS_OBJECT** p_planet) {
+	int dominant;
+	EVDS_VECTOR root_position;
+	if (!system) return EVDS_ERROR_BAD_PARAMETER;
+	if (!position) return EVDS_ERROR_BAD_PARAMETER;
+	if (!p_planet) return EVDS_ERROR_BAD_PARAMETER;
+
+	EVDS_Vector_Initialize(root_position);
+	EVDS_Vector_Convert(&root_position,position,system->inertial_space);
+
+	EVDS_InternalEnvironment_EnterGravitySources(system);
+	dominant = EVDS_InternalEnvironment_GetDominantSource(system,&root_position);
+	*p_planet = (dominant >= 0) ? system->gravity_sources[dominant].object : 0;
+	EVDS_InternalEnvironment_LeaveGravitySources(system);
+
+	if (!(*p_planet)) return EVDS_ERROR_NOT_FOUND;
+	return EVDS_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Find propagator which is a direct child of the object
+////////////////////////////////////////////////////////////////////////////////
+EVDS_OBJECT* EVDS_InternalEnvironment_GetPropagatorFrame(EVDS_OBJECT* object) {
+	SIMC_LIST* children;
+	SIMC_LIST_ENTRY* entry;
+	EVDS_OBJECT* propagator = 0;
+
+	EVDS_Object_GetChildren(object,&children);
+	entry = SIMC_List_GetFirst(children);
+	while (entry) {
+		EVDS_OBJECT* child = (EVDS_OBJECT*)SIMC_List_GetData(children,entry);
+		if (EVDS_Object_CheckType(child,"propagator*") == EVDS_OK) {
+			propagator = child;
+			SIMC_List_Stop(children,entry);
+			break;
+		}
+		entry = SIMC_List_GetNext(children,entry);
+	}
+	return propagator;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Move vessels into propagator frames of their dominant bodies (patched frames).
+///
+/// Every vessel which is a direct child of a propagator is checked against the hierarchy of
+/// spheres of influence. If its dominant body (or the closest ancestor of the dominant body
+/// in the hierarchy) contains a propagator as a direct child, the vessel is moved under that
+/// propagator with EVDS_Object_SetParent(). Vessels stay where they are if no such propagator
+/// exists.
+///
+/// Changing the frame of a vessel when it enters a sphere of influence keeps its state vector
+/// small relative to the body it orbits, which improves numerical conditioning for
+/// interplanetary scenarios. Vessels are not gravity sources, so moving them between frames
+/// keeps the compiled table of gravity sources (unless a vessel carries a planet among its children).
+///
+/// Must be called by user between integration steps (same as EVDS_RigidBody_UpdateDetaching()).
+///
+/// @param[in] system Pointer to the system object
+///
+/// @returns Error code
+/// @retval EVDS_OK Completed successfully
+/// @retval EVDS_ERROR_BAD_PARAMETER "system" is null
+/// @retval EVDS_ERROR_MEMORY Unable to allocate temporary list of vessels
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_Environment_UpdatePatchedFrames(EVDS_SYSTEM* system) {
+	SIMC_LIST* list;
+	SIMC_LIST_ENTRY* entry;
+	EVDS_OBJECT** vessels;
+	EVDS_OBJECT** frames;
+	int i,count = 0,capacity = 0;
+	if (!system) return EVDS_ERROR_BAD_PARAMETER;
+
+	//Count vessels
+	EVDS_ERRCHECK(EVDS_System_GetObjectsByType(system,"vessel",&list));
+	entry = SIMC_List_GetFirst(list);
+	while (entry) {
+		capacity++;
+		entry = SIMC_List_GetNext(list,entry);
+	}
+	if (capacity == 0) return EVDS_OK;
+	vessels = (EVDS_OBJECT**)malloc(sizeof(EVDS_OBJECT*)*capacity*2);
+	if (!vessels) return EVDS_ERROR_MEMORY;
+	frames = vessels + capacity;
+
+	//Find new frames for all vessels (table of gravity sources must not change meanwhile)
+	EVDS_InternalEnvironment_EnterGravitySources(system);
+	entry = SIMC_List_GetFirst(list);
+	while (entry && (count < capacity)) {
+		EVDS_OBJECT* vessel = (EVDS_OBJECT*)SIMC_List_GetData(list,entry);
+		EVDS_OBJECT* parent = 0;
+		EVDS_OBJECT* frame = 0;
+		EVDS_STATE_VECTOR state;
+		EVDS_VECTOR root_position;
+		int dominant;
+
+		//Only vessels which are propagated directly
+		EVDS_Object_GetParent(vessel,&parent);
+		if (parent && (EVDS_Object_CheckType(parent,"propagator*") == EVDS_OK)) {
+			EVDS_Object_GetStateVector(vessel,&state);
+			EVDS_Vector_Initialize(root_position);
+			EVDS_Vector_Convert(&root_position,&state.position,system->inertial_space);
+
+			//Find propagator of the dominant body or its ancestors
+			dominant = EVDS_InternalEnvironment_GetDominantSource(system,&root_position);
+			while ((dominant >= 0) && (!frame)) {
+				frame = EVDS_InternalEnvironment_GetPropagatorFrame(system->gravity_sources[dominant].object);
+				dominant = system->gravity_sources[dominant].soi_parent;
+			}
+			if (frame && (frame != parent)) {
+				vessels[count] = vessel;
+				frames[count] = frame;
+				count++;
+			}
+		}
+		entry = SIMC_List_GetNext(list,entry);
+	}
+	if (entry) SIMC_List_Stop(list,entry);
+	EVDS_InternalEnvironment_LeaveGravitySources(system);
+
+	//Move vessels into their new frames
+	for (i = 0; i < count; i++) {
+		EVDS_Object_SetParent(vessels[i],frames[i]);
+	}
+	free(vessels);
+	return EVDS_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Returns magnetic field in the given position.
 ///
-/// To simplify spherical harmonics, only \f$J_2\f$ harmonic can be used:
+/// Magnetic field of all planets is summed up. Planet may provide a custom callback
+/// (EVDS_Callback_GetMagneticField), or describe its field with a tilted dipole or a
+/// table of spherical harmonics coefficients:
+/// Variable				| Description
+/// ------------------------|-------------------------------------------------------
+/// magnetic.dipole			| Dipole field strength at the equator on the reference radius (in \f$T\f$)
+/// magnetic.pole_latitude	| Latitude of geomagnetic north pole in degrees (90 by default)
+/// magnetic.pole_longitude | Longitude of geomagnetic north pole in degrees (0 by default)
+/// magnetic.harmonics		| Table of Schmidt semi-normalized coefficients (in \f$nT\f$)
+/// magnetic.harmonics_degree | Truncation degree of the spherical harmonics model (entire table by default)
+/// magnetic.harmonics_radius | Reference radius of the model (planet radius by default)
+/// magnetic_field			| Function pointer to EVDS_Callback_GetMagneticField
+///
+/// The field is derived from the magnetic scalar potential:
 /// \f{eqnarray*}{
-///		sin(\theta) &=& sin(arcsin(\frac{z}{\sqrt{x^2 + y^2 + z^2}}))
-///			= \frac{z}{r} \\
-///		n &=& 2 \\
-///		C_{20} &=& J_2 \\
-///		C_{21} &=& 0 \\
-///		C_{22} &=& 0 \\
-///		P_{20} &=& \frac{3}{2}
+///		V &=& R \sum\limits_{n=1}^N (\frac{R}{r})^{n+1}
+///			\sum\limits_{m=0}^n P_{nm} sin(\theta)
+///				[g_{nm} cos(m \lambda) + h_{nm} sin(m \lambda)] \\
+///		\mathbf{B} &=& -\nabla V
 /// \f}
-///
-/// Therefore the equations for gravitational field become:
+/// where \f$P_{nm}\f$ are the Schmidt semi-normalized Legendre associated functions.
+/// Coefficients table is read in the same "n m g h" format as the gravity harmonics
+/// (see EVDS_Environment_GetGravitationalField()), so a World Magnetic Model coefficient
+/// file (@c WMM.COF) can be used directly. Secular variation columns are ignored.
+/// A dipole model is a degree 1 model with coefficients:
 /// \f{eqnarray*}{
-///		\Phi &=& -\frac{\mu}{r}\left[1 + (\frac{R}{\mu})^2 P_{20} \cdot sin(\theta)\cdot C_{20}\right] \\
-///			&=& -\frac{\mu}{r}\left[1 + (\frac{R}{\mu})^2 \frac{3}{2} J_2 
-///				\frac{z}{r} \right] \\
-///		\mathbf{g}_x &=& -\frac{\partial \Phi}{\partial x} = \frac{R^2}{\mu} \frac{3}{2} J_2
-///			\frac{x z}{r^4} -
-///			\frac{x}{r^2} \Phi \\
-///		\mathbf{g}_y &=& -\frac{\partial \Phi}{\partial y} = \frac{R^2}{\mu} \frac{3}{2} J_2
-///			\frac{y z}{r^4} -
-///			\frac{y}{r^2} \Phi \\
-///		\mathbf{g}_z &=& -\frac{\partial \Phi}{\partial z} = \frac{R^2}{\mu} \frac{3}{2} J_2
-///			\left[ \frac{1}{r} - \frac{z^2}{r^4} \right] -
-///			\frac{z}{r^2} \Phi
+///		g_{10} &=& -B_0 sin(\phi_p) \\
+///		g_{11} &=& -B_0 cos(\phi_p) cos(\lambda_p) \\
+///		h_{11} &=& -B_0 cos(\phi_p) sin(\lambda_p)
 /// \f}
 ///
-/// If \f$J_2\f$ factor is not specified and planet is defined as an ellipsoid, WGS84-like
-/// gravity model for ellipsoid is used.
-///
-/// @todo Add information on the preceding gravity model
-/// 
-///
-/// These are the suggested values for solar system major bodies:
-/// Name	| Mass (kg)						| \f$J_2\f$
-/// --------|-------------------------------|----------------
-/// Sun		| \f$1.99 \cdot 10^{30}\f$		| N/A
-/// Mercury | \f$3.30 \cdot 10^{23}\f$		| \f$60 \cdot 10^{-6}\f$
-/// Venus	| \f$4.87 \cdot 10^{24}\f$		| \f$4.458 \cdot 10^{-6}\f$
-/// Earth	| \f$5.97 \cdot 10^{24}\f$		| \f$1.08263 \cdot 10^{-3}\f$
-/// Mars	| \f$6.42 \cdot 10^{23}\f$		| \f$1.96045 \cdot 10^{-3}\f$
-/// Jupiter	| \f$1.90 \cdot 10^{27}\f$		| \f$14.736 \cdot 10^{-3}\f$
-/// Saturn	| \f$5.68 \cdot 10^{26}\f$		| \f$16.298 \cdot 10^{-3}\f$
-/// Uranus	| \f$8.68 \cdot 10^{25}\f$		| \f$3.34343 \cdot 10^{-3}\f$
-/// Neptune	| \f$1.02 \cdot 10^{26}\f$		| \f$3.411 \cdot 10^{-3}\f$
-/// Moon	| \f$7.35 \cdot 10^{22}\f$		| \f$202.7 \cdot 10^{-6}\f$
+/// Both models are evaluated with the same Cunningham recursions as the gravitational
+/// field, and coefficients are loaded once into the table of gravity sources. The field
+/// evaluation does not perform any variable lookups, so it can be called for many
+/// vessels at attitude control rates.
 ///
 /// @param[in] system Pointer to the system object
-/// @param[in] position Position, in which gravity field must be calculated
-/// @param[out] field Total gravitational field in the position
+/// @param[in] position Position, in which magnetic field must be calculated
+/// @param[out] field Total magnetic field in the position (in \f$T\f$, same coordinates as position)
 ///
 /// @returns Error code
 /// @retval EVDS_OK Completed successfully
+/// @retval EVDS_ERROR_BAD_PARAMETER "system" is null
+/// @retval EVDS_ERROR_BAD_PARAMETER "position" is null
+/// @retval EVDS_ERROR_BAD_PARAMETER "field" is null
 ////////////////////////////////////////////////////////////////////////////////
-int EVDS_Environment_GetGravitationalField(EVDS_SYSTEM* system, EVDS_VECTOR* position, EVDS_REAL* phi, EVDS_VECTOR* field) {
+int EVDS_Environment_GetMagneticField(EVDS_SYSTEM* system, EVDS_VECTOR* position, EVDS_VECTOR* field) {
+	int i;
 	EVDS_OBJECT* target_coordinates;
-	SIMC_LIST *planets, *constant_sources;
-	SIMC_LIST_ENTRY* entry;
 	EVDS_VECTOR total_field;
-	EVDS_REAL total_phi;
 
-	//Check input and fetch list of planets
+	//Check input
 	if (!system) return EVDS_ERROR_BAD_PARAMETER;
 	if (!position) return EVDS_ERROR_BAD_PARAMETER;
+	if (!field) return EVDS_ERROR_BAD_PARAMETER;
 	target_coordinates = position->coordinate_system;
-	EVDS_System_GetObjectsByType(system,"planet",&planets);
-	EVDS_System_GetObjectsByType(system, "constant_gravity", &constant_sources);
+	EVDS_Vector_Set(&total_field,EVDS_VECTOR_DIRECTION,target_coordinates,0.0,0.0,0.0);
 
-	//Start accumulating total field and potential
-	EVDS_Vector_Set(&total_field,EVDS_VECTOR_ACCELERATION,target_coordinates,0.0,0.0,0.0);
-	total_phi = 0.0;
+	//Make sure table of sources is up to date
+	EVDS_InternalEnvironment_EnterGravitySources(system);
 
-	//Iterate through all constant sources
-	entry = SIMC_List_GetFirst(constant_sources);
-	while (entry) {
-		EVDS_OBJECT* constant_gravity = SIMC_List_GetData(constant_sources, entry);
-		EVDS_VARIABLE* acceleration_var; // Constant acceleration
-		EVDS_VECTOR acceleration;
+	//Sum up fields of all planets
+	for (i = 0; i < system->gravity_sources_count; i++) {
+		EVDS_INTERNAL_GRAVITY_SOURCE* source = &system->gravity_sources[i];
+		EVDS_VECTOR Gb,B;
+		EVDS_REAL r2,potential;
+		if ((!source->magnetic) && (!source->magnetic_callback)) continue;
 
-		// Get parameter
-		EVDS_Object_GetVariable(constant_gravity, "acceleration", &acceleration_var);
-		EVDS_Variable_GetVector(acceleration_var, &acceleration);
-		
-		//Reinterpret vector as acceleration and add to total field
-		acceleration.derivative_level = EVDS_VECTOR_ACCELERATION;
-		EVDS_Vector_Add(&total_field, &total_field, &acceleration);
-		total_phi += 0; // FIXME
+		//Get position in planet body-fixed coordinates
+		EVDS_Vector_Initialize(Gb);
+		EVDS_Vector_Set(&B,EVDS_VECTOR_DIRECTION,source->object,0.0,0.0,0.0);
+		EVDS_Vector_Convert(&Gb,position,source->object);
+		EVDS_Vector_Dot(&r2,&Gb,&Gb);
+		if (r2 < EVDS_EPS) continue;
+
+		//Compute magnetic field in planet coordinates
+		if (source->magnetic_callback) {
+			source->magnetic_callback(source->object,&Gb,&B);
+		} else {
+			EVDS_REAL R = source->magnetic->radius;
+			EVDS_InternalEnvironment_EvaluateHarmonics(source->magnetic,R*R,&Gb,&potential,&B);
+			B.x = -B.x;
+			B.y = -B.y;
+			B.z = -B.z;
+		}
 
-		entry = SIMC_List_GetNext(constant_sources, entry);
+		//Rotate into target coordinates
+		B.derivative_level = EVDS_VECTOR_DIRECTION;
+		EVDS_Vector_Convert(&B,&B,target_coordinates);
+		EVDS_Vector_Add(&total_field,&total_field,&B);
 	}
+	EVDS_InternalEnvironment_LeaveGravitySources(system);
 
-	//Iterate through all planets
-	entry = SIMC_List_GetFirst(planets);
-	while (entry) {
-		EVDS_VARIABLE* mass_var; //Planet mass
-		EVDS_REAL mass;
-		EVDS_VARIABLE* mu_var; //Gravitational parameter
-		EVDS_REAL mu;
-		EVDS_VARIABLE* j2_var; //First spherical harmonic
-		EVDS_REAL j2;
-		EVDS_VARIABLE* radius_var; //Planet radius
-		EVDS_REAL radius;
-		EVDS_VARIABLE* rs_var; //Sphere of influence
-		EVDS_REAL rs;
-		EVDS_VARIABLE* callback_var; //Custom field
-		EVDS_Callback_GetGravitationalField* callback;
-
-		//Planet state vector
-		EVDS_STATE_VECTOR planet_state;
-		EVDS_OBJECT* planet = SIMC_List_GetData(planets,entry);
-
-		//Initialize temporary vectors
-		EVDS_REAL r2,r;
-		EVDS_VECTOR G0,Gr,Gn,Ga;
-		EVDS_REAL Gphi = 0.0;
-		EVDS_Vector_Initialize(G0);
-		EVDS_Vector_Initialize(Gr);
-		EVDS_Vector_Initialize(Gn);
-		EVDS_Vector_Initialize(Ga);
+	EVDS_Vector_Copy(field,&total_field);
+	return EVDS_OK;
+}
 
-		//Get planet state and position in position vector coordinates
-		EVDS_Object_GetStateVector(planet,&planet_state);
-		EVDS_Vector_Convert(&G0,&planet_state.position,target_coordinates);
 
-		//Get planets parameters
-		EVDS_Object_GetRealVariable(planet,"gravity.mu",&mu,&mu_var);
-		EVDS_Object_GetRealVariable(planet,"gravity.j2",&j2,&j2_var);
-		EVDS_Object_GetRealVariable(planet,"gravity.rs",&rs,&rs_var);
-		EVDS_Object_GetRealVariable(planet,"mass",&mass,&mass_var);
-		EVDS_Object_GetRealVariable(planet,"geometry.radius",&radius,&radius_var);
 
-		//Get custom gravitational field callback
-		if (EVDS_Object_GetVariable(planet,"gravitational_field",&callback_var) == EVDS_OK) {
-			EVDS_Variable_GetFunctionPointer(callback_var,(void**)(&callback));
-		} else {
-			callback = 0;
-		}
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Defining layers of US Standard Atmosphere 1976 below 86 km.
+///
+/// Each layer starts at the given geopotential altitude, temperature varies linearly
+/// within the layer with the given lapse rate. Pressure at the base of every layer
+/// follows from the barometric formula applied to the layers below.
+////////////////////////////////////////////////////////////////////////////////
+const struct {
+	EVDS_REAL altitude;
+	EVDS_REAL temperature;
+	EVDS_REAL lapse_rate;
+	EVDS_REAL pressure;
+} EVDS_Internal_US76Layers[] = {
+	{     0.0e3,  288.15,  -6.5e-3,  101325.0     },
+	{    11.0e3,  216.65,   0.0e-3,   22632.06    },
+	{    20.0e3,  216.65,   1.0e-3,    5474.889   },
+	{    32.0e3,  228.65,   2.8e-3,     868.0187  },
+	{    47.0e3,  270.65,   0.0e-3,     110.9063  },
+	{    51.0e3,  270.65,  -2.8e-3,      66.93887 },
+	{    71.0e3,  214.65,  -2.0e-3,       3.956420},
+};
+const int EVDS_Internal_US76LayersCount =
+	sizeof(EVDS_Internal_US76Layers) / sizeof(EVDS_Internal_US76Layers[0]);
 
-		//Calculate radius-vector
-		EVDS_Vector_Subtract(&Gr,position,&G0);
-		EVDS_Vector_Dot(&r2,&Gr,&Gr);
-		r = sqrt(r2);
 
-		//Check if inside the planet itself
-		if (radius_var && (r < radius*0.9)) {
-			entry = SIMC_List_GetNext(planets,entry);
-			continue; //Too close to the planet
-		}
+////////////////////////////////////////////////////////////////////////////////
+/// @brief US Standard Atmosphere 1976 above 86 km (altitude, temperature, logarithm of pressure and density).
+///
+/// Pressure and density above 86 km follow from diffusion of individual species and have
+/// no closed form, so they are taken from the published tables.
+////////////////////////////////////////////////////////////////////////////////
+const struct {
+	EVDS_REAL altitude;
+	EVDS_REAL temperature;
+	EVDS_REAL log_pressure;
+	EVDS_REAL log_density;
+} EVDS_Internal_US76Table[] = {
+	{   86.0e3,  186.87,   -0.98516,  -11.87562 }, //3.7338e-01 Pa, 6.9580e-06 kg/m3
+	{   90.0e3,  186.87,   -1.69505,  -12.58704 }, //1.8359e-01 Pa, 3.4160e-06 kg/m3
+	{   95.0e3,  188.42,   -2.57747,  -13.48405 }, //7.5966e-02 Pa, 1.3930e-06 kg/m3
+	{  100.0e3,  195.08,   -3.44168,  -14.39462 }, //3.2011e-02 Pa, 5.6040e-07 kg/m3
+	{  110.0e3,  240.00,   -4.94707,  -16.14773 }, //7.1042e-03 Pa, 9.7080e-08 kg/m3
+	{  120.0e3,  360.00,   -5.97630,  -17.62227 }, //2.5382e-03 Pa, 2.2220e-08 kg/m3
+	{  130.0e3,  469.27,   -6.68421,  -18.62500 }, //1.2505e-03 Pa, 8.1520e-09 kg/m3
+	{  140.0e3,  559.63,   -7.23587,  -19.38014 }, //7.2028e-04 Pa, 3.8310e-09 kg/m3
+	{  150.0e3,  634.39,   -7.69693,  -19.99282 }, //4.5422e-04 Pa, 2.0760e-09 kg/m3
+	{  160.0e3,  696.29,   -8.09865,  -20.51382 }, //3.0395e-04 Pa, 1.2330e-09 kg/m3
+	{  180.0e3,  790.07,   -8.78697,  -21.37835 }, //1.5271e-04 Pa, 5.1940e-10 kg/m3
+	{  200.0e3,  854.56,   -9.37597,  -22.09329 }, //8.4736e-05 Pa, 2.5410e-10 kg/m3
+	{  250.0e3,  941.33,  -10.60600,  -23.52458 }, //2.4767e-05 Pa, 6.0730e-11 kg/m3
+	{  300.0e3,  976.01,  -11.64413,  -24.67820 }, //8.7704e-06 Pa, 1.9160e-11 kg/m3
+	{  350.0e3,  990.06,  -12.57719,  -25.68311 }, //3.4498e-06 Pa, 7.0140e-12 kg/m3
+	{  400.0e3,  995.83,  -13.44271,  -26.60033 }, //1.4518e-06 Pa, 2.8030e-12 kg/m3
+	{  450.0e3,  998.22,  -14.25451,  -27.46212 }, //6.4468e-07 Pa, 1.1840e-12 kg/m3
+	{  500.0e3,  999.24,  -15.01165,  -28.28207 }, //3.0236e-07 Pa, 5.2150e-13 kg/m3
+	{  600.0e3,  999.85,  -16.31496,  -29.80521 }, //8.2130e-08 Pa, 1.1370e-13 kg/m3
+	{  700.0e3,  999.97,  -17.26041,  -31.11451 }, //3.1908e-08 Pa, 3.0700e-14 kg/m3
+	{  800.0e3,  999.99,  -17.88794,  -32.10868 }, //1.7036e-08 Pa, 1.1360e-14 kg/m3
+	{  900.0e3, 1000.00,  -18.33698,  -32.78801 }, //1.0873e-08 Pa, 5.7590e-15 kg/m3
+	{ 1000.0e3, 1000.00,  -18.70652,  -33.26873 },  //7.5138e-09 Pa, 3.5610e-15 kg/m3
+};
+const int EVDS_Internal_US76TableCount = 
+	sizeof(EVDS_Internal_US76Table) / sizeof(EVDS_Internal_US76Table[0]);
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Get atmospheric parameters according to US Standard Atmosphere 1976.
+///
+/// Below 86 km temperature is computed from the base temperature and lapse rate of the
+/// layer, and pressure is computed with the barometric formula of the layer:
+/// \f{eqnarray*}{
+///		T &=& T_b + L_b (H - H_b) \\
+///		P &=& P_b \left(\frac{T_b}{T}\right)^{\frac{g_0 M_0}{R^* L_b}} \quad (L_b \neq 0) \\
+///		P &=& P_b \exp\left(-\frac{g_0 M_0 (H - H_b)}{R^* T_b}\right) \quad (L_b = 0)
+/// \f}
+/// where \f$H\f$ is the geopotential altitude and \f$T\f$ is the molecular-scale temperature
+/// (it differs from kinetic temperature by less than 0.05% between 80 km and 86 km).
+/// Density follows from the ideal gas law.
+///
+/// Above 86 km temperature is computed from its defining segments (isothermal, elliptical,
+/// linear and exponential), pressure and density are interpolated log-linearly between
+/// table entries. Altitudes below zero use sea level values, altitudes above 1000 km are
+/// treated as vacuum.
+///
+/// Homosphere composition (N2, O2, Ar) is filled out below 86 km.
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalEnvironment_US76(EVDS_REAL altitude, EVDS_ENVIRONMENT_ATMOSPHERE* atmosphere) {
+	const EVDS_REAL r0 = 6356766.0; //Earth radius for geopotential altitude
+	const EVDS_REAL g0 = 9.80665; //Sea level gravity
+	const EVDS_REAL M0 = 28.9644e-3; //Mean molar mass of air
+	const EVDS_REAL R = 8.31432; //Gas constant
+	int first = 0;
+	int last = EVDS_Internal_US76TableCount-1;
+	EVDS_REAL t;
 
-		//Check if position of source vector matches with planets position
-		if (r2 < EVDS_EPS) {
-			entry = SIMC_List_GetNext(planets,entry);
-			continue; //Planets dont pull themselves
+	if (altitude < 0.0) altitude = 0.0;
+	if (altitude > EVDS_Internal_US76Table[last].altitude) return;
+
+	if (altitude < EVDS_Internal_US76Table[0].altitude) {
+		EVDS_REAL H = r0*altitude/(r0+altitude);
+		EVDS_REAL dH;
+		int layer = EVDS_Internal_US76LayersCount-1;
+
+		//Find layer and compute temperature, pressure and density
+		while ((layer > 0) && (EVDS_Internal_US76Layers[layer].altitude > H)) layer--;
+		dH = H - EVDS_Internal_US76Layers[layer].altitude;
+		atmosphere->temperature = EVDS_Internal_US76Layers[layer].temperature +
+			EVDS_Internal_US76Layers[layer].lapse_rate*dH;
+		if (EVDS_Internal_US76Layers[layer].lapse_rate != 0.0) {
+			atmosphere->pressure = EVDS_Internal_US76Layers[layer].pressure*
+				pow(EVDS_Internal_US76Layers[layer].temperature/atmosphere->temperature,
+					g0*M0/(R*EVDS_Internal_US76Layers[layer].lapse_rate));
+		} else {
+			atmosphere->pressure = EVDS_Internal_US76Layers[layer].pressure*
+				exp(-g0*M0*dH/(R*EVDS_Internal_US76Layers[layer].temperature));
 		}
+		atmosphere->density = atmosphere->pressure*M0/(R*atmosphere->temperature);
+	} else {
+		EVDS_REAL Z = altitude*1e-3;
 
-		//Check if outside of sphere of influence
-		if (rs_var && (r2 > rs*rs)) {
-			entry = SIMC_List_GetNext(planets,entry);
-			continue; //Too far for gravity to have a meaningful influence
+		//Find interval
+		while (last - first > 1) {
+			int middle = (first + last)/2;
+			if (EVDS_Internal_US76Table[middle].altitude > altitude) {
+				last = middle;
+			} else {
+				first = middle;
+			}
 		}
+		t = (altitude - EVDS_Internal_US76Table[first].altitude)/
+			(EVDS_Internal_US76Table[last].altitude - EVDS_Internal_US76Table[first].altitude);
 
-		//Compute gravity acceleration from custom callback or stock code
-		if (callback) {
-			callback(planet,&Gr,&Gphi,&Ga);
-			EVDS_Vector_Add(&total_field,&total_field,&Ga);
-			total_phi += Gphi;
+		//Temperature from its defining segments
+		if (Z < 91.0) {
+			atmosphere->temperature = 186.8673;
+		} else if (Z < 110.0) {
+			atmosphere->temperature = 263.1905 - 76.3232*sqrt(1.0 - pow((Z - 91.0)/19.9429,2));
+		} else if (Z < 120.0) {
+			atmosphere->temperature = 240.0 + 12.0*(Z - 110.0);
 		} else {
-			//Calculate mu for the planet
-			if (!mu_var) {
-				if (mass_var) {
-					mu = 6.6738480e-11 * mass;
-				} else {
-					entry = SIMC_List_GetNext(planets,entry);
-					continue; //Not enough information to compute gravity for this planet
-				}
-			}
-			
-			if (j2_var && radius_var) { //Non-spherical model
-				EVDS_REAL x = Gr.x;
-				EVDS_REAL y = Gr.y;
-				EVDS_REAL z = Gr.z;
-				EVDS_REAL sinlat = z/r;
+			EVDS_REAL xi = (Z - 120.0)*(r0*1e-3 + 120.0)/(r0*1e-3 + Z);
+			atmosphere->temperature = 1000.0 - 640.0*exp(-0.01875*xi);
+		}
 
-				//Potential
-				Gphi = -(mu/r)*(1 + (radius*radius/(mu*mu))*(3.0/2.0)*j2*sinlat);
+		//Interpolate pressure and density
+		atmosphere->pressure = exp(EVDS_Internal_US76Table[first].log_pressure + t*
+			(EVDS_Internal_US76Table[last].log_pressure - EVDS_Internal_US76Table[first].log_pressure));
+		atmosphere->density = exp(EVDS_Internal_US76Table[first].log_density + t*
+			(EVDS_Internal_US76Table[last].log_density - EVDS_Internal_US76Table[first].log_density));
+	}
+	atmosphere->concentration = atmosphere->pressure/(EVDS_ENVIRONMENT_BOLTZMANN*atmosphere->temperature);
 
-				//Acceleration
-				Ga.coordinate_system = Gr.coordinate_system;
-				Ga.x = (radius*radius/mu)*(3.0/2.0)*j2*
-					(x*z/(r2*r2)) -
-					Gphi*x/r2;
-
-				Ga.y = (radius*radius/mu)*(3.0/2.0)*j2*
-					(y*z/(r2*r2)) -
-					Gphi*y/r2;
-
-				Ga.z = (radius*radius/mu)*(3.0/2.0)*j2*
-					(1/r - z*z/(r2*r2)) -
-					Gphi*z/r2;
-			} { //Spherical model  else
-				//Potential
-				Gphi = -mu/r;
+	//Composition of the homosphere
+	if (altitude < 86e3) {
+		atmosphere->partial_concentration[EVDS_ENVIRONMENT_SPECIES_N2] = 0.78084*atmosphere->concentration;
+		atmosphere->partial_concentration[EVDS_ENVIRONMENT_SPECIES_O2] = 0.209476*atmosphere->concentration;
+		atmosphere->partial_concentration[EVDS_ENVIRONMENT_SPECIES_AR] = 0.00934*atmosphere->concentration;
+		atmosphere->partial_density[EVDS_ENVIRONMENT_SPECIES_N2] =
+			atmosphere->partial_concentration[EVDS_ENVIRONMENT_SPECIES_N2]*28.0134e-3/EVDS_ENVIRONMENT_AVOGADRO;
+		atmosphere->partial_density[EVDS_ENVIRONMENT_SPECIES_O2] =
+			atmosphere->partial_concentration[EVDS_ENVIRONMENT_SPECIES_O2]*31.9988e-3/EVDS_ENVIRONMENT_AVOGADRO;
+		atmosphere->partial_density[EVDS_ENVIRONMENT_SPECIES_AR] =
+			atmosphere->partial_concentration[EVDS_ENVIRONMENT_SPECIES_AR]*39.948e-3/EVDS_ENVIRONMENT_AVOGADRO;
+	}
+}
 
-				//Acceleration
-				EVDS_Vector_Normalize(&Gn,&Gr);
-				EVDS_Vector_Multiply(&Ga,&Gn,-mu/r2);
-			}
 
-			//Reinterpret vector as acceleration, add to total acceleration
-			Ga.derivative_level = EVDS_VECTOR_ACCELERATION;
-			EVDS_Vector_Add(&total_field,&total_field,&Ga);
-			total_phi += Gphi;
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Returns atmospheric parameters in the given position.
+///
+/// This function finds the planet with the lowest altitude above its surface which has an
+/// atmosphere, and returns parameters of that atmosphere. Planet has an atmosphere if it
+/// defines one of the following variables:
+/// Variable			| Description
+/// --------------------|-------------------------------------------------------
+/// atmospheric_data	| Function pointer to EVDS_Callback_GetAtmosphericData
+/// atmosphere.model	| Name of the built-in atmospheric model ("us76")
+///
+/// The callback receives position in planet body-fixed coordinates. If callback leaves
+/// some parameters at zero, they are guessed from the remaining parameters (ideal gas with
+/// properties of air is assumed).
+///
+/// Built-in "us76" model uses a precomputed table of US Standard Atmosphere 1976, see
+/// EVDS_InternalEnvironment_US76(). Altitude is measured above the datum of the planet.
+///
+/// All parameters are zero if there are no atmospheres at the given position.
+///
+/// @param[in] system Pointer to the system object
+/// @param[in] position Position, in which atmospheric parameters must be calculated
+/// @param[out] parameters Atmospheric parameters
+///
+/// @returns Error code
+/// @retval EVDS_OK Completed successfully
+/// @retval EVDS_ERROR_BAD_PARAMETER "system" is null
+/// @retval EVDS_ERROR_BAD_PARAMETER "position" is null
+/// @retval EVDS_ERROR_BAD_PARAMETER "parameters" is null
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_Environment_GetAtmosphericParameters(EVDS_SYSTEM* system, EVDS_VECTOR* position, EVDS_ENVIRONMENT_ATMOSPHERE* parameters) {
+	int i;
+	EVDS_OBJECT* atmosphere_planet = 0;
+	EVDS_Callback_GetAtmosphericData* atmosphere_callback = 0;
+	EVDS_VECTOR atmosphere_position;
+	EVDS_REAL atmosphere_altitude = 0.0;
+
+	//Check input
+	if (!system) return EVDS_ERROR_BAD_PARAMETER;
+	if (!position) return EVDS_ERROR_BAD_PARAMETER;
+	if (!parameters) return EVDS_ERROR_BAD_PARAMETER;
+	memset(parameters,0,sizeof(EVDS_ENVIRONMENT_ATMOSPHERE));
+
+	//Find planet with the lowest altitude (parameters of planets are taken from the table of gravity sources)
+	EVDS_InternalEnvironment_EnterGravitySources(system);
+	for (i = 0; i < system->gravity_sources_count; i++) {
+		EVDS_INTERNAL_GRAVITY_SOURCE* source = &system->gravity_sources[i];
+		EVDS_GEODETIC_COORDINATE geocoord;
+		EVDS_VECTOR r;
+		if ((!source->atmosphere_callback) && (!source->has_us76)) continue;
+
+		//Get altitude above the planet
+		EVDS_Vector_Initialize(r);
+		EVDS_Vector_Convert(&r,position,source->object);
+		EVDS_Geodetic_FromVector(&geocoord,&r,&source->datum);
+		if ((!atmosphere_planet) || (geocoord.elevation < atmosphere_altitude)) {
+			atmosphere_planet = source->object;
+			atmosphere_callback = source->atmosphere_callback;
+			atmosphere_altitude = geocoord.elevation;
+			EVDS_Vector_Copy(&atmosphere_position,&r);
 		}
-		entry = SIMC_List_GetNext(planets,entry);
 	}
+	EVDS_InternalEnvironment_LeaveGravitySources(system);
+	if (!atmosphere_planet) return EVDS_OK;
 
-	//Write back information
-	if (phi) *phi = total_phi;
-	if (field) EVDS_Vector_Copy(field,&total_field);
+	//Compute atmospheric parameters
+	if (atmosphere_callback) {
+		EVDS_ERRCHECK(atmosphere_callback(atmosphere_planet,&atmosphere_position,parameters));
+	} else {
+		EVDS_InternalEnvironment_US76(atmosphere_altitude,parameters);
+	}
+
+	//Fill out missing parameters
+	if ((parameters->pressure == 0.0) && (parameters->density > 0.0) && (parameters->temperature > 0.0)) {
+		parameters->pressure = 287.05*parameters->density*parameters->temperature;
+	}
+	if ((parameters->concentration == 0.0) && (parameters->temperature > 0.0)) {
+		parameters->concentration = parameters->pressure/(EVDS_ENVIRONMENT_BOLTZMANN*parameters->temperature);
+	}
 	return EVDS_OK;
-}
\ No newline at end of file
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Returns radiation environment in the given position.
+///
+/// Radiation environment is determined by the planet closest to the position (relative
+/// to its radius) which either defines a custom callback, or a precomputed table of
+/// particle fluxes:
+/// Variable			| Description
+/// --------------------|-------------------------------------------------------
+/// radiation.table		| Table of fluxes and dose rates over L-shell and B/B0 (see below)
+/// radiation_data		| Function pointer to EVDS_Callback_GetRadiationData
+///
+/// Each line of the table holds a single node of a rectilinear grid over the McIlwain
+/// L-shell parameter and the ratio of local magnetic field strength to its equatorial
+/// value on the same field line (the same coordinates as used by AE8/AP8 trapped
+/// particle models):
+/// ~~~{.xml}
+///	<parameter name="radiation.table" type="string">
+///		L	B/B0	electrons	protons		solar		dose_rate
+///		1.2	1.0		1.0e10		2.0e8		0.0			1.0e-8
+///		...
+///	</parameter>
+/// ~~~
+/// Fluxes are given in \f$1/(m^2 s)\f$ and the dose rate in \f$Gy/s\f$. Nodes missing from
+/// the table are treated as zero, positions outside of the table are clamped to its edges.
+/// Values are interpolated bilinearly in logarithmic scale.
+///
+/// L-shell and B/B0 are computed for the dipole part of the planet magnetic field model
+/// (see EVDS_Environment_GetMagneticField()), or for an axial dipole if planet has no magnetic
+/// field model. The table is parsed once when the planet is added to the table of gravity
+/// sources, so the lookup is cheap enough to accumulate dose for many vessels every step.
+///
+/// @param[in] system Pointer to the system object
+/// @param[in] position Position, in which radiation parameters must be calculated
+/// @param[out] parameters Radiation environment in the position (zero if no planet defines it)
+///
+/// @returns Error code
+/// @retval EVDS_OK Completed successfully
+/// @retval EVDS_ERROR_BAD_PARAMETER "system" is null
+/// @retval EVDS_ERROR_BAD_PARAMETER "position" is null
+/// @retval EVDS_ERROR_BAD_PARAMETER "parameters" is null
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_Environment_GetRadiationParameters(EVDS_SYSTEM* system, EVDS_VECTOR* position, EVDS_ENVIRONMENT_RADIATION* parameters) {
+	int i;
+	int error_code = EVDS_OK;
+	EVDS_INTERNAL_GRAVITY_SOURCE* radiation_source = 0;
+	EVDS_VECTOR radiation_position;
+	EVDS_REAL radiation_distance = 0.0;
+
+	//Check input
+	if (!system) return EVDS_ERROR_BAD_PARAMETER;
+	if (!position) return EVDS_ERROR_BAD_PARAMETER;
+	if (!parameters) return EVDS_ERROR_BAD_PARAMETER;
+	memset(parameters,0,sizeof(EVDS_ENVIRONMENT_RADIATION));
+
+	//Make sure table of sources is up to date
+	EVDS_InternalEnvironment_EnterGravitySources(system);
+
+	//Find closest planet which defines radiation environment
+	for (i = 0; i < system->gravity_sources_count; i++) {
+		EVDS_INTERNAL_GRAVITY_SOURCE* source = &system->gravity_sources[i];
+		EVDS_VECTOR r;
+		EVDS_REAL r2,distance;
+		if ((!source->radiation) && (!source->radiation_callback)) continue;
+		if ((!source->radiation_callback) && (!source->magnetic) && (!source->has_radius)) continue;
+
+		//Get position in planet body-fixed coordinates
+		EVDS_Vector_Initialize(r);
+		EVDS_Vector_Convert(&r,position,source->object);
+		EVDS_Vector_Dot(&r2,&r,&r);
+		if (r2 < EVDS_EPS) continue;
+
+		//Distance relative to planet radius
+		distance = sqrt(r2);
+		if (source->has_radius && (source->radius > 0.0)) distance /= source->radius;
+		if ((!radiation_source) || (distance < radiation_distance)) {
+			radiation_source = source;
+			radiation_distance = distance;
+			EVDS_Vector_Copy(&radiation_position,&r);
+		}
+	}
+
+	//Compute radiation parameters
+	if (radiation_source) {
+		if (radiation_source->radiation_callback) {
+			error_code = radiation_source->radiation_callback(radiation_source->object,&radiation_position,parameters);
+		} else {
+			EVDS_InternalEnvironment_GetMagneticCoordinates(radiation_source,&radiation_position,
+				&parameters->L,&parameters->B_B0);
+			EVDS_InternalEnvironment_EvaluateRadiationTable(radiation_source->radiation,
+				parameters->L,parameters->B_B0,parameters);
+		}
+	}
+	EVDS_InternalEnvironment_LeaveGravitySources(system);
+	return error_code;
+}
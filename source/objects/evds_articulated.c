@@ -0,0 +1,1004 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file
+////////////////////////////////////////////////////////////////////////////////
+/// Copyright (C) 2012-2015, Black Phoenix
+///
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the GNU Lesser General Public License as published by the Free Software
+/// Foundation; either version 2 of the License, or (at your option) any later
+/// version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+/// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+/// details.
+///
+/// You should have received a copy of the GNU Lesser General Public License along with
+/// this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+/// Place - Suite 330, Boston, MA  02111-1307, USA.
+///
+/// Further information about the GNU Lesser General Public License can also be found on
+/// the world wide web at http://www.gnu.org.
+////////////////////////////////////////////////////////////////////////////////
+/// @page EVDS_Solver_ArticulatedBody Articulated body
+///
+/// Articulated body is a tree of rigid links connected by single degree of freedom joints
+/// (robotic arms, multi-axis gimbal assemblies, deployable booms). The articulated body object
+/// itself is the base of the tree, which is rigidly attached to its parent. Every child of type
+/// "link" is a link connected to the base, children of type "link" of a link are connected
+/// to that link, and so on.
+///
+/// Motion of the joints is computed with the Featherstone's articulated-body algorithm, which
+/// takes time linear in the number of joints and does not require small time steps (unlike
+/// simulating joints with stiff constraint forces). The joint coordinates are propagated by
+/// the solver itself (semi-implicit Euler integration over the time step passed to
+/// EVDS_Object_Solve()), and state vectors of all links are updated to match them.
+///
+/// Forces and torques returned by children of links (for example rocket engines) are applied
+/// to the links they are attached to. The articulated body returns reaction force and torque
+/// that the mechanism exerts upon the base, so a parent rigid body will feel the reaction of
+/// moving joints. Total mass properties of the whole mechanism are exported in the same way as
+/// rigid body does, so articulated body can be a part of a vessel.
+///
+/// The base is treated as an inertial reference frame. Fictitious forces caused by motion of
+/// the base are not taken into account. Uniform gravity can be specified explicitly (for example
+/// for a mechanism standing on a planet surface), otherwise the mechanism is assumed to be in
+/// free fall along with its parent.
+///
+///
+/// Variables
+/// --------------------------------------------------------------------------------
+/// The following variables are used by the articulated body:
+/// Name			| Description
+/// ----------------|------------------------------------
+///	gravity			| Uniform gravitational acceleration in base coordinates (optional)
+///	total_mass		| Total mass of the base and all links
+///	total_cm		| Total center of mass
+///	total_ix		| Total moment of inertia around total center of mass (X row)
+///	total_iy		| Total moment of inertia around total center of mass (Y row)
+///	total_iz		| Total moment of inertia around total center of mass (Z row)
+///
+/// The following variables are used by every link:
+/// Name			| Description
+/// ----------------|------------------------------------
+///	joint.type		| Joint type: "revolute" (default) or "prismatic"
+///	joint.axis		| Axis of rotation or translation in link coordinates (0 0 1 by default)
+///	joint.q			| Joint coordinate (angle in radians or displacement in meters)
+///	joint.dq		| Joint velocity
+///	joint.ddq		| Joint acceleration (computed by the solver)
+///	joint.force		| Torque or force applied by joint actuator
+///	joint.command	| Commanded joint coordinate (used if stiffness is specified)
+///	joint.stiffness	| Stiffness of the joint servo (torque per unit of error in joint coordinate)
+///	joint.damping	| Viscous damping of the joint (torque per unit of joint velocity)
+///	mass			| Mass of the link
+///	cm				| Center of mass of the link
+///	jx				| Radius of gyration squared tensor (X row)
+///	jy				| Radius of gyration squared tensor (Y row)
+///	jz				| Radius of gyration squared tensor (Z row)
+///
+/// Position and orientation of the link at the moment of initialization correspond to zero
+/// joint coordinate.
+///
+///
+/// Equations
+/// --------------------------------------------------------------------------------
+/// All quantities are 6D spatial vectors (angular part first) expressed in link coordinates.
+/// For every link \f$i\f$ with parent \f$\lambda(i)\f$, transform \f$X_i\f$ from parent
+/// coordinates and joint motion subspace \f$S_i\f$:
+///
+/// \f{eqnarray*}{
+///		v_i &=& X_i v_{\lambda(i)} + S_i \dot{q}_i \\
+///		c_i &=& v_i \times S_i \dot{q}_i \\
+///		p^A_i &=& v_i \times^* I_i v_i - f^{ext}_i \\
+///		U_i &=& I^A_i S_i, \quad D_i = S_i^T U_i, \quad u_i = \tau_i - S_i^T p^A_i \\
+///		I^A_{\lambda(i)} &=& I^A_{\lambda(i)} + X_i^T (I^A_i - U_i U_i^T / D_i) X_i \\
+///		p^A_{\lambda(i)} &=& p^A_{\lambda(i)} + X_i^T (p^A_i + (I^A_i - U_i U_i^T / D_i) c_i + U_i u_i / D_i) \\
+///		\ddot{q}_i &=& (u_i - U_i^T (X_i a_{\lambda(i)} + c_i)) / D_i \\
+///		a_i &=& X_i a_{\lambda(i)} + c_i + S_i \ddot{q}_i
+/// \f}
+///
+/// The first two equations are evaluated from base to leaves, the next three from leaves to base,
+/// and the last two from base to leaves again. Acceleration of the base is \f$a_0 = [0, -g]\f$.
+/// Reaction upon the base is the sum of \f$-X_i^T (I^A_i a_i + p^A_i)\f$ over links attached
+/// to the base.
+////////////////////////////////////////////////////////////////////////////////
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "evds.h"
+
+
+#ifndef DOXYGEN_INTERNAL_STRUCTS
+typedef struct EVDS_SOLVER_ARTICULATED_LINK_TAG {
+	EVDS_OBJECT* object;			//Link object
+	int parent;						//Index of parent link (-1 if link is attached to the base)
+	int is_prismatic;				//Is joint prismatic (otherwise revolute)
+
+	//Joint variables
+	EVDS_VARIABLE *q,*dq,*ddq;		//Joint coordinate and its derivatives
+	EVDS_VARIABLE *force;			//Actuator force or torque
+	EVDS_VARIABLE *command;			//Commanded joint coordinate
+	EVDS_VARIABLE *stiffness;		//Servo stiffness
+	EVDS_VARIABLE *damping;			//Viscous damping
+	EVDS_VARIABLE *mass,*cm;		//Mass and center of mass of the link
+	EVDS_VARIABLE *jx,*jy,*jz;		//Radius of gyration squared of the link
+
+	//Joint geometry
+	EVDS_REAL axis[3];				//Joint axis (link coordinates)
+	EVDS_REAL p0[3];				//Position of the link at zero joint coordinate (parent coordinates)
+	EVDS_REAL q0[4];				//Orientation of the link at zero joint coordinate (parent coordinates)
+
+	//Temporary values used by the algorithm
+	EVDS_REAL E[3][3];				//Rotation from parent coordinates to link coordinates
+	EVDS_REAL r[3];					//Link origin in parent coordinates
+	EVDS_REAL S[6];					//Joint motion subspace
+	EVDS_REAL v[6],c[6],a[6];		//Velocity, bias acceleration, acceleration
+	EVDS_REAL I[6][6];				//Spatial inertia of the link
+	EVDS_REAL IA[6][6],pA[6];		//Articulated inertia and bias force
+	EVDS_REAL U[6],D,u;
+	EVDS_REAL qdd;					//Joint acceleration
+} EVDS_SOLVER_ARTICULATED_LINK;
+
+typedef struct EVDS_SOLVER_ARTICULATED_USERDATA_TAG {
+	//Links in depth-first order (every parent is listed before its children)
+	EVDS_SOLVER_ARTICULATED_LINK* links;
+	int links_count;
+	int children_revision;
+
+	//Base variables
+	EVDS_VARIABLE *gravity;			//Uniform gravity in base coordinates
+	EVDS_VARIABLE *m,*cm;			//Mass and center of mass of the base
+	EVDS_VARIABLE *jx,*jy,*jz;		//Radius of gyration squared of the base
+	EVDS_VARIABLE *M,*CM;			//Total mass and center of mass
+	EVDS_VARIABLE *Ix,*Iy,*Iz;		//Total moment of inertia
+
+	//Reaction upon the base (spatial force in base coordinates)
+	EVDS_REAL reaction[6];
+} EVDS_SOLVER_ARTICULATED_USERDATA;
+
+typedef struct EVDS_SOLVER_ARTICULATED_LINK_USERDATA_TAG {
+	EVDS_VARIABLE *zero_position;	//Position at zero joint coordinate
+	EVDS_VARIABLE *zero_orientation;//Orientation at zero joint coordinate
+} EVDS_SOLVER_ARTICULATED_LINK_USERDATA;
+#endif
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Cross product of two 3D vectors
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalArticulated_Cross(EVDS_REAL* target, EVDS_REAL* a, EVDS_REAL* b) {
+	EVDS_REAL x = a[1]*b[2] - a[2]*b[1];
+	EVDS_REAL y = a[2]*b[0] - a[0]*b[2];
+	EVDS_REAL z = a[0]*b[1] - a[1]*b[0];
+	target[0] = x;
+	target[1] = y;
+	target[2] = z;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Transform motion vector from parent coordinates to link coordinates (X m)
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalArticulated_TransformMotion(EVDS_REAL* target, EVDS_SOLVER_ARTICULATED_LINK* link, EVDS_REAL* m) {
+	int i;
+	EVDS_REAL rw[3],v[3];
+	EVDS_InternalArticulated_Cross(rw,link->r,m);
+	v[0] = m[3] - rw[0];
+	v[1] = m[4] - rw[1];
+	v[2] = m[5] - rw[2];
+	for (i = 0; i < 3; i++) {
+		target[i]   = link->E[i][0]*m[0] + link->E[i][1]*m[1] + link->E[i][2]*m[2];
+		target[i+3] = link->E[i][0]*v[0] + link->E[i][1]*v[1] + link->E[i][2]*v[2];
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Transform force vector from link coordinates to parent coordinates (X^T f)
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalArticulated_TransformForce(EVDS_REAL* target, EVDS_SOLVER_ARTICULATED_LINK* link, EVDS_REAL* f) {
+	int i;
+	EVDS_REAL n[3],rf[3];
+	for (i = 0; i < 3; i++) {
+		n[i]        = link->E[0][i]*f[0] + link->E[1][i]*f[1] + link->E[2][i]*f[2];
+		target[i+3] = link->E[0][i]*f[3] + link->E[1][i]*f[4] + link->E[2][i]*f[5];
+	}
+	EVDS_InternalArticulated_Cross(rf,link->r,&target[3]);
+	target[0] = n[0] + rf[0];
+	target[1] = n[1] + rf[1];
+	target[2] = n[2] + rf[2];
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Transform inertia from link coordinates and add it to inertia in parent coordinates (X^T I X)
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalArticulated_TransformInertia(EVDS_REAL target[6][6], EVDS_SOLVER_ARTICULATED_LINK* link, EVDS_REAL I[6][6]) {
+	int i,j,k;
+	EVDS_REAL X[6][6];
+	EVDS_REAL IX[6][6];
+
+	//Build motion transform X = [E 0; -E*rx E]
+	memset(X,0,sizeof(X));
+	for (i = 0; i < 3; i++) {
+		for (j = 0; j < 3; j++) {
+			X[i][j] = link->E[i][j];
+			X[i+3][j+3] = link->E[i][j];
+		}
+		X[i+3][0] = -(link->E[i][1]*link->r[2] - link->E[i][2]*link->r[1]);
+		X[i+3][1] = -(link->E[i][2]*link->r[0] - link->E[i][0]*link->r[2]);
+		X[i+3][2] = -(link->E[i][0]*link->r[1] - link->E[i][1]*link->r[0]);
+	}
+
+	//Compute X^T I X
+	for (i = 0; i < 6; i++) {
+		for (j = 0; j < 6; j++) {
+			IX[i][j] = 0.0;
+			for (k = 0; k < 6; k++) IX[i][j] += I[i][k]*X[k][j];
+		}
+	}
+	for (i = 0; i < 6; i++) {
+		for (j = 0; j < 6; j++) {
+			for (k = 0; k < 6; k++) target[i][j] += X[k][i]*IX[k][j];
+		}
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Spatial cross product for motion vectors (v x m)
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalArticulated_CrossMotion(EVDS_REAL* target, EVDS_REAL* v, EVDS_REAL* m) {
+	EVDS_REAL a[3],b[3],c[3];
+	EVDS_InternalArticulated_Cross(a,&v[0],&m[0]);
+	EVDS_InternalArticulated_Cross(b,&v[0],&m[3]);
+	EVDS_InternalArticulated_Cross(c,&v[3],&m[0]);
+	target[0] = a[0];			target[1] = a[1];			target[2] = a[2];
+	target[3] = b[0] + c[0];	target[4] = b[1] + c[1];	target[5] = b[2] + c[2];
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Spatial cross product for force vectors (v x* f)
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalArticulated_CrossForce(EVDS_REAL* target, EVDS_REAL* v, EVDS_REAL* f) {
+	EVDS_REAL a[3],b[3],c[3];
+	EVDS_InternalArticulated_Cross(a,&v[0],&f[0]);
+	EVDS_InternalArticulated_Cross(b,&v[3],&f[3]);
+	EVDS_InternalArticulated_Cross(c,&v[0],&f[3]);
+	target[0] = a[0] + b[0];	target[1] = a[1] + b[1];	target[2] = a[2] + b[2];
+	target[3] = c[0];			target[4] = c[1];			target[5] = c[2];
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Multiply 6x6 matrix by a spatial vector
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalArticulated_Multiply(EVDS_REAL* target, EVDS_REAL I[6][6], EVDS_REAL* v) {
+	int i,j;
+	for (i = 0; i < 6; i++) {
+		target[i] = 0.0;
+		for (j = 0; j < 6; j++) target[i] += I[i][j]*v[j];
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Build spatial inertia around reference point from mass, center of mass and inertia tensor
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalArticulated_SpatialInertia(EVDS_REAL I[6][6], EVDS_REAL m, EVDS_REAL* c, EVDS_VECTOR* Ic) {
+	int i,j;
+	EVDS_REAL cc = c[0]*c[0] + c[1]*c[1] + c[2]*c[2];
+	EVDS_REAL cx[3][3];
+	cx[0][0] = 0.0;		cx[0][1] = -c[2];	cx[0][2] = c[1];
+	cx[1][0] = c[2];	cx[1][1] = 0.0;		cx[1][2] = -c[0];
+	cx[2][0] = -c[1];	cx[2][1] = c[0];	cx[2][2] = 0.0;
+
+	for (i = 0; i < 3; i++) {
+		for (j = 0; j < 3; j++) {
+			I[i][j] = m*((i == j ? cc : 0.0) - c[i]*c[j]);
+			I[i][j+3] = m*cx[i][j];
+			I[i+3][j] = -m*cx[i][j];
+			I[i+3][j+3] = (i == j ? m : 0.0);
+		}
+	}
+	I[0][0] += Ic[0].x;	I[0][1] += Ic[0].y;	I[0][2] += Ic[0].z;
+	I[1][0] += Ic[1].x;	I[1][1] += Ic[1].y;	I[1][2] += Ic[1].z;
+	I[2][0] += Ic[2].x;	I[2][1] += Ic[2].y;	I[2][2] += Ic[2].z;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Get mass properties of an object: mass, center of mass and inertia tensor around it
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalArticulated_GetMass(EVDS_OBJECT* object, EVDS_VARIABLE* mass, EVDS_VARIABLE* cm,
+									  EVDS_VARIABLE* jx, EVDS_VARIABLE* jy, EVDS_VARIABLE* jz,
+									  EVDS_REAL* m, EVDS_REAL* c, EVDS_VECTOR* Ic) {
+	EVDS_VECTOR vector;
+	*m = 0.0;
+	c[0] = 0.0; c[1] = 0.0; c[2] = 0.0;
+	EVDS_Vector_Initialize(Ic[0]);
+	EVDS_Vector_Initialize(Ic[1]);
+	EVDS_Vector_Initialize(Ic[2]);
+
+	if (mass) EVDS_Variable_GetReal(mass,m);
+	if (cm) {
+		EVDS_Variable_GetVector(cm,&vector);
+		EVDS_Vector_Get(&vector,&c[0],&c[1],&c[2],object);
+	}
+	if (jx && jy && jz) {
+		EVDS_Variable_GetVector(jx,&Ic[0]);
+		EVDS_Variable_GetVector(jy,&Ic[1]);
+		EVDS_Variable_GetVector(jz,&Ic[2]);
+		EVDS_Vector_Multiply(&Ic[0],&Ic[0],*m);
+		EVDS_Vector_Multiply(&Ic[1],&Ic[1],*m);
+		EVDS_Vector_Multiply(&Ic[2],&Ic[2],*m);
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Count links in the subtree of the object
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalArticulated_CountLinks(EVDS_OBJECT* object) {
+	int count = 0;
+	SIMC_LIST* children;
+	SIMC_LIST_ENTRY* entry;
+
+	EVDS_Object_GetChildren(object,&children);
+	entry = SIMC_List_GetFirst(children);
+	while (entry) {
+		EVDS_OBJECT* child = (EVDS_OBJECT*)SIMC_List_GetData(children,entry);
+		if (EVDS_Object_CheckType(child,"link") == EVDS_OK) {
+			count += 1 + EVDS_InternalArticulated_CountLinks(child);
+		}
+		entry = SIMC_List_GetNext(children,entry);
+	}
+	return count;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Add links in the subtree of the object to the list (in depth-first order)
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalArticulated_AddLinks(EVDS_SOLVER_ARTICULATED_USERDATA* userdata, EVDS_OBJECT* object, int parent) {
+	SIMC_LIST* children;
+	SIMC_LIST_ENTRY* entry;
+
+	EVDS_Object_GetChildren(object,&children);
+	entry = SIMC_List_GetFirst(children);
+	while (entry) {
+		EVDS_OBJECT* child = (EVDS_OBJECT*)SIMC_List_GetData(children,entry);
+		if (EVDS_Object_CheckType(child,"link") == EVDS_OK) {
+			EVDS_SOLVER_ARTICULATED_LINK* link = &userdata->links[userdata->links_count];
+			EVDS_SOLVER_ARTICULATED_LINK_USERDATA* link_userdata;
+			EVDS_VARIABLE* variable;
+			EVDS_VECTOR vector;
+			EVDS_QUATERNION quaternion;
+			EVDS_REAL length;
+			char type[64] = { 0 };
+			int index = userdata->links_count;
+			userdata->links_count++;
+
+			link->object = child;
+			link->parent = parent;
+
+			//Joint type and axis
+			if (EVDS_Object_GetVariable(child,"joint.type",&variable) == EVDS_OK) {
+				EVDS_Variable_GetString(variable,type,63,0);
+			}
+			link->is_prismatic = (strcmp(type,"prismatic") == 0);
+
+			link->axis[0] = 0.0; link->axis[1] = 0.0; link->axis[2] = 1.0;
+			if (EVDS_Object_GetVariable(child,"joint.axis",&variable) == EVDS_OK) {
+				EVDS_Variable_GetVector(variable,&vector);
+				length = sqrt(vector.x*vector.x + vector.y*vector.y + vector.z*vector.z);
+				if (length > EVDS_EPS) {
+					link->axis[0] = vector.x / length;
+					link->axis[1] = vector.y / length;
+					link->axis[2] = vector.z / length;
+				}
+			}
+			memset(link->S,0,sizeof(link->S));
+			if (link->is_prismatic) {
+				link->S[3] = link->axis[0]; link->S[4] = link->axis[1]; link->S[5] = link->axis[2];
+			} else {
+				link->S[0] = link->axis[0]; link->S[1] = link->axis[1]; link->S[2] = link->axis[2];
+			}
+
+			//Pose at zero joint coordinate
+			EVDS_Object_GetSolverdata(child,(void**)&link_userdata);
+			EVDS_Variable_GetVector(link_userdata->zero_position,&vector);
+			EVDS_Variable_GetQuaternion(link_userdata->zero_orientation,&quaternion);
+			link->p0[0] = vector.x; link->p0[1] = vector.y; link->p0[2] = vector.z;
+			link->q0[0] = quaternion.q[0]; link->q0[1] = quaternion.q[1];
+			link->q0[2] = quaternion.q[2]; link->q0[3] = quaternion.q[3];
+
+			//Joint state variables
+			EVDS_Object_GetVariable(child,"joint.q",&link->q);
+			EVDS_Object_GetVariable(child,"joint.dq",&link->dq);
+			EVDS_Object_GetVariable(child,"joint.ddq",&link->ddq);
+			EVDS_Object_GetVariable(child,"joint.force",&link->force);
+			EVDS_Object_GetVariable(child,"joint.command",&link->command);
+			EVDS_Object_GetVariable(child,"joint.stiffness",&link->stiffness);
+			EVDS_Object_GetVariable(child,"joint.damping",&link->damping);
+
+			//Mass properties
+			if (EVDS_Object_GetVariable(child,"mass",&link->mass) != EVDS_OK) link->mass = 0;
+			if (EVDS_Object_GetVariable(child,"cm",&link->cm) != EVDS_OK) link->cm = 0;
+			if ((EVDS_Object_GetVariable(child,"jx",&link->jx) != EVDS_OK) ||
+				(EVDS_Object_GetVariable(child,"jy",&link->jy) != EVDS_OK) ||
+				(EVDS_Object_GetVariable(child,"jz",&link->jz) != EVDS_OK)) {
+				link->jx = 0;
+				link->jy = 0;
+				link->jz = 0;
+			}
+
+			//Add links attached to this one
+			EVDS_InternalArticulated_AddLinks(userdata,child,index);
+		}
+		entry = SIMC_List_GetNext(children,entry);
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Rebuild list of links if list of children has changed.
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalArticulated_UpdateLinks(EVDS_OBJECT* object, EVDS_SOLVER_ARTICULATED_USERDATA* userdata) {
+	int count;
+	if (userdata->children_revision == object->children_revision) return EVDS_OK;
+
+	count = EVDS_InternalArticulated_CountLinks(object);
+	if (userdata->links) free(userdata->links);
+	userdata->links = (EVDS_SOLVER_ARTICULATED_LINK*)malloc(sizeof(EVDS_SOLVER_ARTICULATED_LINK)*(count+1));
+	if (!userdata->links) return EVDS_ERROR_MEMORY;
+	memset(userdata->links,0,sizeof(EVDS_SOLVER_ARTICULATED_LINK)*(count+1));
+
+	userdata->links_count = 0;
+	EVDS_InternalArticulated_AddLinks(userdata,object,-1);
+	userdata->children_revision = object->children_revision;
+	return EVDS_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Compute joint transform of the link and write state vector of the link
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalArticulated_UpdateTransform(EVDS_SOLVER_ARTICULATED_LINK* link, EVDS_REAL q, EVDS_REAL dq, EVDS_REAL ddq) {
+	EVDS_REAL w,x,y,z,s;
+	EVDS_REAL jq[4];
+	EVDS_REAL R0[3][3];
+	EVDS_REAL axis[3];
+	EVDS_OBJECT* parent;
+	EVDS_STATE_VECTOR state;
+	int i;
+
+	//Joint rotation (rotation around joint axis in link coordinates)
+	if (link->is_prismatic) {
+		jq[0] = 1.0; jq[1] = 0.0; jq[2] = 0.0; jq[3] = 0.0;
+	} else {
+		s = sin(q*0.5);
+		jq[0] = cos(q*0.5);
+		jq[1] = s*link->axis[0];
+		jq[2] = s*link->axis[1];
+		jq[3] = s*link->axis[2];
+	}
+
+	//Orientation of link in parent coordinates (zero orientation rotated by joint rotation)
+	w = link->q0[0]*jq[0] - link->q0[1]*jq[1] - link->q0[2]*jq[2] - link->q0[3]*jq[3];
+	x = link->q0[0]*jq[1] + link->q0[1]*jq[0] + link->q0[2]*jq[3] - link->q0[3]*jq[2];
+	y = link->q0[0]*jq[2] - link->q0[1]*jq[3] + link->q0[2]*jq[0] + link->q0[3]*jq[1];
+	z = link->q0[0]*jq[3] + link->q0[1]*jq[2] - link->q0[2]*jq[1] + link->q0[3]*jq[0];
+
+	//Rotation from parent coordinates into link coordinates is transpose of link orientation
+	link->E[0][0] = 1 - 2*(y*y + z*z);	link->E[1][0] = 2*(x*y - w*z);		link->E[2][0] = 2*(x*z + w*y);
+	link->E[0][1] = 2*(x*y + w*z);		link->E[1][1] = 1 - 2*(x*x + z*z);	link->E[2][1] = 2*(y*z - w*x);
+	link->E[0][2] = 2*(x*z - w*y);		link->E[1][2] = 2*(y*z + w*x);		link->E[2][2] = 1 - 2*(x*x + y*y);
+
+	//Joint axis in parent coordinates (same for zero orientation and current orientation)
+	R0[0][0] = 1 - 2*(link->q0[2]*link->q0[2] + link->q0[3]*link->q0[3]);
+	R0[0][1] = 2*(link->q0[1]*link->q0[2] - link->q0[0]*link->q0[3]);
+	R0[0][2] = 2*(link->q0[1]*link->q0[3] + link->q0[0]*link->q0[2]);
+	R0[1][0] = 2*(link->q0[1]*link->q0[2] + link->q0[0]*link->q0[3]);
+	R0[1][1] = 1 - 2*(link->q0[1]*link->q0[1] + link->q0[3]*link->q0[3]);
+	R0[1][2] = 2*(link->q0[2]*link->q0[3] - link->q0[0]*link->q0[1]);
+	R0[2][0] = 2*(link->q0[1]*link->q0[3] - link->q0[0]*link->q0[2]);
+	R0[2][1] = 2*(link->q0[2]*link->q0[3] + link->q0[0]*link->q0[1]);
+	R0[2][2] = 1 - 2*(link->q0[1]*link->q0[1] + link->q0[2]*link->q0[2]);
+	for (i = 0; i < 3; i++) {
+		axis[i] = R0[i][0]*link->axis[0] + R0[i][1]*link->axis[1] + R0[i][2]*link->axis[2];
+	}
+
+	//Position of link origin in parent coordinates
+	for (i = 0; i < 3; i++) {
+		link->r[i] = link->p0[i] + (link->is_prismatic ? axis[i]*q : 0.0);
+	}
+
+	//Write state vector of the link
+	EVDS_Object_GetParent(link->object,&parent);
+	EVDS_Object_GetStateVector(link->object,&state);
+	EVDS_Vector_Set(&state.position,EVDS_VECTOR_POSITION,parent,link->r[0],link->r[1],link->r[2]);
+	state.orientation.q[0] = w;
+	state.orientation.q[1] = x;
+	state.orientation.q[2] = y;
+	state.orientation.q[3] = z;
+	state.orientation.coordinate_system = parent;
+	if (link->is_prismatic) {
+		EVDS_Vector_Set(&state.velocity,EVDS_VECTOR_VELOCITY,parent,axis[0]*dq,axis[1]*dq,axis[2]*dq);
+		EVDS_Vector_Set(&state.acceleration,EVDS_VECTOR_ACCELERATION,parent,axis[0]*ddq,axis[1]*ddq,axis[2]*ddq);
+		EVDS_Vector_Set(&state.angular_velocity,EVDS_VECTOR_ANGULAR_VELOCITY,parent,0,0,0);
+		EVDS_Vector_Set(&state.angular_acceleration,EVDS_VECTOR_ANGULAR_ACCELERATION,parent,0,0,0);
+	} else {
+		EVDS_Vector_Set(&state.velocity,EVDS_VECTOR_VELOCITY,parent,0,0,0);
+		EVDS_Vector_Set(&state.acceleration,EVDS_VECTOR_ACCELERATION,parent,0,0,0);
+		EVDS_Vector_Set(&state.angular_velocity,EVDS_VECTOR_ANGULAR_VELOCITY,parent,axis[0]*dq,axis[1]*dq,axis[2]*dq);
+		EVDS_Vector_Set(&state.angular_acceleration,EVDS_VECTOR_ANGULAR_ACCELERATION,parent,axis[0]*ddq,axis[1]*ddq,axis[2]*ddq);
+	}
+	EVDS_Object_SetStateVector(link->object,&state);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Get external spatial force acting upon the link (forces and torques of its children)
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalArticulated_GetExternalForce(EVDS_SOLVER_ARTICULATED_LINK* link, EVDS_REAL delta_time, EVDS_REAL* f) {
+	SIMC_LIST* children;
+	SIMC_LIST_ENTRY* entry;
+	EVDS_VECTOR origin;
+	memset(f,0,sizeof(EVDS_REAL)*6);
+	EVDS_Vector_Set(&origin,EVDS_VECTOR_POSITION,link->object,0,0,0);
+
+	EVDS_Object_GetChildren(link->object,&children);
+	entry = SIMC_List_GetFirst(children);
+	while (entry) {
+		EVDS_OBJECT* child = (EVDS_OBJECT*)SIMC_List_GetData(children,entry);
+		if ((EVDS_Object_CheckType(child,"link") != EVDS_OK) &&
+			((child->integrate != 0) || (child->solver && child->solver->OnIntegrate))) {
+			EVDS_STATE_VECTOR_DERIVATIVE derivative;
+			EVDS_VECTOR force,torque;
+
+			EVDS_Vector_Initialize(force);
+			EVDS_Vector_Initialize(torque);
+			EVDS_Object_Integrate(child,delta_time,0,&derivative);
+
+			//Force around link origin
+			EVDS_Vector_Convert(&force,&derivative.force,link->object);
+			EVDS_Vector_MoveForceToPosition(&force,&torque,&origin);
+			f[0] += torque.x; f[1] += torque.y; f[2] += torque.z;
+			f[3] += force.x;  f[4] += force.y;  f[5] += force.z;
+
+			//Torque
+			EVDS_Vector_Convert(&torque,&derivative.torque,link->object);
+			f[0] += torque.x; f[1] += torque.y; f[2] += torque.z;
+		}
+		entry = SIMC_List_GetNext(children,entry);
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Compute and store total mass properties of the mechanism (in base coordinates)
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalArticulated_UpdateTotals(EVDS_OBJECT* object, EVDS_SOLVER_ARTICULATED_USERDATA* userdata) {
+	int i,j,k;
+	EVDS_REAL M,C[3];
+	EVDS_REAL I[3][3];
+	EVDS_REAL m,c[3];
+	EVDS_VECTOR Ic[3];
+	EVDS_VECTOR vector;
+	EVDS_REAL (*R)[3][3];			//Rotation from link coordinates to base coordinates
+	EVDS_REAL (*p)[3];				//Position of link origin in base coordinates
+
+	R = (EVDS_REAL(*)[3][3])malloc(sizeof(EVDS_REAL)*9*(userdata->links_count+1));
+	p = (EVDS_REAL(*)[3])malloc(sizeof(EVDS_REAL)*3*(userdata->links_count+1));
+	if ((!R) || (!p)) {
+		if (R) free(R);
+		if (p) free(p);
+		return;
+	}
+
+	//Mass of the base itself (inertia around origin)
+	EVDS_InternalArticulated_GetMass(object,userdata->m,userdata->cm,
+		userdata->jx,userdata->jy,userdata->jz,&m,c,Ic);
+	M = m;
+	for (i = 0; i < 3; i++) {
+		C[i] = m*c[i];
+		I[i][0] = Ic[i].x;
+		I[i][1] = Ic[i].y;
+		I[i][2] = Ic[i].z;
+		for (j = 0; j < 3; j++) I[i][j] += m*((i == j ? c[0]*c[0]+c[1]*c[1]+c[2]*c[2] : 0.0) - c[i]*c[j]);
+	}
+
+	//Add every link
+	for (k = 0; k < userdata->links_count; k++) {
+		EVDS_SOLVER_ARTICULATED_LINK* link = &userdata->links[k];
+		EVDS_REAL lc[3],lI[3][3],RI[3][3];
+
+		//Pose of the link in base coordinates
+		if (link->parent < 0) {
+			for (i = 0; i < 3; i++) {
+				for (j = 0; j < 3; j++) R[k][i][j] = link->E[j][i];
+				p[k][i] = link->r[i];
+			}
+		} else {
+			EVDS_REAL (*Rp)[3] = R[link->parent];
+			for (i = 0; i < 3; i++) {
+				for (j = 0; j < 3; j++) {
+					R[k][i][j] = Rp[i][0]*link->E[j][0] + Rp[i][1]*link->E[j][1] + Rp[i][2]*link->E[j][2];
+				}
+				p[k][i] = p[link->parent][i] + Rp[i][0]*link->r[0] + Rp[i][1]*link->r[1] + Rp[i][2]*link->r[2];
+			}
+		}
+
+		//Mass properties of the link
+		EVDS_InternalArticulated_GetMass(link->object,link->mass,link->cm,link->jx,link->jy,link->jz,&m,c,Ic);
+		if (m <= 0.0) continue;
+		for (i = 0; i < 3; i++) {
+			lc[i] = p[k][i] + R[k][i][0]*c[0] + R[k][i][1]*c[1] + R[k][i][2]*c[2];
+		}
+		for (i = 0; i < 3; i++) {
+			lI[i][0] = Ic[i].x;
+			lI[i][1] = Ic[i].y;
+			lI[i][2] = Ic[i].z;
+		}
+
+		//Rotate inertia tensor into base coordinates (R I R^T) and move it to base origin
+		for (i = 0; i < 3; i++) {
+			for (j = 0; j < 3; j++) {
+				RI[i][j] = R[k][i][0]*lI[0][j] + R[k][i][1]*lI[1][j] + R[k][i][2]*lI[2][j];
+			}
+		}
+		for (i = 0; i < 3; i++) {
+			for (j = 0; j < 3; j++) {
+				I[i][j] += RI[i][0]*R[k][j][0] + RI[i][1]*R[k][j][1] + RI[i][2]*R[k][j][2];
+				I[i][j] += m*((i == j ? lc[0]*lc[0]+lc[1]*lc[1]+lc[2]*lc[2] : 0.0) - lc[i]*lc[j]);
+			}
+			C[i] += m*lc[i];
+		}
+		M += m;
+	}
+	free(R);
+	free(p);
+
+	//Move total inertia from base origin to total center of mass
+	if (M > EVDS_EPS) {
+		C[0] /= M; C[1] /= M; C[2] /= M;
+		for (i = 0; i < 3; i++) {
+			for (j = 0; j < 3; j++) {
+				I[i][j] -= M*((i == j ? C[0]*C[0]+C[1]*C[1]+C[2]*C[2] : 0.0) - C[i]*C[j]);
+			}
+		}
+	}
+
+	//Store totals
+	EVDS_Variable_SetReal(userdata->M,M);
+	EVDS_Vector_Set(&vector,EVDS_VECTOR_POSITION,object,C[0],C[1],C[2]);
+	EVDS_Variable_SetVector(userdata->CM,&vector);
+	EVDS_Vector_Set(&vector,EVDS_VECTOR_POSITION,object,I[0][0],I[0][1],I[0][2]);
+	EVDS_Variable_SetVector(userdata->Ix,&vector);
+	EVDS_Vector_Set(&vector,EVDS_VECTOR_POSITION,object,I[1][0],I[1][1],I[1][2]);
+	EVDS_Variable_SetVector(userdata->Iy,&vector);
+	EVDS_Vector_Set(&vector,EVDS_VECTOR_POSITION,object,I[2][0],I[2][1],I[2][2]);
+	EVDS_Variable_SetVector(userdata->Iz,&vector);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Articulated body solver.
+///
+/// Solves all children, computes joint accelerations using articulated-body algorithm,
+/// then propagates joint coordinates over the time step and updates state vectors of links.
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalArticulated_Solve(EVDS_SYSTEM* system, EVDS_SOLVER* solver, EVDS_OBJECT* object, EVDS_REAL delta_time) {
+	int i,j,k;
+	EVDS_REAL q,dq,tau,value;
+	EVDS_REAL a0[6];
+	EVDS_REAL vJ[6],Xv[6],Iv[6],f[6];
+	EVDS_REAL Ia[6][6],pa[6];
+	EVDS_VECTOR gravity;
+	SIMC_LIST* children;
+	SIMC_LIST_ENTRY* entry;
+	EVDS_SOLVER_ARTICULATED_USERDATA* userdata;
+	EVDS_ERRCHECK(EVDS_Object_GetSolverdata(object,(void**)&userdata));
+	EVDS_ERRCHECK(EVDS_InternalArticulated_UpdateLinks(object,userdata));
+
+	//Solve all children (links without a solving function will solve their children)
+	EVDS_ERRCHECK(EVDS_Object_GetChildren(object,&children));
+	entry = SIMC_List_GetFirst(children);
+	while (entry) {
+		EVDS_Object_Solve((EVDS_OBJECT*)SIMC_List_GetData(children,entry),delta_time);
+		entry = SIMC_List_GetNext(children,entry);
+	}
+
+	//Acceleration of the base (uniform gravity is equivalent to base accelerating upwards)
+	memset(a0,0,sizeof(a0));
+	if (userdata->gravity) {
+		EVDS_Variable_GetVector(userdata->gravity,&gravity);
+		a0[3] = -gravity.x;
+		a0[4] = -gravity.y;
+		a0[5] = -gravity.z;
+	}
+
+	//Pass 1: velocities and bias forces (from base to leaves)
+	for (i = 0; i < userdata->links_count; i++) {
+		EVDS_SOLVER_ARTICULATED_LINK* link = &userdata->links[i];
+		EVDS_REAL m,c[3];
+		EVDS_VECTOR Ic[3];
+
+		EVDS_Variable_GetReal(link->q,&q);
+		EVDS_Variable_GetReal(link->dq,&dq);
+		EVDS_InternalArticulated_UpdateTransform(link,q,dq,link->qdd);
+
+		//Velocity of the link
+		for (j = 0; j < 6; j++) vJ[j] = link->S[j]*dq;
+		if (link->parent < 0) {
+			memcpy(link->v,vJ,sizeof(vJ));
+		} else {
+			EVDS_InternalArticulated_TransformMotion(Xv,link,userdata->links[link->parent].v);
+			for (j = 0; j < 6; j++) link->v[j] = Xv[j] + vJ[j];
+		}
+		EVDS_InternalArticulated_CrossMotion(link->c,link->v,vJ);
+
+		//Spatial inertia and bias force
+		EVDS_InternalArticulated_GetMass(link->object,link->mass,link->cm,link->jx,link->jy,link->jz,&m,c,Ic);
+		EVDS_InternalArticulated_SpatialInertia(link->I,m,c,Ic);
+		memcpy(link->IA,link->I,sizeof(link->IA));
+		EVDS_InternalArticulated_Multiply(Iv,link->I,link->v);
+		EVDS_InternalArticulated_CrossForce(link->pA,link->v,Iv);
+		EVDS_InternalArticulated_GetExternalForce(link,delta_time,f);
+		for (j = 0; j < 6; j++) link->pA[j] -= f[j];
+	}
+
+	//Pass 2: articulated inertias (from leaves to base)
+	for (i = userdata->links_count-1; i >= 0; i--) {
+		EVDS_SOLVER_ARTICULATED_LINK* link = &userdata->links[i];
+		EVDS_SOLVER_ARTICULATED_LINK* parent;
+
+		//Joint force: actuator, servo and damping
+		EVDS_Variable_GetReal(link->q,&q);
+		EVDS_Variable_GetReal(link->dq,&dq);
+		EVDS_Variable_GetReal(link->force,&tau);
+		EVDS_Variable_GetReal(link->stiffness,&value);
+		if (value != 0.0) {
+			EVDS_REAL command;
+			EVDS_Variable_GetReal(link->command,&command);
+			tau += value*(command - q);
+		}
+		EVDS_Variable_GetReal(link->damping,&value);
+		tau -= value*dq;
+
+		EVDS_InternalArticulated_Multiply(link->U,link->IA,link->S);
+		link->D = 0.0;
+		link->u = tau;
+		for (j = 0; j < 6; j++) {
+			link->D += link->S[j]*link->U[j];
+			link->u -= link->S[j]*link->pA[j];
+		}
+		if (link->parent < 0) continue;
+		parent = &userdata->links[link->parent];
+
+		//Inertia and bias force transmitted to parent (joint is locked if it has no inertia along its axis)
+		memcpy(Ia,link->IA,sizeof(Ia));
+		if (link->D > EVDS_EPS) {
+			for (j = 0; j < 6; j++) {
+				for (k = 0; k < 6; k++) Ia[j][k] -= link->U[j]*link->U[k]/link->D;
+			}
+		}
+		EVDS_InternalArticulated_Multiply(pa,Ia,link->c);
+		for (j = 0; j < 6; j++) {
+			pa[j] += link->pA[j];
+			if (link->D > EVDS_EPS) pa[j] += link->U[j]*link->u/link->D;
+		}
+		EVDS_InternalArticulated_TransformInertia(parent->IA,link,Ia);
+		EVDS_InternalArticulated_TransformForce(f,link,pa);
+		for (j = 0; j < 6; j++) parent->pA[j] += f[j];
+	}
+
+	//Pass 3: accelerations (from base to leaves), reaction upon the base
+	memset(userdata->reaction,0,sizeof(userdata->reaction));
+	for (i = 0; i < userdata->links_count; i++) {
+		EVDS_SOLVER_ARTICULATED_LINK* link = &userdata->links[i];
+		EVDS_InternalArticulated_TransformMotion(link->a,link,
+			(link->parent < 0) ? a0 : userdata->links[link->parent].a);
+		for (j = 0; j < 6; j++) link->a[j] += link->c[j];
+
+		link->qdd = 0.0;
+		if (link->D > EVDS_EPS) {
+			value = link->u;
+			for (j = 0; j < 6; j++) value -= link->U[j]*link->a[j];
+			link->qdd = value / link->D;
+		}
+		for (j = 0; j < 6; j++) link->a[j] += link->S[j]*link->qdd;
+
+		//Force transmitted through the joint into the base
+		if (link->parent < 0) {
+			EVDS_InternalArticulated_Multiply(Iv,link->IA,link->a);
+			for (j = 0; j < 6; j++) Iv[j] += link->pA[j];
+			EVDS_InternalArticulated_TransformForce(f,link,Iv);
+			for (j = 0; j < 6; j++) userdata->reaction[j] -= f[j];
+		}
+	}
+
+	//Propagate joint coordinates (semi-implicit Euler)
+	for (i = 0; i < userdata->links_count; i++) {
+		EVDS_SOLVER_ARTICULATED_LINK* link = &userdata->links[i];
+		EVDS_Variable_GetReal(link->q,&q);
+		EVDS_Variable_GetReal(link->dq,&dq);
+		dq += link->qdd*delta_time;
+		q += dq*delta_time;
+		EVDS_Variable_SetReal(link->q,q);
+		EVDS_Variable_SetReal(link->dq,dq);
+		EVDS_Variable_SetReal(link->ddq,link->qdd);
+		EVDS_InternalArticulated_UpdateTransform(link,q,dq,link->qdd);
+	}
+
+	//Update mass properties of the whole mechanism
+	EVDS_InternalArticulated_UpdateTotals(object,userdata);
+	return EVDS_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Output reaction force and torque upon the base
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalArticulated_Integrate(EVDS_SYSTEM* system, EVDS_SOLVER* solver, EVDS_OBJECT* object,
+									   EVDS_REAL delta_time, EVDS_STATE_VECTOR* state, EVDS_STATE_VECTOR_DERIVATIVE* derivative) {
+	EVDS_VECTOR origin;
+	EVDS_SOLVER_ARTICULATED_USERDATA* userdata;
+	EVDS_ERRCHECK(EVDS_Object_GetSolverdata(object,(void**)&userdata));
+
+	EVDS_Vector_Set(&origin,EVDS_VECTOR_POSITION,object,0,0,0);
+	EVDS_Vector_Set(&derivative->force,EVDS_VECTOR_FORCE,object,
+		userdata->reaction[3],userdata->reaction[4],userdata->reaction[5]);
+	EVDS_Vector_SetPositionVector(&derivative->force,&origin);
+	EVDS_Vector_Set(&derivative->torque,EVDS_VECTOR_TORQUE,object,
+		userdata->reaction[0],userdata->reaction[1],userdata->reaction[2]);
+	EVDS_Vector_SetPositionVector(&derivative->torque,&origin);
+	return EVDS_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Initialize articulated body solver
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalArticulated_Initialize(EVDS_SYSTEM* system, EVDS_SOLVER* solver, EVDS_OBJECT* object) {
+	EVDS_SOLVER_ARTICULATED_USERDATA* userdata;
+	if (EVDS_Object_CheckType(object,"articulated_body") != EVDS_OK) return EVDS_IGNORE_OBJECT;
+
+	//Create userdata
+	userdata = (EVDS_SOLVER_ARTICULATED_USERDATA*)malloc(sizeof(EVDS_SOLVER_ARTICULATED_USERDATA));
+	memset(userdata,0,sizeof(EVDS_SOLVER_ARTICULATED_USERDATA));
+	EVDS_ERRCHECK(EVDS_Object_SetSolverdata(object,userdata));
+
+	//List of links will be built during first solver call
+	userdata->links = 0;
+	userdata->links_count = 0;
+	userdata->children_revision = -1;
+
+	//Optional variables
+	if (EVDS_Object_GetVariable(object,"gravity",&userdata->gravity) != EVDS_OK) userdata->gravity = 0;
+	if (EVDS_Object_GetVariable(object,"mass",&userdata->m) != EVDS_OK) userdata->m = 0;
+	if (EVDS_Object_GetVariable(object,"cm",&userdata->cm) != EVDS_OK) userdata->cm = 0;
+	if ((EVDS_Object_GetVariable(object,"jx",&userdata->jx) != EVDS_OK) ||
+		(EVDS_Object_GetVariable(object,"jy",&userdata->jy) != EVDS_OK) ||
+		(EVDS_Object_GetVariable(object,"jz",&userdata->jz) != EVDS_OK)) {
+		userdata->jx = 0;
+		userdata->jy = 0;
+		userdata->jz = 0;
+	}
+
+	//Total mass properties of the mechanism
+	EVDS_ERRCHECK(EVDS_Object_AddVariable(object,"total_mass",EVDS_VARIABLE_TYPE_FLOAT,&userdata->M));
+	EVDS_ERRCHECK(EVDS_Object_AddVariable(object,"total_cm",EVDS_VARIABLE_TYPE_VECTOR,&userdata->CM));
+	EVDS_ERRCHECK(EVDS_Object_AddVariable(object,"total_ix",EVDS_VARIABLE_TYPE_VECTOR,&userdata->Ix));
+	EVDS_ERRCHECK(EVDS_Object_AddVariable(object,"total_iy",EVDS_VARIABLE_TYPE_VECTOR,&userdata->Iy));
+	EVDS_ERRCHECK(EVDS_Object_AddVariable(object,"total_iz",EVDS_VARIABLE_TYPE_VECTOR,&userdata->Iz));
+	return EVDS_CLAIM_OBJECT;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Deinitialize articulated body solver
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalArticulated_Deinitialize(EVDS_SYSTEM* system, EVDS_SOLVER* solver, EVDS_OBJECT* object) {
+	EVDS_SOLVER_ARTICULATED_USERDATA* userdata;
+	EVDS_ERRCHECK(EVDS_Object_GetSolverdata(object,(void**)&userdata));
+	if (userdata->links) free(userdata->links);
+	free(userdata);
+	return EVDS_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Initialize link (add joint variables, remember pose at zero joint coordinate)
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalArticulatedLink_Initialize(EVDS_SYSTEM* system, EVDS_SOLVER* solver, EVDS_OBJECT* object) {
+	EVDS_SOLVER_ARTICULATED_LINK_USERDATA* userdata;
+	EVDS_STATE_VECTOR vector;
+	EVDS_VARIABLE* variable;
+	if (EVDS_Object_CheckType(object,"link") != EVDS_OK) return EVDS_IGNORE_OBJECT;
+
+	//Create userdata
+	userdata = (EVDS_SOLVER_ARTICULATED_LINK_USERDATA*)malloc(sizeof(EVDS_SOLVER_ARTICULATED_LINK_USERDATA));
+	memset(userdata,0,sizeof(EVDS_SOLVER_ARTICULATED_LINK_USERDATA));
+	EVDS_ERRCHECK(EVDS_Object_SetSolverdata(object,userdata));
+
+	//Joint variables
+	EVDS_Object_AddRealVariable(object,"joint.q",0,0);
+	EVDS_Object_AddRealVariable(object,"joint.dq",0,0);
+	EVDS_Object_AddRealVariable(object,"joint.ddq",0,0);
+	EVDS_Object_AddRealVariable(object,"joint.force",0,0);
+	EVDS_Object_AddRealVariable(object,"joint.command",0,0);
+	EVDS_Object_AddRealVariable(object,"joint.stiffness",0,0);
+	EVDS_Object_AddRealVariable(object,"joint.damping",0,0);
+
+	//Remember pose at zero joint coordinate (unless it was loaded along with the object)
+	EVDS_Object_GetStateVector(object,&vector);
+	if (EVDS_Object_GetVariable(object,"joint.zero_position",&variable) != EVDS_OK) {
+		EVDS_ERRCHECK(EVDS_Object_AddVariable(object,"joint.zero_position",EVDS_VARIABLE_TYPE_VECTOR,&variable));
+		EVDS_Variable_SetVector(variable,&vector.position);
+	}
+	userdata->zero_position = variable;
+	if (EVDS_Object_GetVariable(object,"joint.zero_orientation",&variable) != EVDS_OK) {
+		EVDS_ERRCHECK(EVDS_Object_AddVariable(object,"joint.zero_orientation",EVDS_VARIABLE_TYPE_QUATERNION,&variable));
+		EVDS_Variable_SetQuaternion(variable,&vector.orientation);
+	}
+	userdata->zero_orientation = variable;
+	return EVDS_CLAIM_OBJECT;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Deinitialize link
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalArticulatedLink_Deinitialize(EVDS_SYSTEM* system, EVDS_SOLVER* solver, EVDS_OBJECT* object) {
+	void* userdata;
+	EVDS_ERRCHECK(EVDS_Object_GetSolverdata(object,&userdata));
+	free(userdata);
+	return EVDS_OK;
+}
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+EVDS_SOLVER EVDS_Solver_ArticulatedBody = {
+	EVDS_InternalArticulated_Initialize, //OnInitialize
+	EVDS_InternalArticulated_Deinitialize, //OnDeinitialize
+	EVDS_InternalArticulated_Solve, //OnSolve
+	EVDS_InternalArticulated_Integrate, //OnIntegrate
+	0, //OnStateSave
+	0, //OnStateLoad
+	0, //OnStartup
+	0, //OnShutdown
+	0, //OnFinalize
+	0, //userdata
+	EVDS_SOLVER_FLAG_REENTRANT, //flags
+};
+EVDS_SOLVER EVDS_Solver_ArticulatedLink = {
+	EVDS_InternalArticulatedLink_Initialize, //OnInitialize
+	EVDS_InternalArticulatedLink_Deinitialize, //OnDeinitialize
+	0, //OnSolve
+	0, //OnIntegrate
+	0, //OnStateSave
+	0, //OnStateLoad
+	0, //OnStartup
+	0, //OnShutdown
+};
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Register articulated body solver (articulated body and its links)
+///
+/// @param[in] system Pointer to EVDS_SYSTEM
+///
+/// @returns Error code
+/// @retval EVDS_OK Successfully completed
+/// @retval EVDS_ERROR_BAD_PARAMETER "system" is null
+/// @retval EVDS_ERROR_BAD_STATE Cannot register solvers in current state
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_ArticulatedBody_Register(EVDS_SYSTEM* system) {
+	EVDS_ERRCHECK(EVDS_Solver_Register(system,&EVDS_Solver_ArticulatedLink));
+	return EVDS_Solver_Register(system,&EVDS_Solver_ArticulatedBody);
+}
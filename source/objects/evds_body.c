@@ -62,6 +62,13 @@
 ///	total_mass		| Total mass of the body
 ///	total_dmass		| Change in total mass of the body (first derivative)
 ///
+/// The following variables are optional:
+/// Name			| Description
+/// ----------------|------------------------------------
+///	parallel_forces	| Compute forces of children with re-entrant solvers in worker threads (see EVDS_System_ParallelFor()) if there are at least this many of them (0 to disable)
+///	sleep_steps		| Number of consecutive propagator steps at rest after which body falls asleep (0 by default, sleeping disabled)
+///	sleep_threshold	| Velocity, angular velocity and accelerations below which body is considered at rest (1e-9 by default)
+///
 /// Some of these variables must be specified for the rigid body simulation
 ///	(see EVDS_Object_Initialize() for more information):
 /// Name			| Description
@@ -175,8 +182,9 @@
 ///
 /// ### Gravity ###
 /// See EVDS_Environment_GetGravitationalField() for equations related to acceleration due to
-/// gravity equations. See EVDS_Callback_GetGravityGradientTorque() for equations related to
-/// torque due to gravity gradient equations.
+/// gravity equations. See EVDS_Environment_GetGravityGradientTorque() for equations related to
+/// torque due to gravity gradient (it is computed from the total inertia tensor of the body,
+/// not summed over its parts).
 ///
 /// ### Aerodynamic Drag ###
 /// See EVDS_Callback_GetAtmosphericData() for information about equations related to atmospheric
@@ -195,11 +203,27 @@
 #include "evds.h"
 
 
+//Default velocity and acceleration below which body is considered to be at rest
+#define EVDS_RIGID_BODY_SLEEP_THRESHOLD		1e-9
+
+
 #ifndef DOXYGEN_INTERNAL_STRUCTS
+typedef struct EVDS_SOLVER_RIGID_CHILD_TAG {
+	EVDS_OBJECT* object;			//Child object
+	EVDS_VARIABLE *mass;			//Total mass or mass of the child
+	EVDS_VARIABLE *cm;				//Total center of mass or center of mass of the child
+	EVDS_VARIABLE *ix, *iy, *iz;	//Total moment of inertia of the child (if child is a rigid body)
+	EVDS_VARIABLE *jx, *jy, *jz;	//Radius of gyration squared of the child (if there is no total moment of inertia)
+	int has_mass;					//Does child contribute to mass properties
+	int has_forces;					//Does child produce forces or torques
+	int is_reentrant;				//Can forces of the child be computed in a worker thread
+} EVDS_SOLVER_RIGID_CHILD;
+
 typedef struct EVDS_SOLVER_RIGID_USERDATA_TAG {
 	// Is this body static? (immovable in any context)
 	int is_static;
-	// Is this body 
+	// Is this body sleeping? (at rest, not integrated until woken up)
+	int is_sleeping;
 	
 	//Is state consistent (has Solver been already called at least once)
 	int is_consistent;
@@ -219,12 +243,221 @@ typedef struct EVDS_SOLVER_RIGID_USERDATA_TAG {
 
 	//Vessel-specific variables
 	EVDS_VARIABLE *detach;			//Detach vessel from current parent
+
+	//Cached information about children (rebuilt only when list of children changes)
+	EVDS_SOLVER_RIGID_CHILD* children;
+	EVDS_STATE_VECTOR_DERIVATIVE* derivatives;	//Derivatives returned by children during integration
+	int children_count;
+	int children_revision;
+	int reentrant_count;			//Number of force-producing children with re-entrant solvers
+
+	//Parallel force computation
+	EVDS_VARIABLE *parallel_forces;	//Minimum number of re-entrant children to compute their forces in parallel
+
+	//Sleep detection
+	EVDS_VARIABLE *sleep_steps;		//Number of steps at rest before body falls asleep
+	EVDS_VARIABLE *sleep_threshold;	//Velocity and acceleration below which body is considered to be at rest
+	int sleep_counter;				//Number of consecutive steps at rest
+	int step_evaluations;			//Number of evaluations during current step
+	int step_at_rest;				//Was body at rest during all evaluations of current step
+	int sleep_revision;				//Revision of children list when body fell asleep
+	EVDS_VECTOR sleep_position;		//Position at which body fell asleep
+	EVDS_QUATERNION sleep_orientation;	//Orientation at which body fell asleep
 } EVDS_SOLVER_RIGID_USERDATA;
+
+typedef struct EVDS_SOLVER_RIGID_JOB_TAG {
+	EVDS_SOLVER_RIGID_USERDATA* userdata;
+	EVDS_REAL delta_time;
+} EVDS_SOLVER_RIGID_JOB;
 #endif
 
 
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Rebuild cached list of children records if list of children has changed.
+///
+/// Looks up all variables used by the solver in every child once, so that solving and
+/// integration do not need to search for variables by name.
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalRigidBody_UpdateChildren(EVDS_OBJECT* object, EVDS_SOLVER_RIGID_USERDATA* userdata) {
+	int count;
+	SIMC_LIST* children;
+	SIMC_LIST_ENTRY* entry;
+	EVDS_SOLVER_RIGID_CHILD* record;
+
+	//Check if list of children is still valid
+	if (userdata->children_revision == object->children_revision) return EVDS_OK;
+	EVDS_ERRCHECK(EVDS_Object_GetChildren(object,&children));
+
+	//Count children
+	count = 0;
+	entry = SIMC_List_GetFirst(children);
+	while (entry) {
+		count++;
+		entry = SIMC_List_GetNext(children,entry);
+	}
+
+	//Allocate new list of records
+	if (userdata->children) free(userdata->children);
+	if (userdata->derivatives) free(userdata->derivatives);
+	userdata->children = (EVDS_SOLVER_RIGID_CHILD*)malloc(sizeof(EVDS_SOLVER_RIGID_CHILD)*(count+1));
+	userdata->derivatives = (EVDS_STATE_VECTOR_DERIVATIVE*)malloc(sizeof(EVDS_STATE_VECTOR_DERIVATIVE)*(count+1));
+	if ((!userdata->children) || (!userdata->derivatives)) return EVDS_ERROR_MEMORY;
+	memset(userdata->children,0,sizeof(EVDS_SOLVER_RIGID_CHILD)*(count+1));
+	userdata->reentrant_count = 0;
+
+	//Fill out records for every child
+	count = 0;
+	entry = SIMC_List_GetFirst(children);
+	while (entry) {
+		EVDS_OBJECT* child = (EVDS_OBJECT*)SIMC_List_GetData(children,entry);
+		record = &userdata->children[count];
+		record->object = child;
+
+		//Only children which have an integration callback may produce forces
+		record->has_forces = (child->integrate != 0) || (child->solver && child->solver->OnIntegrate);
+		record->is_reentrant = record->has_forces && (child->integrate == 0) &&
+			(child->solver->flags & EVDS_SOLVER_FLAG_REENTRANT);
+		if (record->is_reentrant) userdata->reentrant_count++;
+
+		//Get mass and center of mass
+		record->has_mass = 1;
+		if ((EVDS_Object_GetVariable(child,"total_mass",&record->mass) != EVDS_OK) &&
+			(EVDS_Object_GetVariable(child,"mass",&record->mass) != EVDS_OK)) {
+			record->has_mass = 0;
+		}
+		if ((EVDS_Object_GetVariable(child,"total_cm",&record->cm) != EVDS_OK) &&
+			(EVDS_Object_GetVariable(child,"cm",&record->cm) != EVDS_OK)) {
+			record->has_mass = 0;
+		}
+
+		//Get moments of inertia
+		if ((EVDS_Object_GetVariable(child,"total_ix",&record->ix) != EVDS_OK) ||
+			(EVDS_Object_GetVariable(child,"total_iy",&record->iy) != EVDS_OK) ||
+			(EVDS_Object_GetVariable(child,"total_iz",&record->iz) != EVDS_OK)) {
+			record->ix = 0;
+			record->iy = 0;
+			record->iz = 0;
+			if ((EVDS_Object_GetVariable(child,"jx",&record->jx) != EVDS_OK) ||
+				(EVDS_Object_GetVariable(child,"jy",&record->jy) != EVDS_OK) ||
+				(EVDS_Object_GetVariable(child,"jz",&record->jz) != EVDS_OK)) {
+				record->has_mass = 0;
+			}
+		}
+
+		count++;
+		entry = SIMC_List_GetNext(children,entry);
+	}
+	userdata->children_count = count;
+	userdata->children_revision = object->children_revision;
+	return EVDS_OK;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Compute derivative (forces and torques) of a single child.
+///
+/// Called from worker threads for re-entrant children, see EVDS_System_ParallelFor().
+/// Children which are not re-entrant are skipped, they are integrated by the calling thread.
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalRigidBody_IntegrateChild(EVDS_SYSTEM* system, void* userdata, int index) {
+	EVDS_SOLVER_RIGID_JOB* job = (EVDS_SOLVER_RIGID_JOB*)userdata;
+	EVDS_SOLVER_RIGID_CHILD* record = &job->userdata->children[index];
+	if (!record->is_reentrant) return EVDS_OK;
+	return EVDS_Object_Integrate(record->object,job->delta_time,0,&job->userdata->derivatives[index]);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Check if body is at rest.
+///
+/// Body is at rest if its velocity and angular velocity are below sleep threshold, and
+/// so are the accelerations caused by all forces acting upon it: forces and torques created
+/// by children, gravity and gravity gradient torque. Forces of children which balance gravity
+/// (for example forces supporting a body resting on a surface) do not keep the body awake,
+/// while a body in free fall is never at rest.
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalRigidBody_IsAtRest(EVDS_SYSTEM* system, EVDS_OBJECT* object, EVDS_SOLVER_RIGID_USERDATA* userdata,
+									EVDS_STATE_VECTOR* state, EVDS_REAL mass, EVDS_VECTOR* cm,
+									EVDS_VECTOR* cm_force, EVDS_VECTOR* cm_torque) {
+	EVDS_REAL threshold,length;
+	EVDS_OBJECT* parent_coordinates;
+	EVDS_VECTOR a,alpha,Ga,Tg;
+	EVDS_VECTOR Ix,Iy,Iz,Ix1,Iy1,Iz1;
+
+	//Check velocities
+	threshold = EVDS_RIGID_BODY_SLEEP_THRESHOLD;
+	if (userdata->sleep_threshold) EVDS_Variable_GetReal(userdata->sleep_threshold,&threshold);
+	EVDS_Vector_Length(&length,&state->velocity);
+	if (length > threshold) return 0;
+	EVDS_Vector_Length(&length,&state->angular_velocity);
+	if (length > threshold) return 0;
+
+	//Check linear acceleration due to forces and gravity
+	EVDS_Object_GetParent(object,&parent_coordinates);
+	EVDS_Vector_Multiply(&a,cm_force,1/mass);
+	EVDS_Vector_SetPositionVector(&a,cm);
+	a.derivative_level = EVDS_VECTOR_INERTIAL_TRANSFORM;
+	EVDS_Vector_Convert(&a,&a,parent_coordinates);
+	a.derivative_level = EVDS_VECTOR_ACCELERATION;
+	EVDS_Environment_GetGravitationalField(system,&state->position,0,&Ga);
+	EVDS_Vector_Add(&a,&a,&Ga);
+	EVDS_Vector_Length(&length,&a);
+	if (length > threshold) return 0;
+
+	//Check angular acceleration due to torques and gravity gradient
+	EVDS_Variable_GetVector(userdata->Ix,&Ix);
+	EVDS_Variable_GetVector(userdata->Iy,&Iy);
+	EVDS_Variable_GetVector(userdata->Iz,&Iz);
+	EVDS_Variable_GetVector(userdata->Ix1,&Ix1);
+	EVDS_Variable_GetVector(userdata->Iy1,&Iy1);
+	EVDS_Variable_GetVector(userdata->Iz1,&Iz1);
+	EVDS_Vector_Initialize(Tg);
+	EVDS_Vector_Initialize(alpha);
+	EVDS_Environment_GetGravityGradientTorque(system,cm,&Ix,&Iy,&Iz,&Tg);
+	EVDS_Vector_Add(&Tg,&Tg,cm_torque);
+	EVDS_Tensor_MultiplyByVector(&alpha,&Ix1,&Iy1,&Iz1,&Tg);
+	EVDS_Vector_Length(&length,&alpha);
+	if (length > threshold) return 0;
+	return 1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Count propagator steps during which body stayed at rest, put body to sleep.
+///
+/// Called once per step from the solver (see EVDS_InternalRigidBody_Solve()). A step counts as
+/// a step at rest only if body was at rest during every evaluation of the step.
+////////////////////////////////////////////////////////////////////////////////
+void EVDS_InternalRigidBody_UpdateSleep(EVDS_OBJECT* object, EVDS_SOLVER_RIGID_USERDATA* userdata) {
+	EVDS_REAL sleep_steps = 0.0;
+	EVDS_STATE_VECTOR state;
+	if (userdata->sleep_steps) EVDS_Variable_GetReal(userdata->sleep_steps,&sleep_steps);
+
+	//Steps without any evaluations carry no information
+	if ((sleep_steps >= 1.0) && (!userdata->is_sleeping) && (userdata->step_evaluations > 0)) {
+		if (userdata->step_at_rest) {
+			userdata->sleep_counter++;
+		} else {
+			userdata->sleep_counter = 0;
+		}
+
+		if (userdata->sleep_counter >= sleep_steps) {
+			EVDS_Object_GetStateVector(object,&state);
+			userdata->is_sleeping = 1;
+			userdata->sleep_revision = object->children_revision;
+			userdata->sleep_position = state.position;
+			userdata->sleep_orientation = state.orientation;
+		}
+	}
+
+	//Begin next step
+	userdata->step_evaluations = 0;
+	userdata->step_at_rest = 1;
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief Rigid body solver
 ///
@@ -233,6 +466,9 @@ typedef struct EVDS_SOLVER_RIGID_USERDATA_TAG {
 ///  - Position of center of mass according to all children
 ///  - Rate of change of mass, center of mass
 ///  - Forces acting from inside (engines, etc)
+///
+/// Totals are only recomputed when mass properties of the body or its children were
+/// changed (mass-bearing variables were written or children were moved, added or removed).
 ////////////////////////////////////////////////////////////////////////////////
 int EVDS_InternalRigidBody_Solve(EVDS_SYSTEM* system, EVDS_SOLVER* solver, EVDS_OBJECT* object, EVDS_REAL delta_time) {
 	//State variables
@@ -249,8 +485,7 @@ int EVDS_InternalRigidBody_Solve(EVDS_SYSTEM* system, EVDS_SOLVER* solver, EVDS_
 	EVDS_STATE_VECTOR state;
 
 	//List of children
-	SIMC_LIST* children;
-	SIMC_LIST_ENTRY* entry;
+	int i;
 	EVDS_SOLVER_RIGID_USERDATA* userdata;
 	EVDS_ERRCHECK(EVDS_Object_GetSolverdata(object,(void**)&userdata));
 
@@ -261,15 +496,21 @@ int EVDS_InternalRigidBody_Solve(EVDS_SYSTEM* system, EVDS_SOLVER* solver, EVDS_
 	if (!userdata->cm) EVDS_ERRCHECK(EVDS_Object_GetVariable(object,"cm",&userdata->cm));
 	userdata->is_consistent = 1;
 
+	//Make sure children records are up to date
+	EVDS_ERRCHECK(EVDS_InternalRigidBody_UpdateChildren(object,userdata));
+
 	//Solve all children first
-	EVDS_ERRCHECK(EVDS_Object_GetChildren(object,&children));
-	entry = SIMC_List_GetFirst(children);
-	while (entry) {
-		EVDS_OBJECT* child = (EVDS_OBJECT*)SIMC_List_GetData(children,entry);
-		EVDS_Object_Solve(child,delta_time);
-		entry = SIMC_List_GetNext(children,entry);
+	for (i = 0; i < userdata->children_count; i++) {
+		EVDS_Object_Solve(userdata->children[i].object,delta_time);
 	}
 
+	//Solver is called once per propagator step, count steps which body spent at rest
+	EVDS_InternalRigidBody_UpdateSleep(object,userdata);
+
+	//Reuse previously aggregated totals if no mass properties have changed since last call
+	if (!object->mass_dirty) return EVDS_OK;
+	EVDS_InternalObject_ValidateMass(object);
+
 	//Prepare to accumulate all state variables
 	EVDS_Variable_GetVector(userdata->cm,&cm);
 	CMx = cm.x;		CMy = cm.y;		CMz = cm.z;
@@ -286,54 +527,29 @@ int EVDS_InternalRigidBody_Solve(EVDS_SYSTEM* system, EVDS_SOLVER* solver, EVDS_
 	M = m; dM = 0.0;
 
 	//Accumulate variables in children
-	entry = SIMC_List_GetFirst(children);
-	while (entry) {
-		int error_code;
-		EVDS_VARIABLE* v_cm;
-		EVDS_VARIABLE* v_mass;
-		EVDS_VARIABLE *v_jx, *v_jy, *v_jz;
-		EVDS_VARIABLE *v_ix, *v_iy, *v_iz;
+	for (i = 0; i < userdata->children_count; i++) {
+		EVDS_SOLVER_RIGID_CHILD* record = &userdata->children[i];
 
 		//Skip objects with no mass
-		EVDS_OBJECT* child = (EVDS_OBJECT*)SIMC_List_GetData(children,entry);
-		if ((EVDS_Object_GetVariable(child,"total_mass",&v_mass) != EVDS_OK) &&
-			(EVDS_Object_GetVariable(child,"mass",&v_mass) != EVDS_OK)) {
-			entry = SIMC_List_GetNext(children,entry);
-			continue;
-		}
-		EVDS_Variable_GetReal(v_mass,&m);
+		if (!record->has_mass) continue;
+		EVDS_Variable_GetReal(record->mass,&m);
 
 		//Get center of mass
-		if ((EVDS_Object_GetVariable(child,"total_cm",&v_cm) != EVDS_OK) &&
-			(EVDS_Object_GetVariable(child,"cm",&v_cm) != EVDS_OK)) {
-			entry = SIMC_List_GetNext(children,entry);
-			continue;
-		}
-		EVDS_Variable_GetVector(v_cm,&cm);
+		EVDS_Variable_GetVector(record->cm,&cm);
 		//EVDS_Variable_GetVector(child_userdata->dCM,&dcm);
 
 		//Get moments of inertia
-		error_code  = EVDS_Object_GetVariable(child,"total_ix",&v_ix);
-		error_code += EVDS_Object_GetVariable(child,"total_iy",&v_iy);
-		error_code += EVDS_Object_GetVariable(child,"total_iz",&v_iz);
-		if (error_code != EVDS_OK) {
-			if ((EVDS_Object_GetVariable(child,"jx",&v_jx) != EVDS_OK) ||
-				(EVDS_Object_GetVariable(child,"jy",&v_jy) != EVDS_OK) ||
-				(EVDS_Object_GetVariable(child,"jz",&v_jz) != EVDS_OK)) {
-				entry = SIMC_List_GetNext(children,entry);
-				continue;
-			}
-
-			EVDS_Variable_GetVector(v_jx,&Ix1);
-			EVDS_Variable_GetVector(v_jy,&Iy1);
-			EVDS_Variable_GetVector(v_jz,&Iz1);
+		if (!record->ix) {
+			EVDS_Variable_GetVector(record->jx,&Ix1);
+			EVDS_Variable_GetVector(record->jy,&Iy1);
+			EVDS_Variable_GetVector(record->jz,&Iz1);
 			EVDS_Vector_Multiply(&Ix1,&Ix1,m);
 			EVDS_Vector_Multiply(&Iy1,&Iy1,m);
 			EVDS_Vector_Multiply(&Iz1,&Iz1,m);
 		} else {
-			EVDS_Variable_GetVector(v_ix,&Ix1);
-			EVDS_Variable_GetVector(v_iy,&Iy1);
-			EVDS_Variable_GetVector(v_iz,&Iz1);
+			EVDS_Variable_GetVector(record->ix,&Ix1);
+			EVDS_Variable_GetVector(record->iy,&Iy1);
+			EVDS_Variable_GetVector(record->iz,&Iz1);
 		}
 
 		//Convert CM to correct coordinates
@@ -341,7 +557,7 @@ int EVDS_InternalRigidBody_Solve(EVDS_SYSTEM* system, EVDS_SOLVER* solver, EVDS_
 		//EVDS_Vector_Get(&dcm,&dcmx,&dcmy,&dcmz,object);
 
 		//Get child position
-		EVDS_Object_GetStateVector(child,&state);
+		EVDS_Object_GetStateVector(record->object,&state);
 		x = state.position.x;
 		y = state.position.y;
 		z = state.position.z;
@@ -373,7 +589,6 @@ int EVDS_InternalRigidBody_Solve(EVDS_SYSTEM* system, EVDS_SOLVER* solver, EVDS_
 		EVDS_Vector_Add(&Ix,&Ix,&cIx);
 		EVDS_Vector_Add(&Iy,&Iy,&cIy);
 		EVDS_Vector_Add(&Iz,&Iz,&cIz);
-		entry = SIMC_List_GetNext(children,entry);
 	}
 
 	//Store variables
@@ -398,9 +613,98 @@ int EVDS_InternalRigidBody_Solve(EVDS_SYSTEM* system, EVDS_SOLVER* solver, EVDS_
 
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Compute total force and torque created by children around center of mass.
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_InternalRigidBody_AccumulateForces(EVDS_SYSTEM* system, EVDS_OBJECT* object, EVDS_SOLVER_RIGID_USERDATA* userdata,
+											EVDS_REAL delta_time, EVDS_VECTOR* cm, EVDS_VECTOR* cm_force, EVDS_VECTOR* cm_torque) {
+	int i;
+	EVDS_REAL parallel_forces;
+	EVDS_SOLVER_RIGID_JOB job;
+
+	//Begin accumulating forces
+	EVDS_Vector_Set(cm_force,EVDS_VECTOR_FORCE,object,0,0,0);
+	EVDS_Vector_Set(cm_torque,EVDS_VECTOR_TORQUE,object,0,0,0);
+
+	//Get childrens forces (accelerations not supported)
+	parallel_forces = 0.0;
+	if (userdata->parallel_forces) EVDS_Variable_GetReal(userdata->parallel_forces,&parallel_forces);
+	if ((parallel_forces >= 1.0) && (userdata->reentrant_count >= parallel_forces)) {
+		//Re-entrant children are integrated by worker threads, all others in this thread
+		for (i = 0; i < userdata->children_count; i++) {
+			if (userdata->children[i].has_forces && (!userdata->children[i].is_reentrant)) {
+				EVDS_Object_Integrate(userdata->children[i].object,delta_time,0,&userdata->derivatives[i]);
+			}
+		}
+		job.userdata = userdata;
+		job.delta_time = delta_time;
+		EVDS_System_ParallelFor(system,EVDS_InternalRigidBody_IntegrateChild,&job,userdata->children_count);
+	} else {
+		for (i = 0; i < userdata->children_count; i++) {
+			if (userdata->children[i].has_forces) {
+				EVDS_Object_Integrate(userdata->children[i].object,delta_time,0,&userdata->derivatives[i]);
+			}
+		}
+	}
+
+	//Accumulate forces in order of children (result does not depend on how forces were computed)
+	for (i = 0; i < userdata->children_count; i++) {
+		EVDS_VECTOR force;
+		EVDS_VECTOR torque;
+		EVDS_VECTOR force_position;
+		EVDS_VECTOR torque_position;
+		EVDS_STATE_VECTOR_DERIVATIVE* child_derivative = &userdata->derivatives[i];
+		if (!userdata->children[i].has_forces) continue;
+
+		EVDS_Vector_Initialize(force);
+		EVDS_Vector_Initialize(torque);
+		EVDS_Vector_Initialize(force_position);
+		EVDS_Vector_Initialize(torque_position);
+
+		//----------------------------------------------------------------------
+		// Calculate force around current rigid bodies CM
+		//----------------------------------------------------------------------
+		// Convert force into vessel coordinates
+		EVDS_Vector_Convert(&force,&child_derivative->force,object);
+
+		// Move this force vector into center of mass (and calculate new torque that corresponds to this change)
+		EVDS_Vector_MoveForceToPosition(&force, &torque, cm);
+
+		// Accumulate forces and torques
+		EVDS_Vector_Add(cm_force,cm_force,&force);
+		EVDS_Vector_Add(cm_torque,cm_torque,&torque);
+
+		//----------------------------------------------------------------------
+		// Calculate torque around current rigid bodies CM
+		//----------------------------------------------------------------------
+		// Convert force into vessel coordinates
+		EVDS_Vector_Convert(&torque, &child_derivative->torque, object);
+
+		// Move torque into center of mass (does not result in any extra forces, as those are summed up by previous call)
+		EVDS_Vector_MoveTorqueToPosition(&torque, cm);
+
+		// Accumulate forces and torques
+		//EVDS_Vector_Add(&cm_force, &cm_force, &force); // This is not required for torques
+		EVDS_Vector_Add(cm_torque, cm_torque, &torque);
+	}
+	return EVDS_OK;
+}
+
+
+
+
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief Rigid body integration routine. Outputs actual motion of the body
+///
+/// Static bodies and sleeping bodies only accumulate forces of their children (so they
+/// can be passed on to the parent), but skip computing their own motion.
+///
+/// A body falls asleep after it stays at rest for "sleep_steps" consecutive propagator steps
+/// (see EVDS_InternalRigidBody_IsAtRest()). Sleeping body still checks forces of its children
+/// and the environment (gravity) during every evaluation. It is woken up when they no longer
+/// balance out, by any change of its state vector, when list of children is modified, or by
+/// EVDS_RigidBody_Wake().
 ////////////////////////////////////////////////////////////////////////////////
 int EVDS_InternalRigidBody_Integrate(EVDS_SYSTEM* system, EVDS_SOLVER* solver, EVDS_OBJECT* object,
 									 EVDS_REAL delta_time, EVDS_STATE_VECTOR* state, EVDS_STATE_VECTOR_DERIVATIVE* derivative) {
@@ -417,12 +721,12 @@ int EVDS_InternalRigidBody_Integrate(EVDS_SYSTEM* system, EVDS_SOLVER* solver, E
 	EVDS_VECTOR cm_alpha; //Total angular acceleration at CM
 	EVDS_VECTOR w; //Angular velocity in local coordinates
 	EVDS_VECTOR Iw;
+	EVDS_VECTOR Tg; //Gravity gradient torque at CM
 
-	//List of children
-	SIMC_LIST* children;
-	SIMC_LIST_ENTRY* entry;
+	//Solver data
 	EVDS_SOLVER_RIGID_USERDATA* userdata;
 	EVDS_ERRCHECK(EVDS_Object_GetSolverdata(object,(void**)&userdata));
+	EVDS_ERRCHECK(EVDS_InternalRigidBody_UpdateChildren(object,userdata));
 	
 	//Copy velocities, reset accelerations
 	EVDS_Vector_Copy(&derivative->velocity,&state->velocity);
@@ -437,6 +741,41 @@ int EVDS_InternalRigidBody_Integrate(EVDS_SYSTEM* system, EVDS_SOLVER* solver, E
 	//Prepare some variables
 	EVDS_Variable_GetVector(userdata->CM,&cm);
 	EVDS_Variable_GetReal(userdata->M,&mass);
+
+	//Sanity check on mass
+	if (mass <= EVDS_EPS) return EVDS_OK;
+
+	//Accumulate forces and torques from children, store them (as force/torque in center of mass) in the derivative
+	EVDS_ERRCHECK(EVDS_InternalRigidBody_AccumulateForces(system,object,userdata,delta_time,&cm,&cm_force,&cm_torque));
+	EVDS_Vector_Copy(&derivative->force,&cm_force);
+	EVDS_Vector_SetPositionVector(&derivative->force,&cm);
+	EVDS_Vector_Copy(&derivative->torque,&cm_torque);
+	EVDS_Vector_SetPositionVector(&derivative->torque,&cm);
+
+	//Do not move static bodies
+	if (userdata->is_static) return EVDS_OK;
+
+	//Sleeping bodies stay where they are until they are woken up
+	if (userdata->is_sleeping) {
+		if ((userdata->sleep_revision == object->children_revision) &&
+			(userdata->sleep_position.x == state->position.x) &&
+			(userdata->sleep_position.y == state->position.y) &&
+			(userdata->sleep_position.z == state->position.z) &&
+			(userdata->sleep_orientation.q[0] == state->orientation.q[0]) &&
+			(userdata->sleep_orientation.q[1] == state->orientation.q[1]) &&
+			(userdata->sleep_orientation.q[2] == state->orientation.q[2]) &&
+			(userdata->sleep_orientation.q[3] == state->orientation.q[3]) &&
+			EVDS_InternalRigidBody_IsAtRest(system,object,userdata,state,mass,&cm,&cm_force,&cm_torque)) {
+			EVDS_Vector_Multiply(&derivative->velocity,&derivative->velocity,0.0);
+			EVDS_Vector_Multiply(&derivative->angular_velocity,&derivative->angular_velocity,0.0);
+			return EVDS_OK;
+		}
+		userdata->is_sleeping = 0;
+		userdata->sleep_counter = 0;
+		userdata->step_at_rest = 0;
+	}
+
+	//Prepare variables for computing motion of the body
 	EVDS_Variable_GetVector(userdata->Ix,&Ix);
 	EVDS_Variable_GetVector(userdata->Iy,&Iy);
 	EVDS_Variable_GetVector(userdata->Iz,&Iz);
@@ -445,75 +784,17 @@ int EVDS_InternalRigidBody_Integrate(EVDS_SYSTEM* system, EVDS_SOLVER* solver, E
 	EVDS_Variable_GetVector(userdata->Iz1,&Iz1);
 	EVDS_Object_GetParent(object,&parent_coordinates); //Move in parent coordinates
 
-	//Sanity check on mass
-	if (mass <= EVDS_EPS) return EVDS_OK;
-
 	//Calculate accelerations from forces & torques created by children objects
 	EVDS_Vector_Initialize(cm_a);
 	EVDS_Vector_Initialize(cm_alpha);
 	EVDS_Vector_Initialize(w);
 	EVDS_Vector_Initialize(Iw);
-
-	//Begin accumulating forces
-	EVDS_Vector_Set(&cm_force,EVDS_VECTOR_FORCE,object,0,0,0);
-	EVDS_Vector_Set(&cm_torque,EVDS_VECTOR_TORQUE,object,0,0,0);
-
-	//Iterate through children
-	EVDS_ERRCHECK(EVDS_Object_GetChildren(object,&children));
-	entry = SIMC_List_GetFirst(children);
-	while (entry) {
-		EVDS_VECTOR force;
-		EVDS_VECTOR torque;
-		EVDS_VECTOR force_position;
-		EVDS_VECTOR torque_position;
-		EVDS_STATE_VECTOR_DERIVATIVE child_derivative;
-		EVDS_OBJECT* child = (EVDS_OBJECT*)SIMC_List_GetData(children,entry);
-
-		//Get childrens forces (accelerations not supported)
-		EVDS_Object_Integrate(child,delta_time,0,&child_derivative); 
-		EVDS_Vector_Initialize(force);
-		EVDS_Vector_Initialize(torque);
-		EVDS_Vector_Initialize(force_position);
-		EVDS_Vector_Initialize(torque_position);
-
-		//----------------------------------------------------------------------
-		// Calculate force around current rigid bodies CM
-		//----------------------------------------------------------------------
-		// Convert force into vessel coordinates
-		EVDS_Vector_Convert(&force,&child_derivative.force,object);
-
-		// Move this force vector into center of mass (and calculate new torque that corresponds to this change)
-		EVDS_Vector_MoveForceToPosition(&force, &torque, &cm);
-
-		// Accumulate forces and torques
-		EVDS_Vector_Add(&cm_force,&cm_force,&force);
-		EVDS_Vector_Add(&cm_torque,&cm_torque,&torque);
-
-		//----------------------------------------------------------------------
-		// Calculate torque around current rigid bodies CM
-		//----------------------------------------------------------------------
-		// Convert force into vessel coordinates
-		EVDS_Vector_Convert(&torque, &child_derivative.torque, object);
-
-		// Move torque into center of mass (does not result in any extra forces, as those are summed up by previous call)
-		EVDS_Vector_MoveTorqueToPosition(&torque, &cm);
-
-		// Accumulate forces and torques
-		//EVDS_Vector_Add(&cm_force, &cm_force, &force); // This is not required for torques
-		EVDS_Vector_Add(&cm_torque, &cm_torque, &torque);
-		
-
-		entry = SIMC_List_GetNext(children,entry);
-	}
+	EVDS_Vector_Initialize(Tg);
 
 
 	//--------------------------------------------------------------------------
 	// Convert force into acceleration
 	//--------------------------------------------------------------------------
-	// Store force (as force in center of mass) in the derivative
-	EVDS_Vector_Copy(&derivative->force,&cm_force);
-	EVDS_Vector_SetPositionVector(&derivative->force,&cm);
-
 	// Convert force to linear acceleration (a = F/m)
 	EVDS_Vector_Multiply(&cm_a, &cm_force, 1 / mass); // Apply scalar scale (1/m)
 	EVDS_Vector_SetPositionVector(&cm_a, &cm);
@@ -531,9 +812,9 @@ int EVDS_InternalRigidBody_Integrate(EVDS_SYSTEM* system, EVDS_SOLVER* solver, E
 	//--------------------------------------------------------------------------
 	// Convert torque into angular acceleration
 	//--------------------------------------------------------------------------
-	//Store torque (as torque in center of mass) in the derivative
-	EVDS_Vector_Copy(&derivative->torque, &cm_torque);
-	EVDS_Vector_SetPositionVector(&derivative->torque, &cm);
+	//Calculate gravity gradient torque from the total inertia tensor
+	EVDS_Environment_GetGravityGradientTorque(system, &cm, &Ix, &Iy, &Iz, &Tg);
+	EVDS_Vector_Add(&Tg, &Tg, &cm_torque); //T = T_children + T_gravity
 
 	//Compute angular acceleration in *local* inertial coordinate frame
 	//alpha_l = (I^-1) [T_l - w_l x (I*w_l)]
@@ -541,7 +822,7 @@ int EVDS_InternalRigidBody_Integrate(EVDS_SYSTEM* system, EVDS_SOLVER* solver, E
 	EVDS_Tensor_MultiplyByVector(&Iw, &Ix, &Iy, &Iz, &w); //I*w
 	EVDS_Vector_Cross(&Iw, &w, &Iw); //w x [I*w]
 	Iw.derivative_level = EVDS_VECTOR_TORQUE; //Treat [w x (I*w)] as torque
-	EVDS_Vector_Subtract(&Iw, &cm_torque, &Iw); //T - [w x (I*w)]
+	EVDS_Vector_Subtract(&Iw, &Tg, &Iw); //T - [w x (I*w)]
 	EVDS_Tensor_MultiplyByVector(&cm_alpha, &Ix1, &Iy1, &Iz1, &Iw); //alpha = I^-1 [T - w x (I*w)]
 	EVDS_Vector_SetPositionVector(&cm_alpha, &cm); //Set explicitly where vector is located
 
@@ -581,12 +862,14 @@ int EVDS_InternalRigidBody_Integrate(EVDS_SYSTEM* system, EVDS_SOLVER* solver, E
 	EVDS_Vector_Add(&derivative->acceleration,&derivative->acceleration,&Ga);
 
 
-	//Do not move static bodies (FIXME: make static bodies more special)
-	if (userdata->is_static) {
-		derivative->acceleration.x = 0;
-		derivative->acceleration.y = 0;
-		derivative->acceleration.z = 0;
+	//--------------------------------------------------------------------------
+	// Check if body stays at rest (body is put to sleep by the solver)
+	//--------------------------------------------------------------------------
+	if (userdata->sleep_steps && userdata->step_at_rest &&
+		(!EVDS_InternalRigidBody_IsAtRest(system,object,userdata,state,mass,&cm,&cm_force,&cm_torque))) {
+		userdata->step_at_rest = 0;
 	}
+	userdata->step_evaluations++;
 	return EVDS_OK;
 }
 
@@ -628,6 +911,29 @@ int EVDS_InternalRigidBody_Initialize(EVDS_SYSTEM* system, EVDS_SOLVER* solver,
 	userdata->cm = 0;
 	userdata->is_consistent = 0;
 
+	//Children records will be built during first solver call
+	userdata->children = 0;
+	userdata->derivatives = 0;
+	userdata->children_count = 0;
+	userdata->children_revision = -1;
+
+	//Forces are computed in a single thread unless requested otherwise
+	if (EVDS_Object_GetVariable(object,"parallel_forces",&userdata->parallel_forces) != EVDS_OK) {
+		userdata->parallel_forces = 0;
+	}
+
+	//Sleep detection is disabled unless requested
+	if (EVDS_Object_GetVariable(object,"sleep_steps",&userdata->sleep_steps) != EVDS_OK) {
+		userdata->sleep_steps = 0;
+	}
+	if (EVDS_Object_GetVariable(object,"sleep_threshold",&userdata->sleep_threshold) != EVDS_OK) {
+		userdata->sleep_threshold = 0;
+	}
+	userdata->is_sleeping = 0;
+	userdata->sleep_counter = 0;
+	userdata->step_evaluations = 0;
+	userdata->step_at_rest = 1;
+
 	//Make sure runtime state variables exist
 	EVDS_ERRCHECK(EVDS_Object_AddVariable(object,"total_cm",EVDS_VARIABLE_TYPE_VECTOR,&userdata->CM));
 	EVDS_ERRCHECK(EVDS_Object_AddVariable(object,"total_dcm",EVDS_VARIABLE_TYPE_VECTOR,&userdata->dCM));
@@ -660,6 +966,8 @@ int EVDS_InternalRigidBody_Initialize(EVDS_SYSTEM* system, EVDS_SOLVER* solver,
 int EVDS_InternalRigidBody_Deinitialize(EVDS_SYSTEM* system, EVDS_SOLVER* solver, EVDS_OBJECT* object) {
 	EVDS_SOLVER_RIGID_USERDATA* userdata;
 	EVDS_ERRCHECK(EVDS_Object_GetSolverdata(object,(void**)&userdata));
+	if (userdata->children) free(userdata->children);
+	if (userdata->derivatives) free(userdata->derivatives);
 	free(userdata);
 	return EVDS_OK;
 }
@@ -733,6 +1041,43 @@ int EVDS_RigidBody_IsConsistent(EVDS_OBJECT* object) {
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Returns EVDS_OK if rigid body is sleeping (at rest and not being integrated)
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_RigidBody_IsSleeping(EVDS_OBJECT* object) {
+	EVDS_SOLVER_RIGID_USERDATA* userdata;
+	if (!object) return EVDS_ERROR_BAD_PARAMETER;
+	if (EVDS_RigidBody_IsConsistent(object) != EVDS_OK) return EVDS_ERROR_BAD_STATE;
+
+	EVDS_ERRCHECK(EVDS_Object_GetSolverdata(object, (void**)&userdata));
+	if (userdata->is_sleeping) {
+		return EVDS_OK;
+	} else {
+		return EVDS_ERROR_BAD_STATE;
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Wake up a sleeping rigid body.
+///
+/// Bodies are woken up automatically by unbalanced forces of their children or gravity and by
+/// changes of their state vector. This call must be used for all other events (for example
+/// collisions) which must make body move again.
+////////////////////////////////////////////////////////////////////////////////
+int EVDS_RigidBody_Wake(EVDS_OBJECT* object) {
+	EVDS_SOLVER_RIGID_USERDATA* userdata;
+	if (!object) return EVDS_ERROR_BAD_PARAMETER;
+	if (EVDS_RigidBody_IsConsistent(object) != EVDS_OK) return EVDS_ERROR_BAD_STATE;
+
+	EVDS_ERRCHECK(EVDS_Object_GetSolverdata(object, (void**)&userdata));
+	userdata->is_sleeping = 0;
+	userdata->sleep_counter = 0;
+	userdata->step_at_rest = 0;
+	return EVDS_OK;
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief Returns total mass of the object and its children.
 ////////////////////////////////////////////////////////////////////////////////
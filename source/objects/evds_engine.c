@@ -644,9 +644,13 @@ int EVDS_InternalRocketEngine_Solve_Basic(EVDS_SOLVER_ENGINE_USERDATA* userdata,
 	EVDS_REAL vacuum_isp,atmospheric_isp,current_isp;
 	EVDS_REAL current_throttle;
 	EVDS_REAL current_mass_flow;
+	EVDS_ENVIRONMENT_ATMOSPHERE atmosphere;
+	EVDS_STATE_VECTOR state;
 
 	//Determine atmospheric pressure
-	atmospheric_pressure_bar = 0.0;
+	EVDS_Object_GetStateVector(object,&state);
+	EVDS_Environment_GetAtmosphericParameters(object->system,&state.position,&atmosphere);
+	atmospheric_pressure_bar = atmosphere.pressure/1e5;
 	if (atmospheric_pressure_bar < 0.0) atmospheric_pressure_bar = 0.0;
 	if (atmospheric_pressure_bar > 1.0) atmospheric_pressure_bar = 1.0;
 
@@ -972,6 +976,9 @@ EVDS_SOLVER EVDS_Solver_RocketEngine = {
 	0, //OnStateLoad
 	0, //OnStartup
 	0, //OnShutdown
+	0, //OnFinalize
+	0, //userdata
+	EVDS_SOLVER_FLAG_REENTRANT, //flags
 };
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief Register engine solver
@@ -111,6 +111,9 @@ EVDS_SOLVER EVDS_Solver_Force = {
 	0, //OnStateLoad
 	0, //OnStartup
 	0, //OnShutdown
+	0, //OnFinalize
+	0, //userdata
+	EVDS_SOLVER_FLAG_REENTRANT, //flags
 };
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief Register engine solver
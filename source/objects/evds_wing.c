@@ -109,6 +109,9 @@ EVDS_SOLVER EVDS_Solver_WingSegment = {
 	0, //OnStateLoad
 	0, //OnStartup
 	0, //OnShutdown
+	0, //OnFinalize
+	0, //userdata
+	EVDS_SOLVER_FLAG_REENTRANT, //flags
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -115,4 +115,14 @@ if EVDS_STANDALONE ~= false then
 		SIMC_PATH.."include" }
 	files { "../tests/**" }
 	links { "evds", "simc" }
+
+	-- NRLMSISE-00 addon is tested if the model sources are available
+	if NRLMSISE_PATH then
+		defines { "EVDS_TESTS_NRLMSISE_00" }
+		includedirs { "../addons", NRLMSISE_PATH }
+		files {
+			"../addons/evds_nrlmsise-00.c",
+			NRLMSISE_PATH.."nrlmsise-00.c",
+			NRLMSISE_PATH.."nrlmsise-00_data.c" }
+	end
 end
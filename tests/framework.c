@@ -53,5 +53,7 @@ void main() {
 	//Test_EVDS_GIMBAL();
 	//Test_EVDS_ROCKET_ENGINE();
 	//Test_EVDS_WING();
+	//Test_EVDS_ARTICULATED_BODY();
+	//Test_EVDS_NRLMSISE_00();
 	getchar();
 }
\ No newline at end of file
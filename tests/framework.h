@@ -155,6 +155,8 @@ void Test_EVDS_MODIFIER();
 void Test_EVDS_GIMBAL();
 void Test_EVDS_ROCKET_ENGINE();
 void Test_EVDS_WING();
+void Test_EVDS_ARTICULATED_BODY();
+void Test_EVDS_NRLMSISE_00();
 
 //Disable annoying warnings
 #pragma warning(disable: 4101)
@@ -562,4 +562,570 @@ void Test_EVDS_FRAMES() {
 			}
 		}
 	} END_TEST
+
+
+
+	START_TEST("Gravitational field (cached sources)") {
+		/// These tests make sure gravitational field follows changes of the planets
+		/// parameters and position.
+		EVDS_OBJECT* earth;
+		EVDS_OBJECT* parent;
+
+		ERROR_CHECK(EVDS_Object_LoadFromString(root,
+"<EVDS version=\"31\">"
+"	<object name=\"Earth\" type=\"planet\">"
+"		<parameter name=\"gravity.mu\">4.0e14</parameter>"
+"		<parameter name=\"geometry.radius\">6.0e6</parameter>"
+"	</object>"
+"</EVDS>",&earth));
+		ERROR_CHECK(EVDS_Object_Initialize(earth,1));
+
+		/// Field at 10000 km from the center
+		EVDS_Vector_Set(&vector,EVDS_VECTOR_POSITION,root,1.0e7,0,0);
+		ERROR_CHECK(EVDS_Environment_GetGravitationalField(system,&vector,&real,&vector1));
+		VECTOR_EQUAL_TO(&vector1,-4.0,0,0);
+		REAL_EQUAL_TO(real,-4.0e7);
+
+		/// Changing gravitational parameter must update the field
+		ERROR_CHECK(EVDS_Object_GetVariable(earth,"gravity.mu",&variable));
+		ERROR_CHECK(EVDS_Variable_SetReal(variable,8.0e14));
+		ERROR_CHECK(EVDS_Environment_GetGravitationalField(system,&vector,&real,&vector1));
+		VECTOR_EQUAL_TO(&vector1,-8.0,0,0);
+
+		/// Moving the planet must update the field
+		ERROR_CHECK(EVDS_Object_SetPosition(earth,root,-1.0e7,0,0));
+		ERROR_CHECK(EVDS_Environment_GetGravitationalField(system,&vector,&real,&vector1));
+		VECTOR_EQUAL_TO(&vector1,-2.0,0,0);
+
+		/// Moving objects which are not gravity sources to a new parent keeps the compiled table
+		ERROR_CHECK(EVDS_Object_Create(root,&object));
+		ERROR_CHECK(EVDS_Object_SetType(object,"vessel"));
+		ERROR_CHECK(EVDS_Object_Initialize(object,1));
+		ERROR_CHECK(EVDS_Object_Create(root,&parent));
+		ERROR_CHECK(EVDS_Object_Initialize(parent,1));
+		ERROR_CHECK(EVDS_Environment_GetGravitationalField(system,&vector,&real,&vector1));
+		EQUAL_TO(system->gravity_sources_revision,system->gravity_revision);
+		ERROR_CHECK(EVDS_Object_SetParent(object,parent));
+		EQUAL_TO(system->gravity_sources_revision,system->gravity_revision);
+
+		/// Moving a subtree which contains a gravity source recompiles the table
+		ERROR_CHECK(EVDS_Object_SetParent(earth,object));
+		EQUAL_TO((system->gravity_sources_revision != system->gravity_revision),1);
+		ERROR_CHECK(EVDS_Environment_GetGravitationalField(system,&vector,&real,&vector1));
+		EQUAL_TO(system->gravity_sources_revision,system->gravity_revision);
+		ERROR_CHECK(EVDS_Object_SetParent(object,root));
+		EQUAL_TO((system->gravity_sources_revision != system->gravity_revision),1);
+		ERROR_CHECK(EVDS_Environment_GetGravitationalField(system,&vector,&real,&vector1));
+		VECTOR_EQUAL_TO(&vector1,-2.0,0,0);
+	} END_TEST
+
+
+
+	START_TEST("Gravitational field (spherical harmonics)") {
+		/// These tests compare spherical harmonics model with the simplified J2 model, and make sure
+		/// gravitational field matches gradient of the potential for a high-degree model.
+		EVDS_OBJECT* earth_j2;
+		EVDS_OBJECT* earth_harmonics;
+		EVDS_REAL phi1,phi2,dx,dy,dz;
+		EVDS_REAL h = 1.0;
+
+		ERROR_CHECK(EVDS_Object_LoadFromString(root,
+"<EVDS version=\"31\">"
+"	<object name=\"Earth (J2)\" type=\"planet\">"
+"		<parameter name=\"gravity.mu\">398600441800000</parameter>"
+"		<parameter name=\"gravity.j2\">1.08262668e-3</parameter>"
+"		<parameter name=\"geometry.radius\">6378137.0</parameter>"
+"	</object>"
+"</EVDS>",&earth_j2));
+		ERROR_CHECK(EVDS_Object_Initialize(earth_j2,1));
+
+		/// J2 model on the equator and above the pole
+		EVDS_Vector_Set(&vector,EVDS_VECTOR_POSITION,root,7.0e6,0,0);
+		ERROR_CHECK(EVDS_Environment_GetGravitationalField(system,&vector,&real,&vector1));
+		VECTOR_EQUAL_TO_EPS(&vector1,-(398600441800000.0/4.9e13)*(1+1.5*1.08262668e-3*pow(6378137.0/7.0e6,2)),0,0,1e-5);
+		EVDS_Vector_Set(&vector,EVDS_VECTOR_POSITION,root,0,0,7.0e6);
+		ERROR_CHECK(EVDS_Environment_GetGravitationalField(system,&vector,&real,&vector1));
+		VECTOR_EQUAL_TO_EPS(&vector1,0,0,-(398600441800000.0/4.9e13)*(1-3*1.08262668e-3*pow(6378137.0/7.0e6,2)),1e-5);
+
+		/// Same model defined by a table of coefficients must give the same result
+		EVDS_Vector_Set(&vector,EVDS_VECTOR_POSITION,root,4.0e6,3.0e6,5.0e6);
+		ERROR_CHECK(EVDS_Environment_GetGravitationalField(system,&vector,&phi1,&vector1));
+		EVDS_Object_Destroy(earth_j2);
+
+		ERROR_CHECK(EVDS_Object_LoadFromString(root,
+"<EVDS version=\"31\">"
+"	<object name=\"Earth (harmonics)\" type=\"planet\">"
+"		<parameter name=\"gravity.mu\">398600441800000</parameter>"
+"		<parameter name=\"geometry.radius\">6378137.0</parameter>"
+"		<parameter name=\"gravity.harmonics\" type=\"string\">"
+"			2 0 -0.48416531D-03 0.0\n"
+"		</parameter>"
+"	</object>"
+"</EVDS>",&earth_harmonics));
+		ERROR_CHECK(EVDS_Object_Initialize(earth_harmonics,1));
+		ERROR_CHECK(EVDS_Environment_GetGravitationalField(system,&vector,&phi2,&vector2));
+		VECTOR_EQUAL_TO_EPS(&vector2,vector1.x,vector1.y,vector1.z,1e-6);
+		REAL_EQUAL_TO_EPS(phi2,phi1,1e-2);
+
+		/// Higher degree model: field must be the gradient of potential
+		ERROR_CHECK(EVDS_Object_GetVariable(earth_harmonics,"gravity.harmonics",&variable));
+		strcpy(string,
+			"gfc 2 0 -0.484165143790815D-03  0.000000000000000D+00\n"
+			"gfc 2 1 -0.206615509074176D-09  0.138441389137979D-08\n"
+			"gfc 2 2  0.243938357328313D-05 -0.140027370385934D-05\n"
+			"gfc 3 0  0.957161207093473D-06  0.000000000000000D+00\n"
+			"gfc 3 1  0.203046201047864D-05  0.248200415856872D-06\n"
+			"gfc 3 2  0.904787894809528D-06 -0.619005475177618D-06\n"
+			"gfc 3 3  0.721321757121568D-06  0.141434926192941D-05\n"
+			"gfc 4 0  0.539965866638991D-06  0.000000000000000D+00\n"
+			"gfc 4 4 -0.188560802735000D-06  0.308853169333000D-06\n"
+			"gfc 5 3 -0.451955406071000D-06 -0.214847190624000D-06\n");
+		ERROR_CHECK(EVDS_Variable_SetString(variable,string,strlen(string)));
+		EVDS_Vector_Set(&vector,EVDS_VECTOR_POSITION,root,4.0e6+h,3.0e6,5.0e6);
+		ERROR_CHECK(EVDS_Environment_GetGravitationalField(system,&vector,&phi1,0));
+		EVDS_Vector_Set(&vector,EVDS_VECTOR_POSITION,root,4.0e6-h,3.0e6,5.0e6);
+		ERROR_CHECK(EVDS_Environment_GetGravitationalField(system,&vector,&phi2,0));
+		dx = -(phi1-phi2)/(2*h);
+		EVDS_Vector_Set(&vector,EVDS_VECTOR_POSITION,root,4.0e6,3.0e6+h,5.0e6);
+		ERROR_CHECK(EVDS_Environment_GetGravitationalField(system,&vector,&phi1,0));
+		EVDS_Vector_Set(&vector,EVDS_VECTOR_POSITION,root,4.0e6,3.0e6-h,5.0e6);
+		ERROR_CHECK(EVDS_Environment_GetGravitationalField(system,&vector,&phi2,0));
+		dy = -(phi1-phi2)/(2*h);
+		EVDS_Vector_Set(&vector,EVDS_VECTOR_POSITION,root,4.0e6,3.0e6,5.0e6+h);
+		ERROR_CHECK(EVDS_Environment_GetGravitationalField(system,&vector,&phi1,0));
+		EVDS_Vector_Set(&vector,EVDS_VECTOR_POSITION,root,4.0e6,3.0e6,5.0e6-h);
+		ERROR_CHECK(EVDS_Environment_GetGravitationalField(system,&vector,&phi2,0));
+		dz = -(phi1-phi2)/(2*h);
+
+		EVDS_Vector_Set(&vector,EVDS_VECTOR_POSITION,root,4.0e6,3.0e6,5.0e6);
+		ERROR_CHECK(EVDS_Environment_GetGravitationalField(system,&vector,0,&vector1));
+		VECTOR_EQUAL_TO_EPS(&vector1,dx,dy,dz,1e-6);
+	} END_TEST
+
+
+
+	START_TEST("Gravitational field (precomputed grid)") {
+		/// These tests compare gravitational field interpolated from the precomputed grid
+		/// with the field computed directly from the spherical harmonics model.
+		EVDS_OBJECT* earth;
+		EVDS_REAL phi1,phi2;
+
+		ERROR_CHECK(EVDS_Object_LoadFromString(root,
+"<EVDS version=\"31\">"
+"	<object name=\"Earth\" type=\"planet\">"
+"		<parameter name=\"gravity.mu\">398600441800000</parameter>"
+"		<parameter name=\"geometry.radius\">6378137.0</parameter>"
+"		<parameter name=\"gravity.grid_resolution\">1.0</parameter>"
+"		<parameter name=\"gravity.harmonics\" type=\"string\">"
+"			2 0 -0.484165143790815D-03  0.000000000000000D+00\n"
+"			2 2  0.243938357328313D-05 -0.140027370385934D-05\n"
+"			3 1  0.203046201047864D-05  0.248200415856872D-06\n"
+"			4 4 -0.188560802735000D-06  0.308853169333000D-06\n"
+"			5 3 -0.451955406071000D-06 -0.214847190624000D-06\n"
+"		</parameter>"
+"	</object>"
+"</EVDS>",&earth));
+		ERROR_CHECK(EVDS_Object_Initialize(earth,1));
+
+		/// Field from the grid (near the pole and at low orbit)
+		EVDS_Vector_Set(&vector,EVDS_VECTOR_POSITION,root,1.0e5,-2.0e5,6.8e6);
+		ERROR_CHECK(EVDS_Environment_GetGravitationalField(system,&vector,&phi1,&vector1));
+		EVDS_Vector_Set(&vector,EVDS_VECTOR_POSITION,root,-4.1e6,3.3e6,4.2e6);
+		ERROR_CHECK(EVDS_Environment_GetGravitationalField(system,&vector,&phi2,&vector2));
+
+		/// Field computed directly
+		ERROR_CHECK(EVDS_Object_GetVariable(earth,"gravity.grid_resolution",&variable));
+		ERROR_CHECK(EVDS_Variable_SetReal(variable,0.0));
+		EVDS_Vector_Set(&vector,EVDS_VECTOR_POSITION,root,1.0e5,-2.0e5,6.8e6);
+		ERROR_CHECK(EVDS_Environment_GetGravitationalField(system,&vector,&real,&vector));
+		VECTOR_EQUAL_TO_EPS(&vector1,vector.x,vector.y,vector.z,1e-6);
+		REAL_EQUAL_TO_EPS(phi1,real,1.0);
+		EVDS_Vector_Set(&vector,EVDS_VECTOR_POSITION,root,-4.1e6,3.3e6,4.2e6);
+		ERROR_CHECK(EVDS_Environment_GetGravitationalField(system,&vector,&real,&vector));
+		VECTOR_EQUAL_TO_EPS(&vector2,vector.x,vector.y,vector.z,1e-6);
+		REAL_EQUAL_TO_EPS(phi2,real,1.0);
+	} END_TEST
+
+
+
+	START_TEST("Gravitational field (Barnes-Hut approximation)") {
+		/// These tests compare gravitational field of many bodies computed with the octree
+		/// against direct summation.
+		int i;
+		EVDS_REAL phi1,phi2;
+		EVDS_REAL error;
+
+		/// Create a cloud of point masses
+		for (i = 0; i < 300; i++) {
+			ERROR_CHECK(EVDS_Object_Create(root,&object));
+			ERROR_CHECK(EVDS_Object_SetType(object,"planet"));
+			ERROR_CHECK(EVDS_Object_AddRealVariable(object,"gravity.mu",1.0e10*(1+(i % 7)),0));
+			ERROR_CHECK(EVDS_Object_SetPosition(object,root,
+				1.0e9*((i*37) % 101)/101.0,
+				1.0e9*((i*53) % 103)/103.0,
+				1.0e9*((i*71) % 107)/107.0));
+			ERROR_CHECK(EVDS_Object_Initialize(object,1));
+		}
+
+		/// Field with the approximation (enabled by default for 256 or more bodies)
+		EVDS_Vector_Set(&vector,EVDS_VECTOR_POSITION,root,-2.0e8,0.5e9,1.2e9);
+		ERROR_CHECK(EVDS_Environment_GetGravitationalField(system,&vector,&phi1,&vector1));
+
+		/// Field computed with direct summation
+		ERROR_CHECK(EVDS_Environment_SetGravityApproximation(system,0.0,0));
+		ERROR_CHECK(EVDS_Environment_GetGravitationalField(system,&vector,&phi2,&vector2));
+
+		EVDS_Vector_Subtract(&vector,&vector1,&vector2);
+		EVDS_Vector_Length(&error,&vector);
+		EVDS_Vector_Length(&real,&vector2);
+		REAL_EQUAL_TO_EPS(error/real,0.0,1e-2);
+		REAL_EQUAL_TO_EPS((phi1-phi2)/phi2,0.0,1e-2);
+
+		/// Gravity gradient torque includes point masses approximated with the octree
+		{
+			EVDS_VECTOR Ix,Iy,Iz,torque1,torque2;
+			EVDS_Vector_Set(&Ix,EVDS_VECTOR_DIRECTION,root,1.0e3,0.2e3,0.0);
+			EVDS_Vector_Set(&Iy,EVDS_VECTOR_DIRECTION,root,0.2e3,2.0e3,0.1e3);
+			EVDS_Vector_Set(&Iz,EVDS_VECTOR_DIRECTION,root,0.0,0.1e3,3.0e3);
+			EVDS_Vector_Set(&vector,EVDS_VECTOR_POSITION,root,-2.0e8,0.5e9,1.2e9);
+			ERROR_CHECK(EVDS_Environment_SetGravityApproximation(system,0.5,256));
+			ERROR_CHECK(EVDS_Environment_GetGravityGradientTorque(system,&vector,&Ix,&Iy,&Iz,&torque1));
+			ERROR_CHECK(EVDS_Environment_SetGravityApproximation(system,0.0,0));
+			ERROR_CHECK(EVDS_Environment_GetGravityGradientTorque(system,&vector,&Ix,&Iy,&Iz,&torque2));
+
+			EVDS_Vector_Length(&real,&torque2);
+			EQUAL_TO((real > 0.0),1);
+			EVDS_Vector_Subtract(&vector,&torque1,&torque2);
+			EVDS_Vector_Length(&error,&vector);
+			REAL_EQUAL_TO_EPS(error/real,0.0,1e-9);
+		}
+	} END_TEST
+
+
+
+
+	START_TEST("Gravitational field (spheres of influence)") {
+		/// These tests check that the field is evaluated only for the dominant body and its
+		/// ancestors, and that vessels are moved into frames of their dominant bodies.
+		EVDS_OBJECT *sun,*earth,*moon,*mars,*earth_frame,*vessel,*parent;
+
+		ERROR_CHECK(EVDS_Object_LoadFromString(root,
+"<EVDS version=\"31\">"
+"	<object name=\"Sun\" type=\"planet\">"
+"		<parameter name=\"gravity.mu\">1.0e20</parameter>"
+"	</object>"
+"</EVDS>",&sun));
+		ERROR_CHECK(EVDS_Object_Initialize(sun,1));
+		ERROR_CHECK(EVDS_Object_LoadFromString(root,
+"<EVDS version=\"31\">"
+"	<object name=\"Earth\" type=\"planet\">"
+"		<parameter name=\"gravity.mu\">4.0e14</parameter>"
+"		<parameter name=\"gravity.rs\">1.0e9</parameter>"
+"	</object>"
+"</EVDS>",&earth));
+		ERROR_CHECK(EVDS_Object_SetPosition(earth,root,1.0e11,0,0));
+		ERROR_CHECK(EVDS_Object_Create(earth,&earth_frame));
+		ERROR_CHECK(EVDS_Object_SetType(earth_frame,"propagator_rk4"));
+		ERROR_CHECK(EVDS_Object_Initialize(earth,1));
+		ERROR_CHECK(EVDS_Object_LoadFromString(root,
+"<EVDS version=\"31\">"
+"	<object name=\"Moon\" type=\"planet\">"
+"		<parameter name=\"gravity.mu\">5.0e12</parameter>"
+"		<parameter name=\"gravity.rs\">6.0e7</parameter>"
+"	</object>"
+"</EVDS>",&moon));
+		ERROR_CHECK(EVDS_Object_SetPosition(moon,root,1.0e11+4.0e8,0,0));
+		ERROR_CHECK(EVDS_Object_Initialize(moon,1));
+		ERROR_CHECK(EVDS_Object_LoadFromString(root,
+"<EVDS version=\"31\">"
+"	<object name=\"Mars\" type=\"planet\">"
+"		<parameter name=\"gravity.mu\">4.0e13</parameter>"
+"		<parameter name=\"gravity.rs\">6.0e8</parameter>"
+"	</object>"
+"</EVDS>",&mars));
+		ERROR_CHECK(EVDS_Object_SetPosition(mars,root,-2.0e11,0,0));
+		ERROR_CHECK(EVDS_Object_Initialize(mars,1));
+
+		/// Dominant bodies
+		EVDS_Vector_Set(&vector,EVDS_VECTOR_POSITION,root,1.0e11+4.0e8,1.0e7,0);
+		ERROR_CHECK(EVDS_Environment_GetDominantBody(system,&vector,&object));
+		EQUAL_TO(object,moon);
+		EVDS_Vector_Set(&vector,EVDS_VECTOR_POSITION,root,1.0e11,1.0e8,0);
+		ERROR_CHECK(EVDS_Environment_GetDominantBody(system,&vector,&object));
+		EQUAL_TO(object,earth);
+		EVDS_Vector_Set(&vector,EVDS_VECTOR_POSITION,root,0,1.0e11,0);
+		EQUAL_TO(EVDS_Environment_GetDominantBody(system,&vector,&object),EVDS_ERROR_NOT_FOUND);
+
+		/// Field near the Moon includes the Moon, Earth and Sun, but not Mars
+		EVDS_Vector_Set(&vector,EVDS_VECTOR_POSITION,root,1.0e11+4.0e8,1.0e7,0);
+		ERROR_CHECK(EVDS_Environment_GetGravitationalField(system,&vector,&real,&vector1));
+		REAL_EQUAL_TO_EPS(real/(
+			-1.0e20/sqrt(pow(1.0e11+4.0e8,2)+1.0e14)
+			-4.0e14/sqrt(pow(4.0e8,2)+1.0e14)
+			-5.0e12/1.0e7),1.0,1e-12);
+		REAL_EQUAL_TO_EPS(vector1.y/(
+			-1.0e20*1.0e7/pow(pow(1.0e11+4.0e8,2)+1.0e14,1.5)
+			-4.0e14*1.0e7/pow(pow(4.0e8,2)+1.0e14,1.5)
+			-5.0e12/1.0e14),1.0,1e-12);
+
+		/// Vessel near the Moon moves into the frame of the Earth (Moon has no propagator)
+		ERROR_CHECK(EVDS_Object_Create(root,&object));
+		ERROR_CHECK(EVDS_Object_SetType(object,"propagator_rk4"));
+		ERROR_CHECK(EVDS_Object_Initialize(object,1));
+		ERROR_CHECK(EVDS_Object_Create(object,&vessel));
+		ERROR_CHECK(EVDS_Object_SetType(vessel,"vessel"));
+		ERROR_CHECK(EVDS_Object_SetPosition(vessel,root,1.0e11+4.0e8,1.0e7,0));
+		ERROR_CHECK(EVDS_Object_Initialize(vessel,1));
+
+		ERROR_CHECK(EVDS_Environment_UpdatePatchedFrames(system));
+		ERROR_CHECK(EVDS_Object_GetParent(vessel,&parent));
+		EQUAL_TO(parent,earth_frame);
+
+		/// Moving a vessel between frames keeps the compiled table of gravity sources
+		EQUAL_TO(system->gravity_sources_revision,system->gravity_revision);
+		ERROR_CHECK(EVDS_Object_GetStateVector(vessel,&state));
+		EVDS_Vector_Convert(&vector,&state.position,root);
+		VECTOR_EQUAL_TO_EPS(&vector,1.0e11+4.0e8,1.0e7,0,1e-3);
+
+		/// Vessel stays in its frame on the next update
+		ERROR_CHECK(EVDS_Environment_UpdatePatchedFrames(system));
+		ERROR_CHECK(EVDS_Object_GetParent(vessel,&parent));
+		EQUAL_TO(parent,earth_frame);
+	} END_TEST
+
+
+	START_TEST("Gravitational field (many positions)") {
+		/// These tests compare field evaluated in many positions at once with the field
+		/// evaluated separately in every position.
+		int i;
+		EVDS_OBJECT *earth,*moon,*frame;
+		EVDS_VECTOR positions[6],fields[6];
+		EVDS_REAL phis[6];
+
+		ERROR_CHECK(EVDS_Object_LoadFromString(root,
+"<EVDS version=\"31\">"
+"	<object name=\"Sun\" type=\"planet\">"
+"		<parameter name=\"gravity.mu\">1.0e20</parameter>"
+"	</object>"
+"</EVDS>",&object));
+		ERROR_CHECK(EVDS_Object_Initialize(object,1));
+		ERROR_CHECK(EVDS_Object_LoadFromString(root,
+"<EVDS version=\"31\">"
+"	<object name=\"Earth\" type=\"planet\">"
+"		<parameter name=\"gravity.mu\">398600441800000</parameter>"
+"		<parameter name=\"gravity.j2\">1.08262668e-3</parameter>"
+"		<parameter name=\"gravity.rs\">1.0e9</parameter>"
+"		<parameter name=\"geometry.radius\">6378137.0</parameter>"
+"	</object>"
+"</EVDS>",&earth));
+		ERROR_CHECK(EVDS_Object_SetPosition(earth,root,1.0e11,0,0));
+		ERROR_CHECK(EVDS_Object_SetOrientation(earth,root,EVDS_RAD(20.0),EVDS_RAD(30.0),EVDS_RAD(40.0)));
+		ERROR_CHECK(EVDS_Object_Initialize(earth,1));
+		ERROR_CHECK(EVDS_Object_LoadFromString(root,
+"<EVDS version=\"31\">"
+"	<object name=\"Moon\" type=\"planet\">"
+"		<parameter name=\"gravity.mu\">4.9e12</parameter>"
+"		<parameter name=\"gravity.rs\">6.0e7</parameter>"
+"		<parameter name=\"geometry.radius\">1737000.0</parameter>"
+"	</object>"
+"</EVDS>",&moon));
+		ERROR_CHECK(EVDS_Object_SetPosition(moon,root,1.0e11+4.0e8,0,0));
+		ERROR_CHECK(EVDS_Object_Initialize(moon,1));
+
+		/// Constant acceleration
+		ERROR_CHECK(EVDS_Object_Create(root,&object));
+		ERROR_CHECK(EVDS_Object_SetType(object,"constant_gravity"));
+		ERROR_CHECK(EVDS_Object_AddVariable(object,"acceleration",EVDS_VARIABLE_TYPE_VECTOR,&variable));
+		EVDS_Vector_Set(&vector,EVDS_VECTOR_ACCELERATION,root,0.0,0.0,-0.01);
+		ERROR_CHECK(EVDS_Variable_SetVector(variable,&vector));
+		ERROR_CHECK(EVDS_Object_Initialize(object,1));
+
+		/// Rotated frame in which the field is returned
+		ERROR_CHECK(EVDS_Object_Create(root,&frame));
+		ERROR_CHECK(EVDS_Object_SetPosition(frame,root,1.0e11,1.0e6,0));
+		ERROR_CHECK(EVDS_Object_SetOrientation(frame,root,EVDS_RAD(10.0),EVDS_RAD(0.0),EVDS_RAD(70.0)));
+		ERROR_CHECK(EVDS_Object_Initialize(frame,1));
+
+		/// Positions near the Earth, near the Moon, inside the Earth and far from all planets
+		EVDS_Vector_Set(&positions[0],EVDS_VECTOR_POSITION,frame,4.0e6,3.0e6,5.0e6);
+		EVDS_Vector_Set(&positions[1],EVDS_VECTOR_POSITION,root,1.0e11+7.0e6,1.0e5,-2.0e5);
+		EVDS_Vector_Set(&positions[2],EVDS_VECTOR_POSITION,root,1.0e11+4.0e8,2.0e6,1.0e6);
+		EVDS_Vector_Set(&positions[3],EVDS_VECTOR_POSITION,frame,1.0e6,0.0,0.0);
+		EVDS_Vector_Set(&positions[4],EVDS_VECTOR_POSITION,root,0.0,1.0e11,0.0);
+		EVDS_Vector_Set(&positions[5],EVDS_VECTOR_POSITION,earth,0.0,0.0,7.0e6);
+		ERROR_CHECK(EVDS_Environment_GetGravitationalFieldMany(system,positions,6,phis,fields));
+
+		for (i = 0; i < 6; i++) {
+			EVDS_Vector_Initialize(vector);
+			EVDS_Vector_Convert(&vector,&positions[i],frame);
+			ERROR_CHECK(EVDS_Environment_GetGravitationalField(system,&vector,&real,&vector1));
+			EQUAL_TO(fields[i].coordinate_system,frame);
+			VECTOR_EQUAL_TO_EPS(&fields[i],vector1.x,vector1.y,vector1.z,1e-9);
+			REAL_EQUAL_TO_EPS(phis[i]/real,1.0,1e-12);
+		}
+
+		/// Invalid arguments
+		EQUAL_TO(EVDS_Environment_GetGravitationalFieldMany(system,0,6,phis,fields),EVDS_ERROR_BAD_PARAMETER);
+		EQUAL_TO(EVDS_Environment_GetGravitationalFieldMany(system,positions,-1,phis,fields),EVDS_ERROR_BAD_PARAMETER);
+		ERROR_CHECK(EVDS_Environment_GetGravitationalFieldMany(system,positions,0,phis,fields));
+	} END_TEST
+
+
+	START_TEST("Atmospheric parameters (US Standard Atmosphere 1976)") {
+		EVDS_OBJECT* earth;
+		EVDS_ENVIRONMENT_ATMOSPHERE atmosphere;
+
+		ERROR_CHECK(EVDS_Object_LoadFromString(root,
+"<EVDS version=\"31\">"
+"	<object name=\"Earth\" type=\"planet\">"
+"		<parameter name=\"gravity.mu\">398600440000000</parameter>"
+"		<parameter name=\"geometry.radius\">6378145.0</parameter>"
+"		<parameter name=\"atmosphere.model\">us76</parameter>"
+"	</object>"
+"</EVDS>",&earth));
+		ERROR_CHECK(EVDS_Object_Initialize(earth,1));
+
+		/// Sea level and table entries
+		EVDS_Vector_Set(&vector,EVDS_VECTOR_POSITION,root,6378145.0,0,0);
+		ERROR_CHECK(EVDS_Environment_GetAtmosphericParameters(system,&vector,&atmosphere));
+		REAL_EQUAL_TO_EPS(atmosphere.pressure,101325.0,1.0);
+		REAL_EQUAL_TO_EPS(atmosphere.density,1.225,1e-3);
+		REAL_EQUAL_TO_EPS(atmosphere.temperature,288.15,1e-2);
+		REAL_EQUAL_TO_EPS(atmosphere.concentration,2.547e25,1e23);
+
+		EVDS_Vector_Set(&vector,EVDS_VECTOR_POSITION,root,0,6378145.0+10e3,0);
+		ERROR_CHECK(EVDS_Environment_GetAtmosphericParameters(system,&vector,&atmosphere));
+		REAL_EQUAL_TO_EPS(atmosphere.pressure,26500.0,1.0);
+		REAL_EQUAL_TO_EPS(atmosphere.density,0.41351,1e-4);
+
+		/// Layers below 86 km are evaluated from their lapse rates and the barometric formula
+		EVDS_Vector_Set(&vector,EVDS_VECTOR_POSITION,root,0,6378145.0+5e3,0);
+		ERROR_CHECK(EVDS_Environment_GetAtmosphericParameters(system,&vector,&atmosphere));
+		REAL_EQUAL_TO_EPS(atmosphere.temperature,255.676,1e-3);
+		REAL_EQUAL_TO_EPS(atmosphere.pressure,54048.0,1.0);
+		REAL_EQUAL_TO_EPS(atmosphere.density,0.73643,1e-5);
+		EVDS_Vector_Set(&vector,EVDS_VECTOR_POSITION,root,0,6378145.0+47e3,0);
+		ERROR_CHECK(EVDS_Environment_GetAtmosphericParameters(system,&vector,&atmosphere));
+		REAL_EQUAL_TO_EPS(atmosphere.temperature,269.684,1e-3);
+		REAL_EQUAL_TO_EPS(atmosphere.pressure,115.851,1e-3);
+		EVDS_Vector_Set(&vector,EVDS_VECTOR_POSITION,root,0,6378145.0+84e3,0);
+		ERROR_CHECK(EVDS_Environment_GetAtmosphericParameters(system,&vector,&atmosphere));
+		REAL_EQUAL_TO_EPS(atmosphere.temperature,190.841,1e-3);
+		REAL_EQUAL_TO_EPS(atmosphere.density/9.6939e-06,1.0,1e-4);
+
+		/// Temperature above 86 km follows its defining segments
+		EVDS_Vector_Set(&vector,EVDS_VECTOR_POSITION,root,0,6378145.0+115e3,0);
+		ERROR_CHECK(EVDS_Environment_GetAtmosphericParameters(system,&vector,&atmosphere));
+		REAL_EQUAL_TO_EPS(atmosphere.temperature,300.0,1e-6);
+
+		/// Log-linear interpolation between entries
+		EVDS_Vector_Set(&vector,EVDS_VECTOR_POSITION,root,0,0,-6378145.0-250e3);
+		ERROR_CHECK(EVDS_Environment_GetAtmosphericParameters(system,&vector,&atmosphere));
+		REAL_EQUAL_TO_EPS(atmosphere.density/6.073e-11,1.0,1e-3);
+		EVDS_Vector_Set(&vector,EVDS_VECTOR_POSITION,root,0,0,-6378145.0-275e3);
+		ERROR_CHECK(EVDS_Environment_GetAtmosphericParameters(system,&vector,&atmosphere));
+		REAL_EQUAL_TO_EPS(atmosphere.density/sqrt(6.073e-11*1.916e-11),1.0,1e-3);
+
+		/// Vacuum above the atmosphere
+		EVDS_Vector_Set(&vector,EVDS_VECTOR_POSITION,root,6378145.0+2000e3,0,0);
+		ERROR_CHECK(EVDS_Environment_GetAtmosphericParameters(system,&vector,&atmosphere));
+		REAL_EQUAL_TO(atmosphere.density,0.0);
+		REAL_EQUAL_TO(atmosphere.pressure,0.0);
+	} END_TEST
+
+
+
+	START_TEST("Magnetic field (dipole and spherical harmonics)") {
+		EVDS_OBJECT* planet;
+		EVDS_VECTOR field;
+
+		/// Axial dipole: field points north at the equator, down at the north pole
+		ERROR_CHECK(EVDS_Object_LoadFromString(root,
+"<EVDS version=\"31\">"
+"	<object name=\"Dipole\" type=\"planet\">"
+"		<parameter name=\"geometry.radius\">6371200.0</parameter>"
+"		<parameter name=\"magnetic.dipole\">30000e-9</parameter>"
+"	</object>"
+"</EVDS>",&planet));
+		ERROR_CHECK(EVDS_Object_Initialize(planet,1));
+
+		EVDS_Vector_Set(&vector,EVDS_VECTOR_POSITION,root,6371200.0,0,0);
+		ERROR_CHECK(EVDS_Environment_GetMagneticField(system,&vector,&field));
+		VECTOR_EQUAL_TO_EPS(&field,0.0,0.0,30000e-9,1e-12);
+		EVDS_Vector_Set(&vector,EVDS_VECTOR_POSITION,root,0,0,6371200.0);
+		ERROR_CHECK(EVDS_Environment_GetMagneticField(system,&vector,&field));
+		VECTOR_EQUAL_TO_EPS(&field,0.0,0.0,-60000e-9,1e-12);
+		EVDS_Vector_Set(&vector,EVDS_VECTOR_POSITION,root,0,2.0*6371200.0,0);
+		ERROR_CHECK(EVDS_Environment_GetMagneticField(system,&vector,&field));
+		VECTOR_EQUAL_TO_EPS(&field,0.0,0.0,30000e-9/8.0,1e-12);
+		ERROR_CHECK(EVDS_Object_Destroy(planet));
+
+		/// Zonal term of a WMM-style coefficients table (header and secular variation are skipped)
+		ERROR_CHECK(EVDS_Object_LoadFromString(root,
+"<EVDS version=\"31\">"
+"	<object name=\"Harmonics\" type=\"planet\">"
+"		<parameter name=\"geometry.radius\">6371200.0</parameter>"
+"		<parameter name=\"magnetic.harmonics\" type=\"string\">"
+"    2020.0            WMM-2020        12/10/2019\n"
+"  2  0   -2500.0       0.0      -11.0        0.0\n"
+"999999999999999999999999999999999999999999999999\n"
+"		</parameter>"
+"	</object>"
+"</EVDS>",&planet));
+		ERROR_CHECK(EVDS_Object_Initialize(planet,1));
+
+		EVDS_Vector_Set(&vector,EVDS_VECTOR_POSITION,root,0,0,6371200.0);
+		ERROR_CHECK(EVDS_Environment_GetMagneticField(system,&vector,&field));
+		VECTOR_EQUAL_TO_EPS(&field,0.0,0.0,3.0*(-2500e-9),1e-12);
+		EVDS_Vector_Set(&vector,EVDS_VECTOR_POSITION,root,6371200.0,0,0);
+		ERROR_CHECK(EVDS_Environment_GetMagneticField(system,&vector,&field));
+		VECTOR_EQUAL_TO_EPS(&field,-1.5*(-2500e-9),0.0,0.0,1e-12);
+		ERROR_CHECK(EVDS_Object_Destroy(planet));
+	} END_TEST
+
+
+
+	START_TEST("Radiation parameters (flux tables)") {
+		EVDS_OBJECT* planet;
+		EVDS_ENVIRONMENT_RADIATION radiation;
+
+		ERROR_CHECK(EVDS_Object_LoadFromString(root,
+"<EVDS version=\"31\">"
+"	<object name=\"Earth\" type=\"planet\">"
+"		<parameter name=\"geometry.radius\">6371200.0</parameter>"
+"		<parameter name=\"magnetic.dipole\">30000e-9</parameter>"
+"		<parameter name=\"radiation.table\" type=\"string\">"
+"L B/B0 electrons protons solar dose\n"
+"1.0 1.0 1e10 1e8 0.0 1e-8\n"
+"2.0 1.0 1e8  1e6 0.0 1e-10\n"
+"1.0 4.0 1e9  1e7 0.0 1e-9\n"
+"2.0 4.0 1e7  1e5 1e4 1e-11\n"
+"		</parameter>"
+"	</object>"
+"</EVDS>",&planet));
+		ERROR_CHECK(EVDS_Object_Initialize(planet,1));
+
+		/// Magnetic equator: interpolation along L-shell
+		EVDS_Vector_Set(&vector,EVDS_VECTOR_POSITION,root,1.5*6371200.0,0,0);
+		ERROR_CHECK(EVDS_Environment_GetRadiationParameters(system,&vector,&radiation));
+		REAL_EQUAL_TO(radiation.L,1.5);
+		REAL_EQUAL_TO(radiation.B_B0,1.0);
+		REAL_EQUAL_TO_EPS(radiation.electron_flux/1e9,1.0,1e-9);
+		REAL_EQUAL_TO_EPS(radiation.proton_flux/1e7,1.0,1e-9);
+		REAL_EQUAL_TO(radiation.solar_flux,0.0);
+		REAL_EQUAL_TO_EPS(radiation.dose_rate/1e-9,1.0,1e-9);
+
+		/// Dipole coordinates off the magnetic equator
+		EVDS_Vector_Set(&vector,EVDS_VECTOR_POSITION,root,
+			1.2*6371200.0*cos(EVDS_RAD(30.0)),0,1.2*6371200.0*sin(EVDS_RAD(30.0)));
+		ERROR_CHECK(EVDS_Environment_GetRadiationParameters(system,&vector,&radiation));
+		REAL_EQUAL_TO(radiation.L,1.6);
+		REAL_EQUAL_TO(radiation.B_B0,sqrt(1.75)/0.421875);
+
+		/// Positions outside of the table are clamped to its edges
+		EVDS_Vector_Set(&vector,EVDS_VECTOR_POSITION,root,0,5.0*6371200.0,0);
+		ERROR_CHECK(EVDS_Environment_GetRadiationParameters(system,&vector,&radiation));
+		REAL_EQUAL_TO_EPS(radiation.electron_flux/1e8,1.0,1e-9);
+		ERROR_CHECK(EVDS_Object_Destroy(planet));
+	} END_TEST
 }
\ No newline at end of file
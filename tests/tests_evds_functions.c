@@ -156,6 +156,7 @@ void Test_EVDS_FUNCTIONS() {
 	START_TEST("Functions (extra multi-dimensional tests)") {
 		EVDS_REAL y;
 		EVDS_VARIABLE *A, *B, *C;
+		int hint[EVDS_VARIABLE_FUNCTION_HINT_SIZE] = { 0 };
 		ERROR_CHECK(EVDS_System_DatabaseFromString(system,
 "<EVDS>"
 "	<database name=\"combustion\">"
@@ -264,6 +265,524 @@ void Test_EVDS_FUNCTIONS() {
 		ERROR_CHECK(EVDS_Variable_GetFunctionValue(C, 4.5, 400.0e5, 0.5, &y));
 		REAL_EQUAL_TO(y, 3205.4*0.5);
 
+		//Test lookup hint in nested tables
+		ERROR_CHECK(EVDS_Variable_GetFunctionValueHint(C, 4.5, 350.0e5, 0.5, hint, &y));
+		REAL_EQUAL_TO(y, 3201.2*0.5);
+		ERROR_CHECK(EVDS_Variable_GetFunctionValueHint(C, 5.25, 325.0e5, 0.5, hint, &y));
+		REAL_EQUAL_TO(y, 0.5*0.5*(0.5*(3375.4+3521.9) + 0.5*(3383.4+3533.0)));
+		ERROR_CHECK(EVDS_Variable_GetFunctionValueHint(C, 4.5, 400.0e5, 1.0, hint, &y));
+		REAL_EQUAL_TO(y, 3205.4);
+
+
+	} END_TEST
+
+
+
+
+	START_TEST("Functions (segment lookup)") {
+		int i,k,errors = 0;
+		char* table;
+		EVDS_REAL x,y,t;
+		int hint[EVDS_VARIABLE_FUNCTION_HINT_SIZE] = { 0 };
+
+		/// Large table (y = x^2 in integer nodes)
+		table = (char*)malloc(65536);
+		strcpy(table,"<EVDS><database name=\"tables\"><entry name=\"curve\"><parameter name=\"f\" type=\"function\">");
+		for (i = 0; i < 2000; i++) {
+			sprintf(table+strlen(table),"%d %d\n",i,i*i);
+		}
+		strcat(table,"</parameter></entry></database></EVDS>");
+		ERROR_CHECK(EVDS_System_DatabaseFromString(system,table));
+		free(table);
+
+		ERROR_CHECK(EVDS_System_GetDatabaseByName(system,"tables",&variable));
+		ERROR_CHECK(EVDS_Variable_GetNested(variable,"curve",&variable));
+		ERROR_CHECK(EVDS_Variable_GetNested(variable,"f",&variable));
+
+		/// Forward and backward sweeps, random jumps (with and without hint)
+		for (i = 0; i < 3*5400; i++) {
+			if (i < 5400) {
+				x = 0.37*i;
+			} else if (i < 2*5400) {
+				x = 1999.0 - 0.37*(i-5400);
+			} else {
+				x = ((i*7919) % 19990)*0.1;
+			}
+			k = (int)x;
+			t = x - k;
+			if (k >= 1999) { k = 1999; t = 0.0; }
+
+			EVDS_Variable_GetFunctionValueHint(variable,x,0.0,0.0,hint,&y);
+			if (fabs(y - (k*k + t*(2*k+1))) > 1e-6) errors++;
+			EVDS_Variable_GetFunctionValue(variable,x,0.0,0.0,&y);
+			if (fabs(y - (k*k + t*(2*k+1))) > 1e-6) errors++;
+		}
+		EQUAL_TO(errors,0);
+
+		/// Edges of the table
+		ERROR_CHECK(EVDS_Variable_GetFunctionValueHint(variable,-5.0,0.0,0.0,hint,&y));
+		REAL_EQUAL_TO(y,0.0);
+		ERROR_CHECK(EVDS_Variable_GetFunctionValueHint(variable,5000.0,0.0,0.0,hint,&y));
+		REAL_EQUAL_TO(y,1999.0*1999.0);
+		ERROR_CHECK(EVDS_Variable_GetFunctionValueHint(variable,1.5,0.0,0.0,hint,&y));
+		REAL_EQUAL_TO(y,2.5);
+	} END_TEST
+
+
+
+
+	START_TEST("Functions (spline interpolation)") {
+		int i,j;
+		EVDS_REAL x,y,error_linear,error_spline;
+		EVDS_VARIABLE *L, *S, *N;
+		ERROR_CHECK(EVDS_System_DatabaseFromString(system,
+"<EVDS>"
+"	<database name=\"tables\">"
+"		<entry name=\"sine\">"
+"			<parameter name=\"linear\" interpolation=\"linear\" type=\"function\">"
+"				0.0 0.0 0.5 0.479426 1.0 0.841471 1.5 0.997495 2.0 0.909297"
+"				2.5 0.598472 3.0 0.141120 3.5 -0.350783 4.0 -0.756802"
+"			</parameter>"
+"			<parameter name=\"spline\" interpolation=\"spline\" type=\"function\">"
+"				0.0 0.0 0.5 0.479426 1.0 0.841471 1.5 0.997495 2.0 0.909297"
+"				2.5 0.598472 3.0 0.141120 3.5 -0.350783 4.0 -0.756802"
+"			</parameter>"
+"			<parameter name=\"nested\" interpolation=\"spline\">"
+"				<data value=\"0.0\" interpolation=\"spline\">0.0 0.0 1.0 1.0 2.0 4.0 3.0 9.0</data>"
+"				<data value=\"1.0\" interpolation=\"spline\">0.0 1.0 1.0 2.0 2.0 5.0 3.0 10.0</data>"
+"				<data value=\"2.0\" interpolation=\"spline\">0.0 4.0 1.0 5.0 2.0 8.0 3.0 13.0</data>"
+"				<data value=\"3.0\" interpolation=\"spline\">0.0 9.0 1.0 10.0 2.0 13.0 3.0 18.0</data>"
+"			</parameter>"
+"		</entry>"
+"	</database>"
+"</EVDS>"));
+
+		ERROR_CHECK(EVDS_System_GetDatabaseByName(system,"tables",&variable));
+		ERROR_CHECK(EVDS_Variable_GetNested(variable,"sine",&variable));
+		ERROR_CHECK(EVDS_Variable_GetNested(variable,"linear",&L));
+		ERROR_CHECK(EVDS_Variable_GetNested(variable,"spline",&S));
+		ERROR_CHECK(EVDS_Variable_GetNested(variable,"nested",&N));
+
+		/// Spline passes through nodes and is clamped outside of the table
+		ERROR_CHECK(EVDS_Variable_GetFunctionValue(S, 1.5, 0.0, 0.0, &y));
+		REAL_EQUAL_TO(y, 0.997495);
+		ERROR_CHECK(EVDS_Variable_GetFunctionValue(S, -1.0, 0.0, 0.0, &y));
+		REAL_EQUAL_TO(y, 0.0);
+		ERROR_CHECK(EVDS_Variable_GetFunctionValue(S, 5.0, 0.0, 0.0, &y));
+		REAL_EQUAL_TO(y, -0.756802);
+
+		/// Spline is much more accurate than linear interpolation inside the table
+		error_linear = 0.0;
+		error_spline = 0.0;
+		for (x = 0.5; x <= 3.5; x += 0.01) {
+			ERROR_CHECK(EVDS_Variable_GetFunctionValue(L, x, 0.0, 0.0, &y));
+			if (fabs(y - sin(x)) > error_linear) error_linear = fabs(y - sin(x));
+			ERROR_CHECK(EVDS_Variable_GetFunctionValue(S, x, 0.0, 0.0, &y));
+			if (fabs(y - sin(x)) > error_spline) error_spline = fabs(y - sin(x));
+		}
+		REAL_EQUAL_TO_EPS(error_spline, 0.0, 5e-3);
+		EQUAL_TO((error_spline*5.0 < error_linear), 1);
+
+		/// Nested spline tables (f = x^2 + y^2)
+		ERROR_CHECK(EVDS_Variable_GetFunctionValue(N, 2.0, 1.0, 0.0, &y));
+		REAL_EQUAL_TO(y, 5.0);
+		for (i = 0; i < 5; i++) {
+			for (j = 0; j < 5; j++) {
+				x = 1.0 + 0.2*i;
+				ERROR_CHECK(EVDS_Variable_GetFunctionValue(N, x, 1.0 + 0.2*j, 0.0, &y));
+				REAL_EQUAL_TO_EPS(y, (x*x + (1.0+0.2*j)*(1.0+0.2*j)), 0.1);
+			}
+		}
+		ERROR_CHECK(EVDS_Variable_GetFunctionValue(N, 1.5, 1.5, 0.0, &y));
+		REAL_EQUAL_TO_EPS(y, 4.5, 0.1);
+	} END_TEST
+
+
+
+
+	START_TEST("Functions (compiled grid)") {
+		int i,j,k,errors = 0;
+		EVDS_REAL x,y,z,v1,v2;
+		EVDS_VARIABLE *R, *U, *V;
+		int hint[EVDS_VARIABLE_FUNCTION_HINT_SIZE] = { 0 };
+		ERROR_CHECK(EVDS_System_DatabaseFromString(system,
+"<EVDS>"
+"	<database name=\"grids\">"
+"		<entry name=\"tables\">"
+"			<parameter name=\"rectilinear\" type=\"function\">"
+"				<data value=\"0\">"
+"					0	0"
+"					0.5	1.5"
+"					2	6"
+"					5	15"
+"				</data>"
+"				<data value=\"1\">"
+"					0	2"
+"					0.5	4"
+"					2	10"
+"					5	22"
+"				</data>"
+"				<data value=\"2\">"
+"					0	4"
+"					0.5	6.5"
+"					2	14"
+"					5	29"
+"				</data>"
+"				<data value=\"3\">"
+"					0	6"
+"					0.5	9"
+"					2	18"
+"					5	36"
+"				</data>"
+"			</parameter>"
+"			<parameter name=\"irregular\" type=\"function\">"
+"				<data value=\"0\">"
+"					0	0"
+"					1	1"
+"				</data>"
+"				<data value=\"1\">"
+"					0	1"
+"					0.5	1.25"
+"					1	2"
+"				</data>"
+"			</parameter>"
+"			<parameter name=\"volume\" type=\"function\" compile=\"grid\">"
+"				<data value=\"0\">"
+"					<data value=\"0\">"
+"						0	0"
+"						2	6"
+"					</data>"
+"					<data value=\"1\">"
+"						0	2"
+"						2	8"
+"					</data>"
+"					<data value=\"2\">"
+"						0	4"
+"						2	10"
+"					</data>"
+"				</data>"
+"				<data value=\"1\">"
+"					<data value=\"0\">"
+"						0	1"
+"						2	7"
+"					</data>"
+"					<data value=\"1\">"
+"						0	3"
+"						2	9"
+"					</data>"
+"					<data value=\"2\">"
+"						0	5"
+"						2	11"
+"					</data>"
+"				</data>"
+"			</parameter>"
+"		</entry>"
+"	</database>"
+"</EVDS>"));
+
+		ERROR_CHECK(EVDS_System_GetDatabaseByName(system,"grids",&variable));
+		ERROR_CHECK(EVDS_Variable_GetNested(variable,"tables",&variable));
+		ERROR_CHECK(EVDS_Variable_GetNested(variable,"rectilinear",&R));
+		ERROR_CHECK(EVDS_Variable_GetNested(variable,"irregular",&U));
+		ERROR_CHECK(EVDS_Variable_GetNested(variable,"volume",&V));
+
+		/// Rectilinear table is reproduced exactly (including extrapolation)
+		for (i = 0; i <= 40; i++) {
+			for (j = 0; j <= 40; j++) {
+				x = -0.5 + 0.1*i;
+				y = -0.5 + 0.15*j;
+				ERROR_CHECK(EVDS_Variable_CompileFunction(R,EVDS_VARIABLE_FUNCTION_COMPILE_NONE));
+				ERROR_CHECK(EVDS_Variable_GetFunctionValue(R,x,y,0.0,&v1));
+				ERROR_CHECK(EVDS_Variable_CompileFunction(R,EVDS_VARIABLE_FUNCTION_COMPILE_GRID));
+				ERROR_CHECK(EVDS_Variable_GetFunctionValueHint(R,x,y,0.0,hint,&v2));
+				if (fabs(v1 - v2) > 1e-9) errors++;
+			}
+		}
+		EQUAL_TO(errors,0);
+		ERROR_CHECK(EVDS_Variable_GetFunctionValue(R,1.5,1.0,0.0,&y));
+		REAL_EQUAL_TO(y,(2*1.5 + 3*1.0 + 1.5*1.0));
+
+		/// Irregular table is exact in the grid nodes
+		ERROR_CHECK(EVDS_Variable_CompileFunction(U,EVDS_VARIABLE_FUNCTION_COMPILE_GRID));
+		ERROR_CHECK(EVDS_Variable_GetFunctionValue(U,0.0,0.5,0.0,&y));
+		REAL_EQUAL_TO(y,0.5);
+		ERROR_CHECK(EVDS_Variable_GetFunctionValue(U,1.0,0.5,0.0,&y));
+		REAL_EQUAL_TO(y,1.25);
+		ERROR_CHECK(EVDS_Variable_GetFunctionValue(U,0.5,1.0,0.0,&y));
+		REAL_EQUAL_TO(y,1.5);
+		ERROR_CHECK(EVDS_Variable_GetFunctionValue(U,0.5,0.25,0.0,&y));
+		REAL_EQUAL_TO(y,(0.5*0.25 + 0.5*(0.5*0.25) + 0.5));
+
+		/// 3D table compiled when loaded
+		for (i = 0; i <= 12; i++) {
+			for (j = 0; j <= 12; j++) {
+				for (k = 0; k <= 12; k++) {
+					x = 0.1*i;
+					y = 0.2*j;
+					z = 0.2*k;
+					if (x > 1.0) x = 1.0;
+					if (y > 2.0) y = 2.0;
+					if (z > 2.0) z = 2.0;
+					ERROR_CHECK(EVDS_Variable_GetFunctionValueHint(V,0.1*i,0.2*j,0.2*k,hint,&v2));
+					if (fabs(v2 - (x + 2*y + 3*z)) > 1e-9) errors++;
+				}
+			}
+		}
+		EQUAL_TO(errors,0);
+
+		/// Invalid parameters
+		EQUAL_TO(EVDS_Variable_CompileFunction(0,EVDS_VARIABLE_FUNCTION_COMPILE_GRID),EVDS_ERROR_BAD_PARAMETER);
+		EQUAL_TO(EVDS_Variable_CompileFunction(V,-1),EVDS_ERROR_BAD_PARAMETER);
+		EQUAL_TO(EVDS_Variable_CompileFunction(variable,EVDS_VARIABLE_FUNCTION_COMPILE_GRID),EVDS_ERROR_BAD_STATE);
+	} END_TEST
+
+
+
+
+	START_TEST("Functions (batch evaluation)") {
+		int i,errors = 0;
+		EVDS_REAL x[256],y[256],out[256],value;
+		EVDS_VARIABLE *A, *B, *C, *D, *E;
+		ERROR_CHECK(EVDS_System_DatabaseFromString(system,
+"<EVDS>"
+"	<database name=\"batch\">"
+"		<entry name=\"tables\">"
+"			<parameter name=\"thrust\" type=\"function\" compile=\"grid\">"
+"				0.0 0.0"
+"				1.0 1.0"
+"				2.0 4.0"
+"				3.0 9.0"
+"				4.0 16.0"
+"			</parameter>"
+"			<parameter name=\"lift\" type=\"function\" order=\"yx\">"
+"				<data value=\"0.0\">"
+"					0.0	0.0"
+"					10.0	1.0"
+"				</data>"
+"				<data value=\"1.0\">"
+"					0.0	0.5"
+"					10.0	2.0"
+"				</data>"
+"			</parameter>"
+"			<parameter name=\"skewed\" type=\"function\" order=\"xx\" compile=\"grid\">"
+"				<data value=\"0.0\">"
+"					0.0	0.0"
+"					10.0	1.0"
+"				</data>"
+"				<data value=\"1.0\">"
+"					0.0	0.5"
+"					10.0	2.0"
+"				</data>"
+"			</parameter>"
+"			<parameter name=\"drag\" type=\"function\" compile=\"grid\">"
+"				<data value=\"0.0\">"
+"					0.0	0.0"
+"					2.0	1.0"
+"					4.0	3.0"
+"					6.0	2.0"
+"				</data>"
+"				<data value=\"1.5\">"
+"					0.0	0.5"
+"					2.0	2.0"
+"					4.0	5.0"
+"					6.0	4.5"
+"				</data>"
+"				<data value=\"3.0\">"
+"					0.0	1.5"
+"					2.0	2.5"
+"					4.0	4.0"
+"					6.0	7.0"
+"				</data>"
+"			</parameter>"
+"			<parameter name=\"constant\">2.5</parameter>"
+"		</entry>"
+"	</database>"
+"</EVDS>"));
+
+		ERROR_CHECK(EVDS_System_GetDatabaseByName(system,"batch",&variable));
+		ERROR_CHECK(EVDS_Variable_GetNested(variable,"tables",&variable));
+		ERROR_CHECK(EVDS_Variable_GetNested(variable,"thrust",&A));
+		ERROR_CHECK(EVDS_Variable_GetNested(variable,"lift",&B));
+		ERROR_CHECK(EVDS_Variable_GetNested(variable,"constant",&C));
+		ERROR_CHECK(EVDS_Variable_GetNested(variable,"drag",&D));
+		ERROR_CHECK(EVDS_Variable_GetNested(variable,"skewed",&E));
+		for (i = 0; i < 256; i++) {
+			x[i] = -1.0 + 0.025*i;
+			y[i] = -2.0 + 0.06*((i*37) % 256);
+		}
+
+		/// Compiled 1D table
+		ERROR_CHECK(EVDS_Variable_GetFunctionValues(A,x,0,0,256,out));
+		for (i = 0; i < 256; i++) {
+			ERROR_CHECK(EVDS_Variable_GetFunctionValue(A,x[i],0.0,0.0,&value));
+			if (fabs(out[i] - value) > 1e-9) errors++;
+		}
+		EQUAL_TO(errors,0);
+		REAL_EQUAL_TO(out[100],2.5);
+
+		/// Same table without compiling
+		ERROR_CHECK(EVDS_Variable_CompileFunction(A,EVDS_VARIABLE_FUNCTION_COMPILE_NONE));
+		ERROR_CHECK(EVDS_Variable_GetFunctionValues(A,x,0,0,256,out));
+		for (i = 0; i < 256; i++) {
+			ERROR_CHECK(EVDS_Variable_GetFunctionValue(A,x[i],0.0,0.0,&value));
+			if (fabs(out[i] - value) > 1e-9) errors++;
+		}
+		EQUAL_TO(errors,0);
+
+		/// Reordered 2D table, compiled and not compiled
+		ERROR_CHECK(EVDS_Variable_GetFunctionValues(B,x,y,0,256,out));
+		for (i = 0; i < 256; i++) {
+			ERROR_CHECK(EVDS_Variable_GetFunctionValue(B,x[i],y[i],0.0,&value));
+			if (fabs(out[i] - value) > 1e-9) errors++;
+		}
+		EQUAL_TO(errors,0);
+		ERROR_CHECK(EVDS_Variable_CompileFunction(B,EVDS_VARIABLE_FUNCTION_COMPILE_GRID));
+		ERROR_CHECK(EVDS_Variable_GetFunctionValues(B,x,y,0,256,out));
+		for (i = 0; i < 256; i++) {
+			ERROR_CHECK(EVDS_Variable_GetFunctionValue(B,x[i],y[i],0.0,&value));
+			if (fabs(out[i] - value) > 1e-9) errors++;
+		}
+		EQUAL_TO(errors,0);
+
+		/// Compiled uniform 2D table (bilinear interpolation, clamped outside of the table)
+		ERROR_CHECK(EVDS_Variable_GetFunctionValues(D,y,x,0,256,out));
+		for (i = 0; i < 256; i++) {
+			ERROR_CHECK(EVDS_Variable_GetFunctionValue(D,y[i],x[i],0.0,&value));
+			if (fabs(out[i] - value) > 1e-9) errors++;
+		}
+		EQUAL_TO(errors,0);
+		x[0] = 0.75;
+		y[0] = 3.0;
+		ERROR_CHECK(EVDS_Variable_GetFunctionValues(D,x,y,0,1,out));
+		REAL_EQUAL_TO(out[0],0.5*(0.5*(1.0+3.0)+0.5*(2.0+5.0)));
+
+		/// Order which is not a permutation of variables leaves a variable unused
+		errors = 0;
+		ERROR_CHECK(EVDS_Variable_GetFunctionValues(E,x,y,0,256,out));
+		for (i = 0; i < 256; i++) {
+			ERROR_CHECK(EVDS_Variable_GetFunctionValue(E,x[i],y[i],0.0,&value));
+			if (fabs(out[i] - value) > 1e-9) errors++;
+		}
+		EQUAL_TO(errors,0);
+
+		/// Constants and invalid parameters
+		ERROR_CHECK(EVDS_Variable_GetFunctionValues(C,x,0,0,256,out));
+		REAL_EQUAL_TO(out[255],2.5);
+		ERROR_CHECK(EVDS_Variable_GetFunctionValues(A,x,0,0,0,out));
+		EQUAL_TO(EVDS_Variable_GetFunctionValues(0,x,0,0,256,out),EVDS_ERROR_BAD_PARAMETER);
+		EQUAL_TO(EVDS_Variable_GetFunctionValues(A,x,0,0,256,0),EVDS_ERROR_BAD_PARAMETER);
+		EQUAL_TO(EVDS_Variable_GetFunctionValues(A,x,0,0,-1,out),EVDS_ERROR_BAD_PARAMETER);
+	} END_TEST
+
+
+
+
+	START_TEST("Functions (Chebyshev approximation)") {
+		int i,errors = 0;
+		EVDS_REAL x[512],exact[512],out[512];
+		EVDS_VARIABLE *S, *L, *K, *N;
+		ERROR_CHECK(EVDS_System_DatabaseFromString(system,
+"<EVDS>"
+"	<database name=\"approximation\">"
+"		<entry name=\"tables\">"
+"			<parameter name=\"sine\" type=\"function\" interpolation=\"spline\" tolerance=\"1e-6\">"
+"				0.000000	0.000000"
+"				0.500000	0.479426"
+"				1.000000	0.841471"
+"				1.500000	0.997495"
+"				2.000000	0.909297"
+"				2.500000	0.598472"
+"				3.000000	0.141120"
+"				3.500000	-0.350783"
+"				4.000000	-0.756802"
+"				4.500000	-0.977530"
+"				5.000000	-0.958924"
+"				5.500000	-0.705540"
+"				6.000000	-0.279415"
+"				6.500000	0.215120"
+"				7.000000	0.656987"
+"				7.500000	0.938000"
+"				8.000000	0.989358"
+"				8.500000	0.798487"
+"				9.000000	0.412118"
+"				9.500000	-0.075151"
+"				10.000000	-0.544021"
+"			</parameter>"
+"			<parameter name=\"thrust\" type=\"function\" tolerance=\"1e-3\">"
+"				0.0		0.0"
+"				0.5		1000.0"
+"				3.0		1100.0"
+"				7.5		900.0"
+"				8.0		0.0"
+"			</parameter>"
+"			<parameter name=\"kink\" type=\"function\" tolerance=\"1e-9\">"
+"				0.0		0.0"
+"				1.0		1.0"
+"				3.0		-1.0"
+"			</parameter>"
+"			<parameter name=\"nested\" type=\"function\">"
+"				<data value=\"0.0\">0.0 0.0 1.0 1.0</data>"
+"				<data value=\"1.0\">0.0 1.0 1.0 2.0</data>"
+"			</parameter>"
+"		</entry>"
+"	</database>"
+"</EVDS>"));
+
+		ERROR_CHECK(EVDS_System_GetDatabaseByName(system,"approximation",&variable));
+		ERROR_CHECK(EVDS_Variable_GetNested(variable,"tables",&variable));
+		ERROR_CHECK(EVDS_Variable_GetNested(variable,"sine",&S));
+		ERROR_CHECK(EVDS_Variable_GetNested(variable,"thrust",&L));
+		ERROR_CHECK(EVDS_Variable_GetNested(variable,"kink",&K));
+		ERROR_CHECK(EVDS_Variable_GetNested(variable,"nested",&N));
+
+		/// Spline table approximated within the tolerance
+		for (i = 0; i < 512; i++) {
+			x[i] = -0.5 + 11.0*i/511.0;
+			ERROR_CHECK(EVDS_Variable_GetFunctionValue(S,x[i],0.0,0.0,&exact[i]));
+		}
+		ERROR_CHECK(EVDS_Variable_CompileFunction(S,EVDS_VARIABLE_FUNCTION_COMPILE_CHEBYSHEV));
+		ERROR_CHECK(EVDS_Variable_GetFunctionValues(S,x,0,0,512,out));
+		for (i = 0; i < 512; i++) {
+			if (fabs(out[i] - exact[i]) > 1e-6) errors++;
+		}
+		EQUAL_TO(errors,0);
+
+		/// Linear table with corners
+		for (i = 0; i < 512; i++) {
+			x[i] = -1.0 + 10.0*i/511.0;
+			ERROR_CHECK(EVDS_Variable_GetFunctionValue(L,x[i],0.0,0.0,&exact[i]));
+		}
+		ERROR_CHECK(EVDS_Variable_CompileFunction(L,EVDS_VARIABLE_FUNCTION_COMPILE_CHEBYSHEV));
+		for (i = 0; i < 512; i++) {
+			ERROR_CHECK(EVDS_Variable_GetFunctionValue(L,x[i],0.0,0.0,&out[i]));
+			if (fabs(out[i] - exact[i]) > 1e-3) errors++;
+		}
+		EQUAL_TO(errors,0);
+		ERROR_CHECK(EVDS_Variable_GetFunctionValue(L,3.0,0.0,0.0,&out[0]));
+		REAL_EQUAL_TO_EPS(out[0],1100.0,1e-3);
+
+		/// Kink at 1/3 of the table becomes a boundary between pieces
+		errors = 0;
+		for (i = 0; i < 512; i++) {
+			x[i] = -0.5 + 4.0*i/511.0;
+			ERROR_CHECK(EVDS_Variable_GetFunctionValue(K,x[i],0.0,0.0,&exact[i]));
+		}
+		ERROR_CHECK(EVDS_Variable_CompileFunction(K,EVDS_VARIABLE_FUNCTION_COMPILE_CHEBYSHEV));
+		EQUAL_TO(((EVDS_VARIABLE_FUNCTION*)K->value)->chebyshev->count,2);
+		ERROR_CHECK(EVDS_Variable_GetFunctionValues(K,x,0,0,512,out));
+		for (i = 0; i < 512; i++) {
+			if (fabs(out[i] - exact[i]) > 1e-9) errors++;
+		}
+		EQUAL_TO(errors,0);
+		ERROR_CHECK(EVDS_Variable_GetFunctionValue(K,1.0,0.0,0.0,&out[0]));
+		REAL_EQUAL_TO_EPS(out[0],1.0,1e-9);
+
+		/// Removing the approximation restores the table
+		ERROR_CHECK(EVDS_Variable_CompileFunction(L,EVDS_VARIABLE_FUNCTION_COMPILE_NONE));
+		ERROR_CHECK(EVDS_Variable_GetFunctionValue(L,1.75,0.0,0.0,&out[0]));
+		REAL_EQUAL_TO(out[0],1050.0);
 
+		/// Only 1D tables can be approximated
+		EQUAL_TO(EVDS_Variable_CompileFunction(N,EVDS_VARIABLE_FUNCTION_COMPILE_CHEBYSHEV),EVDS_ERROR_BAD_STATE);
 	} END_TEST
-}
\ No newline at end of file
+}
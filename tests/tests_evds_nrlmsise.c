@@ -0,0 +1,132 @@
+#include "framework.h"
+
+#ifdef EVDS_TESTS_NRLMSISE_00
+#include "evds_nrlmsise-00.h"
+
+void Test_EVDS_NRLMSISE_00() {
+	START_TEST("NRLMSISE-00 cache") {
+		/// These tests compare cached model output with the full model, and check that
+		/// nodes are reused within a generation and invalidated when the cache is refreshed.
+		EVDS_OBJECT *earth,*direct;
+		EVDS_GEODETIC_COORDINATE geocoord;
+		EVDS_ENVIRONMENT_ATMOSPHERE cached,full;
+		int hits,misses,generation;
+
+		/// Planet with the cache and planet which evaluates the full model every time
+		ERROR_CHECK(EVDS_Object_LoadFromString(root,
+"<EVDS version=\"31\">"
+"	<object name=\"Earth\" type=\"planet\">"
+"		<parameter name=\"geometry.radius\">6378145.0</parameter>"
+"	</object>"
+"</EVDS>",&earth));
+		ERROR_CHECK(EVDS_NRLMSISE_00_Initialize(earth));
+		ERROR_CHECK(EVDS_Object_Initialize(earth,1));
+		ERROR_CHECK(EVDS_Object_LoadFromString(root,
+"<EVDS version=\"31\">"
+"	<object name=\"Direct\" type=\"planet\">"
+"		<parameter name=\"geometry.radius\">6378145.0</parameter>"
+"	</object>"
+"</EVDS>",&direct));
+		ERROR_CHECK(EVDS_Object_Initialize(direct,1));
+		ERROR_CHECK(EVDS_System_SetTime(system,56000.25));
+
+		/// Node of the grid (120 km, 40 deg latitude, 7 h local solar time) matches the full model
+		EVDS_Geodetic_Set(&geocoord,earth,40.0,15.0,120e3);
+		EVDS_Geodetic_ToVector(&vector,&geocoord);
+		ERROR_CHECK(EVDS_NRLMSISE_00_GetAtmosphericData(earth,&vector,&cached));
+		EVDS_Geodetic_Set(&geocoord,direct,40.0,15.0,120e3);
+		EVDS_Geodetic_ToVector(&vector,&geocoord);
+		ERROR_CHECK(EVDS_NRLMSISE_00_GetAtmosphericData(direct,&vector,&full));
+		REAL_EQUAL_TO_EPS((cached.density/full.density),1.0,1e-6);
+		REAL_EQUAL_TO_EPS((cached.temperature/full.temperature),1.0,1e-6);
+
+		/// First query evaluates all nodes of the cell, second query reuses them
+		ERROR_CHECK(EVDS_NRLMSISE_00_GetCacheStatistics(earth,&hits,&misses,&generation));
+		EQUAL_TO(hits,0);
+		EQUAL_TO(misses,8);
+		EQUAL_TO(generation,1);
+		EVDS_Geodetic_Set(&geocoord,earth,40.0,15.0,120e3);
+		EVDS_Geodetic_ToVector(&vector,&geocoord);
+		ERROR_CHECK(EVDS_NRLMSISE_00_GetAtmosphericData(earth,&vector,&cached));
+		ERROR_CHECK(EVDS_NRLMSISE_00_GetCacheStatistics(earth,&hits,&misses,&generation));
+		EQUAL_TO(hits,8);
+		EQUAL_TO(misses,8);
+
+		/// Point between the nodes is interpolated close to the full model
+		EVDS_Geodetic_Set(&geocoord,earth,37.3,-52.7,123.4e3);
+		EVDS_Geodetic_ToVector(&vector,&geocoord);
+		ERROR_CHECK(EVDS_NRLMSISE_00_GetAtmosphericData(earth,&vector,&cached));
+		EVDS_Geodetic_Set(&geocoord,direct,37.3,-52.7,123.4e3);
+		EVDS_Geodetic_ToVector(&vector,&geocoord);
+		ERROR_CHECK(EVDS_NRLMSISE_00_GetAtmosphericData(direct,&vector,&full));
+		REAL_EQUAL_TO_EPS((cached.density/full.density),1.0,2e-2);
+		REAL_EQUAL_TO_EPS((cached.temperature/full.temperature),1.0,1e-2);
+		ERROR_CHECK(EVDS_NRLMSISE_00_GetCacheStatistics(earth,&hits,&misses,&generation));
+		EQUAL_TO(misses,16);
+
+		/// Cache is kept within the refresh cadence
+		ERROR_CHECK(EVDS_System_SetTime(system,56000.25+60.0/86400.0));
+		EVDS_Geodetic_Set(&geocoord,earth,40.0,15.0,120e3);
+		EVDS_Geodetic_ToVector(&vector,&geocoord);
+		ERROR_CHECK(EVDS_NRLMSISE_00_GetAtmosphericData(earth,&vector,&cached));
+		ERROR_CHECK(EVDS_NRLMSISE_00_GetCacheStatistics(earth,&hits,&misses,&generation));
+		EQUAL_TO(generation,1);
+		EQUAL_TO(hits,16);
+		EQUAL_TO(misses,16);
+
+		/// Cache is refreshed and all nodes are evaluated again outside of the cadence
+		ERROR_CHECK(EVDS_System_SetTime(system,56000.25+3600.0/86400.0));
+		ERROR_CHECK(EVDS_NRLMSISE_00_GetAtmosphericData(earth,&vector,&cached));
+		ERROR_CHECK(EVDS_NRLMSISE_00_GetCacheStatistics(earth,&hits,&misses,&generation));
+		EQUAL_TO(generation,2);
+		EQUAL_TO(hits,16);
+		EQUAL_TO(misses,24);
+
+		ERROR_CHECK(EVDS_NRLMSISE_00_Deinitialize(earth));
+	} END_TEST
+
+	START_TEST("NRLMSISE-00 cache local solar time") {
+		/// Local solar time of a query follows the system time between cache refreshes
+		EVDS_OBJECT *earth,*direct;
+		EVDS_GEODETIC_COORDINATE geocoord;
+		EVDS_ENVIRONMENT_ATMOSPHERE cached,full;
+		int hits,misses,generation;
+
+		/// Planet with the cache refreshed once per day
+		ERROR_CHECK(EVDS_Object_LoadFromString(root,
+"<EVDS version=\"31\">"
+"	<object name=\"Earth\" type=\"planet\">"
+"		<parameter name=\"geometry.radius\">6378145.0</parameter>"
+"		<parameter name=\"nrlmsise-00_cadence\">86400.0</parameter>"
+"	</object>"
+"</EVDS>",&earth));
+		ERROR_CHECK(EVDS_NRLMSISE_00_Initialize(earth));
+		ERROR_CHECK(EVDS_Object_Initialize(earth,1));
+		ERROR_CHECK(EVDS_Object_LoadFromString(root,
+"<EVDS version=\"31\">"
+"	<object name=\"Direct\" type=\"planet\">"
+"		<parameter name=\"geometry.radius\">6378145.0</parameter>"
+"	</object>"
+"</EVDS>",&direct));
+		ERROR_CHECK(EVDS_Object_Initialize(direct,1));
+
+		/// Cache is stamped at 6 h universal time
+		ERROR_CHECK(EVDS_System_SetTime(system,56000.25));
+		EVDS_Geodetic_Set(&geocoord,earth,40.0,0.0,120e3);
+		EVDS_Geodetic_ToVector(&vector,&geocoord);
+		ERROR_CHECK(EVDS_NRLMSISE_00_GetAtmosphericData(earth,&vector,&cached));
+
+		/// Noon at 0 deg longitude six hours later matches the full model
+		ERROR_CHECK(EVDS_System_SetTime(system,56000.5));
+		ERROR_CHECK(EVDS_NRLMSISE_00_GetAtmosphericData(earth,&vector,&cached));
+		EVDS_Geodetic_Set(&geocoord,direct,40.0,0.0,120e3);
+		EVDS_Geodetic_ToVector(&vector,&geocoord);
+		ERROR_CHECK(EVDS_NRLMSISE_00_GetAtmosphericData(direct,&vector,&full));
+		ERROR_CHECK(EVDS_NRLMSISE_00_GetCacheStatistics(earth,&hits,&misses,&generation));
+		EQUAL_TO(generation,1);
+		REAL_EQUAL_TO_EPS((cached.density/full.density),1.0,1e-2);
+
+		ERROR_CHECK(EVDS_NRLMSISE_00_Deinitialize(earth));
+	} END_TEST
+}
+#endif
@@ -1,5 +1,50 @@
 #include "framework.h"
 
+int Test_GravityGradientTorque(EVDS_OBJECT* object, EVDS_VECTOR* r, EVDS_VECTOR* torque) {
+	EVDS_Vector_Set(torque,EVDS_VECTOR_TORQUE,r->coordinate_system,0,0,3000);
+	return EVDS_OK;
+}
+
+int Test_InertialForce_Initialize(EVDS_SYSTEM* system, EVDS_SOLVER* solver, EVDS_OBJECT* object) {
+	if (EVDS_Object_CheckType(object,"test_inertial_force") != EVDS_OK) return EVDS_IGNORE_OBJECT;
+	return EVDS_CLAIM_OBJECT;
+}
+
+SIMC_THREAD_ID Test_MainThread;
+int Test_WorkerEvaluations;
+
+int Test_InertialForce_Integrate(EVDS_SYSTEM* system, EVDS_SOLVER* solver, EVDS_OBJECT* object,
+								 EVDS_REAL delta_time, EVDS_STATE_VECTOR* state, EVDS_STATE_VECTOR_DERIVATIVE* derivative) {
+	int i;
+	volatile EVDS_REAL work = 0.0;
+	EVDS_OBJECT* inertial;
+	EVDS_System_GetRootInertialSpace(system,&inertial);
+	if (SIMC_Thread_GetUniqueID() != Test_MainThread) Test_WorkerEvaluations = 1;
+
+	//Force is fixed in inertial space, so it must be converted through all parents
+	EVDS_Vector_Set(&derivative->force,EVDS_VECTOR_FORCE,inertial,0.0,0.0,100.0);
+	EVDS_Vector_Convert(&derivative->force,&derivative->force,object);
+	EVDS_Vector_SetPosition(&derivative->force,object,0.0,0.0,0.0);
+
+	//Make evaluation expensive enough for worker threads to pick up some of the children
+	for (i = 0; i < 20000; i++) work += 1e-9;
+	return EVDS_OK;
+}
+
+EVDS_SOLVER Test_Solver_InertialForce = {
+	Test_InertialForce_Initialize, //OnInitialize
+	0, //OnDeinitialize
+	0, //OnSolve
+	Test_InertialForce_Integrate, //OnIntegrate
+	0, //OnStateSave
+	0, //OnStateLoad
+	0, //OnStartup
+	0, //OnShutdown
+	0, //OnFinalize
+	0, //userdata
+	EVDS_SOLVER_FLAG_REENTRANT, //flags
+};
+
 void Test_EVDS_RIGID_BODY() {
 	/*START_TEST("Rigid body basic integration test") {
 		int i;
@@ -111,6 +156,341 @@ void Test_EVDS_RIGID_BODY() {
 	} END_TEST
 
 
+	START_TEST("Rigid body mass properties (incremental aggregation)") {
+		EVDS_OBJECT* vessel;
+		EVDS_OBJECT* part;
+		EVDS_VARIABLE* part_mass;
+		EVDS_VARIABLE* total_mass;
+
+		ERROR_CHECK(EVDS_Object_LoadFromString(root,
+			"<EVDS version=\"31\">"
+			"    <object name=\"Vessel\" type=\"vessel\">"
+			"        <parameter name=\"mass\">1000</parameter>"
+			"        <parameter name=\"jx\">1 0 0</parameter>"
+			"        <parameter name=\"jy\">0 1 0</parameter>"
+			"        <parameter name=\"jz\">0 0 1</parameter>"
+			"        <object name=\"Part\" type=\"rigid_body\" x=\"2\">"
+			"            <parameter name=\"mass\">500</parameter>"
+			"            <parameter name=\"jx\">1 0 0</parameter>"
+			"            <parameter name=\"jy\">0 1 0</parameter>"
+			"            <parameter name=\"jz\">0 0 1</parameter>"
+			"        </object>"
+			"    </object>"
+			"</EVDS>", &vessel));
+		ERROR_CHECK(EVDS_Object_Initialize(vessel, 1));
+		ERROR_CHECK(EVDS_System_GetObjectByName(system, 0, "Part", &part));
+		ERROR_CHECK(EVDS_Object_GetVariable(part, "mass", &part_mass));
+		ERROR_CHECK(EVDS_Object_GetVariable(vessel, "total_mass", &total_mass));
+
+		//First solver call aggregates everything
+		EVDS_Object_Solve(vessel, 0.0);
+		EVDS_Variable_GetReal(total_mass, &real);
+		REAL_EQUAL_TO(real, 1500.0);
+		EQUAL_TO(vessel->mass_dirty, 0);
+		EQUAL_TO(part->mass_dirty, 0);
+
+		//Writing same value does not invalidate mass properties
+		ERROR_CHECK(EVDS_Variable_SetReal(part_mass, 500.0));
+		EQUAL_TO(vessel->mass_dirty, 0);
+
+		//Changing mass of the child invalidates the vessel
+		ERROR_CHECK(EVDS_Variable_SetReal(part_mass, 250.0));
+		EQUAL_TO(part->mass_dirty, 1);
+		EQUAL_TO(vessel->mass_dirty, 1);
+		EVDS_Object_Solve(vessel, 0.0);
+		EVDS_Variable_GetReal(total_mass, &real);
+		REAL_EQUAL_TO(real, 1250.0);
+		EQUAL_TO(vessel->mass_dirty, 0);
+
+		//Moving the child invalidates the vessel
+		ERROR_CHECK(EVDS_Object_SetPosition(part, vessel, 4, 0, 0));
+		EQUAL_TO(vessel->mass_dirty, 1);
+		EVDS_Object_Solve(vessel, 0.0);
+		ERROR_CHECK(EVDS_Object_GetVariable(vessel, "total_cm", &variable));
+		EVDS_Variable_GetVector(variable, &vector);
+		REAL_EQUAL_TO(vector.x, 250.0*4.0/1250.0);
+
+		//Children which do not aggregate mass properties are marked as up to date by the vessel
+		ERROR_CHECK(EVDS_Object_LoadFromString(root,
+			"<EVDS version=\"31\">"
+			"    <object name=\"Vessel 2\" type=\"vessel\">"
+			"        <parameter name=\"mass\">1000</parameter>"
+			"        <parameter name=\"jx\">1 0 0</parameter>"
+			"        <parameter name=\"jy\">0 1 0</parameter>"
+			"        <parameter name=\"jz\">0 0 1</parameter>"
+			"        <object name=\"Frame\">"
+			"            <parameter name=\"mass\">100</parameter>"
+			"            <parameter name=\"cm\">0 0 0</parameter>"
+			"            <object name=\"Bolt\">"
+			"                <parameter name=\"mass\">1</parameter>"
+			"            </object>"
+			"        </object>"
+			"    </object>"
+			"</EVDS>", &vessel));
+		ERROR_CHECK(EVDS_Object_Initialize(vessel, 1));
+		ERROR_CHECK(EVDS_System_GetObjectByName(system, 0, "Frame", &part));
+		ERROR_CHECK(EVDS_System_GetObjectByName(system, 0, "Bolt", &object));
+		ERROR_CHECK(EVDS_Object_GetVariable(vessel, "total_mass", &total_mass));
+		EVDS_Object_Solve(vessel, 0.0);
+		EVDS_Variable_GetReal(total_mass, &real);
+		REAL_EQUAL_TO(real, 1100.0);
+		EQUAL_TO(part->mass_dirty, 0);
+		EQUAL_TO(object->mass_dirty, 0);
+
+		//Changes to them still reach the vessel
+		ERROR_CHECK(EVDS_Object_GetVariable(part, "mass", &part_mass));
+		ERROR_CHECK(EVDS_Variable_SetReal(part_mass, 200.0));
+		EQUAL_TO(vessel->mass_dirty, 1);
+		EVDS_Object_Solve(vessel, 0.0);
+		EVDS_Variable_GetReal(total_mass, &real);
+		REAL_EQUAL_TO(real, 1200.0);
+		ERROR_CHECK(EVDS_Object_GetVariable(object, "mass", &part_mass));
+		ERROR_CHECK(EVDS_Variable_SetReal(part_mass, 2.0));
+		EQUAL_TO(part->mass_dirty, 1);
+		EQUAL_TO(vessel->mass_dirty, 1);
+	} END_TEST
+
+
+	START_TEST("Rigid body sleeping") {
+		int i;
+		EVDS_OBJECT* vessel;
+		EVDS_STATE_VECTOR state_vector;
+
+		ERROR_CHECK(EVDS_Object_LoadFromString(root,
+			"<EVDS version=\"31\">"
+			"    <object type=\"propagator_rk4\">"
+			"        <object name=\"Vessel\" type=\"vessel\">"
+			"            <parameter name=\"mass\">1000</parameter>"
+			"            <parameter name=\"jx\">1 0 0</parameter>"
+			"            <parameter name=\"jy\">0 1 0</parameter>"
+			"            <parameter name=\"jz\">0 0 1</parameter>"
+			"            <parameter name=\"sleep_steps\">8</parameter>"
+			"        </object>"
+			"    </object>"
+			"</EVDS>", &object));
+		ERROR_CHECK(EVDS_Object_Initialize(object, 1));
+		ERROR_CHECK(EVDS_System_GetObjectByName(system, 0, "Vessel", &vessel));
+
+		//Sleep is counted in propagator steps, not in evaluations
+		for (i = 0; i < 5; i++) {
+			EVDS_Object_Solve(object, 0.1);
+		}
+		EQUAL_TO(EVDS_RigidBody_IsSleeping(vessel), EVDS_ERROR_BAD_STATE);
+
+		//Body at rest without any forces falls asleep
+		for (i = 0; i < 5; i++) {
+			EVDS_Object_Solve(object, 0.1);
+		}
+		EQUAL_TO(EVDS_RigidBody_IsSleeping(vessel), EVDS_OK);
+
+		//Change of state wakes the body up
+		EVDS_Object_GetStateVector(vessel, &state_vector);
+		EVDS_Vector_Set(&state_vector.velocity, EVDS_VECTOR_VELOCITY,
+			state_vector.velocity.coordinate_system, 1, 0, 0);
+		EVDS_Object_SetStateVector(vessel, &state_vector);
+		EVDS_Object_Solve(object, 0.1);
+		EQUAL_TO(EVDS_RigidBody_IsSleeping(vessel), EVDS_ERROR_BAD_STATE);
+
+		EVDS_Object_GetStateVector(vessel, &state_vector);
+		REAL_EQUAL_TO_EPS(state_vector.position.x, 0.1, EVDS_EPSf);
+	} END_TEST
+
+	START_TEST("Rigid body sleeping is disabled by default") {
+		int i;
+		EVDS_OBJECT* vessel;
+
+		ERROR_CHECK(EVDS_Object_LoadFromString(root,
+			"<EVDS version=\"31\">"
+			"    <object type=\"propagator_rk4\">"
+			"        <object name=\"Vessel\" type=\"vessel\">"
+			"            <parameter name=\"mass\">1000</parameter>"
+			"            <parameter name=\"jx\">1 0 0</parameter>"
+			"            <parameter name=\"jy\">0 1 0</parameter>"
+			"            <parameter name=\"jz\">0 0 1</parameter>"
+			"        </object>"
+			"    </object>"
+			"</EVDS>", &object));
+		ERROR_CHECK(EVDS_Object_Initialize(object, 1));
+		ERROR_CHECK(EVDS_System_GetObjectByName(system, 0, "Vessel", &vessel));
+
+		for (i = 0; i < 100; i++) {
+			EVDS_Object_Solve(object, 0.1);
+		}
+		EQUAL_TO(EVDS_RigidBody_IsSleeping(vessel), EVDS_ERROR_BAD_STATE);
+	} END_TEST
+
+	START_TEST("Rigid body sleeping in gravity") {
+		int i;
+		EVDS_OBJECT* planet;
+		EVDS_OBJECT* supported;
+		EVDS_OBJECT* falling;
+		EVDS_OBJECT* support;
+		EVDS_VECTOR force;
+
+		/// Body supported against gravity falls asleep, body in free fall never does
+		ERROR_CHECK(EVDS_Object_LoadFromString(root,
+			"<EVDS version=\"31\">"
+			"    <object name=\"Earth\" type=\"planet\">"
+			"        <parameter name=\"gravity.mu\">398600441800000</parameter>"
+			"    </object>"
+			"</EVDS>", &planet));
+		ERROR_CHECK(EVDS_Object_Initialize(planet, 1));
+		ERROR_CHECK(EVDS_Object_LoadFromString(root,
+			"<EVDS version=\"31\">"
+			"    <object type=\"propagator_rk4\">"
+			"        <object name=\"Supported\" type=\"vessel\" x=\"7000000\">"
+			"            <parameter name=\"mass\">1000</parameter>"
+			"            <parameter name=\"jx\">1 0 0</parameter>"
+			"            <parameter name=\"jy\">0 1 0</parameter>"
+			"            <parameter name=\"jz\">0 0 1</parameter>"
+			"            <parameter name=\"sleep_steps\">4</parameter>"
+			"            <parameter name=\"sleep_threshold\">1e-6</parameter>"
+			"            <object name=\"Support\" type=\"force\">"
+			"                <parameter name=\"magnitude\">8134.702893877551 0 0</parameter>"
+			"            </object>"
+			"        </object>"
+			"        <object name=\"Falling\" type=\"vessel\" y=\"7000000\">"
+			"            <parameter name=\"mass\">1000</parameter>"
+			"            <parameter name=\"jx\">1 0 0</parameter>"
+			"            <parameter name=\"jy\">0 1 0</parameter>"
+			"            <parameter name=\"jz\">0 0 1</parameter>"
+			"            <parameter name=\"sleep_steps\">4</parameter>"
+			"            <parameter name=\"sleep_threshold\">1e-6</parameter>"
+			"        </object>"
+			"    </object>"
+			"</EVDS>", &object));
+		ERROR_CHECK(EVDS_Object_Initialize(object, 1));
+		ERROR_CHECK(EVDS_System_GetObjectByName(system, 0, "Supported", &supported));
+		ERROR_CHECK(EVDS_System_GetObjectByName(system, 0, "Falling", &falling));
+		ERROR_CHECK(EVDS_System_GetObjectByName(system, 0, "Support", &support));
+
+		for (i = 0; i < 10; i++) {
+			EVDS_Object_Solve(object, 0.1);
+		}
+		EQUAL_TO(EVDS_RigidBody_IsSleeping(supported), EVDS_OK);
+		EQUAL_TO(EVDS_RigidBody_IsSleeping(falling), EVDS_ERROR_BAD_STATE);
+
+		/// Removing support wakes the body up and it starts falling
+		ERROR_CHECK(EVDS_Object_GetVariable(support, "magnitude", &variable));
+		EVDS_Variable_GetVector(variable, &force);
+		force.x = 0.0;
+		EVDS_Variable_SetVector(variable, &force);
+		EVDS_Object_Solve(object, 0.1);
+		EQUAL_TO(EVDS_RigidBody_IsSleeping(supported), EVDS_ERROR_BAD_STATE);
+
+		EVDS_Object_GetStateVector(supported, &state);
+		EQUAL_TO((state.position.x < 7000000.0), 1);
+	} END_TEST
+
+	START_TEST("Rigid body gravity gradient torque") {
+		EVDS_OBJECT* vessel;
+		EVDS_OBJECT* planet;
+
+		/// Gravity gradient torque is computed from the total inertia tensor
+		ERROR_CHECK(EVDS_Object_LoadFromString(root,
+			"<EVDS version=\"31\">"
+			"    <object name=\"Earth\" type=\"planet\">"
+			"        <parameter name=\"gravity.mu\">398600441800000</parameter>"
+			"    </object>"
+			"</EVDS>", &planet));
+		ERROR_CHECK(EVDS_Object_Initialize(planet, 1));
+		ERROR_CHECK(EVDS_Object_LoadFromString(root,
+			"<EVDS version=\"31\">"
+			"    <object type=\"propagator_rk4\">"
+			"        <object name=\"Vessel\" type=\"vessel\" x=\"7000000\">"
+			"            <parameter name=\"mass\">1000</parameter>"
+			"            <parameter name=\"jx\">1 0.1 0</parameter>"
+			"            <parameter name=\"jy\">0.1 2 0</parameter>"
+			"            <parameter name=\"jz\">0 0 3</parameter>"
+			"        </object>"
+			"    </object>"
+			"</EVDS>", &object));
+		ERROR_CHECK(EVDS_Object_Initialize(object, 1));
+		ERROR_CHECK(EVDS_System_GetObjectByName(system, 0, "Vessel", &vessel));
+		EVDS_Object_Solve(object, 0.0);
+
+		/// T = 3 mu/r^3 (r x I*r), alpha = I^-1 T
+		ERROR_CHECK(EVDS_Object_Integrate(vessel, 0.0, 0, &derivative));
+		REAL_EQUAL_TO_EPS(derivative.angular_acceleration.z/(398600441800000.0/(10.0*pow(7.0e6,3))), 1.0, 1e-6);
+		REAL_EQUAL_TO_EPS(derivative.angular_acceleration.x, 0.0, 1e-15);
+		REAL_EQUAL_TO_EPS(derivative.angular_acceleration.y, 0.0, 1e-15);
+		ERROR_CHECK(EVDS_Object_Destroy(planet));
+
+		/// Planet may override the stock model
+		ERROR_CHECK(EVDS_Object_Create(root, &planet));
+		ERROR_CHECK(EVDS_Object_SetType(planet, "planet"));
+		ERROR_CHECK(EVDS_Object_AddVariable(planet, "gravity_gradient_torque", EVDS_VARIABLE_TYPE_FUNCTION_PTR, &variable));
+		ERROR_CHECK(EVDS_Variable_SetFunctionPointer(variable, (void*)Test_GravityGradientTorque));
+		ERROR_CHECK(EVDS_Object_Initialize(planet, 1));
+		ERROR_CHECK(EVDS_Object_Integrate(vessel, 0.0, 0, &derivative));
+		REAL_EQUAL_TO_EPS(derivative.angular_acceleration.z, 1.0, 1e-12);
+		ERROR_CHECK(EVDS_Object_Destroy(planet));
+	} END_TEST
+
+
+	START_TEST("Rigid body parallel forces") {
+		int i;
+		EVDS_OBJECT *serial, *parallel;
+		EVDS_STATE_VECTOR serial_state, parallel_state;
+		char children[2048] = { 0 };
+		char* vessel_description =
+			"            <parameter name=\"mass\">1000</parameter>"
+			"            <parameter name=\"jx\">1 0 0</parameter>"
+			"            <parameter name=\"jy\">0 2 0</parameter>"
+			"            <parameter name=\"jz\">0 0 3</parameter>";
+
+		/// Forces computed by worker threads match forces computed sequentially
+		ERROR_CHECK(EVDS_Solver_Register(system, &Test_Solver_InertialForce));
+		ERROR_CHECK(EVDS_System_SetWorkerThreads(system, 4));
+		for (i = 0; i < 24; i++) {
+			sprintf(children + strlen(children),
+				"<object type=\"test_inertial_force\" x=\"%d\" y=\"%d\" z=\"%d\" />", i%5-2, i%3-1, i%7-3);
+		}
+		sprintf(string,
+			"<EVDS version=\"35\">"
+			"    <object type=\"propagator_rk4\">"
+			"        <object name=\"Serial\" type=\"vessel\">%s%s</object>"
+			"        <object name=\"Parallel\" type=\"vessel\">"
+			"            <parameter name=\"parallel_forces\">2</parameter>%s%s</object>"
+			"    </object>"
+			"</EVDS>", vessel_description, children, vessel_description, children);
+		ERROR_CHECK(EVDS_Object_LoadFromString(root, string, &object));
+		ERROR_CHECK(EVDS_Object_Initialize(object, 1));
+		ERROR_CHECK(EVDS_System_GetObjectByName(system, 0, "Serial", &serial));
+		ERROR_CHECK(EVDS_System_GetObjectByName(system, 0, "Parallel", &parallel));
+
+		//Rotating vessels see forces fixed in inertial space change direction within a step
+		EVDS_Object_GetStateVector(serial, &state);
+		EVDS_Vector_Set(&state.angular_velocity, EVDS_VECTOR_ANGULAR_VELOCITY,
+			state.angular_velocity.coordinate_system, 0.3, EVDS_RAD(90), 0.1);
+		EVDS_Object_SetStateVector(serial, &state);
+		EVDS_Object_SetStateVector(parallel, &state);
+
+		Test_MainThread = SIMC_Thread_GetUniqueID();
+		Test_WorkerEvaluations = 0;
+		for (i = 0; i < 4; i++) {
+			EVDS_Object_Solve(object, 0.1);
+		}
+		EQUAL_TO(Test_WorkerEvaluations, 1);
+		EVDS_Object_GetStateVector(serial, &serial_state);
+		EVDS_Object_GetStateVector(parallel, &parallel_state);
+		EQUAL_TO(parallel_state.position.x, serial_state.position.x);
+		EQUAL_TO(parallel_state.position.y, serial_state.position.y);
+		EQUAL_TO(parallel_state.position.z, serial_state.position.z);
+		EQUAL_TO(parallel_state.velocity.x, serial_state.velocity.x);
+		EQUAL_TO(parallel_state.velocity.z, serial_state.velocity.z);
+		EQUAL_TO(parallel_state.angular_velocity.x, serial_state.angular_velocity.x);
+		EQUAL_TO(parallel_state.angular_velocity.y, serial_state.angular_velocity.y);
+		EQUAL_TO(parallel_state.orientation.q[0], serial_state.orientation.q[0]);
+		EQUAL_TO(parallel_state.orientation.q[1], serial_state.orientation.q[1]);
+		EQUAL_TO(parallel_state.orientation.q[2], serial_state.orientation.q[2]);
+		EQUAL_TO(parallel_state.orientation.q[3], serial_state.orientation.q[3]);
+		REAL_EQUAL_TO_EPS(serial_state.velocity.z, (24*100.0/1000.0*0.4), 1e-9);
+		ERROR_CHECK(EVDS_System_SetWorkerThreads(system, 0));
+	} END_TEST
+
+
+
 	/*START_TEST("Rigid body rotation under force") {
 		int i;
 		EVDS_OBJECT* vessel;
@@ -1136,4 +1516,52 @@ void Test_EVDS_WING() {
 		ERROR_CHECK(EVDS_Object_GetRealVariable(object,"nozzle.exit_area",&real,&variable));
 		REAL_EQUAL_TO(real,EVDS_PI*4.0);*/
 	} END_TEST
-}
\ No newline at end of file
+}
+
+
+
+void Test_EVDS_ARTICULATED_BODY() {
+	START_TEST("Articulated body (pendulum)") {
+		EVDS_OBJECT* link;
+
+		/// Point mass on a horizontal arm, revolute joint around Y axis, gravity along -Z
+		ERROR_CHECK(EVDS_Object_LoadFromString(root,
+			"<EVDS version=\"31\">"
+			"    <object name=\"Arm\" type=\"articulated_body\">"
+			"        <parameter name=\"gravity\">0 0 -9.81</parameter>"
+			"        <object name=\"Link\" type=\"link\">"
+			"            <parameter name=\"joint.axis\">0 1 0</parameter>"
+			"            <parameter name=\"mass\">2</parameter>"
+			"            <parameter name=\"cm\">1 0 0</parameter>"
+			"        </object>"
+			"    </object>"
+			"</EVDS>", &object));
+		ERROR_CHECK(EVDS_Object_Initialize(object,1));
+		ERROR_CHECK(EVDS_System_GetObjectByName(system,0,"Link",&link));
+
+		ERROR_CHECK(EVDS_Object_Solve(object,0.0));
+		ERROR_CHECK(EVDS_Object_GetRealVariable(object,"total_mass",&real,0));
+		REAL_EQUAL_TO(real,2.0);
+
+		//Angular acceleration is g/l, pendulum falls downwards
+		ERROR_CHECK(EVDS_Object_GetRealVariable(link,"joint.ddq",&real,0));
+		REAL_EQUAL_TO(real,9.81);
+
+		//Base carries weight of the link and the torque around the joint
+		ERROR_CHECK(EVDS_Object_Integrate(object,0.0,0,&derivative));
+		REAL_EQUAL_TO(derivative.force.z,0.0);
+		REAL_EQUAL_TO(derivative.torque.y,0.0);
+
+		//Rigid servo holds the arm in place, base carries full weight
+		ERROR_CHECK(EVDS_Object_GetVariable(link,"joint.stiffness",&variable));
+		ERROR_CHECK(EVDS_Variable_SetReal(variable,1e6));
+		ERROR_CHECK(EVDS_Object_GetVariable(link,"joint.command",&variable));
+		ERROR_CHECK(EVDS_Variable_SetReal(variable,-2*9.81/1e6));
+		ERROR_CHECK(EVDS_Object_Solve(object,0.0));
+		ERROR_CHECK(EVDS_Object_GetRealVariable(link,"joint.ddq",&real,0));
+		REAL_EQUAL_TO_EPS(real,0.0,EVDS_EPSf);
+		ERROR_CHECK(EVDS_Object_Integrate(object,0.0,0,&derivative));
+		REAL_EQUAL_TO_EPS(derivative.force.z,-2*9.81,EVDS_EPSf);
+		REAL_EQUAL_TO_EPS(derivative.torque.y,2*9.81,EVDS_EPSf);
+	} END_TEST
+}
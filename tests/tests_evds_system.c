@@ -1,5 +1,36 @@
 #include "framework.h"
 
+int Test_ParallelJob(EVDS_SYSTEM* system, void* userdata, int index) {
+	EVDS_REAL* results = (EVDS_REAL*)userdata;
+	results[index] = index*index;
+	return EVDS_OK;
+}
+
+int Test_OnLoadObject(EVDS_OBJECT_LOADEX* info, EVDS_OBJECT* object) {
+	int* count = (int*)info->userdata;
+	(*count)++;
+	return EVDS_OK;
+}
+
+int Test_OnPostInitialize(EVDS_SYSTEM* system, EVDS_SOLVER* solver, EVDS_OBJECT* object) {
+	SIMC_LIST* list;
+	SIMC_LIST_ENTRY* entry;
+	int is_initialized;
+
+	//Children must be initialized before their parent
+	EVDS_Object_GetAllChildren(object,&list);
+	entry = SIMC_List_GetFirst(list);
+	while (entry) {
+		EVDS_Object_IsInitialized((EVDS_OBJECT*)SIMC_List_GetData(list,entry),&is_initialized);
+		if (!is_initialized) {
+			SIMC_List_Stop(list,entry);
+			return EVDS_ERROR_BAD_STATE;
+		}
+		entry = SIMC_List_GetNext(list,entry);
+	}
+	return EVDS_OK;
+}
+
 void Test_EVDS_SYSTEM() {
 	START_TEST("Return codes") {
 		EQUAL_TO(EVDS_System_Create(0), EVDS_ERROR_BAD_PARAMETER);
@@ -39,6 +70,10 @@ void Test_EVDS_SYSTEM() {
 		EQUAL_TO(EVDS_System_SetUserdata(0,0), EVDS_ERROR_BAD_PARAMETER);
 		EQUAL_TO(EVDS_System_GetUserdata(system,0), EVDS_ERROR_BAD_PARAMETER);
 		EQUAL_TO(EVDS_System_GetUserdata(0,&object), EVDS_ERROR_BAD_PARAMETER);
+		EQUAL_TO(EVDS_System_SetWorkerThreads(0,1), EVDS_ERROR_BAD_PARAMETER);
+		EQUAL_TO(EVDS_System_SetWorkerThreads(system,-1), EVDS_ERROR_BAD_PARAMETER);
+		EQUAL_TO(EVDS_System_ParallelFor(0,Test_ParallelJob,0,1), EVDS_ERROR_BAD_PARAMETER);
+		EQUAL_TO(EVDS_System_ParallelFor(system,0,0,1), EVDS_ERROR_BAD_PARAMETER);
 	} END_TEST
 
 
@@ -143,4 +178,389 @@ void Test_EVDS_SYSTEM() {
 		EQUAL_TO(var->type,EVDS_VARIABLE_TYPE_FUNCTION);
 		EQUAL_TO(obj,0);
 	} END_TEST
-}
\ No newline at end of file
+
+
+	START_TEST("EVDS_System_ParallelFor") {
+		int i;
+		EVDS_REAL results[256] = { 0 };
+
+		//Sequential execution
+		ERROR_CHECK(EVDS_System_ParallelFor(system,Test_ParallelJob,results,256));
+		REAL_EQUAL_TO(results[0],0.0);
+		REAL_EQUAL_TO(results[255],255.0*255.0);
+
+		//Execution in worker threads
+		memset(results,0,sizeof(results));
+		ERROR_CHECK(EVDS_System_SetWorkerThreads(system,4));
+		ERROR_CHECK(EVDS_System_ParallelFor(system,Test_ParallelJob,results,256));
+		for (i = 0; i < 256; i++) {
+			SILENT_EQUAL_TO(results[i],i*i);
+		}
+		REAL_EQUAL_TO(results[255],255.0*255.0);
+		ERROR_CHECK(EVDS_System_SetWorkerThreads(system,0));
+	} END_TEST
+
+
+
+	START_TEST("Binary snapshots") {
+		void* data;
+		size_t size;
+		char *description1,*description2;
+		EVDS_OBJECT *loaded,*container;
+		ERROR_CHECK(EVDS_Object_LoadFromString(root,
+"<EVDS version=\"35\">"
+"	<object name=\"Vessel\" type=\"vessel\" x=\"100\" y=\"20\" vz=\"5\" pitch=\"30\">"
+"		<parameter name=\"mass\">1000</parameter>"
+"		<parameter name=\"cm\">1.0 0.0 -0.5</parameter>"
+"		<parameter name=\"comments\">Test vessel</parameter>"
+"		<parameter name=\"thrust\" type=\"function\" interpolation=\"spline\">"
+"			0.0 0.0"
+"			1.0 100.0"
+"			2.0 150.0"
+"		</parameter>"
+"		<parameter name=\"table\">"
+"			<data value=\"1.0\">0.0 1.0 1.0 2.0</data>"
+"			<data value=\"2.0\">0.0 3.0 1.0 5.0</data>"
+"		</parameter>"
+"		<object name=\"Engine\" type=\"rocket_engine\" x=\"-2\">"
+"			<parameter name=\"fuel\">"
+"				<tank name=\"main\">fuel_tank</tank>"
+"			</parameter>"
+"		</object>"
+"		<object name=\"Tank\" type=\"fuel_tank\" />"
+"	</object>"
+"</EVDS>",&object));
+
+		/// Round trip through the snapshot
+		ERROR_CHECK(EVDS_Object_SaveBinaryToMemory(object,&data,&size));
+		ERROR_CHECK(EVDS_Object_Create(root,&container));
+		ERROR_CHECK(EVDS_Object_LoadBinaryFromMemory(container,data,size,&loaded));
+		ERROR_CHECK(EVDS_Object_SaveToString(object,&description1));
+		ERROR_CHECK(EVDS_Object_SaveToString(loaded,&description2));
+		STRING_EQUAL_TO(description1,description2);
+		free(description1);
+		free(description2);
+
+		ERROR_CHECK(EVDS_Object_GetVariable(loaded,"thrust",&variable));
+		ERROR_CHECK(EVDS_Variable_GetFunctionValue(variable,1.5,0.0,0.0,&real));
+		ERROR_CHECK(EVDS_Object_GetVariable(object,"thrust",&variable));
+		ERROR_CHECK(EVDS_Variable_GetFunctionValue(variable,1.5,0.0,0.0,&vector.x));
+		REAL_EQUAL_TO(real,vector.x);
+		ERROR_CHECK(EVDS_Object_GetVariable(loaded,"table",&variable));
+		ERROR_CHECK(EVDS_Variable_GetFunctionValue(variable,1.5,0.5,0.0,&real));
+		REAL_EQUAL_TO(real,2.75);
+
+		/// Damaged snapshots are rejected
+		EQUAL_TO(EVDS_Object_LoadBinaryFromMemory(root,data,size/2,0),EVDS_ERROR_SYNTAX);
+		((char*)data)[0] = 'X';
+		EQUAL_TO(EVDS_Object_LoadBinaryFromMemory(root,data,size,0),EVDS_ERROR_SYNTAX);
+		free(data);
+
+		/// Conversion between XML and binary files
+		ERROR_CHECK(EVDS_Object_SaveToFile(object,"evds_test_snapshot.evds"));
+		ERROR_CHECK(EVDS_Object_ConvertFile(root,"evds_test_snapshot.evds","evds_test_snapshot.evdb"));
+		ERROR_CHECK(EVDS_Object_Create(root,&container));
+		ERROR_CHECK(EVDS_Object_LoadBinary(container,"evds_test_snapshot.evdb",&loaded));
+		ERROR_CHECK(EVDS_Object_ConvertFile(root,"evds_test_snapshot.evdb","evds_test_snapshot.evds"));
+		ERROR_CHECK(EVDS_Object_Create(root,&container));
+		ERROR_CHECK(EVDS_Object_LoadFromFile(container,"evds_test_snapshot.evds",&object));
+		ERROR_CHECK(EVDS_Object_SaveToString(object,&description1));
+		ERROR_CHECK(EVDS_Object_SaveToString(loaded,&description2));
+		STRING_EQUAL_TO(description1,description2);
+		free(description1);
+		free(description2);
+		remove("evds_test_snapshot.evds");
+		remove("evds_test_snapshot.evdb");
+
+		EQUAL_TO(EVDS_Object_LoadBinary(root,"evds_test_missing.evdb",0),EVDS_ERROR_FILE);
+		EQUAL_TO(EVDS_Object_LoadBinaryFromMemory(0,&size,sizeof(size),0),EVDS_ERROR_BAD_PARAMETER);
+	} END_TEST
+
+	START_TEST("Streaming loader") {
+		EVDS_OBJECT_LOADEX info = { 0 };
+		EVDS_OBJECT_SAVEEX save_info = { 0 };
+		EVDS_OBJECT *container1,*container2;
+		char* description;
+		int count,i,j;
+		FILE* file;
+
+		info.OnLoadObject = Test_OnLoadObject;
+		info.userdata = &count;
+		info.description =
+"<?xml version=\"1.0\"?>"
+"<DATA version=\"35\">"
+"	<!-- First file: <object name=\"Ignored\"/> -->"
+"	<EVDS>"
+"		<object name=\"Vessel\" type=\"vessel\" x=\"100\" pitch=\"30\">"
+"			<parameter name=\"mass\">1000</parameter>"
+"			<parameter name=\"comments\">a &gt; b</parameter>"
+"			<parameter name=\"thrust\" type=\"function\">"
+"				<data value=\"1.0\">0.0 1.0 1.0 2.0</data>"
+"				<data value=\"2.0\">0.0 3.0 1.0 5.0</data>"
+"			</parameter>"
+"			<object name=\"Engine\" type=\"rocket_engine\" x=\"-2\">"
+"				<parameter name=\"fuel\"><tank name=\"main\">fuel_tank</tank></parameter>"
+"			</object>"
+"			<object name=\"Tank\" type=\"fuel_tank\" />"
+"		</object>"
+"		<object name=\"Probe\" type=\"vessel\" />"
+"	</EVDS>"
+"	<EVDS>"
+"		<object name=\"Lander\" type=\"vessel\" y=\"-5\">"
+"			<parameter name=\"mass\">500</parameter>"
+"		</object>"
+"	</EVDS>"
+"</DATA>";
+
+		/// Streamed objects match objects loaded from the whole document
+		ERROR_CHECK(EVDS_Object_Create(root,&container1));
+		ERROR_CHECK(EVDS_Object_Create(root,&container2));
+		count = 0;
+		ERROR_CHECK(EVDS_Object_LoadEx(container1,0,&info));
+		EQUAL_TO(count,3);
+		EQUAL_TO(info.version,35);
+		count = 0;
+		info.flags = EVDS_OBJECT_LOADEX_STREAMING;
+		ERROR_CHECK(EVDS_Object_LoadEx(container2,0,&info));
+		EQUAL_TO(count,3);
+		EQUAL_TO(info.version,35);
+
+		save_info.flags = EVDS_OBJECT_SAVEEX_ONLY_CHILDREN;
+		ERROR_CHECK(EVDS_Object_SaveEx(container1,0,&save_info));
+		description = save_info.description;
+		save_info.flags = EVDS_OBJECT_SAVEEX_ONLY_CHILDREN;
+		ERROR_CHECK(EVDS_Object_SaveEx(container2,0,&save_info));
+		STRING_EQUAL_TO(description,save_info.description);
+		free(description);
+		free(save_info.description);
+
+		/// Only first object is loaded
+		count = 0;
+		info.flags = EVDS_OBJECT_LOADEX_STREAMING | EVDS_OBJECT_LOADEX_ONLY_FIRST;
+		info.firstObject = 0;
+		ERROR_CHECK(EVDS_Object_Create(root,&container2));
+		ERROR_CHECK(EVDS_Object_LoadEx(container2,0,&info));
+		EQUAL_TO(info.firstObject->parent,container2);
+		ERROR_CHECK(EVDS_System_GetObjectByName(system,container2,"Vessel",&object));
+		EQUAL_TO(EVDS_System_GetObjectByName(system,container2,"Probe",&object),EVDS_ERROR_NOT_FOUND);
+
+		/// Files larger than the read window
+		file = fopen("evds_test_stream.evds","w+");
+		fprintf(file,"<EVDS version=\"35\">\n");
+		for (i = 0; i < 2000; i++) {
+			fprintf(file,"\t<object name=\"Object %d\" type=\"vessel\" x=\"%d\">\n",i,i);
+			fprintf(file,"\t\t<parameter name=\"mass\">%d</parameter>\n",i+1);
+			fprintf(file,"\t\t<parameter name=\"comments\">");
+			for (j = 0; j < i; j++) fputc('x',file);
+			fprintf(file,"</parameter>\n");
+			fprintf(file,"\t</object>\n");
+		}
+		fprintf(file,"</EVDS>\n");
+		fclose(file);
+
+		count = 0;
+		info.flags = EVDS_OBJECT_LOADEX_STREAMING;
+		info.description = 0;
+		ERROR_CHECK(EVDS_Object_Create(root,&container2));
+		ERROR_CHECK(EVDS_Object_LoadEx(container2,"evds_test_stream.evds",&info));
+		remove("evds_test_stream.evds");
+		EQUAL_TO(count,2000);
+		ERROR_CHECK(EVDS_System_GetObjectByName(system,container2,"Object 1999",&object));
+		ERROR_CHECK(EVDS_Object_GetRealVariable(object,"mass",&real,0));
+		REAL_EQUAL_TO(real,2000.0);
+		ERROR_CHECK(EVDS_Object_GetVariable(object,"comments",&variable));
+		ERROR_CHECK(EVDS_Variable_GetString(variable,string,8192,0));
+		EQUAL_TO(strlen(string),1999);
+
+		/// Malformed input
+		info.description = "<EVDS><object name=\"Broken\"><parameter name=\"mass\">1</parameter>";
+		EQUAL_TO(EVDS_Object_LoadEx(container2,0,&info),EVDS_ERROR_SYNTAX);
+		info.description = "<EVDS><object name=\"Broken\"></EVDS></object>";
+		EQUAL_TO(EVDS_Object_LoadEx(container2,0,&info),EVDS_ERROR_SYNTAX);
+		info.description = "<EVDS><object name=\"Broken";
+		EQUAL_TO(EVDS_Object_LoadEx(container2,0,&info),EVDS_ERROR_SYNTAX);
+		info.description = "<object name=\"Broken\"/>";
+		EQUAL_TO(EVDS_Object_LoadEx(container2,0,&info),EVDS_ERROR_SYNTAX);
+		info.description = 0;
+		EQUAL_TO(EVDS_Object_LoadEx(container2,"evds_test_missing.evds",&info),EVDS_ERROR_FILE);
+	} END_TEST
+
+	START_TEST("Parallel initialization") {
+		EVDS_GLOBAL_CALLBACKS callbacks = { 0 };
+		EVDS_OBJECT *vessel,*child,*nested,*engine;
+		EVDS_OBJECT* vessels[32];
+		int count,i,j,is_initialized;
+
+		callbacks.OnPostInitialize = Test_OnPostInitialize;
+		ERROR_CHECK(EVDS_System_SetGlobalCallbacks(system,&callbacks));
+		ERROR_CHECK(EVDS_System_SetWorkerThreads(system,4));
+
+		/// Non-blocking initialization through worker threads
+		for (i = 0; i < 500; i++) {
+			ERROR_CHECK(EVDS_Object_Create(root,&vessel));
+			ERROR_CHECK(EVDS_Object_SetType(vessel,"vessel"));
+			for (j = 0; j < 4; j++) {
+				ERROR_CHECK(EVDS_Object_Create(vessel,&child));
+				ERROR_CHECK(EVDS_Object_SetType(child,"static_body"));
+				ERROR_CHECK(EVDS_Object_SetName(child,"Child"));
+				ERROR_CHECK(EVDS_Object_AddRealVariable(child,"mass",10.0,0));
+				ERROR_CHECK(EVDS_Object_Create(child,&nested));
+				ERROR_CHECK(EVDS_Object_AddRealVariable(nested,"mass",1.0,0));
+			}
+			ERROR_CHECK(EVDS_Object_Initialize(vessel,0));
+			EQUAL_TO(EVDS_Object_Initialize(vessel,0),EVDS_ERROR_BAD_STATE);
+		}
+		ERROR_CHECK(EVDS_System_WaitForInitialization(system));
+
+		count = 0;
+		ERROR_CHECK(EVDS_Object_GetChildren(root,&list));
+		entry = SIMC_List_GetFirst(list);
+		while (entry) {
+			SIMC_LIST* children;
+			SIMC_LIST_ENTRY* child_entry;
+			vessel = (EVDS_OBJECT*)SIMC_List_GetData(list,entry);
+			ERROR_CHECK(EVDS_Object_GetChildren(vessel,&children));
+			child_entry = SIMC_List_GetFirst(children);
+			j = 0;
+			while (child_entry) {
+				j++;
+				child_entry = SIMC_List_GetNext(children,child_entry);
+			}
+			if (j == 4) count++;
+			entry = SIMC_List_GetNext(list,entry);
+		}
+		EQUAL_TO(count,500);
+		ERROR_CHECK(EVDS_System_GetObjectByName(system,vessel,"Child",&object));
+		ERROR_CHECK(EVDS_System_GetObjectByName(system,vessel,"Child (3)",&object));
+
+		/// Blocking initialization through worker threads
+		ERROR_CHECK(EVDS_Object_Create(root,&vessel));
+		ERROR_CHECK(EVDS_Object_Create(vessel,&child));
+		ERROR_CHECK(EVDS_Object_Create(child,&nested));
+		ERROR_CHECK(EVDS_Object_Initialize(vessel,1));
+		ERROR_CHECK(EVDS_Object_IsInitialized(vessel,&is_initialized));
+		EQUAL_TO(is_initialized,1);
+		ERROR_CHECK(EVDS_Object_IsInitialized(nested,&is_initialized));
+		EQUAL_TO(is_initialized,1);
+
+		/// Siblings are initialized in the order they are listed (engine finds tanks listed before it)
+		for (i = 0; i < 32; i++) {
+			ERROR_CHECK(EVDS_Object_LoadFromString(root,
+"<EVDS version=\"34\">"
+"    <object name=\"Vessel\" type=\"vessel\">"
+"        <object name=\"Oxidizer\" type=\"fuel_tank\">"
+"            <parameter name=\"fuel.type\">O2</parameter>"
+"            <parameter name=\"fuel.mass\">4000</parameter>"
+"        </object>"
+"        <object name=\"Fuel\" type=\"fuel_tank\">"
+"            <parameter name=\"fuel.type\">H2</parameter>"
+"            <parameter name=\"fuel.mass\">1000</parameter>"
+"        </object>"
+"        <object name=\"Rocket engine\" type=\"rocket_engine\">"
+"            <parameter name=\"mass\">1000</parameter>"
+"            <parameter name=\"vacuum.isp\">400.0</parameter>"
+"            <parameter name=\"vacuum.thrust\">100.0</parameter>"
+"        </object>"
+"    </object>"
+"</EVDS>",&vessels[i]));
+			ERROR_CHECK(EVDS_Object_Initialize(vessels[i],0));
+		}
+		ERROR_CHECK(EVDS_System_WaitForInitialization(system));
+
+		count = 0;
+		for (i = 0; i < 32; i++) {
+			char fuel[64] = { 0 };
+			char oxidizer[64] = { 0 };
+			ERROR_CHECK(EVDS_System_GetObjectByName(system,vessels[i],"Rocket engine",&engine));
+			if (EVDS_Object_GetVariable(engine,"combustion.fuel",&variable) == EVDS_OK) {
+				EVDS_Variable_GetString(variable,fuel,63,0);
+			}
+			if (EVDS_Object_GetVariable(engine,"combustion.oxidizer",&variable) == EVDS_OK) {
+				EVDS_Variable_GetString(variable,oxidizer,63,0);
+			}
+			if ((strcmp(fuel,"H2") == 0) && (strcmp(oxidizer,"O2") == 0) &&
+				(EVDS_Object_GetRealVariable(engine,"combustion.of_ratio",&real,0) == EVDS_OK) &&
+				(fabs(real - 4.0) < 1e-9)) count++;
+		}
+		EQUAL_TO(count,32);
+
+		/// Non-blocking initialization without worker threads
+		ERROR_CHECK(EVDS_System_SetWorkerThreads(system,0));
+		ERROR_CHECK(EVDS_Object_Create(root,&vessel));
+		ERROR_CHECK(EVDS_Object_Create(vessel,&child));
+		ERROR_CHECK(EVDS_Object_Initialize(vessel,0));
+		ERROR_CHECK(EVDS_System_WaitForInitialization(system));
+		ERROR_CHECK(EVDS_Object_IsInitialized(vessel,&is_initialized));
+		EQUAL_TO(is_initialized,1);
+
+		EQUAL_TO(EVDS_System_WaitForInitialization(0),EVDS_ERROR_BAD_PARAMETER);
+
+		/// Remove callbacks installed by this test
+		memset(&callbacks,0,sizeof(callbacks));
+		ERROR_CHECK(EVDS_System_SetGlobalCallbacks(system,&callbacks));
+	} END_TEST
+
+
+	START_TEST("EVDS_StringToReal") {
+		const char* numbers[] = { "0", "-0.0", "12.5", "0.001", "1e10", "-2.5E-3", "1e22", "3e-22",
+			"123456789012345", "0.1", "1e", "1e+", "1.5e-x", "29.999999999999996", "1e300", "1e-300",
+			"0x10", "nan", ".5", "5." };
+		EVDS_OBJECT_LOADEX info = { 0 };
+		EVDS_VARIABLE* variable;
+		EVDS_OBJECT* tank;
+		EVDS_REAL value;
+		char *end,*strtod_end;
+		int i;
+
+		/// Numbers are parsed exactly like strtod() does
+		for (i = 0; i < (int)(sizeof(numbers)/sizeof(numbers[0])); i++) {
+			EVDS_REAL strtod_value = strtod(numbers[i],&strtod_end);
+			EVDS_StringToReal(numbers[i],&end,&value);
+			SILENT_EQUAL_TO(end,strtod_end);
+			if (strtod_value == strtod_value) {
+				SILENT_EQUAL_TO(value,strtod_value);
+			}
+		}
+
+		/// Units of measurement
+		ERROR_CHECK(EVDS_StringToReal("10 m",0,&value));
+		REAL_EQUAL_TO(value,10.0);
+		ERROR_CHECK(EVDS_StringToReal("10 ft",0,&value));
+		REAL_EQUAL_TO(value,3.048);
+		ERROR_CHECK(EVDS_StringToReal("10 C",0,&value));
+		REAL_EQUAL_TO(value,283.15);
+		ERROR_CHECK(EVDS_StringToReal("2 lb",0,&value));
+		REAL_EQUAL_TO(value,(2*0.453592));
+		ERROR_CHECK(EVDS_StringToReal("2 lbs",0,&value));
+		REAL_EQUAL_TO(value,(2*0.453592));
+		ERROR_CHECK(EVDS_StringToReal("1 lb/ft3",0,&value));
+		REAL_EQUAL_TO(value,16.0184634);
+		ERROR_CHECK(EVDS_StringToReal("1.5 bar",0,&value));
+		REAL_EQUAL_TO(value,1.5e5);
+		ERROR_CHECK(EVDS_StringToReal("  1.0+",0,&value));
+		REAL_EQUAL_TO(value,(1.0+EVDS_EPS));
+		EQUAL_TO(EVDS_StringToReal("10 furlongs",0,&value),EVDS_ERROR_SYNTAX);
+		EQUAL_TO(EVDS_StringToReal("10 lbx",0,&value),EVDS_ERROR_SYNTAX);
+
+		/// Parameters of old files are renamed
+		info.description =
+"<?xml version=\"1.0\"?>"
+"<EVDS version=\"31\">"
+"	<object name=\"Tank\" type=\"fuel_tank\">"
+"		<parameter name=\"fuel_mass\">100</parameter>"
+"		<parameter name=\"outer_radius\">2 ft</parameter>"
+"		<parameter name=\"mass\">10</parameter>"
+"	</object>"
+"</EVDS>";
+		ERROR_CHECK(EVDS_Object_LoadEx(root,0,&info));
+		ERROR_CHECK(EVDS_System_GetObjectByName(system,0,"Tank",&tank));
+		ERROR_CHECK(EVDS_Object_GetVariable(tank,"fuel.mass",&variable));
+		ERROR_CHECK(EVDS_Variable_GetReal(variable,&value));
+		REAL_EQUAL_TO(value,100.0);
+		ERROR_CHECK(EVDS_Object_GetVariable(tank,"geometry.outer_radius",&variable));
+		ERROR_CHECK(EVDS_Variable_GetReal(variable,&value));
+		REAL_EQUAL_TO(value,0.6096);
+		ERROR_CHECK(EVDS_Object_GetVariable(tank,"mass",&variable));
+		EQUAL_TO(EVDS_Object_GetVariable(tank,"fuel_mass",&variable),EVDS_ERROR_NOT_FOUND);
+	} END_TEST
+}